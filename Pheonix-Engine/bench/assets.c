@@ -0,0 +1,214 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <core/image.h>
+#include <loaders/sdf-loader.h>
+#include <loaders/ptex-loader.h>
+#include <asset-sys/pack.h>
+#include <asset-sys/vfs.h>
+#include <external/cJSON.h>
+
+#define ASSETS_JSON_PATH "assets/fonts/raw/sdf/Roboto/roboto.json"
+#define ASSETS_PSDF_PATH "assets/fonts/psdf/roboto.psdf"
+#define ASSETS_PNG_PATH "assets/icons/logo.png"
+#define ASSETS_PTEX_PATH "bench.ptex"
+#define ASSETS_PACK_PATH "bench.pxpak"
+
+struct assets_ctx {
+    char* json;
+    size_t json_size;
+
+    unsigned char* png;
+    size_t png_size;
+    unsigned char* pixels;
+    size_t stride;
+};
+
+static void run_cjson(void* p) {
+    struct assets_ctx* c = p;
+    cJSON* root = cJSON_ParseWithLength(c->json, c->json_size);
+    px_bench_consume(root != NULL);
+    cJSON_Delete(root);
+}
+
+static void run_psdf(void* p) {
+    (void)p;
+    struct px_sdf_font_source src;
+    if (px_sdf_read(ASSETS_PSDF_PATH, &src) == ERR_SUCCESS) {
+        px_bench_consume(src.header.glyph_count);
+        px_sdf_source_free(&src);
+    }
+}
+
+static void run_png(void* p) {
+    struct assets_ctx* c = p;
+    PX_ImageInfo info;
+    px_bench_consume(image_png_decode(c->png, c->png_size, &info, c->pixels, c->stride) == ERR_SUCCESS);
+}
+
+// Rewrites the cooked file with one change to see the read turn it down
+static t_err_codes read_patched(size_t at, const void* bytes, size_t len) {
+    size_t size = 0;
+    char* data = px_bench_read_file(ASSETS_PTEX_PATH, &size);
+    if (!data || at + len > size) {
+        free(data);
+        return ERR_UNKNOWN;
+    }
+    memcpy(data + at, bytes, len);
+
+    const char* patched = ASSETS_PTEX_PATH ".bad";
+    FILE* f = fopen(patched, "wb");
+    bool written = f && fwrite(data, 1, size, f) == size;
+    if (f) fclose(f);
+    free(data);
+
+    t_err_codes err = ERR_UNKNOWN;
+    struct px_ptex_source src;
+    if (written) {
+        err = px_ptex_read(patched, &src);
+        if (err == ERR_SUCCESS)
+            px_ptex_source_free(&src);
+    }
+    remove(patched);
+    return err;
+}
+
+static int check_ptex(void) {
+    struct px_ptex_source src;
+    uint32_t reshaped[2] = {0};
+    PX_PTexBuildDesc desc = { .premultiply = true, .mipmaps = true };
+    bool ok = px_ptex_build(ASSETS_PNG_PATH, ASSETS_PTEX_PATH, &desc) == ERR_SUCCESS &&
+              px_ptex_read(ASSETS_PTEX_PATH, &src) == ERR_SUCCESS;
+    if (ok) {
+        ok = src.header.mip_count > 1 && src.mips[1].width % 2 == 0;
+        // Same byte count as mip 1, but not half of mip 0
+        reshaped[0] = src.mips[1].width / 2;
+        reshaped[1] = src.mips[1].height * 2;
+        px_ptex_source_free(&src);
+    }
+
+    size_t header = sizeof(struct px_ptex_header), mip = sizeof(struct px_ptex_mip);
+    size_t mip1_width = header + mip + offsetof(struct px_ptex_mip, width);
+    uint32_t huge[2] = { UINT32_MAX, UINT32_MAX }, zero = 0;
+    bool rejected = ok &&
+                    read_patched(mip1_width, reshaped, sizeof(reshaped)) == ERR_INTERNAL &&
+                    read_patched(offsetof(struct px_ptex_header, width), huge, sizeof(huge)) == ERR_INTERNAL &&
+                    read_patched(offsetof(struct px_ptex_header, width), &zero, sizeof(zero)) == ERR_INTERNAL &&
+                    read_patched(header + offsetof(struct px_ptex_mip, size), &zero, sizeof(zero)) == ERR_INTERNAL;
+    printf("ptex rejects broken files: %s\n", rejected ? "matches expected" : "MISMATCH");
+
+    remove(ASSETS_PTEX_PATH);
+    return rejected ? 0 : 1;
+}
+
+// Mounts the pack with one change and opens path from it; source is where the
+// bytes came from, PX_VFS_SOURCE_NONE when the mount or the open failed
+static t_err_codes mount_patched(size_t at, const void* bytes, size_t len, const char* path, PX_VFSSource* source) {
+    size_t size = 0;
+    char* data = px_bench_read_file(ASSETS_PACK_PATH, &size);
+    *source = PX_VFS_SOURCE_NONE;
+    if (!data || at + len > size) {
+        free(data);
+        return ERR_UNKNOWN;
+    }
+    memcpy(data + at, bytes, len);
+
+    const char* patched = ASSETS_PACK_PATH ".bad";
+    FILE* f = fopen(patched, "wb");
+    bool written = f && fwrite(data, 1, size, f) == size;
+    if (f) fclose(f);
+    free(data);
+
+    t_err_codes err = written ? px_vfs_mount(patched) : ERR_UNKNOWN;
+    PX_VFile file;
+    if (err == ERR_SUCCESS && px_vfs_open(path, &file) == ERR_SUCCESS) {
+        *source = file.source;
+        px_vfs_close(&file);
+    }
+    px_vfs_unmount();
+    remove(patched);
+    return err;
+}
+
+// Offsets picked so that offset + length wraps around to a small value
+static int check_pack(void) {
+    static const char* const roots[] = { "shaders" };
+    px_vfs_set_loose_override(false);
+
+    size_t size = 0;
+    char* data = px_pack_build(ASSETS_PACK_PATH, roots, 1) == ERR_SUCCESS ? px_bench_read_file(ASSETS_PACK_PATH, &size) : NULL;
+    struct px_pack_header h = {0};
+    struct px_pack_entry e = {0};
+    char path[256] = {0};
+    bool ok = data && size >= sizeof(h);
+    if (ok) {
+        memcpy(&h, data, sizeof(h));
+        ok = h.entry_count > 0 && h.entries_offset + sizeof(e) <= size;
+    }
+    if (ok) {
+        memcpy(&e, data + h.entries_offset, sizeof(e));
+        ok = e.path_len < sizeof(path) && h.strings_offset + e.path_offset + e.path_len <= size;
+    }
+    if (ok)
+        memcpy(path, data + h.strings_offset + e.path_offset, e.path_len);
+    free(data);
+
+    PX_VFSSource source;
+    uint64_t wrap = UINT64_MAX;
+    ok = ok && mount_patched(0, &h.magic, sizeof(h.magic), path, &source) == ERR_SUCCESS && source == PX_VFS_SOURCE_PACK;
+    ok = ok && mount_patched(offsetof(struct px_pack_header, entries_offset), &wrap, sizeof(wrap), path, &source) == ERR_INTERNAL;
+    ok = ok && mount_patched(offsetof(struct px_pack_header, strings_offset), &wrap, sizeof(wrap), path, &source) == ERR_INTERNAL;
+    // A broken entry is not served from the pack, the loose file is used instead
+    ok = ok && mount_patched(h.entries_offset + offsetof(struct px_pack_entry, offset), &wrap, sizeof(wrap), path, &source) == ERR_SUCCESS &&
+         source == PX_VFS_SOURCE_LOOSE;
+    printf("pack rejects wrapping offsets: %s\n", ok ? "matches expected" : "MISMATCH");
+
+    // Back to the build's default
+#ifdef NDEBUG
+    px_vfs_set_loose_override(false);
+#else
+    px_vfs_set_loose_override(true);
+#endif
+    remove(ASSETS_PACK_PATH);
+    return ok ? 0 : 1;
+}
+
+int bench_assets(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    struct assets_ctx ctx = {0};
+    PX_ImageInfo info;
+    int result = 0;
+
+    ctx.json = px_bench_read_file(ASSETS_JSON_PATH, &ctx.json_size);
+    ctx.png = (unsigned char*)px_bench_read_file(ASSETS_PNG_PATH, &ctx.png_size);
+    if (!ctx.json || !ctx.png || image_png_info(ctx.png, ctx.png_size, &info) != ERR_SUCCESS) {
+        fprintf(stderr, "Could not open %s or %s\n", ASSETS_JSON_PATH, ASSETS_PNG_PATH);
+        result = 1;
+        goto done;
+    }
+    ctx.stride = (size_t)info.width * IMAGE_CHANNELS;
+    ctx.pixels = (unsigned char*)malloc(ctx.stride * info.height);
+    if (!ctx.pixels) {
+        result = 1;
+        goto done;
+    }
+
+    result = check_ptex() | check_pack();
+
+    px_bench_run("cjson_parse_roboto", run_cjson, &ctx);
+    px_bench_run("psdf_load_roboto", run_psdf, &ctx);
+    px_bench_run("png_decode_logo", run_png, &ctx);
+
+done:
+    free(ctx.json);
+    free(ctx.png);
+    free(ctx.pixels);
+    return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#include <font.h>
+
+#define PX_BENCH_NAME_MAX 64
+#define PX_BENCH_MAX_RESULTS 256
+
+typedef int (*px_bench_fn)(int argc, char** argv);
+
+typedef struct {
+    const char* name;
+    const char* description;
+    px_bench_fn run;
+} PX_BenchCase;
+
+static inline uint64_t px_bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Shared by every case, set from the command line
+typedef struct {
+    int warmup; // untimed samples before measuring
+    int samples; // timed samples per measurement
+    double min_sample_ms; // the body is repeated until one sample takes this long
+} PX_BenchConfig;
+
+extern PX_BenchConfig px_bench_config;
+
+// Per-call times over all samples of one measurement
+typedef struct {
+    char name[PX_BENCH_NAME_MAX]; // "<case>/<measurement>"
+    uint64_t iterations; // calls per sample
+    int samples;
+    double min_ns;
+    double median_ns;
+    double mean_ns;
+    double stddev_ns;
+    double p95_ns;
+    double max_ns;
+} PX_BenchResult;
+
+typedef void (*px_bench_body)(void* ctx);
+
+// Calibrates, warms up and samples body, then prints and records the result
+const PX_BenchResult* px_bench_run(const char* name, px_bench_body body, void* ctx);
+// Keeps the optimizer from discarding results computed only for timing
+void px_bench_consume(uint64_t value);
+
+void px_bench_begin_case(const char* name);
+int px_bench_result_count(void);
+const PX_BenchResult* px_bench_result(int index);
+int px_bench_write_json(const char* path);
+// Compares medians against a file from --json; returns the regression count or -1
+int px_bench_compare(const char* baseline_path, double threshold_pct);
+
+// Font from a PSDF with no GL texture, for cases on the headless UI
+PX_Font* px_bench_load_font(const char* path);
+// Whole file into memory, NUL terminated
+char* px_bench_read_file(const char* path, size_t* out_size);
+
+// Cases
+int bench_sdf_json(int argc, char** argv);
+int bench_pixel(int argc, char** argv);
+int bench_text(int argc, char** argv);
+int bench_editor(int argc, char** argv);
+int bench_assets(int argc, char** argv);
+int bench_window_input(int argc, char** argv);
+int bench_jobs(int argc, char** argv);
+int bench_hit_test(int argc, char** argv);
+int bench_layout(int argc, char** argv);
+int bench_transform(int argc, char** argv);
+int bench_project(int argc, char** argv);
+int bench_signals(int argc, char** argv);
@@ -0,0 +1,322 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <editor.h>
+#include <rendering-sys.h>
+
+#define EDITOR_FONT_PATH "assets/fonts/psdf/roboto.psdf"
+#define EDITOR_ADD_SMALL 1000
+#define EDITOR_ADD_LARGE 10000
+#define EDITOR_WALK_COUNT 1000000
+#define EDITOR_DRAW_SMALL 10
+#define EDITOR_FANOUT 8
+
+// The scene as it was before the pools: one heap node per object, siblings
+// found by walking from the first child on every append
+struct list_object {
+    struct list_object* parent;
+    struct list_object* child;
+    struct list_object* next;
+    int child_count;
+    const char* name;
+};
+
+struct editor_ctx {
+    PX_Font* font;
+    char (*names)[16];
+    int count;
+    bool flat; // everything at the top level, the widest sibling lists there are
+
+    struct list_object* list;
+    PX_EditorScene scene;
+};
+
+static void list_add(struct list_object* parent, struct list_object* obj) {
+    if (!parent->child) {
+        parent->child = obj;
+        parent->child_count = 1;
+        return;
+    }
+    struct list_object* tail = parent->child;
+    while (tail->next)
+        tail = tail->next;
+    tail->next = obj;
+    parent->child_count++;
+}
+
+// Parent of object i in a tree EDITOR_FANOUT wide; the first EDITOR_FANOUT sit at the top level
+static int tree_parent(int i) {
+    return i < EDITOR_FANOUT ? -1 : i / EDITOR_FANOUT - 1;
+}
+
+static int object_parent(const struct editor_ctx* c, int i) {
+    return c->flat ? -1 : tree_parent(i);
+}
+
+static void build_list(struct editor_ctx* c) {
+    struct list_object* root = &c->list[c->count];
+    memset(root, 0, sizeof(*root));
+    for (int i = 0; i < c->count; i++) {
+        struct list_object* obj = &c->list[i];
+        memset(obj, 0, sizeof(*obj));
+        obj->name = c->names[i];
+        int p = object_parent(c, i);
+        obj->parent = p < 0 ? root : &c->list[p];
+        list_add(obj->parent, obj);
+    }
+}
+
+// Handles come back in insertion order, so object i's parent is handles[tree_parent(i)]
+static PX_EditorHandle* g_handles;
+
+static bool build_scene(struct editor_ctx* c) {
+    editor_scene_free(&c->scene);
+    if (editor_scene_init(&c->scene, (uint32_t)c->count + 1) != ERR_SUCCESS)
+        return false;
+    for (int i = 0; i < c->count; i++) {
+        int p = object_parent(c, i);
+        g_handles[i] = editor_scene_add(&c->scene, p < 0 ? PX_EDITOR_NULL_HANDLE : g_handles[p], c->names[i]);
+        if (g_handles[i] == PX_EDITOR_NULL_HANDLE)
+            return false;
+    }
+    return true;
+}
+
+// Order dependent, so both walks only agree when they visit in the same order
+static uint64_t walk_hash(uint64_t h, uint32_t depth, const char* name) {
+    return (h ^ (depth * 131u + (unsigned char)name[3] + (unsigned char)name[4] * 7u)) * 1099511628211ull;
+}
+
+static uint64_t walk_list(const struct list_object* obj, uint32_t depth, uint64_t h) {
+    for (; obj; obj = obj->next)
+        h = walk_list(obj->child, depth + 1, walk_hash(h, depth, obj->name));
+    return h;
+}
+
+static uint64_t walk_scene(PX_EditorScene* s) {
+    editor_scene_sort(s);
+    uint64_t h = 14695981039346656037ull;
+    for (uint32_t i = 1; i < s->count; i++)
+        h = walk_hash(h, s->depth[i] - 1, s->name[i]);
+    return h;
+}
+
+// Stale handles, subtree removal, and pre-order after the holes are filled and sorted
+static int check_scene(struct editor_ctx* c) {
+    bool ok = build_scene(c);
+    // Breadth first insertion, so the slots are not in pre-order until walked
+    ok = ok && c->scene.count == (uint32_t)c->count + 1 && !c->scene.sorted;
+
+    build_list(c);
+    uint64_t expected = walk_list(c->list[c->count].child, 0, 14695981039346656037ull);
+    ok = ok && walk_scene(&c->scene) == expected;
+
+    // Object 1 owns objects 16 to 23 and everything below those
+    PX_EditorHandle removed = g_handles[1];
+    PX_EditorHandle grandchild = g_handles[(16 + 1) * EDITOR_FANOUT];
+    uint32_t before = c->scene.count;
+    ok = ok && editor_scene_remove(&c->scene, removed);
+    ok = ok && editor_scene_slot(&c->scene, removed) == PX_EDITOR_NO_SLOT &&
+         editor_scene_slot(&c->scene, grandchild) == PX_EDITOR_NO_SLOT && !c->scene.sorted;
+    ok = ok && !editor_scene_remove(&c->scene, removed) && !editor_scene_remove(&c->scene, editor_scene_root(&c->scene));
+
+    // Same tree through the old nodes, with object 1 unlinked
+    struct list_object* root = &c->list[c->count];
+    struct list_object* gone = &c->list[1];
+    c->list[0].next = gone->next;
+    root->child_count--;
+    uint32_t subtree = 1;
+    for (int i = 2; i < c->count; i++) {
+        int p = i;
+        while (p >= 0 && p != 1)
+            p = tree_parent(p);
+        subtree += p == 1;
+    }
+    ok = ok && c->scene.count == before - subtree;
+    ok = ok && walk_scene(&c->scene) == walk_list(root->child, 0, 14695981039346656037ull) && c->scene.sorted;
+
+    // A freed id comes back with a new generation, the old handle stays dead
+    PX_EditorHandle reused = editor_scene_add(&c->scene, PX_EDITOR_NULL_HANDLE, "reused");
+    ok = ok && reused != removed && (uint32_t)reused == (uint32_t)removed &&
+         editor_scene_slot(&c->scene, removed) == PX_EDITOR_NO_SLOT &&
+         editor_scene_slot(&c->scene, reused) == c->scene.count - 1 && c->scene.sorted;
+
+    printf("scene: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static bool rows_match_rebuild(PX_EditorHierarchy* h, const PX_EditorScene* s) {
+    PX_EditorHierarchy fresh = {0};
+    editor_hierarchy_sync(&fresh, s);
+    bool ok = h->valid && h->revision == s->revision && fresh.row_count == h->row_count &&
+              memcmp(fresh.rows, h->rows, sizeof(uint32_t) * h->row_count) == 0;
+    editor_hierarchy_free(&fresh);
+    return ok;
+}
+
+// Depth first adds patch the rows in place; collapse, expand and remove agree with a rebuild
+static int check_hierarchy(struct editor_ctx* c) {
+    PX_EditorHierarchy h = {0};
+    PX_EditorHandle last[4] = {0};
+    bool ok = editor_scene_init(&c->scene, 0) == ERR_SUCCESS;
+    editor_hierarchy_sync(&h, &c->scene);
+    for (int i = 0; i < 64 && ok; i++) {
+        int level = i % 4;
+        last[level] = editor_scene_add(&c->scene, level == 0 ? PX_EDITOR_NULL_HANDLE : last[level - 1], c->names[i]);
+        editor_hierarchy_added(&h, &c->scene, last[level]);
+        ok = h.revision == c->scene.revision;
+    }
+    ok = ok && h.row_count == 65 && rows_match_rebuild(&h, &c->scene);
+
+    // Slot 5 heads the second chain of four
+    PX_EditorHandle head = c->scene.handle[5];
+    editor_hierarchy_set_collapsed(&h, &c->scene, head, true);
+    ok = ok && h.row_count == 62 && rows_match_rebuild(&h, &c->scene);
+    // Added under a collapsed object, there is no row for it
+    PX_EditorHandle hidden = editor_scene_add(&c->scene, c->scene.handle[6], "hidden");
+    editor_hierarchy_added(&h, &c->scene, hidden);
+    ok = ok && h.row_count == 62 && rows_match_rebuild(&h, &c->scene);
+    editor_hierarchy_set_collapsed(&h, &c->scene, head, false);
+    ok = ok && h.row_count == 66 && rows_match_rebuild(&h, &c->scene);
+
+    // Collapsed inside a collapsed parent, expanding the parent keeps the child's rows out
+    editor_hierarchy_set_collapsed(&h, &c->scene, c->scene.handle[6], true);
+    editor_hierarchy_set_collapsed(&h, &c->scene, head, true);
+    editor_hierarchy_set_collapsed(&h, &c->scene, head, false);
+    ok = ok && h.row_count == 63 && rows_match_rebuild(&h, &c->scene);
+
+    editor_scene_remove(&c->scene, head);
+    editor_hierarchy_sync(&h, &c->scene);
+    ok = ok && h.row_count == 61 && rows_match_rebuild(&h, &c->scene);
+
+    editor_hierarchy_free(&h);
+    editor_scene_free(&c->scene);
+    printf("hierarchy: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static void run_list_add(void* p) {
+    struct editor_ctx* c = p;
+    build_list(c);
+    px_bench_consume((uint64_t)c->list[c->count].child_count);
+}
+
+static void run_scene_add(void* p) {
+    struct editor_ctx* c = p;
+    px_bench_consume(build_scene(c) ? c->scene.count : 0);
+}
+
+static void run_list_walk(void* p) {
+    struct editor_ctx* c = p;
+    px_bench_consume(walk_list(c->list[c->count].child, 0, 0));
+}
+
+static void run_scene_walk(void* p) {
+    struct editor_ctx* c = p;
+    px_bench_consume(walk_scene(&c->scene));
+}
+
+static void run_draw(void* p) {
+    struct editor_ctx* c = p;
+    px_rs_frame_start();
+    editor_draw_scene_panel(
+        (PX_Transform2){{0, 30}, {320, 720}},
+        (PX_Color4){0x0A, 0x0A, 0x0A, 0x80},
+        (PX_Color4){0xFF, 0xFF, 0xFF, 0xFF},
+        (PX_Color4){0x14, 0x14, 0x14, 0xFF},
+        0.03f, 0.0f,
+        c->font, 16.0f,
+        8, 32
+    );
+}
+
+static int setup(struct editor_ctx* c, int count) {
+    c->count = count;
+    c->names = calloc(count, sizeof(*c->names));
+    c->list = (struct list_object*)calloc((size_t)count + 1, sizeof(struct list_object));
+    g_handles = (PX_EditorHandle*)calloc(count, sizeof(PX_EditorHandle));
+    if (!c->names || !c->list || !g_handles)
+        return 1;
+    for (int i = 0; i < count; i++)
+        snprintf(c->names[i], sizeof(c->names[i]), "obj%d", i);
+    return 0;
+}
+
+static void teardown(struct editor_ctx* c) {
+    free(c->names);
+    free(c->list);
+    free(g_handles);
+    editor_scene_free(&c->scene);
+    c->names = NULL;
+    c->list = NULL;
+    g_handles = NULL;
+}
+
+int bench_editor(int argc, char** argv) {
+    const char* font_path = argc > 0 ? argv[0] : EDITOR_FONT_PATH;
+    int result = 0;
+
+    struct editor_ctx ctx = {0};
+    static const struct { int count; const char* list; const char* scene; } adds[] = {
+        { EDITOR_ADD_SMALL, "list_add_flat_1000", "scene_add_flat_1000" },
+        { EDITOR_ADD_LARGE, "list_add_flat_10000", "scene_add_flat_10000" }
+    };
+    for (size_t i = 0; i < sizeof(adds) / sizeof(adds[0]) && result == 0; i++) {
+        result = setup(&ctx, adds[i].count);
+        if (result == 0 && i == 0)
+            result = check_scene(&ctx);
+        if (result == 0) {
+            ctx.flat = true;
+            px_bench_run(adds[i].list, run_list_add, &ctx);
+            px_bench_run(adds[i].scene, run_scene_add, &ctx);
+            ctx.flat = false;
+        }
+        teardown(&ctx);
+    }
+
+    // A million objects: built once, walked depth first both ways
+    if (result == 0 && setup(&ctx, EDITOR_WALK_COUNT) == 0 && build_scene(&ctx)) {
+        build_list(&ctx);
+        px_bench_run("scene_add_tree_1m", run_scene_add, &ctx);
+        px_bench_run("list_walk_1m", run_list_walk, &ctx);
+        px_bench_run("scene_walk_1m", run_scene_walk, &ctx);
+    } else {
+        result = 1;
+    }
+    teardown(&ctx);
+
+    // The panel draws what fits in it, 10 objects or a million
+    static const struct { int count; const char* name; } draws[] = {
+        { EDITOR_DRAW_SMALL, "draw_scene_panel_10" },
+        { EDITOR_WALK_COUNT, "draw_scene_panel_1m" }
+    };
+    PX_EditorState* state = editor_get_state();
+    ctx.font = px_bench_load_font(font_path);
+    if (result != 0 || !ctx.font || px_rs_init_ui_headless((PX_Scale2){1280, 720}) != ERR_SUCCESS)
+        result = 1;
+    for (size_t i = 0; i < sizeof(draws) / sizeof(draws[0]) && result == 0; i++) {
+        result = setup(&ctx, draws[i].count);
+        if (result == 0 && i == 0)
+            result = check_hierarchy(&ctx);
+        if (result == 0) {
+            editor_new_project("bench");
+            for (int j = 0; j < ctx.count; j++) {
+                int p = tree_parent(j);
+                g_handles[j] = editor_add_object(p < 0 ? PX_EDITOR_NULL_HANDLE : g_handles[p], ctx.names[j]);
+            }
+            px_bench_run(draws[i].name, run_draw, &ctx);
+            printf("\t%u of %u rows drawn\n", state->hierarchy.drawn, state->hierarchy.row_count);
+            editor_scene_free(&state->scene);
+            editor_hierarchy_free(&state->hierarchy);
+        }
+        teardown(&ctx);
+    }
+    px_rs_shutdown_ui();
+
+    teardown(&ctx);
+    px_font_destroy(ctx.font);
+    return result;
+}
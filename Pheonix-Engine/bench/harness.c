@@ -0,0 +1,225 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <loaders/sdf-loader.h>
+#include <external/cJSON.h>
+
+#define BENCH_MAX_ITERATIONS (1ull << 30)
+
+PX_BenchConfig px_bench_config = {
+    .warmup = 3,
+    .samples = 15,
+    .min_sample_ms = 5.0
+};
+
+static PX_BenchResult bench_results[PX_BENCH_MAX_RESULTS];
+static int bench_result_count = 0;
+static const char* bench_case = "";
+static volatile uint64_t bench_sink = 0;
+
+void px_bench_consume(uint64_t value) {
+    bench_sink += value;
+}
+
+void px_bench_begin_case(const char* name) {
+    bench_case = name;
+}
+
+int px_bench_result_count(void) {
+    return bench_result_count;
+}
+
+const PX_BenchResult* px_bench_result(int index) {
+    return (index >= 0 && index < bench_result_count) ? &bench_results[index] : NULL;
+}
+
+static uint64_t time_sample(px_bench_body body, void* ctx, uint64_t iterations) {
+    uint64_t start = px_bench_now_ns();
+    for (uint64_t i = 0; i < iterations; i++)
+        body(ctx);
+    return px_bench_now_ns() - start;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+const PX_BenchResult* px_bench_run(const char* name, px_bench_body body, void* ctx) {
+    if (bench_result_count >= PX_BENCH_MAX_RESULTS)
+        return NULL;
+
+    // Double the batch until one sample is long enough to time reliably
+    double min_ns = px_bench_config.min_sample_ms * 1e6;
+    uint64_t iterations = 1;
+    while (iterations < BENCH_MAX_ITERATIONS && (double)time_sample(body, ctx, iterations) < min_ns)
+        iterations *= 2;
+
+    for (int i = 0; i < px_bench_config.warmup; i++)
+        time_sample(body, ctx, iterations);
+
+    int samples = px_bench_config.samples > 0 ? px_bench_config.samples : 1;
+    double* per_call = (double*)malloc(sizeof(double) * samples);
+    if (!per_call)
+        return NULL;
+
+    double sum = 0.0;
+    for (int i = 0; i < samples; i++) {
+        per_call[i] = (double)time_sample(body, ctx, iterations) / (double)iterations;
+        sum += per_call[i];
+    }
+    qsort(per_call, samples, sizeof(double), cmp_double);
+
+    PX_BenchResult* r = &bench_results[bench_result_count++];
+    memset(r, 0, sizeof(*r));
+    snprintf(r->name, sizeof(r->name), "%s/%s", bench_case, name);
+    r->iterations = iterations;
+    r->samples = samples;
+    r->min_ns = per_call[0];
+    r->max_ns = per_call[samples - 1];
+    r->median_ns = samples % 2 ? per_call[samples / 2] : (per_call[samples / 2 - 1] + per_call[samples / 2]) / 2.0;
+    r->p95_ns = per_call[(int)ceil(0.95 * samples) - 1];
+    r->mean_ns = sum / samples;
+
+    double var = 0.0;
+    for (int i = 0; i < samples; i++)
+        var += (per_call[i] - r->mean_ns) * (per_call[i] - r->mean_ns);
+    r->stddev_ns = samples > 1 ? sqrt(var / (samples - 1)) : 0.0;
+    free(per_call);
+
+    printf("\t%-28s median %12.1f ns  min %12.1f  p95 %12.1f  +-%5.1f%%  (%d x %llu)\n",
+           name, r->median_ns, r->min_ns, r->p95_ns,
+           r->mean_ns > 0.0 ? 100.0 * r->stddev_ns / r->mean_ns : 0.0,
+           r->samples, (unsigned long long)r->iterations);
+
+    return r;
+}
+
+int px_bench_write_json(const char* path) {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "version", 1);
+    cJSON* results = cJSON_AddArrayToObject(root, "results");
+
+    for (int i = 0; i < bench_result_count; i++) {
+        const PX_BenchResult* r = &bench_results[i];
+        cJSON* o = cJSON_CreateObject();
+        cJSON_AddStringToObject(o, "name", r->name);
+        cJSON_AddNumberToObject(o, "iterations", (double)r->iterations);
+        cJSON_AddNumberToObject(o, "samples", r->samples);
+        cJSON_AddNumberToObject(o, "min_ns", r->min_ns);
+        cJSON_AddNumberToObject(o, "median_ns", r->median_ns);
+        cJSON_AddNumberToObject(o, "mean_ns", r->mean_ns);
+        cJSON_AddNumberToObject(o, "stddev_ns", r->stddev_ns);
+        cJSON_AddNumberToObject(o, "p95_ns", r->p95_ns);
+        cJSON_AddNumberToObject(o, "max_ns", r->max_ns);
+        cJSON_AddItemToArray(results, o);
+    }
+
+    char* json = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!json)
+        return 1;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "Could not open %s\n", path);
+        cJSON_free(json);
+        return 1;
+    }
+    fputs(json, f);
+    fputc('\n', f);
+    fclose(f);
+    cJSON_free(json);
+
+    printf("Results written to %s\n", path);
+    return 0;
+}
+
+int px_bench_compare(const char* baseline_path, double threshold_pct) {
+    size_t size = 0;
+    char* text = px_bench_read_file(baseline_path, &size);
+    if (!text) {
+        fprintf(stderr, "Could not open baseline %s\n", baseline_path);
+        return -1;
+    }
+
+    cJSON* root = cJSON_Parse(text);
+    free(text);
+    cJSON* results = cJSON_GetObjectItemCaseSensitive(root, "results");
+    if (!cJSON_IsArray(results)) {
+        fprintf(stderr, "Baseline %s has no results\n", baseline_path);
+        cJSON_Delete(root);
+        return -1;
+    }
+
+    int regressions = 0;
+    printf("== compare: %s (threshold %.1f%%) ==\n", baseline_path, threshold_pct);
+    for (int i = 0; i < bench_result_count; i++) {
+        const PX_BenchResult* r = &bench_results[i];
+
+        const cJSON* base = NULL;
+        const cJSON* it;
+        cJSON_ArrayForEach(it, results) {
+            const cJSON* name = cJSON_GetObjectItemCaseSensitive(it, "name");
+            if (cJSON_IsString(name) && strcmp(name->valuestring, r->name) == 0) {
+                base = it;
+                break;
+            }
+        }
+
+        const cJSON* median = base ? cJSON_GetObjectItemCaseSensitive(base, "median_ns") : NULL;
+        if (!cJSON_IsNumber(median) || median->valuedouble <= 0.0) {
+            printf("\t%-36s %12.1f ns  (new)\n", r->name, r->median_ns);
+            continue;
+        }
+
+        double change = 100.0 * (r->median_ns - median->valuedouble) / median->valuedouble;
+        bool regressed = change > threshold_pct;
+        regressions += regressed;
+        printf("\t%-36s %12.1f ns  was %12.1f  %+7.1f%%  %6.2fx%s\n", r->name, r->median_ns, median->valuedouble, change,
+               r->median_ns > 0.0 ? median->valuedouble / r->median_ns : 0.0, regressed ? "  REGRESSION" : "");
+    }
+
+    cJSON_Delete(root);
+    return regressions;
+}
+
+char* px_bench_read_file(const char* path, size_t* out_size) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+
+    char* data = (char*)malloc(size + 1);
+    if (!data) {
+        fclose(f);
+        return NULL;
+    }
+    *out_size = fread(data, 1, size, f);
+    data[*out_size] = '\0';
+    fclose(f);
+    return data;
+}
+
+PX_Font* px_bench_load_font(const char* path) {
+    struct px_sdf_font_source src;
+    if (px_sdf_read(path, &src) != ERR_SUCCESS) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return NULL;
+    }
+
+    struct px_sdf_font_data sdf;
+    px_sdf_source_finish(&src, 0, &sdf);
+    PX_Font* font = px_sdf_font_create(&sdf);
+    if (!font)
+        free(sdf.glyphs);
+    return font;
+}
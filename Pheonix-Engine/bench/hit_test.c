@@ -0,0 +1,188 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <event-sys.h>
+#include <rendering-sys.h>
+
+#define HIT_SCREEN_W 1920
+#define HIT_SCREEN_H 1080
+#define HIT_RECTS 10000
+#define HIT_QUERIES 4096
+#define HIT_FONT_PATH "assets/fonts/psdf/roboto.psdf"
+
+struct hit_ctx {
+    PX_Transform2 rects[HIT_RECTS];
+    PX_Vector2 points[HIT_QUERIES];
+};
+
+static uint32_t hit_rand(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+// Mostly list-row sized rects plus a few panels, like an editor layout
+static void fill_layout(struct hit_ctx* c) {
+    uint32_t seed = 7;
+    for (int i = 0; i < HIT_RECTS; i++) {
+        bool panel = i % 500 == 0;
+        int w = panel ? 200 + (int)(hit_rand(&seed) % 600) : 40 + (int)(hit_rand(&seed) % 200);
+        int h = panel ? 200 + (int)(hit_rand(&seed) % 400) : 16 + (int)(hit_rand(&seed) % 16);
+        c->rects[i] = (PX_Transform2){
+            { (int)(hit_rand(&seed) % (HIT_SCREEN_W + 100)) - 50, (int)(hit_rand(&seed) % (HIT_SCREEN_H + 100)) - 50 },
+            { w, h }
+        };
+    }
+    for (int i = 0; i < HIT_QUERIES; i++)
+        c->points[i] = (PX_Vector2){ (int)(hit_rand(&seed) % HIT_SCREEN_W), (int)(hit_rand(&seed) % HIT_SCREEN_H) };
+}
+
+static void record_layout(const struct hit_ctx* c) {
+    px_rs_hit_begin((PX_Scale2){ HIT_SCREEN_W, HIT_SCREEN_H });
+    for (int i = 0; i < HIT_RECTS; i++)
+        px_rs_hit_add(c->rects[i], PX_RS_HIT_DROPDOWN_ITEM, c, i, -1);
+    px_rs_hit_end();
+}
+
+// What every frame did before: each rect tested, the last one drawn wins
+static int linear_hit(const struct hit_ctx* c, PX_Vector2 p) {
+    for (int i = HIT_RECTS - 1; i >= 0; i--) {
+        PX_Transform2 r = c->rects[i];
+        if (p.x >= r.pos.x && p.x <= r.pos.x + r.scale.w && p.y >= r.pos.y && p.y <= r.pos.y + r.scale.h)
+            return i;
+    }
+    return -1;
+}
+
+static int check_grid(const struct hit_ctx* c) {
+    record_layout(c);
+    uint64_t generation = px_rs_hit_generation();
+
+    bool ok = true;
+    for (int i = 0; i < HIT_QUERIES && ok; i++) {
+        PX_RSHit hit;
+        int expected = linear_hit(c, c->points[i]);
+        ok = px_rs_hit_query(c->points[i], &hit) ? hit.index == expected : expected == -1;
+    }
+    // Redrawing the same layout must not count as a change
+    record_layout(c);
+    ok = ok && px_rs_hit_generation() == generation;
+
+    printf("grid: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static void draw_menu(PX_Dropdown* dd) {
+    px_rs_frame_start();
+    px_rs_draw_dropdown(dd);
+    px_rs_frame_end();
+}
+
+static int g_clicked_item = -1;
+static int g_clicked_option = -1;
+
+static void on_menu_click(const PX_Event_GSignal* signal, void* user) {
+    (void)user;
+    g_clicked_item = signal->ui_dropdown_click.opened_index;
+    g_clicked_option = signal->ui_dropdown_click.clicked_option;
+}
+
+// Open the second menu, hover and click its third option through the grid
+static int check_dropdown(PX_Font* font) {
+    PX_Dropdown dd = {0};
+    dd.width = HIT_SCREEN_W;
+    dd.height = 30;
+    dd.font = font;
+    dd.font_size = 16.0f;
+    dd.option_font_size = 14.0f;
+    dd.stext_pos = (PX_Vector2){ 4, 8 };
+    dd.spacing = 64;
+
+    static const char* labels[] = { "File", "Edit", "View", "Help" };
+    bool ok = px_rs_dropdown_init(&dd) == ERR_SUCCESS;
+    for (int i = 0; i < 3 && ok; i++)
+        ok = px_rs_dropdown_add_item(&dd, labels[i], labels, 4) != NULL;
+    if (!ok) {
+        px_rs_dropdown_free(&dd);
+        printf("dropdown: MISMATCH\n");
+        return 1;
+    }
+    PX_DropdownItem* edit = &dd.items[1];
+
+    event_sys_init((PX_Scale2){ HIT_SCREEN_W, HIT_SCREEN_H }, (PX_Vector2){ 0, 0 });
+    event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, &dd, on_menu_click, NULL);
+    g_clicked_item = g_clicked_option = -1;
+
+    PX_Transform2 r = {0};
+    draw_menu(&dd);
+    px_layout_rect(edit->node, &r);
+    event_mouse_move((PX_Vector2){ r.pos.x + 2, r.pos.y + 2 });
+    event_hover_dropdown(&dd);
+    ok = dd.hover_index == 1;
+    event_click_dropdown(&dd);
+    ok = ok && edit->is_open;
+
+    draw_menu(&dd);
+    ok = ok && px_layout_rect(edit->options[2].node, &r);
+    event_mouse_move((PX_Vector2){ r.pos.x + 1, r.pos.y + 1 });
+    event_hover_dropdown(&dd);
+    ok = ok && edit->hover_index == 2 && dd.hover_index == -1;
+    event_click_dropdown(&dd);
+    event_dispatch_gsignals();
+    ok = ok && !edit->is_open && g_clicked_item == 1 && g_clicked_option == 2;
+
+    px_rs_dropdown_free(&dd);
+    event_sys_init((PX_Scale2){ HIT_SCREEN_W, HIT_SCREEN_H }, (PX_Vector2){ 0, 0 });
+
+    printf("dropdown: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static void run_build(void* p) {
+    record_layout((const struct hit_ctx*)p);
+}
+
+static void run_grid_queries(void* p) {
+    const struct hit_ctx* c = p;
+    uint64_t sum = 0;
+    PX_RSHit hit;
+    for (int i = 0; i < HIT_QUERIES; i++)
+        sum += px_rs_hit_query(c->points[i], &hit) ? (uint64_t)hit.index : 0;
+    px_bench_consume(sum);
+}
+
+static void run_linear_queries(void* p) {
+    const struct hit_ctx* c = p;
+    uint64_t sum = 0;
+    for (int i = 0; i < HIT_QUERIES; i++)
+        sum += (uint64_t)(linear_hit(c, c->points[i]) + 1);
+    px_bench_consume(sum);
+}
+
+int bench_hit_test(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    struct hit_ctx* c = (struct hit_ctx*)malloc(sizeof(*c));
+    PX_Font* font = px_bench_load_font(HIT_FONT_PATH);
+    if (!c || !font || px_rs_init_ui_headless((PX_Scale2){ HIT_SCREEN_W, HIT_SCREEN_H }) != ERR_SUCCESS) {
+        free(c);
+        px_font_destroy(font);
+        return 1;
+    }
+    fill_layout(c);
+
+    int result = check_grid(c) | check_dropdown(font);
+
+    px_bench_run("build_10k", run_build, c);
+    record_layout(c);
+    px_bench_run("grid_4k_queries", run_grid_queries, c);
+    px_bench_run("linear_4k_queries", run_linear_queries, c);
+
+    px_rs_shutdown_ui();
+    px_font_destroy(font);
+    free(c);
+    return result;
+}
@@ -0,0 +1,104 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <window-sys.h>
+#include <window-sys/backends.h>
+
+#define INPUT_BURST 1000
+
+static void push_move(PX_WE_Queue* q, int x, int y) {
+    PX_WEvent ev = { .type = PX_WE_MOUSE_MOVE, .x = x, .y = y };
+    px_we_queue_push(q, &ev);
+}
+
+static void push_type(PX_WE_Queue* q, PX_WE_Type type) {
+    PX_WEvent ev = { .type = type };
+    px_we_queue_push(q, &ev);
+}
+
+static int drain(PX_WE_Queue* q) {
+    PX_WEvent ev;
+    int n = 0;
+    while (px_we_queue_pop(q, &ev))
+        n++;
+    return n;
+}
+
+// A burst of motion around a click must come out as move, click, move
+static int check_coalescing(void) {
+    PX_WE_Queue q = {0};
+    for (int i = 0; i < INPUT_BURST; i++)
+        push_move(&q, i, i);
+    push_type(&q, PX_WE_MOUSE_DOWN);
+    for (int i = 0; i < INPUT_BURST; i++)
+        push_move(&q, -i, i);
+
+    PX_WEvent ev[3];
+    int n = 0;
+    while (n < 3 && px_we_queue_pop(&q, &ev[n]))
+        n++;
+    bool ok = n == 3 && px_we_queue_empty(&q) &&
+              ev[0].type == PX_WE_MOUSE_MOVE && ev[0].x == INPUT_BURST - 1 && ev[0].merged == INPUT_BURST - 1 &&
+              ev[1].type == PX_WE_MOUSE_DOWN &&
+              ev[2].type == PX_WE_MOUSE_MOVE && ev[2].x == -(INPUT_BURST - 1);
+    px_we_queue_free(&q);
+
+    printf("coalescing: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+// At the cap clicks push out queued motion, only then are events dropped
+static int check_overflow(void) {
+    PX_WE_Queue q = {0};
+    push_move(&q, 1, 1);
+    for (int i = 0; i < PX_WE_QUEUE_MAX; i++)
+        push_type(&q, i % 2 ? PX_WE_KEYUP : PX_WE_KEYDOWN);
+
+    PX_WEvent first;
+    bool ok = q.count == PX_WE_QUEUE_MAX && q.stats.dropped == 1 &&
+              px_we_queue_pop(&q, &first) && first.type == PX_WE_KEYDOWN;
+    push_type(&q, PX_WE_KEYDOWN);
+    push_type(&q, PX_WE_KEYDOWN);
+    ok = ok && q.count == PX_WE_QUEUE_MAX && q.stats.dropped == 2;
+    px_we_queue_free(&q);
+
+    printf("overflow: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static void run_motion_burst(void* p) {
+    PX_WE_Queue* q = p;
+    q->history_count = 0; // as px_ws_poll does
+    for (int i = 0; i < INPUT_BURST; i++)
+        push_move(q, i, i);
+    px_bench_consume((uint64_t)drain(q));
+}
+
+static void run_mixed_burst(void* p) {
+    PX_WE_Queue* q = p;
+    for (int i = 0; i < INPUT_BURST / 4; i++) {
+        push_move(q, i, 0);
+        push_move(q, i, 1);
+        push_move(q, i, 2);
+        push_type(q, i % 2 ? PX_WE_MOUSE_UP : PX_WE_MOUSE_DOWN);
+    }
+    px_bench_consume((uint64_t)drain(q));
+}
+
+int bench_window_input(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    int result = check_coalescing() | check_overflow();
+
+    PX_WE_Queue q = {0};
+    px_bench_run("motion_burst_1000", run_motion_burst, &q);
+    px_bench_run("mixed_burst_1000", run_mixed_burst, &q);
+    q.keep_history = true;
+    px_bench_run("motion_burst_history_1000", run_motion_burst, &q);
+    px_we_queue_free(&q);
+
+    return result;
+}
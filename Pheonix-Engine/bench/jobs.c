@@ -0,0 +1,197 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include <core/jobs.h>
+#include <core/hash.h>
+#include <core/pixel.h>
+#include <core/image.h>
+
+#define JOBS_IMAGE_SIZE 2048
+#define JOBS_HASH_CHUNKS 256
+#define JOBS_HASH_CHUNK (64 * 1024)
+#define JOBS_DECODES 16
+#define JOBS_PNG_PATH "assets/icons/logo.png"
+
+struct jobs_ctx {
+    uint8_t* src;
+    uint8_t* dst;
+    uint64_t hashes[JOBS_HASH_CHUNKS];
+    PX_ImageJob decodes[JOBS_DECODES];
+    bool decode_ok;
+};
+
+struct jobs_scaling {
+    const char* name;
+    double median_ns[PX_JOB_MAX_WORKERS + 1];
+};
+
+static void premultiply_rows(void* p, size_t begin, size_t end) {
+    struct jobs_ctx* ctx = (struct jobs_ctx*)p;
+    size_t row = (size_t)JOBS_IMAGE_SIZE * 4;
+    px_pixel_premultiply(ctx->dst + begin * row, ctx->src + begin * row, (end - begin) * JOBS_IMAGE_SIZE);
+}
+
+static void hash_chunks(void* p, size_t begin, size_t end) {
+    struct jobs_ctx* ctx = (struct jobs_ctx*)p;
+    size_t image_bytes = (size_t)JOBS_IMAGE_SIZE * JOBS_IMAGE_SIZE * 4;
+    for (size_t i = begin; i < end; i++)
+        ctx->hashes[i] = px_hash64(ctx->src + (i * JOBS_HASH_CHUNK) % image_bytes, JOBS_HASH_CHUNK, i);
+}
+
+static void run_premultiply(void* p) {
+    px_job_parallel_for(JOBS_IMAGE_SIZE, 0, premultiply_rows, p);
+    px_bench_consume(((struct jobs_ctx*)p)->dst[12345]);
+}
+
+static void run_hash(void* p) {
+    struct jobs_ctx* ctx = (struct jobs_ctx*)p;
+    px_job_parallel_for(JOBS_HASH_CHUNKS, 0, hash_chunks, ctx);
+    px_bench_consume(ctx->hashes[JOBS_HASH_CHUNKS - 1]);
+}
+
+static void run_decode(void* p) {
+    struct jobs_ctx* ctx = (struct jobs_ctx*)p;
+    for (int i = 0; i < JOBS_DECODES; i++)
+        ctx->decodes[i] = (PX_ImageJob){ .path = JOBS_PNG_PATH };
+    ctx->decode_ok = image_png_decode_batch(ctx->decodes, JOBS_DECODES) == ERR_SUCCESS;
+    for (int i = 0; i < JOBS_DECODES; i++)
+        free(ctx->decodes[i].pixels);
+}
+
+static atomic_llong g_range_sum;
+static atomic_int g_stage;
+
+static void sum_range(void* p, size_t begin, size_t end) {
+    (void)p;
+    long long sum = 0;
+    for (size_t i = begin; i < end; i++)
+        sum += (long long)i;
+    atomic_fetch_add(&g_range_sum, sum);
+}
+
+static void stage_first(void* p) {
+    (void)p;
+    atomic_store(&g_stage, 1);
+}
+
+static void stage_second(void* p) {
+    bool* ok = (bool*)p;
+    *ok = atomic_load(&g_stage) == 1;
+    atomic_store(&g_stage, 2);
+}
+
+// Every part of a split range runs exactly once, dependents run after their counter
+static int check_jobs(void) {
+    bool ok = true;
+    for (int rep = 0; rep < 64 && ok; rep++) {
+        atomic_store(&g_range_sum, 0);
+        px_job_parallel_for(100000, rep % 2 ? 0 : 7, sum_range, NULL);
+        ok = atomic_load(&g_range_sum) == 99999LL * 100000 / 2;
+
+        PX_JobCounter first, second;
+        px_job_counter_init(&first);
+        px_job_counter_init(&second);
+        atomic_store(&g_stage, 0);
+        bool ordered = false;
+        px_job_run(&(PX_JobDesc){ stage_first, NULL, PX_JOB_ANY_THREAD }, &first);
+        px_job_run_after(&(PX_JobDesc){ stage_second, &ordered, PX_JOB_ANY_THREAD }, &first, &second);
+        px_job_wait(&second);
+        ok = ok && ordered;
+    }
+    return ok ? 0 : 1;
+}
+
+static void print_utilisation(void) {
+    PX_JobStats stats;
+    px_jobs_stats(&stats);
+    if (stats.thread_count == 0 || stats.elapsed_ns == 0)
+        return;
+
+    printf("\tutilisation:");
+    for (int i = 0; i < stats.thread_count; i++)
+        printf(" %s%d %.0f%% (%llu steals)", i == 0 ? "main" : "w", i,
+               100.0 * (double)stats.threads[i].busy_ns / (double)stats.elapsed_ns,
+               (unsigned long long)stats.threads[i].steals);
+    printf("\n");
+}
+
+int bench_jobs(int argc, char** argv) {
+    int max_threads = argc > 0 ? atoi(argv[0]) : px_cpu_count();
+    if (max_threads < 1)
+        max_threads = 1;
+    if (max_threads > PX_JOB_MAX_WORKERS + 1)
+        max_threads = PX_JOB_MAX_WORKERS + 1;
+    printf("threads: 1 to %d (%d cores online)\n", max_threads, px_cpu_count());
+
+    struct jobs_ctx* ctx = (struct jobs_ctx*)calloc(1, sizeof(*ctx));
+    size_t image_bytes = (size_t)JOBS_IMAGE_SIZE * JOBS_IMAGE_SIZE * 4;
+    if (ctx) {
+        ctx->src = (uint8_t*)malloc(image_bytes);
+        ctx->dst = (uint8_t*)malloc(image_bytes);
+    }
+    if (!ctx || !ctx->src || !ctx->dst) {
+        if (ctx) {
+            free(ctx->src);
+            free(ctx->dst);
+        }
+        free(ctx);
+        return 1;
+    }
+    for (size_t i = 0; i < image_bytes; i++)
+        ctx->src[i] = (uint8_t)(i * 2654435761u >> 24);
+
+    struct jobs_scaling scaling[] = {
+        { .name = "premultiply_2048" },
+        { .name = "hash_16mb" },
+        { .name = "png_decode_x16" }
+    };
+    px_bench_body bodies[] = { run_premultiply, run_hash, run_decode };
+    int measurement_count = (int)(sizeof(scaling) / sizeof(scaling[0]));
+
+    // One thread is the serial baseline, the job system is not even running
+    int result = 0;
+    for (int threads = 1; threads <= max_threads; threads++) {
+        if (threads > 1 && px_jobs_init(threads - 1) != ERR_SUCCESS) {
+            fprintf(stderr, "Could not start %d job workers\n", threads - 1);
+            result = 1;
+            break;
+        }
+
+        int check = check_jobs();
+        printf("jobs x%d: %s\n", threads, check == 0 ? "matches expected" : "MISMATCH");
+        result |= check;
+
+        px_jobs_reset_stats();
+        for (int m = 0; m < measurement_count; m++) {
+            char name[PX_BENCH_NAME_MAX];
+            snprintf(name, sizeof(name), "%s/t%d", scaling[m].name, threads);
+            const PX_BenchResult* r = px_bench_run(name, bodies[m], ctx);
+            scaling[m].median_ns[threads] = r ? r->median_ns : 0.0;
+        }
+        if (!ctx->decode_ok) {
+            fprintf(stderr, "Could not decode %s\n", JOBS_PNG_PATH);
+            result = 1;
+        }
+        print_utilisation();
+        px_jobs_shutdown();
+    }
+
+    printf("scaling (speedup over one thread):\n");
+    for (int m = 0; m < measurement_count; m++) {
+        printf("\t%-20s", scaling[m].name);
+        for (int threads = 1; threads <= max_threads; threads++) {
+            double t = scaling[m].median_ns[threads];
+            printf(" x%d %.2f", threads, t > 0.0 ? scaling[m].median_ns[1] / t : 0.0);
+        }
+        printf("\n");
+    }
+
+    free(ctx->src);
+    free(ctx->dst);
+    free(ctx);
+    return result;
+}
@@ -0,0 +1,127 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rendering-sys.h>
+
+#define LAYOUT_FONT_PATH "assets/fonts/psdf/roboto.psdf"
+#define LAYOUT_PANELS 64
+#define LAYOUT_ROWS 64 // per panel
+#define LAYOUT_ROW_H 16
+#define LAYOUT_GAP 4
+
+struct layout_ctx {
+    PX_Font* font;
+    PX_LayoutNode root;
+    PX_LayoutNode panels[LAYOUT_PANELS];
+    PX_LayoutNode rows[LAYOUT_PANELS][LAYOUT_ROWS];
+    char labels[LAYOUT_PANELS][LAYOUT_ROWS][32];
+    int edit;
+};
+
+// A row of panels, each a column of text rows: 4k text nodes
+static bool build(struct layout_ctx* c) {
+    c->root = px_layout_create(PX_LAYOUT_NONE, &(PX_LayoutDesc){ .flow = PX_LAYOUT_ROW, .spacing = LAYOUT_GAP });
+    for (int p = 0; p < LAYOUT_PANELS; p++) {
+        c->panels[p] = px_layout_create(c->root, &(PX_LayoutDesc){
+            .flow = PX_LAYOUT_COLUMN,
+            .padding = { 6, 6 },
+            .spacing = LAYOUT_GAP
+        });
+        for (int r = 0; r < LAYOUT_ROWS; r++) {
+            snprintf(c->labels[p][r], sizeof(c->labels[p][r]), "Row %d of panel %d", r, p);
+            c->rows[p][r] = px_layout_create(c->panels[p], &(PX_LayoutDesc){ .size = { 0, LAYOUT_ROW_H } });
+            if (c->rows[p][r] == PX_LAYOUT_NONE)
+                return false;
+            px_layout_set_text(c->rows[p][r], c->font, c->labels[p][r], 14.0f);
+        }
+    }
+    px_layout_update();
+    return true;
+}
+
+// Rows stack under each other and panels follow each other's widths
+static int check_layout(struct layout_ctx* c) {
+    PX_Transform2 a, b, panel;
+    bool ok = px_layout_rect(c->rows[3][0], &a) && px_layout_rect(c->rows[3][1], &b) && px_layout_rect(c->panels[3], &panel);
+    ok = ok && b.pos.y == a.pos.y + LAYOUT_ROW_H + LAYOUT_GAP && a.pos.x == panel.pos.x + 6 &&
+         a.scale.w == px_rs_text_width(c->font, c->labels[3][0], 14.0f);
+
+    // Widening a row of one panel moves every later panel, and only reaches up its own chain
+    PX_Transform2 next_before, next_after;
+    px_layout_rect(c->panels[4], &next_before);
+    strcpy(c->labels[3][5], "A far longer label than most");
+    px_layout_set_text(c->rows[3][5], c->font, c->labels[3][5], 14.0f);
+    int laid_out = px_layout_update();
+    PX_LayoutStats stats;
+    px_layout_stats(&stats);
+    px_layout_rect(c->panels[4], &next_after);
+    ok = ok && laid_out == 3 && stats.text_measures == 1 && next_after.pos.x > next_before.pos.x;
+
+    // Hidden subtrees have no rect and leave a gap-free flow
+    px_layout_set_hidden(c->panels[3], true);
+    PX_Transform2 hidden;
+    ok = ok && !px_layout_rect(c->rows[3][0], &hidden);
+    px_layout_rect(c->panels[4], &next_after);
+    ok = ok && next_after.pos.x == panel.pos.x;
+    px_layout_set_hidden(c->panels[3], false);
+    px_layout_rect(c->panels[4], &next_after);
+    ok = ok && next_after.pos.x > panel.pos.x;
+
+    // Nothing dirty, nothing to do
+    ok = ok && px_layout_update() == 0;
+
+    printf("layout: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+// What every frame paid before: every label measured, every rect placed
+static void run_full(void* p) {
+    struct layout_ctx* c = p;
+    for (int i = 0; i < LAYOUT_PANELS; i++)
+        for (int r = 0; r < LAYOUT_ROWS; r++)
+            px_layout_set_text(c->rows[i][r], c->font, c->labels[i][r], 14.0f);
+    px_bench_consume((uint64_t)px_layout_update());
+}
+
+static void run_one_label(void* p) {
+    struct layout_ctx* c = p;
+    int i = c->edit++ % (LAYOUT_PANELS * LAYOUT_ROWS);
+    PX_LayoutNode row = c->rows[i / LAYOUT_ROWS][i % LAYOUT_ROWS];
+    px_layout_set_text(row, c->font, c->labels[i / LAYOUT_ROWS][i % LAYOUT_ROWS], 14.0f);
+    px_bench_consume((uint64_t)px_layout_update());
+}
+
+static void run_clean(void* p) {
+    (void)p;
+    px_bench_consume((uint64_t)px_layout_update());
+}
+
+int bench_layout(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    struct layout_ctx* c = (struct layout_ctx*)calloc(1, sizeof(*c));
+    if (!c)
+        return 1;
+    c->font = px_bench_load_font(LAYOUT_FONT_PATH);
+    if (!c->font || !build(c)) {
+        px_layout_shutdown();
+        px_font_destroy(c->font);
+        free(c);
+        return 1;
+    }
+
+    int result = check_layout(c);
+
+    px_bench_run("full_4k_nodes", run_full, c);
+    px_bench_run("one_label", run_one_label, c);
+    px_bench_run("clean", run_clean, c);
+
+    px_layout_shutdown();
+    px_font_destroy(c->font);
+    free(c);
+    return result;
+}
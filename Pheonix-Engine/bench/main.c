@@ -0,0 +1,112 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_DEFAULT_THRESHOLD 10.0
+
+static const PX_BenchCase bench_cases[] = {
+    { "sdf-json", "SDF atlas JSON ingestion: cJSON DOM vs streaming reader", bench_sdf_json },
+    { "pixel", "Pixel conversion kernels: reference check and scalar/SSE2/AVX2 throughput", bench_pixel },
+    { "text", "UTF-8 decode, glyph lookup, text width, glyph quads and batch merging", bench_text },
+    { "editor", "Editor object insertion and scene tree traversal", bench_editor },
+    { "assets", "PTEX and pack rejects, cJSON parse of the SDF description, PSDF load and PNG decode", bench_assets },
+    { "input", "Window event queue: motion coalescing, overflow and burst throughput", bench_window_input },
+    { "jobs", "Job system: dependency checks and 1..N thread scaling on pixel, hash and decode work", bench_jobs },
+    { "hit-test", "Widget hit-test grid: agreement with a linear scan, dropdown clicks, build and query cost", bench_hit_test },
+    { "layout", "Retained layout tree: placement checks, full relayout vs one changed label", bench_layout },
+    { "transform", "World transforms: 4x4 kernels per ISA, propagation checks, full and one-leaf updates", bench_transform },
+    { "project", "Project files: .pxproj round trip and rejects, 1M object save, load and plain read", bench_project },
+    { "signals", "Signal bus: multi-producer order and count, route reuse, send and dispatch cost", bench_signals },
+};
+
+#define BENCH_CASE_COUNT (int)(sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static void print_help(void) {
+    printf("Usage: pheonix-engine-bench [options] [case] [case args...]\n");
+    printf("Options:\n");
+    printf("\t--warmup <n>: Untimed samples before measuring (default: %d)\n", px_bench_config.warmup);
+    printf("\t--samples <n>: Timed samples per measurement (default: %d)\n", px_bench_config.samples);
+    printf("\t--min-sample-ms <ms>: Shortest time one sample may take (default: %.1f)\n", px_bench_config.min_sample_ms);
+    printf("\t--json <path>: Writes every measurement as JSON\n");
+    printf("\t--baseline <path>: Compares medians against an earlier --json file, fails on regressions\n");
+    printf("\t--threshold <pct>: Slowdown counted as a regression (default: %.0f)\n", BENCH_DEFAULT_THRESHOLD);
+    printf("Cases:\n");
+    for (int i = 0; i < BENCH_CASE_COUNT; i++)
+        printf("\t%s: %s\n", bench_cases[i].name, bench_cases[i].description);
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    const char* baseline_path = NULL;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+
+    int arg = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++) {
+        const char* opt = argv[arg];
+        if (strcmp(opt, "--help") == 0) {
+            print_help();
+            return 0;
+        }
+
+        if (arg + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", opt);
+            return 1;
+        }
+        const char* value = argv[++arg];
+
+        if (strcmp(opt, "--warmup") == 0)
+            px_bench_config.warmup = atoi(value);
+        else if (strcmp(opt, "--samples") == 0)
+            px_bench_config.samples = atoi(value);
+        else if (strcmp(opt, "--min-sample-ms") == 0)
+            px_bench_config.min_sample_ms = atof(value);
+        else if (strcmp(opt, "--json") == 0)
+            json_path = value;
+        else if (strcmp(opt, "--baseline") == 0)
+            baseline_path = value;
+        else if (strcmp(opt, "--threshold") == 0)
+            threshold = atof(value);
+        else {
+            fprintf(stderr, "Unknown option %s\n", opt);
+            print_help();
+            return 1;
+        }
+    }
+
+    const char* filter = arg < argc ? argv[arg] : NULL;
+    int result = 0;
+    int ran = 0;
+
+    for (int i = 0; i < BENCH_CASE_COUNT; i++) {
+        if (filter && strcmp(filter, bench_cases[i].name) != 0)
+            continue;
+
+        printf("== %s ==\n", bench_cases[i].name);
+        px_bench_begin_case(bench_cases[i].name);
+        if (bench_cases[i].run(filter ? argc - arg - 1 : 0, filter ? argv + arg + 1 : NULL) != 0)
+            result = 1;
+        ran++;
+    }
+
+    if (ran == 0) {
+        fprintf(stderr, "Unknown bench case '%s'\n", filter);
+        print_help();
+        return 1;
+    }
+
+    if (json_path && px_bench_write_json(json_path) != 0)
+        result = 1;
+
+    if (baseline_path) {
+        int regressions = px_bench_compare(baseline_path, threshold);
+        if (regressions != 0) {
+            if (regressions > 0)
+                fprintf(stderr, "%d measurement(s) regressed by more than %.1f%%\n", regressions, threshold);
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,262 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <core/pixel.h>
+
+// Small enough to stay in cache, so the kernels are timed rather than DRAM
+#define PIXEL_BENCH_W 512
+#define PIXEL_BENCH_H 256
+// Odd sizes so every kernel also runs its tail loop
+#define PIXEL_CHECK_W 131
+#define PIXEL_CHECK_H 77
+
+static const uint8_t order_bgra[4] = { 2, 1, 0, 3 };
+static const uint8_t order_argb[4] = { 3, 0, 1, 2 };
+
+static void fill_random(uint8_t* p, size_t n, uint32_t seed) {
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        p[i] = (uint8_t)(x >> 24);
+    }
+}
+
+// ---- Reference implementations, written for clarity only ----
+
+static void ref_premultiply(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count * 4; i += 4) {
+        unsigned a = src[i + 3];
+        for (int c = 0; c < 3; c++)
+            dst[i + c] = (uint8_t)((2 * src[i + c] * a + 255) / 510);
+        dst[i + 3] = (uint8_t)a;
+    }
+}
+
+static void ref_swizzle(uint8_t* dst, const uint8_t* src, size_t count, const uint8_t order[4]) {
+    for (size_t i = 0; i < count * 4; i += 4) {
+        uint8_t px[4];
+        memcpy(px, src + i, 4);
+        for (int c = 0; c < 4; c++)
+            dst[i + c] = px[order[c]];
+    }
+}
+
+static void ref_gray(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i * 4 + 0] = dst[i * 4 + 1] = dst[i * 4 + 2] = src[i];
+        dst[i * 4 + 3] = 255;
+    }
+}
+
+static void ref_rgb(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        memcpy(dst + i * 4, src + i * 3, 3);
+        dst[i * 4 + 3] = 255;
+    }
+}
+
+static void ref_box(uint8_t* dst, int dw, int dh, const uint8_t* src, int sw, int sh) {
+    for (int dy = 0; dy < dh; dy++) {
+        int y0 = dy * sh / dh, y1 = (dy + 1) * sh / dh;
+        if (y1 <= y0) y1 = y0 + 1;
+        for (int dx = 0; dx < dw; dx++) {
+            int x0 = dx * sw / dw, x1 = (dx + 1) * sw / dw;
+            if (x1 <= x0) x1 = x0 + 1;
+            for (int c = 0; c < 4; c++) {
+                unsigned sum = 0, n = 0;
+                for (int y = y0; y < y1; y++)
+                    for (int x = x0; x < x1; x++, n++)
+                        sum += src[((size_t)y * sw + x) * 4 + c];
+                dst[((size_t)dy * dw + dx) * 4 + c] = (uint8_t)((sum + n / 2) / n);
+            }
+        }
+    }
+}
+
+static int max_diff(const uint8_t* a, const uint8_t* b, size_t n) {
+    int worst = 0;
+    for (size_t i = 0; i < n; i++) {
+        int d = abs((int)a[i] - (int)b[i]);
+        if (d > worst) worst = d;
+    }
+    return worst;
+}
+
+static bool check(const char* isa, const char* op, int diff, int tolerance) {
+    if (diff <= tolerance)
+        return true;
+    fprintf(stderr, "\t%s %s: off by %d (allowed %d)\n", isa, op, diff, tolerance);
+    return false;
+}
+
+static bool verify_isa(PX_PixelISA kernels) {
+    const char* isa = px_pixel_isa_name(kernels);
+    const int w = PIXEL_CHECK_W, h = PIXEL_CHECK_H;
+    const size_t count = (size_t)w * h;
+    bool ok = true;
+
+    uint8_t* src = (uint8_t*)malloc(count * 4);
+    uint8_t* out = (uint8_t*)malloc(count * 4);
+    uint8_t* ref = (uint8_t*)malloc(count * 4);
+    fill_random(src, count * 4, 0x9E3779B9u);
+
+    // Every (color, alpha) pair, then random pixels
+    uint8_t* all = (uint8_t*)malloc(256 * 256 * 4);
+    uint8_t* all_out = (uint8_t*)malloc(256 * 256 * 4);
+    uint8_t* all_ref = (uint8_t*)malloc(256 * 256 * 4);
+    for (int c = 0; c < 256; c++) {
+        for (int a = 0; a < 256; a++) {
+            uint8_t* p = all + (c * 256 + a) * 4;
+            p[0] = p[1] = p[2] = (uint8_t)c;
+            p[3] = (uint8_t)a;
+        }
+    }
+    px_pixel_premultiply(all_out, all, 256 * 256);
+    ref_premultiply(all_ref, all, 256 * 256);
+    ok &= check(isa, "premultiply (exhaustive)", max_diff(all_out, all_ref, 256 * 256 * 4), 0);
+
+    px_pixel_premultiply(out, src, count);
+    ref_premultiply(ref, src, count);
+    ok &= check(isa, "premultiply", max_diff(out, ref, count * 4), 0);
+
+    memcpy(out, src, count * 4);
+    px_pixel_premultiply(out, out, count);
+    ok &= check(isa, "premultiply (in place)", max_diff(out, ref, count * 4), 0);
+
+    px_pixel_swizzle(out, src, count, order_argb);
+    ref_swizzle(ref, src, count, order_argb);
+    ok &= check(isa, "swizzle", max_diff(out, ref, count * 4), 0);
+
+    px_pixel_premultiply_bgra(out, src, count);
+    ref_premultiply(ref, src, count);
+    ref_swizzle(ref, ref, count, order_bgra);
+    ok &= check(isa, "premultiply_bgra", max_diff(out, ref, count * 4), 0);
+
+    px_pixel_gray_to_rgba(out, src, count);
+    ref_gray(ref, src, count);
+    ok &= check(isa, "gray_to_rgba", max_diff(out, ref, count * 4), 0);
+
+    px_pixel_rgb_to_rgba(out, src, count);
+    ref_rgb(ref, src, count);
+    ok &= check(isa, "rgb_to_rgba", max_diff(out, ref, count * 4), 0);
+
+    const int dw = w / 3, dh = h / 2;
+    px_pixel_downscale_box(out, dw, dh, (size_t)dw * 4, src, w, h, (size_t)w * 4);
+    ref_box(ref, dw, dh, src, w, h);
+    ok &= check(isa, "downscale_box", max_diff(out, ref, (size_t)dw * dh * 4), 0);
+
+    // Lanczos has no closed form reference; it is held to the scalar kernels
+    px_pixel_downscale_lanczos(out, dw, dh, (size_t)dw * 4, src, w, h, (size_t)w * 4);
+    px_pixel_set_isa(PX_PIXEL_ISA_SCALAR);
+    px_pixel_downscale_lanczos(ref, dw, dh, (size_t)dw * 4, src, w, h, (size_t)w * 4);
+    px_pixel_set_isa(kernels);
+    ok &= check(isa, "downscale_lanczos", max_diff(out, ref, (size_t)dw * dh * 4), 1);
+
+    free(all);
+    free(all_out);
+    free(all_ref);
+    free(src);
+    free(out);
+    free(ref);
+    return ok;
+}
+
+static double time_best_ms(void (*fn)(void*), void* ctx, int iterations) {
+    double best = 0.0;
+    for (int i = 0; i < iterations; i++) {
+        uint64_t start = px_bench_now_ns();
+        fn(ctx);
+        double ms = (double)(px_bench_now_ns() - start) / 1e6;
+        if (i == 0 || ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+struct pixel_ctx {
+    uint8_t* src;
+    uint8_t* dst;
+    size_t count;
+};
+
+static void run_premultiply(void* p) { struct pixel_ctx* c = p; px_pixel_premultiply(c->dst, c->src, c->count); }
+static void run_swizzle(void* p) { struct pixel_ctx* c = p; px_pixel_swizzle(c->dst, c->src, c->count, order_bgra); }
+static void run_premultiply_bgra(void* p) { struct pixel_ctx* c = p; px_pixel_premultiply_bgra(c->dst, c->src, c->count); }
+static void run_gray(void* p) { struct pixel_ctx* c = p; px_pixel_gray_to_rgba(c->dst, c->src, c->count); }
+static void run_rgb(void* p) { struct pixel_ctx* c = p; px_pixel_rgb_to_rgba(c->dst, c->src, c->count); }
+static void run_box(void* p) {
+    struct pixel_ctx* c = p;
+    px_pixel_downscale_box(c->dst, PIXEL_BENCH_W / 4, PIXEL_BENCH_H / 4, PIXEL_BENCH_W, c->src, PIXEL_BENCH_W, PIXEL_BENCH_H, PIXEL_BENCH_W * 4);
+}
+static void run_lanczos(void* p) {
+    struct pixel_ctx* c = p;
+    px_pixel_downscale_lanczos(c->dst, PIXEL_BENCH_W / 4, PIXEL_BENCH_H / 4, PIXEL_BENCH_W, c->src, PIXEL_BENCH_W, PIXEL_BENCH_H, PIXEL_BENCH_W * 4);
+}
+
+static const struct {
+    const char* name;
+    void (*run)(void*);
+    int iterations;
+} pixel_ops[] = {
+    { "premultiply", run_premultiply, 50 },
+    { "swizzle", run_swizzle, 50 },
+    { "premultiply_bgra", run_premultiply_bgra, 50 },
+    { "gray_to_rgba", run_gray, 50 },
+    { "rgb_to_rgba", run_rgb, 50 },
+    { "downscale_box/4", run_box, 20 },
+    { "downscale_lanczos/4", run_lanczos, 5 },
+};
+
+#define PIXEL_OP_COUNT (int)(sizeof(pixel_ops) / sizeof(pixel_ops[0]))
+
+int bench_pixel(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    PX_PixelISA best = px_pixel_isa();
+    struct pixel_ctx ctx = { .count = (size_t)PIXEL_BENCH_W * PIXEL_BENCH_H };
+    ctx.src = (uint8_t*)malloc(ctx.count * 4);
+    ctx.dst = (uint8_t*)malloc(ctx.count * 4);
+    if (!ctx.src || !ctx.dst) {
+        free(ctx.src);
+        free(ctx.dst);
+        return 1;
+    }
+    fill_random(ctx.src, ctx.count * 4, 12345);
+
+    double ms[3][PIXEL_OP_COUNT] = {{0}};
+    int result = 0;
+
+    printf("cpu: %s, %dx%d RGBA source\n", px_pixel_isa_name(best), PIXEL_BENCH_W, PIXEL_BENCH_H);
+    for (int isa = PX_PIXEL_ISA_SCALAR; isa <= (int)best; isa++) {
+        const char* name = px_pixel_isa_name((PX_PixelISA)isa);
+        px_pixel_set_isa((PX_PixelISA)isa);
+
+        bool ok = verify_isa((PX_PixelISA)isa);
+        if (!ok) result = 1;
+        printf("%s: %s\n", name, ok ? "matches reference" : "MISMATCH");
+
+        for (int op = 0; op < PIXEL_OP_COUNT; op++)
+            ms[isa][op] = time_best_ms(pixel_ops[op].run, &ctx, pixel_ops[op].iterations);
+    }
+    px_pixel_set_isa(best);
+
+    double mpix = (double)ctx.count / 1e6;
+    for (int op = 0; op < PIXEL_OP_COUNT; op++) {
+        printf("\t%-20s", pixel_ops[op].name);
+        for (int isa = PX_PIXEL_ISA_SCALAR; isa <= (int)best; isa++) {
+            printf("  %s %8.1f Mpx/s", px_pixel_isa_name((PX_PixelISA)isa), mpix / (ms[isa][op] / 1000.0));
+            if (isa > PX_PIXEL_ISA_SCALAR)
+                printf(" (%.1fx)", ms[PX_PIXEL_ISA_SCALAR][op] / ms[isa][op]);
+        }
+        printf("\n");
+    }
+
+    free(ctx.src);
+    free(ctx.dst);
+    return result;
+}
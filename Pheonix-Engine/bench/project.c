@@ -0,0 +1,328 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <editor.h>
+
+#define PROJECT_CHECK_COUNT 20000
+#define PROJECT_SCENE_COUNT 1000000
+#define PROJECT_FANOUT 8
+#define PROJECT_DEFAULT_PATH "bench.pxproj"
+
+struct project_ctx {
+    const char* path;
+    PX_EditorScene scene;
+    PX_EditorHandle* handles;
+    int count;
+    char* buffer; // for the plain read
+    size_t buffer_size;
+};
+
+static const PX_EditorProjectInfo project_info = { 4.0f, PX_EDITOR_CUR_VERSION, PX_EDITOR_CUR_VERSION, "bench" };
+
+static uint32_t project_rand(uint32_t* state) {
+    *state ^= *state << 13; *state ^= *state >> 17; *state ^= *state << 5;
+    return *state;
+}
+
+static float project_randf(uint32_t* state) {
+    return (float)(project_rand(state) >> 8) / (float)(1u << 24) * 2.0f - 1.0f;
+}
+
+static PX_Transform3 random_transform(uint32_t* state) {
+    PX_Transform3 t;
+    t.pos = (PX_Vector3f){ project_randf(state) * 10.0f, project_randf(state) * 10.0f, project_randf(state) * 10.0f };
+    t.scale = (PX_Scale3f){ 1.0f + project_randf(state) * 0.01f, 1.0f, 1.0f + project_randf(state) * 0.01f };
+    float x = project_randf(state), y = project_randf(state), z = project_randf(state), w = 4.0f;
+    float len = sqrtf(x * x + y * y + z * z + w * w);
+    t.rot = (PX_Orientation3){ x / len, y / len, z / len, w / len };
+    return t;
+}
+
+// Breadth first adds, so the slots are out of pre-order until the save sorts them
+static bool build_scene(struct project_ctx* c, int count) {
+    c->count = count;
+    c->handles = (PX_EditorHandle*)malloc(sizeof(PX_EditorHandle) * (size_t)count);
+    if (!c->handles || editor_scene_init(&c->scene, (uint32_t)count + 1) != ERR_SUCCESS)
+        return false;
+
+    uint32_t seed = 7;
+    char name[32];
+    for (int i = 0; i < count; i++) {
+        int p = i < PROJECT_FANOUT ? -1 : i / PROJECT_FANOUT - 1;
+        snprintf(name, sizeof(name), "object %d", i);
+        c->handles[i] = editor_scene_add(&c->scene, p < 0 ? PX_EDITOR_NULL_HANDLE : c->handles[p], name);
+        PX_Transform3 t = random_transform(&seed);
+        if (c->handles[i] == PX_EDITOR_NULL_HANDLE || !editor_scene_set_transform(&c->scene, c->handles[i], &t))
+            return false;
+    }
+    return true;
+}
+
+static void free_scene(struct project_ctx* c) {
+    editor_scene_free(&c->scene);
+    free(c->handles);
+    c->handles = NULL;
+}
+
+static bool same_string(const char* a, const char* b) {
+    return (a == NULL) == (b == NULL) && (!a || strcmp(a, b) == 0);
+}
+
+// Slot for slot once both are sorted: links, names, flags, transforms and world matrices
+static bool scenes_match(PX_EditorScene* a, PX_EditorScene* b) {
+    editor_scene_sort(a);
+    editor_scene_sort(b);
+    editor_scene_update_transforms(a);
+    editor_scene_update_transforms(b);
+    if (a->count != b->count)
+        return false;
+
+    for (uint32_t i = 0; i < a->count; i++) {
+        if (a->parent[i] != b->parent[i] || a->first_child[i] != b->first_child[i] ||
+            a->last_child[i] != b->last_child[i] || a->next[i] != b->next[i] || a->prev[i] != b->prev[i] ||
+            a->child_count[i] != b->child_count[i] || a->depth[i] != b->depth[i] ||
+            a->collapsed[i] != b->collapsed[i] || strcmp(a->name[i], b->name[i]) != 0 ||
+            a->material[i].used != b->material[i].used ||
+            !same_string(a->material[i].name, b->material[i].name) ||
+            memcmp(&a->transform[i], &b->transform[i], sizeof(PX_Transform3)) != 0 ||
+            memcmp(&a->world[i], &b->world[i], sizeof(PX_Mat4)) != 0 ||
+            editor_scene_slot(b, b->handle[i]) != i)
+            return false;
+    }
+    return true;
+}
+
+// Rewrites the saved file with one change to see the load turn it down
+static t_err_codes load_patched(const char* path, size_t at, const void* bytes, size_t len, size_t truncate) {
+    size_t size = 0;
+    char* data = px_bench_read_file(path, &size);
+    if (!data || at + len > size)
+        return ERR_UNKNOWN;
+    memcpy(data + at, bytes, len);
+
+    char patched[512];
+    snprintf(patched, sizeof(patched), "%s.bad", path);
+    FILE* f = fopen(patched, "wb");
+    size_t out = truncate ? truncate : size;
+    bool written = f && fwrite(data, 1, out, f) == out;
+    if (f) fclose(f);
+    free(data);
+
+    t_err_codes err = ERR_UNKNOWN;
+    PX_EditorScene scene;
+    if (written) {
+        err = editor_scene_load(&scene, patched, NULL);
+        if (err == ERR_SUCCESS)
+            editor_scene_free(&scene);
+    }
+    remove(patched);
+    return err;
+}
+
+// Same file with everything from the first section on moved shift bytes later and
+// the offsets moved with it: sound in every way except its alignment
+static t_err_codes load_shifted(const char* path, size_t shift) {
+    size_t size = 0;
+    char* data = px_bench_read_file(path, &size);
+    char* out = data ? (char*)calloc(1, size + shift) : NULL;
+    PX_PXProj_Hdr h;
+    if (!out || size < sizeof(h)) {
+        free(data);
+        free(out);
+        return ERR_UNKNOWN;
+    }
+    memcpy(&h, data, sizeof(h));
+
+    // The table has to fit and sit before the first section, which stays in the file
+    uint64_t table = (uint64_t)h.section_count * sizeof(PX_PXProj_Section);
+    bool fits = h.section_count > 0 && h.sections_offset <= size && table <= size - h.sections_offset;
+    uint64_t first = UINT64_MAX;
+    for (uint32_t i = 0; fits && i < h.section_count; i++) {
+        PX_PXProj_Section sec;
+        memcpy(&sec, data + h.sections_offset + i * sizeof(sec), sizeof(sec));
+        if (sec.offset < first)
+            first = sec.offset;
+    }
+    if (!fits || first > size || first < h.sections_offset + table) {
+        free(data);
+        free(out);
+        return ERR_UNKNOWN;
+    }
+    memcpy(out, data, (size_t)first);
+    memcpy(out + first + shift, data + first, size - (size_t)first);
+    for (uint32_t i = 0; i < h.section_count; i++) {
+        PX_PXProj_Section sec;
+        char* at = out + h.sections_offset + i * sizeof(sec);
+        memcpy(&sec, at, sizeof(sec));
+        sec.offset += shift;
+        memcpy(at, &sec, sizeof(sec));
+    }
+    h.file_size += shift;
+    memcpy(out, &h, sizeof(h));
+    free(data);
+
+    char shifted[512];
+    snprintf(shifted, sizeof(shifted), "%s.shifted", path);
+    FILE* f = fopen(shifted, "wb");
+    bool written = f && fwrite(out, 1, size + shift, f) == size + shift;
+    if (f) fclose(f);
+    free(out);
+
+    t_err_codes err = ERR_UNKNOWN;
+    PX_EditorScene scene;
+    if (written) {
+        err = editor_scene_load(&scene, shifted, NULL);
+        if (err == ERR_SUCCESS)
+            editor_scene_free(&scene);
+    }
+    remove(shifted);
+    return err;
+}
+
+static int check_project(struct project_ctx* c) {
+    bool ok = build_scene(c, PROJECT_CHECK_COUNT);
+    // A removal and a few materials and collapsed objects on top
+    ok = ok && editor_scene_remove(&c->scene, c->handles[3]);
+    for (int i = 10; ok && i < PROJECT_CHECK_COUNT; i += 97) {
+        uint32_t slot = editor_scene_slot(&c->scene, c->handles[i]);
+        if (slot == PX_EDITOR_NO_SLOT)
+            continue;
+        c->scene.material[slot] = (PX_EditorMaterial){ true, i % 2 ? "stone" : "glass" };
+        c->scene.collapsed[slot] = i % 3 == 0;
+    }
+
+    PX_EditorScene loaded;
+    PX_EditorProjectInfo info = {0};
+    ok = ok && editor_scene_save(&c->scene, &project_info, c->path) == ERR_SUCCESS;
+    ok = ok && editor_scene_load(&loaded, c->path, &info) == ERR_SUCCESS;
+    if (ok) {
+        // An edit before the first update lands next to the stale world matrices
+        // and stays in the private mapping, the file keeps the saved transform
+        uint32_t seed = 7;
+        PX_Transform3 saved = loaded.transform[7], edited = random_transform(&seed);
+        ok = editor_scene_set_transform(&loaded, loaded.handle[7], &edited) &&
+             editor_scene_set_transform(&c->scene, c->scene.handle[7], &edited);
+        // Saved in pre-order, so it loads sorted
+        ok = ok && loaded.sorted && scenes_match(&c->scene, &loaded) && same_string(info.name, project_info.name) &&
+             info.opengl_version == project_info.opengl_version;
+        // Objects added after a load go to the name chunks next to the mapped ones
+        PX_EditorHandle added = editor_scene_add(&loaded, editor_scene_root(&loaded), "added");
+        ok = ok && added != PX_EDITOR_NULL_HANDLE && editor_scene_add(&c->scene, editor_scene_root(&c->scene), "added") != PX_EDITOR_NULL_HANDLE;
+        ok = ok && editor_scene_remove(&loaded, loaded.handle[5]) && editor_scene_remove(&c->scene, c->scene.handle[5]);
+        ok = ok && scenes_match(&c->scene, &loaded);
+        editor_scene_free(&loaded);
+
+        PX_EditorScene again;
+        if (ok && editor_scene_load(&again, c->path, NULL) == ERR_SUCCESS) {
+            ok = memcmp(&again.transform[7], &saved, sizeof(saved)) == 0;
+            editor_scene_free(&again);
+        } else {
+            ok = false;
+        }
+    }
+    printf("round trip: %s\n", ok ? "matches expected" : "MISMATCH");
+
+    // Broken files are turned down and leave nothing behind
+    uint32_t bad_magic = 0, bad_parent = 5;
+    size_t objects = 0, table = 0;
+    PX_PXProj_Hdr hdr;
+    PX_PXProj_Section sec;
+    size_t size = 0;
+    char* data = px_bench_read_file(c->path, &size);
+    if (data && size > sizeof(hdr)) {
+        memcpy(&hdr, data, sizeof(hdr));
+        table = (size_t)hdr.sections_offset;
+        if (table < size && size - table > sizeof(sec)) {
+            memcpy(&sec, data + table, sizeof(sec));
+            objects = (size_t)sec.offset;
+        }
+    }
+    free(data);
+    uint64_t misaligned_table = table + 4;
+    bool rejected = objects > 0 &&
+                    load_patched(c->path, 0, &bad_magic, sizeof(bad_magic), 0) == ERR_MAGIC_INVALID &&
+                    load_patched(c->path, 0, &(uint32_t){ PX_PXPROJ_MAGIC }, 4, size / 2) == ERR_INTERNAL &&
+                    // Object 3 naming object 5 as its parent would be a forward link
+                    load_patched(c->path, objects + 3 * sizeof(PX_PXProj_Object), &bad_parent, sizeof(bad_parent), 0) == ERR_INTERNAL &&
+                    // Records are read in place, so offsets off the alignment are turned down
+                    load_patched(c->path, offsetof(PX_PXProj_Hdr, sections_offset), &misaligned_table, sizeof(misaligned_table), 0) == ERR_INTERNAL &&
+                    load_shifted(c->path, PX_PXPROJ_ALIGN) == ERR_SUCCESS &&
+                    load_shifted(c->path, 4) == ERR_INTERNAL;
+    printf("rejects broken files: %s\n", rejected ? "matches expected" : "MISMATCH");
+
+    free_scene(c);
+    return ok && rejected ? 0 : 1;
+}
+
+static void run_save(void* p) {
+    struct project_ctx* c = p;
+    px_bench_consume(editor_scene_save(&c->scene, &project_info, c->path));
+}
+
+static void run_load(void* p) {
+    struct project_ctx* c = p;
+    PX_EditorScene scene;
+    if (editor_scene_load(&scene, c->path, NULL) == ERR_SUCCESS) {
+        px_bench_consume(scene.count);
+        editor_scene_free(&scene);
+    }
+}
+
+// What the load leaves to the first update: every local and world matrix
+static void run_load_update(void* p) {
+    struct project_ctx* c = p;
+    PX_EditorScene scene;
+    if (editor_scene_load(&scene, c->path, NULL) == ERR_SUCCESS) {
+        editor_scene_update_transforms(&scene);
+        px_bench_consume(scene.count);
+        editor_scene_free(&scene);
+    }
+}
+
+// The floor: the file's bytes copied out of the page cache, nothing else
+static void run_read(void* p) {
+    struct project_ctx* c = p;
+    FILE* f = fopen(c->path, "rb");
+    if (!f)
+        return;
+    size_t n = fread(c->buffer, 1, c->buffer_size, f);
+    fclose(f);
+    px_bench_consume(n);
+}
+
+int bench_project(int argc, char** argv) {
+    struct project_ctx c = {0};
+    c.path = argc > 0 && argv[0][0] != '-' ? argv[0] : PROJECT_DEFAULT_PATH;
+
+    int result = check_project(&c);
+    if (result == 0 && build_scene(&c, PROJECT_SCENE_COUNT)) {
+        px_bench_run("save_1m", run_save, &c);
+
+        size_t size = 0;
+        free(px_bench_read_file(c.path, &size));
+        c.buffer = (char*)malloc(size);
+        c.buffer_size = size;
+        free_scene(&c);
+        if (c.buffer) {
+            printf("file: %.1f MB\n", (double)size / (1024.0 * 1024.0));
+            px_bench_run("read_file_1m", run_read, &c);
+            px_bench_run("load_1m", run_load, &c);
+            px_bench_run("load_update_1m", run_load_update, &c);
+        } else {
+            result = 1;
+        }
+    } else {
+        free_scene(&c);
+        result = 1;
+    }
+
+    free(c.buffer);
+    remove(c.path);
+    return result;
+}
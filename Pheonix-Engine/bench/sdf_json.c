@@ -0,0 +1,180 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <font.h>
+#include <loaders/sdf-loader.h>
+#include <external/cJSON.h>
+
+#define SDF_JSON_DEFAULT_PATH "assets/fonts/raw/sdf/Roboto/roboto.json"
+#define SDF_JSON_DEFAULT_GLYPHS 40000
+
+typedef t_err_codes (*sdf_parse_fn)(const char*, size_t, const PX_SDFBuildDesc*, struct px_sdf_json_font*);
+
+static size_t dom_alloc_count = 0;
+
+static void* counting_malloc(size_t sz) {
+    dom_alloc_count++;
+    return malloc(sz);
+}
+
+static char* load_text(const char* path, size_t* out_size) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+
+    char* text = (char*)malloc(size + 1);
+    if (!text) {
+        fclose(f);
+        return NULL;
+    }
+    *out_size = fread(text, 1, size, f);
+    text[*out_size] = '\0';
+    fclose(f);
+    return text;
+}
+
+// Repeats the glyph records of a real atlas description until it holds
+// roughly target_glyphs entries, to get a CJK-sized input.
+static char* synthesize_large(const char* text, int source_glyphs, int target_glyphs, size_t* out_size) {
+    const char* begin = strstr(text, "\"glyphs\":[");
+    if (!begin || source_glyphs <= 0)
+        return NULL;
+    begin += strlen("\"glyphs\":[");
+
+    int depth = 0;
+    const char* end = begin;
+    for (; *end; end++) {
+        if (*end == '[' || *end == '{') depth++;
+        else if (*end == '}') depth--;
+        else if (*end == ']') {
+            if (depth == 0) break;
+            depth--;
+        }
+    }
+    if (!*end)
+        return NULL;
+
+    size_t prefix = (size_t)(begin - text);
+    size_t body = (size_t)(end - begin);
+    size_t suffix = strlen(end);
+    int repeat = target_glyphs / source_glyphs;
+    if (repeat < 1)
+        repeat = 1;
+
+    size_t size = prefix + (body + 1) * repeat + suffix;
+    char* out = (char*)malloc(size + 1);
+    if (!out)
+        return NULL;
+
+    char* p = out;
+    memcpy(p, text, prefix); p += prefix;
+    for (int i = 0; i < repeat; i++) {
+        if (i > 0) *p++ = ',';
+        memcpy(p, begin, body); p += body;
+    }
+    memcpy(p, end, suffix); p += suffix;
+    *p = '\0';
+
+    *out_size = (size_t)(p - out);
+    return out;
+}
+
+static double run_parser(sdf_parse_fn fn, const char* text, size_t size, const PX_SDFBuildDesc* desc, int iterations, struct px_sdf_json_font* keep) {
+    double best_ms = 0.0;
+
+    for (int i = 0; i < iterations; i++) {
+        struct px_sdf_json_font parsed = {0};
+        uint64_t start = px_bench_now_ns();
+        t_err_codes err = fn(text, size, desc, &parsed);
+        double ms = (double)(px_bench_now_ns() - start) / 1e6;
+
+        if (err != ERR_SUCCESS)
+            return -1.0;
+        if (i == 0 || ms < best_ms)
+            best_ms = ms;
+
+        if (i == iterations - 1 && keep)
+            *keep = parsed;
+        else
+            px_sdf_json_free(&parsed);
+    }
+
+    return best_ms;
+}
+
+static int bench_input(const char* label, const char* text, size_t size, int iterations) {
+    PX_SDFBuildDesc desc = {
+        .pixel_size = 64,
+        .atlas_size = 512,
+        .sdf_range = 8,
+        .ascii_only = true
+    };
+
+    struct px_sdf_json_font dom = {0};
+    struct px_sdf_json_font stream = {0};
+
+    dom_alloc_count = 0;
+    cJSON_InitHooks(&(cJSON_Hooks){ counting_malloc, free });
+    double dom_ms = run_parser(px_sdf_parse_json_dom, text, size, &desc, iterations, &dom);
+    cJSON_InitHooks(NULL);
+    size_t dom_allocs = dom_alloc_count / (size_t)iterations;
+
+    double stream_ms = run_parser(px_sdf_parse_json_stream, text, size, &desc, iterations, &stream);
+
+    if (dom_ms < 0.0 || stream_ms < 0.0) {
+        fprintf(stderr, "%s: parse failed\n", label);
+        px_sdf_json_free(&dom);
+        px_sdf_json_free(&stream);
+        return 1;
+    }
+
+    bool same = memcmp(&dom.header, &stream.header, sizeof(dom.header)) == 0 &&
+        memcmp(dom.glyphs, stream.glyphs, sizeof(*dom.glyphs) * dom.header.glyph_count) == 0;
+
+    double mb = (double)size / (1024.0 * 1024.0);
+    printf("%s: %u glyphs, %.2f MiB, best of %d\n", label, dom.header.glyph_count, mb, iterations);
+    printf("\tdom:    %10.3f ms  %8.1f MiB/s  %zu allocations\n", dom_ms, mb / (dom_ms / 1000.0), dom_allocs);
+    printf("\tstream: %10.3f ms  %8.1f MiB/s  (%.1fx)\n", stream_ms, mb / (stream_ms / 1000.0), dom_ms / stream_ms);
+    printf("\toutput: %s\n", same ? "identical" : "MISMATCH");
+
+    px_sdf_json_free(&dom);
+    px_sdf_json_free(&stream);
+    return same ? 0 : 1;
+}
+
+int bench_sdf_json(int argc, char** argv) {
+    const char* path = argc > 0 ? argv[0] : SDF_JSON_DEFAULT_PATH;
+    int target_glyphs = argc > 1 ? atoi(argv[1]) : SDF_JSON_DEFAULT_GLYPHS;
+
+    size_t size = 0;
+    char* text = load_text(path, &size);
+    if (!text) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return 1;
+    }
+
+    int result = bench_input(path, text, size, 50);
+
+    struct px_sdf_json_font probe = {0};
+    PX_SDFBuildDesc probe_desc = { .pixel_size = 64 };
+    if (px_sdf_parse_json_stream(text, size, &probe_desc, &probe) == ERR_SUCCESS && target_glyphs > 0) {
+        size_t large_size = 0;
+        char* large = synthesize_large(text, probe.header.glyph_count, target_glyphs, &large_size);
+        if (large) {
+            result |= bench_input("synthetic", large, large_size, 1);
+            free(large);
+        }
+    }
+    px_sdf_json_free(&probe);
+
+    free(text);
+    return result;
+}
@@ -0,0 +1,213 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include <event-sys.h>
+
+#define SIGNALS_PRODUCERS 4
+#define SIGNALS_CHECK_COUNT 100000 // per producer
+#define SIGNALS_RUN_COUNT 20000
+#define SIGNALS_KEPT 32
+#define SIGNALS_CHURN (PX_GSIGNAL_MAX_SUBSCRIBERS * 16)
+#define SIGNALS_BATCH 512
+
+struct producer {
+    int id;
+    int count;
+    pthread_t thread;
+};
+
+struct consumer {
+    int next[SIGNALS_PRODUCERS]; // sequence expected from each producer
+    long total;
+    bool in_order;
+};
+
+static struct producer g_producers[SIGNALS_PRODUCERS];
+
+// Sources are only compared, never dereferenced
+static const void* fake_source(int i) {
+    return (const void*)(uintptr_t)(0x1000 + i * 16);
+}
+
+static PX_Event_GSignal make_signal(const void* source, int a, int b) {
+    PX_Event_GSignal signal = {0};
+    signal.type = EVENT_GSIGNAL_UI_DROPDOWN_CLICK;
+    signal.source = source;
+    signal.ui_dropdown_click = (PX_Event_GSignal_UIDropdownClick){ NULL, a, b };
+    return signal;
+}
+
+static void* produce(void* p) {
+    struct producer* pr = p;
+    for (int seq = 0; seq < pr->count; seq++) {
+        PX_Event_GSignal signal = make_signal(pr, pr->id, seq);
+        // A full ring turns the send down, the consumer frees room soon after
+        while (!event_send_gsignal(&signal))
+            sched_yield();
+    }
+    return NULL;
+}
+
+static void on_produced(const PX_Event_GSignal* signal, void* user) {
+    struct consumer* c = user;
+    int id = signal->ui_dropdown_click.opened_index;
+    if (id < 0 || id >= SIGNALS_PRODUCERS || signal->ui_dropdown_click.clicked_option != c->next[id] ||
+        signal->source != &g_producers[id])
+        c->in_order = false;
+    else
+        c->next[id]++;
+    c->total++;
+}
+
+// Dispatches on this thread until every producer's signals came through
+static bool run_producers(struct consumer* c, int count) {
+    *c = (struct consumer){ .in_order = true };
+    bool ok = event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, NULL, on_produced, c) == ERR_SUCCESS;
+
+    int started = 0;
+    for (; ok && started < SIGNALS_PRODUCERS; started++) {
+        g_producers[started] = (struct producer){ started, count, 0 };
+        if (pthread_create(&g_producers[started].thread, NULL, produce, &g_producers[started]) != 0)
+            break;
+    }
+    long expected = (long)started * count;
+    while (c->total < expected)
+        event_dispatch_gsignals();
+    for (int i = 0; i < started; i++)
+        pthread_join(g_producers[i].thread, NULL);
+
+    event_unsubscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, NULL, on_produced, c);
+    return ok && started == SIGNALS_PRODUCERS && !event_gsignals_pending();
+}
+
+static int check_fifo(void) {
+    struct consumer c;
+    bool ok = run_producers(&c, SIGNALS_CHECK_COUNT) && c.in_order &&
+              c.total == (long)SIGNALS_PRODUCERS * SIGNALS_CHECK_COUNT;
+    for (int i = 0; ok && i < SIGNALS_PRODUCERS; i++)
+        ok = c.next[i] == SIGNALS_CHECK_COUNT;
+    printf("%d producers, per-producer order and count: %s\n", SIGNALS_PRODUCERS, ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static void count_signal(const PX_Event_GSignal* signal, void* user) {
+    (void)signal;
+    (*(int*)user)++;
+}
+
+// Routes for sources that come and go must not use up the table, and the ones
+// kept alive next to them must still be found after the removals moved them
+static int check_routes(void) {
+    static int kept[SIGNALS_KEPT];
+    int churned = 0;
+    bool ok = true;
+    for (int i = 0; ok && i < SIGNALS_KEPT; i++) {
+        kept[i] = 0;
+        ok = event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, fake_source(i), count_signal, &kept[i]) == ERR_SUCCESS;
+    }
+
+    for (int i = 0; ok && i < SIGNALS_CHURN; i++) {
+        const void* source = fake_source(SIGNALS_KEPT + i);
+        PX_Event_GSignal signal = make_signal(source, 0, 0);
+        ok = event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, source, count_signal, &churned) == ERR_SUCCESS &&
+             event_send_gsignal(&signal) && event_dispatch_gsignals() == 1;
+        event_unsubscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, source, count_signal, &churned);
+    }
+    ok = ok && churned == SIGNALS_CHURN;
+
+    for (int i = 0; ok && i < SIGNALS_KEPT; i++) {
+        PX_Event_GSignal signal = make_signal(fake_source(i), 0, 0);
+        ok = event_send_gsignal(&signal);
+    }
+    event_dispatch_gsignals();
+    for (int i = 0; i < SIGNALS_KEPT; i++) {
+        ok = ok && kept[i] == 1;
+        event_unsubscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, fake_source(i), count_signal, &kept[i]);
+    }
+
+    printf("routes freed with their last subscriber: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+struct unsubscriber {
+    int calls;
+    int* victim; // user of the subscriber this one unsubscribes, NULL for itself
+};
+
+static void unsubscribe_next(const PX_Event_GSignal* signal, void* user) {
+    struct unsubscriber* u = user;
+    u->calls++;
+    event_unsubscribe_gsignal(signal->type, signal->source, count_signal, u->victim);
+}
+
+static void unsubscribe_self(const PX_Event_GSignal* signal, void* user) {
+    (*(int*)user)++;
+    event_unsubscribe_gsignal(signal->type, signal->source, unsubscribe_self, user);
+}
+
+// Callbacks unsubscribing the next subscriber, themselves and with them the
+// last one of the route: nothing removed is called, the table stays sound
+static int check_unsubscribe_in_callback(void) {
+    static int next_calls, self_calls, kept;
+    next_calls = self_calls = kept = 0;
+    struct unsubscriber u = { 0, &next_calls };
+    const void* shared = fake_source(0);
+    const void* lone = fake_source(1);
+    bool ok = event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, shared, unsubscribe_next, &u) == ERR_SUCCESS &&
+              event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, shared, count_signal, &next_calls) == ERR_SUCCESS &&
+              event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, shared, count_signal, &kept) == ERR_SUCCESS &&
+              event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, lone, unsubscribe_self, &self_calls) == ERR_SUCCESS;
+
+    for (int round = 0; ok && round < 2; round++) {
+        PX_Event_GSignal a = make_signal(shared, 0, 0), b = make_signal(lone, 0, 0);
+        ok = event_send_gsignal(&a) && event_send_gsignal(&b) && event_dispatch_gsignals() == 2;
+    }
+    ok = ok && u.calls == 2 && next_calls == 0 && kept == 2 && self_calls == 1;
+
+    // The lone route went with its last subscriber and comes back on a new one
+    ok = ok && event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, lone, count_signal, &self_calls) == ERR_SUCCESS;
+    PX_Event_GSignal again = make_signal(lone, 0, 0);
+    ok = ok && event_send_gsignal(&again) && event_dispatch_gsignals() == 1 && self_calls == 2;
+
+    event_unsubscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, lone, count_signal, &self_calls);
+    event_unsubscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, shared, unsubscribe_next, &u);
+    event_unsubscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, shared, count_signal, &kept);
+    printf("unsubscribe from a callback: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static void run_send_dispatch(void* p) {
+    (void)p;
+    for (int i = 0; i < SIGNALS_BATCH; i++) {
+        PX_Event_GSignal signal = make_signal(fake_source(i), i, 0);
+        event_send_gsignal(&signal);
+    }
+    px_bench_consume((uint64_t)event_dispatch_gsignals());
+}
+
+static void run_contended(void* p) {
+    (void)p;
+    struct consumer c;
+    run_producers(&c, SIGNALS_RUN_COUNT);
+    px_bench_consume((uint64_t)c.total);
+}
+
+int bench_signals(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+
+    event_sys_init((PX_Scale2){ 0, 0 }, (PX_Vector2){ 0, 0 });
+    int result = check_routes() | check_unsubscribe_in_callback() | check_fifo();
+
+    px_bench_run("send_dispatch_512", run_send_dispatch, NULL);
+    px_bench_run("4_producers_80k", run_contended, NULL);
+
+    event_sys_init((PX_Scale2){ 0, 0 }, (PX_Vector2){ 0, 0 });
+    return result;
+}
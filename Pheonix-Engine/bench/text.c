@@ -0,0 +1,105 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rendering-sys.h>
+#include <loaders/sdf-loader.h>
+#include <decoders/unicode.h>
+
+#define TEXT_FONT_PATH "assets/fonts/psdf/roboto.psdf"
+#define TEXT_UTF8_BYTES 4096
+#define TEXT_LINES 20
+#define TEXT_PANELS 256
+
+static const char* text_sample = "The quick brown fox jumps over the lazy dog 0123456789";
+
+struct text_ctx {
+    PX_Font* font;
+    char utf8[TEXT_UTF8_BYTES + 8];
+};
+
+// ASCII with 2, 3 and 4 byte sequences mixed in, roughly what UI strings hold
+static void fill_utf8(char* out, size_t size) {
+    static const char* pieces[] = { "Scene", " ", "caf\xC3\xA9", "\xE2\x82\xAC", "\xE6\x97\xA5\xE6\x9C\xAC", "\xF0\x9F\x99\x82", "Object_", "42" };
+    size_t n = 0;
+    for (int i = 0; ; i++) {
+        const char* piece = pieces[i % (sizeof(pieces) / sizeof(pieces[0]))];
+        size_t len = strlen(piece);
+        if (n + len > size)
+            break;
+        memcpy(out + n, piece, len);
+        n += len;
+    }
+    out[n] = '\0';
+}
+
+static void run_utf8(void* p) {
+    struct text_ctx* c = p;
+    uint64_t sum = 0;
+    for (const char* s = c->utf8; *s; )
+        sum += px_utf8_decode(&s);
+    px_bench_consume(sum);
+}
+
+static void run_find_glyph(void* p) {
+    struct text_ctx* c = p;
+    uint64_t hits = 0;
+    for (uint32_t cp = 32; cp < 127; cp++)
+        hits += px_sdf_find_glyph(c->font, cp) != NULL;
+    px_bench_consume(hits);
+}
+
+static void run_text_width(void* p) {
+    struct text_ctx* c = p;
+    px_bench_consume((uint64_t)px_rs_text_width(c->font, text_sample, 16.0f));
+}
+
+static void run_quads(void* p) {
+    struct text_ctx* c = p;
+    px_rs_frame_start();
+    for (int i = 0; i < TEXT_LINES; i++)
+        px_rs_render_text(text_sample, 16.0f, (PX_Vector2){8, 8 + i * 20}, (PX_Color4){0xFF, 0xFF, 0xFF, 0xFF}, c->font);
+}
+
+// Identical panels collapse into one batch
+static void run_batch_merge(void* p) {
+    (void)p;
+    px_rs_frame_start();
+    for (int i = 0; i < TEXT_PANELS; i++)
+        px_rs_draw_panel((PX_Transform2){{i, i}, {32, 16}}, (PX_Color4){0x20, 0x20, 0x20, 0xFF}, 0.03f, 4.0f);
+}
+
+// Alternating parameters break every merge
+static void run_batch_split(void* p) {
+    (void)p;
+    px_rs_frame_start();
+    for (int i = 0; i < TEXT_PANELS; i++)
+        px_rs_draw_panel((PX_Transform2){{i, i}, {32, 16}}, (PX_Color4){0x20, 0x20, 0x20, 0xFF}, 0.03f, (float)(i & 1) * 4.0f);
+}
+
+int bench_text(int argc, char** argv) {
+    const char* font_path = argc > 0 ? argv[0] : TEXT_FONT_PATH;
+
+    struct text_ctx ctx = {0};
+    ctx.font = px_bench_load_font(font_path);
+    if (!ctx.font)
+        return 1;
+    if (px_rs_init_ui_headless((PX_Scale2){1280, 720}) != ERR_SUCCESS) {
+        px_font_destroy(ctx.font);
+        return 1;
+    }
+    fill_utf8(ctx.utf8, TEXT_UTF8_BYTES);
+
+    px_bench_run("utf8_decode_4k", run_utf8, &ctx);
+    px_bench_run("find_glyph_ascii", run_find_glyph, &ctx);
+    px_bench_run("text_width", run_text_width, &ctx);
+    px_bench_run("glyph_quads", run_quads, &ctx);
+    px_bench_run("push_batch_merge", run_batch_merge, &ctx);
+    px_bench_run("push_batch_split", run_batch_split, &ctx);
+
+    px_rs_shutdown_ui();
+    px_font_destroy(ctx.font);
+    return 0;
+}
@@ -0,0 +1,318 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <core/mat4.h>
+#include <core/jobs.h>
+#include <editor.h>
+
+#define TRANSFORM_BATCH 4096
+#define TRANSFORM_CHECK_COUNT 100000
+#define TRANSFORM_SCENE_COUNT 1000000
+#define TRANSFORM_FANOUT 8
+#define TRANSFORM_NAIVE_QUERIES 4096
+
+struct transform_ctx {
+    PX_Mat4* a;
+    PX_Mat4* b;
+    PX_Mat4* out;
+
+    PX_EditorScene scene;
+    PX_EditorHandle* handles;
+    int count;
+    uint32_t seed;
+    uint32_t edit;
+};
+
+static uint32_t transform_rand(uint32_t* state) {
+    *state ^= *state << 13; *state ^= *state >> 17; *state ^= *state << 5;
+    return *state;
+}
+
+static float transform_randf(uint32_t* state) {
+    return (float)(transform_rand(state) >> 8) / (float)(1u << 24) * 2.0f - 1.0f;
+}
+
+static void fill_matrices(PX_Mat4* m, size_t count, uint32_t seed) {
+    for (size_t i = 0; i < count; i++)
+        for (int k = 0; k < 16; k++)
+            m[i].m[k] = transform_randf(&seed);
+}
+
+// Near the identity, so products down a deep chain stay finite
+static PX_Transform3 random_transform(uint32_t* state) {
+    PX_Transform3 t;
+    t.pos = (PX_Vector3f){ transform_randf(state) * 10.0f, transform_randf(state) * 10.0f, transform_randf(state) * 10.0f };
+    t.scale = (PX_Scale3f){ 1.0f + transform_randf(state) * 0.01f, 1.0f + transform_randf(state) * 0.01f, 1.0f };
+    float x = transform_randf(state), y = transform_randf(state), z = transform_randf(state), w = 4.0f;
+    float len = sqrtf(x * x + y * y + z * z + w * w);
+    t.rot = (PX_Orientation3){ x / len, y / len, z / len, w / len };
+    return t;
+}
+
+// ---- Reference, written for clarity only ----
+
+static void ref_mul(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b) {
+    PX_Mat4 r;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = a->m[row] * b->m[col * 4];
+            for (int k = 1; k < 4; k++)
+                sum += a->m[k * 4 + row] * b->m[col * 4 + k];
+            r.m[col * 4 + row] = sum;
+        }
+    }
+    *out = r;
+}
+
+// What every query paid with nothing cached: the chain of locals from the root down
+static void ref_world(const PX_EditorScene* s, uint32_t slot, PX_Mat4* out) {
+    uint32_t chain[256];
+    int n = 0;
+    for (uint32_t i = slot; i != PX_EDITOR_NO_SLOT && n < 256; i = s->parent[i])
+        chain[n++] = i;
+    *out = s->local[chain[n - 1]];
+    for (int i = n - 2; i >= 0; i--)
+        ref_mul(out, out, &s->local[chain[i]]);
+}
+
+static bool check_kernels(PX_Mat4ISA isa) {
+    PX_Mat4* a = (PX_Mat4*)malloc(sizeof(PX_Mat4) * 67);
+    PX_Mat4* b = (PX_Mat4*)malloc(sizeof(PX_Mat4) * 67);
+    PX_Mat4* out = (PX_Mat4*)malloc(sizeof(PX_Mat4) * 67);
+    PX_Mat4* ref = (PX_Mat4*)malloc(sizeof(PX_Mat4) * 67);
+    uint32_t parent[67];
+    if (!a || !b || !out || !ref) {
+        free(a); free(b); free(out); free(ref);
+        return false;
+    }
+    fill_matrices(a, 67, 11);
+    fill_matrices(b, 67, 23);
+
+    px_mat4_mul_batch(out, a, b, 67);
+    bool ok = true;
+    for (int i = 0; i < 67; i++) {
+        ref_mul(&ref[i], &a[i], &b[i]);
+        ok = ok && memcmp(&out[i], &ref[i], sizeof(PX_Mat4)) == 0;
+    }
+
+    // Both aliasing forms
+    PX_Mat4 m = a[3];
+    px_mat4_mul(&m, &m, &b[3]);
+    ok = ok && memcmp(&m, &ref[3], sizeof(m)) == 0;
+    m = b[4];
+    px_mat4_mul(&m, &a[4], &m);
+    ok = ok && memcmp(&m, &ref[4], sizeof(m)) == 0;
+
+    // A random forest, parents always earlier
+    uint32_t seed = 5;
+    for (int i = 0; i < 67; i++)
+        parent[i] = i == 0 || transform_rand(&seed) % 5 == 0 ? PX_MAT4_NO_PARENT : transform_rand(&seed) % (uint32_t)i;
+    for (int i = 0; i < 67; i++) {
+        if (parent[i] == PX_MAT4_NO_PARENT)
+            ref[i] = b[i];
+        else
+            ref_mul(&ref[i], &ref[parent[i]], &b[i]);
+    }
+    px_mat4_mul_parents(out, b, parent, 0, 67);
+    ok = ok && memcmp(out, ref, sizeof(PX_Mat4) * 67) == 0;
+
+    printf("%s: %s\n", px_mat4_isa_name(isa), ok ? "matches reference" : "MISMATCH");
+    free(a); free(b); free(out); free(ref);
+    return ok;
+}
+
+static bool check_compose(void) {
+    // A quarter turn about z takes x to y, then the translation lands it
+    const float t[3] = { 1.0f, 2.0f, 3.0f };
+    const float q[4] = { 0.0f, 0.0f, sqrtf(0.5f), sqrtf(0.5f) };
+    const float s[3] = { 2.0f, 2.0f, 2.0f };
+    PX_Mat4 m;
+    px_mat4_compose(&m, t, q, s);
+    // Column 0 is where x goes
+    float x = m.m[0] + m.m[12], y = m.m[1] + m.m[13], z = m.m[2] + m.m[14];
+    bool ok = fabsf(x - 1.0f) < 1e-5f && fabsf(y - 4.0f) < 1e-5f && fabsf(z - 3.0f) < 1e-5f;
+    printf("compose: %s\n", ok ? "matches expected" : "MISMATCH");
+    return ok;
+}
+
+static bool build_scene(struct transform_ctx* c, int count) {
+    c->count = count;
+    c->handles = (PX_EditorHandle*)malloc(sizeof(PX_EditorHandle) * (size_t)count);
+    if (!c->handles || editor_scene_init(&c->scene, (uint32_t)count + 1) != ERR_SUCCESS)
+        return false;
+
+    c->seed = 99;
+    for (int i = 0; i < count; i++) {
+        int p = i < TRANSFORM_FANOUT ? -1 : i / TRANSFORM_FANOUT - 1;
+        c->handles[i] = editor_scene_add(&c->scene, p < 0 ? PX_EDITOR_NULL_HANDLE : c->handles[p], "o");
+        PX_Transform3 t = random_transform(&c->seed);
+        if (c->handles[i] == PX_EDITOR_NULL_HANDLE || !editor_scene_set_transform(&c->scene, c->handles[i], &t))
+            return false;
+    }
+    return true;
+}
+
+static void free_scene(struct transform_ctx* c) {
+    editor_scene_free(&c->scene);
+    free(c->handles);
+    c->handles = NULL;
+}
+
+static bool worlds_match(const PX_EditorScene* s) {
+    for (uint32_t i = 0; i < s->count; i++) {
+        PX_Mat4 ref;
+        ref_world(s, i, &ref);
+        if (memcmp(&ref, &s->world[i], sizeof(ref)) != 0)
+            return false;
+    }
+    return true;
+}
+
+static uint32_t subtree_size(const PX_EditorScene* s, uint32_t slot) {
+    uint32_t n = 1;
+    for (uint32_t c = s->first_child[slot]; c != PX_EDITOR_NO_SLOT; c = s->next[c])
+        n += subtree_size(s, c);
+    return n;
+}
+
+// Every world matrix against the chain product, after a full and after partial updates
+static int check_scene(struct transform_ctx* c) {
+    bool ok = build_scene(c, TRANSFORM_CHECK_COUNT);
+    ok = ok && editor_scene_update_transforms(&c->scene) == c->scene.count - 1 && worlds_match(&c->scene);
+    ok = ok && editor_scene_update_transforms(&c->scene) == 0;
+
+    // An object and one below it: only the upper one's subtree is redone
+    PX_EditorHandle upper = c->handles[3], lower = c->handles[(3 + 1) * TRANSFORM_FANOUT + 2];
+    PX_Transform3 t = random_transform(&c->seed);
+    editor_scene_set_transform(&c->scene, lower, &t);
+    t = random_transform(&c->seed);
+    editor_scene_set_transform(&c->scene, upper, &t);
+    uint32_t expected = subtree_size(&c->scene, editor_scene_slot(&c->scene, upper));
+    ok = ok && editor_scene_update_transforms(&c->scene) == expected && worlds_match(&c->scene);
+
+    // A removal moves slots around and the world matrices have to follow
+    editor_scene_remove(&c->scene, c->handles[5]);
+    editor_scene_set_transform(&c->scene, c->handles[2], &t);
+    PX_Mat4 world;
+    ok = ok && editor_scene_world(&c->scene, c->handles[TRANSFORM_CHECK_COUNT - 1], &world) && worlds_match(&c->scene);
+    ok = ok && !editor_scene_world(&c->scene, c->handles[5], &world);
+
+    free_scene(c);
+    return ok ? 0 : 1;
+}
+
+static void run_batch(void* p) {
+    struct transform_ctx* c = p;
+    px_mat4_mul_batch(c->out, c->a, c->b, TRANSFORM_BATCH);
+    px_bench_consume((uint64_t)c->out[TRANSFORM_BATCH - 1].m[0]);
+}
+
+static void run_full_update(void* p) {
+    struct transform_ctx* c = p;
+    PX_Transform3 t = c->scene.transform[0];
+    editor_scene_set_transform(&c->scene, editor_scene_root(&c->scene), &t);
+    px_bench_consume(editor_scene_update_transforms(&c->scene));
+}
+
+// One leaf moved per frame, the common edit
+static void run_leaf_update(void* p) {
+    struct transform_ctx* c = p;
+    PX_EditorHandle leaf = c->handles[c->count - 1 - (int)(c->edit++ % 1024)];
+    PX_Transform3 t = random_transform(&c->seed);
+    editor_scene_set_transform(&c->scene, leaf, &t);
+    px_bench_consume(editor_scene_update_transforms(&c->scene));
+}
+
+static void run_naive_queries(void* p) {
+    struct transform_ctx* c = p;
+    PX_Mat4 m;
+    float sum = 0.0f;
+    for (int i = 0; i < TRANSFORM_NAIVE_QUERIES; i++) {
+        ref_world(&c->scene, (uint32_t)((uint64_t)i * 2654435761u % c->scene.count), &m);
+        sum += m.m[12];
+    }
+    px_bench_consume((uint64_t)sum);
+}
+
+static void run_cached_queries(void* p) {
+    struct transform_ctx* c = p;
+    PX_Mat4 m;
+    float sum = 0.0f;
+    for (int i = 0; i < TRANSFORM_NAIVE_QUERIES; i++) {
+        editor_scene_world(&c->scene, c->scene.handle[(uint64_t)i * 2654435761u % c->scene.count], &m);
+        sum += m.m[12];
+    }
+    px_bench_consume((uint64_t)sum);
+}
+
+int bench_transform(int argc, char** argv) {
+    int threads = argc > 0 ? atoi(argv[0]) : px_cpu_count();
+    if (threads < 1)
+        threads = 1;
+    if (threads > PX_JOB_MAX_WORKERS + 1)
+        threads = PX_JOB_MAX_WORKERS + 1;
+
+    struct transform_ctx c = {0};
+    c.a = (PX_Mat4*)malloc(sizeof(PX_Mat4) * TRANSFORM_BATCH);
+    c.b = (PX_Mat4*)malloc(sizeof(PX_Mat4) * TRANSFORM_BATCH);
+    c.out = (PX_Mat4*)malloc(sizeof(PX_Mat4) * TRANSFORM_BATCH);
+    if (!c.a || !c.b || !c.out) {
+        free(c.a); free(c.b); free(c.out);
+        return 1;
+    }
+    fill_matrices(c.a, TRANSFORM_BATCH, 1);
+    fill_matrices(c.b, TRANSFORM_BATCH, 2);
+
+    int result = 0;
+    PX_Mat4ISA best = px_mat4_isa();
+    for (int isa = PX_MAT4_ISA_SCALAR; isa <= (int)best; isa++) {
+        px_mat4_set_isa((PX_Mat4ISA)isa);
+        if (!check_kernels((PX_Mat4ISA)isa))
+            result = 1;
+        char name[PX_BENCH_NAME_MAX];
+        snprintf(name, sizeof(name), "mul_batch_4096/%s", px_mat4_isa_name((PX_Mat4ISA)isa));
+        px_bench_run(name, run_batch, &c);
+    }
+    px_mat4_set_isa(best);
+    if (!check_compose())
+        result = 1;
+
+    // Serial first, then spread over the job system
+    for (int t = 1; t <= threads && result == 0; t = t == 1 && threads > 1 ? threads : t + threads) {
+        if (t > 1 && px_jobs_init(t - 1) != ERR_SUCCESS) {
+            fprintf(stderr, "Could not start %d job workers\n", t - 1);
+            result = 1;
+            break;
+        }
+        int check = check_scene(&c);
+        printf("scene x%d: %s\n", t, check == 0 ? "matches expected" : "MISMATCH");
+        result |= check;
+
+        if (result == 0 && build_scene(&c, TRANSFORM_SCENE_COUNT)) {
+            editor_scene_update_transforms(&c.scene);
+            char name[PX_BENCH_NAME_MAX];
+            snprintf(name, sizeof(name), "full_update_1m/t%d", t);
+            px_bench_run(name, run_full_update, &c);
+            if (t == 1) {
+                px_bench_run("leaf_update_1m", run_leaf_update, &c);
+                px_bench_run("naive_world_4k_queries", run_naive_queries, &c);
+                px_bench_run("cached_world_4k_queries", run_cached_queries, &c);
+            }
+        } else {
+            result = 1;
+        }
+        free_scene(&c);
+        if (t > 1)
+            px_jobs_shutdown();
+    }
+
+    free(c.a);
+    free(c.b);
+    free(c.out);
+    return result;
+}
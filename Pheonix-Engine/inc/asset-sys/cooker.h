@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <err-codes.h>
+#include <font.h>
+#include <loaders/ptex-loader.h>
+
+#define PX_COOK_MANIFEST ".pxcook"
+#define PX_COOK_VERSION 1
+
+typedef enum {
+    PX_COOK_KIND_SDF_FONT = 0, // SDF JSON + PNG atlas pair -> PSDF
+    PX_COOK_KIND_TTF,
+    PX_COOK_KIND_IMAGE, // PNG -> PTEX
+    PX_COOK_KIND_SHADER,
+    PX_COOK_KIND_COUNT
+} PX_CookKind;
+
+typedef struct {
+    int workers; // 0 = one per core
+    bool force; // ignore the manifest and cook everything
+    const char* shader_dir; // optional, discovered alongside the asset dir
+    PX_SDFBuildDesc sdf;
+    PX_PTexBuildDesc ptex;
+} PX_CookDesc;
+
+typedef struct {
+    int discovered[PX_COOK_KIND_COUNT];
+    int cooked;
+    int up_to_date;
+    int failed;
+    int no_cooker;
+    double elapsed_ms;
+} PX_CookReport;
+
+t_err_codes px_cook_assets(const char* asset_dir, const PX_CookDesc* desc, PX_CookReport* report);
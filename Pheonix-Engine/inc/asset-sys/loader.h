@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <rendering-sys/opengl.h>
+#include <err-codes.h>
+#include <font.h>
+
+// Default share of a frame spent on texture uploads
+#define PX_LOADER_FRAME_BUDGET_MS 2.0
+
+typedef enum {
+    PX_ASSET_PENDING = 0,
+    PX_ASSET_READY,
+    PX_ASSET_FAILED
+} PX_AssetState;
+
+typedef enum {
+    PX_ASSET_FONT = 0,
+    PX_ASSET_IMAGE
+} PX_AssetKind;
+
+typedef struct px_asset PX_Asset;
+
+// Reads and decodes on the job system (inline when it is not running); GL work
+// only happens in px_loader_pump on the thread owning the context.
+t_err_codes px_loader_init(void);
+void px_loader_shutdown(void);
+// Uploads staged assets until budget_ms is used up (<= 0 drains everything)
+void px_loader_pump(double budget_ms);
+// Assets are still decoding or waiting for upload, the frame loop keeps pumping
+bool px_loader_busy(void);
+
+PX_Asset* px_asset_load_font(const char* path);
+// PNG sources are decoded on the worker; cooked .ptex files upload as is
+PX_Asset* px_asset_load_image(const char* path);
+
+PX_AssetState px_asset_state(const PX_Asset* asset);
+// Pumps uploads on the calling thread until the asset leaves the pending state
+t_err_codes px_asset_wait(PX_Asset* asset);
+
+// The caller owns the returned font, the handle still has to be released
+PX_Font* px_asset_take_font(PX_Asset* asset);
+// Image textures live as long as their handle
+GLuint px_asset_texture(const PX_Asset* asset);
+int px_asset_width(const PX_Asset* asset);
+int px_asset_height(const PX_Asset* asset);
+
+void px_asset_release(PX_Asset* asset);
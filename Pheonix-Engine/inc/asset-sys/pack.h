@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <err-codes.h>
+
+#define PX_PACK_MAGIC 0x4B505850 // PXPK
+#define PX_PACK_CUR_VERSION 1
+#define PX_PACK_ALIGN 64
+#define PX_PACK_DEFAULT_PATH "pheonix.pxpak"
+
+// Layout: header | entries | buckets | path strings | data (each entry aligned)
+#pragma pack(push, 1)
+struct px_pack_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+
+    uint32_t entry_count;
+    uint32_t bucket_count; // power of two, open addressing
+
+    uint64_t entries_offset;
+    uint64_t buckets_offset; // uint32_t per bucket: entry index + 1, 0 = empty
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    uint64_t data_offset;
+    uint64_t file_size;
+};
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+struct px_pack_entry {
+    uint64_t path_hash;
+    uint64_t content_hash;
+    uint64_t offset; // from the start of the pack
+    uint64_t size;
+    uint32_t path_offset; // into the string table
+    uint32_t path_len;
+};
+#pragma pack(pop)
+
+uint64_t px_pack_path_hash(const char* path, uint32_t len);
+
+// Packs every runtime file under the roots (raw source trees are skipped),
+// keyed by its path as seen from the working directory.
+t_err_codes px_pack_build(const char* out_path, const char* const* roots, int root_count);
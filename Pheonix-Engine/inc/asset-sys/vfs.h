@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <err-codes.h>
+
+typedef enum {
+    PX_VFS_SOURCE_NONE = 0,
+    PX_VFS_SOURCE_PACK,
+    PX_VFS_SOURCE_LOOSE
+} PX_VFSSource;
+
+// Read-only view of a file. Pack entries point straight into the mapped
+// pack; loose files are mapped on their own. Always pair with px_vfs_close.
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    PX_VFSSource source;
+
+    void* map;
+    size_t map_size;
+} PX_VFile;
+
+t_err_codes px_vfs_mount(const char* pack_path);
+void px_vfs_unmount(void);
+bool px_vfs_mounted(void);
+
+// Loose files on disk win over pack entries (on by default in debug builds)
+void px_vfs_set_loose_override(bool enabled);
+
+t_err_codes px_vfs_open(const char* path, PX_VFile* out);
+void px_vfs_close(PX_VFile* file);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+// Process wide heap counters. Built with ALLOC_STATS=1 (PX_ALLOC_STATS) the
+// engine links with --wrap=malloc (and calloc/realloc/free), so every allocation
+// made by engine code goes through here; allocations made inside libc or driver
+// libraries are not seen. Without it the counters stay at zero.
+typedef struct {
+    uint64_t allocs; // malloc, calloc and realloc calls
+    uint64_t frees;
+    uint64_t bytes; // requested, not what the allocator handed out
+} PX_AllocStats;
+
+void px_alloc_stats(PX_AllocStats* out);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Decides when the main loop draws. Frames are only drawn after something
+// changed (input, resize, expose, loader work), are capped to a rate, and
+// the loop blocks on the window system for as long as nothing is due.
+//
+//     int timeout = px_frame_sched_timeout_ms(&sched, px_frame_now_ns());
+//     if (timeout != 0)
+//         px_ws_wait_events(&win, timeout);
+//     ... poll, handle events, px_frame_sched_invalidate ...
+//     if (px_frame_sched_begin(&sched, px_frame_now_ns()))
+//         ... draw and swap ...
+
+#define PX_FRAME_SETTLE_FRAMES 2 // state changed by one frame's update is drawn by the next
+#define PX_FRAME_UNFOCUSED_FPS 15
+
+typedef struct {
+    int fps_cap; // 0 leaves pacing to the swap interval
+    int unfocused_fps; // cap while another window has focus, 0 keeps fps_cap
+} PX_FrameSchedDesc;
+
+typedef struct {
+    PX_FrameSchedDesc desc;
+    int dirty_frames;
+    bool focused;
+    bool visible;
+    uint64_t last_frame_ns;
+    uint64_t frames;
+} PX_FrameSched;
+
+uint64_t px_frame_now_ns(void);
+
+// Starts dirty, focused and visible so the first frame is drawn at once
+void px_frame_sched_init(PX_FrameSched* s, const PX_FrameSchedDesc* desc);
+void px_frame_sched_invalidate(PX_FrameSched* s);
+void px_frame_sched_set_focus(PX_FrameSched* s, bool focused);
+// Hidden windows draw nothing until they are shown (or exposed) again
+void px_frame_sched_set_visible(PX_FrameSched* s, bool visible);
+
+// How long the loop may block for input: 0 draws now, -1 waits for the next event
+int px_frame_sched_timeout_ms(const PX_FrameSched* s, uint64_t now_ns);
+// True when a frame is due; it is then counted as drawn
+bool px_frame_sched_begin(PX_FrameSched* s, uint64_t now_ns);
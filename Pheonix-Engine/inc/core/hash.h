@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <err-codes.h>
+
+// 64-bit non-cryptographic content hash (XXH64 algorithm)
+uint64_t px_hash64(const void* data, size_t len, uint64_t seed);
+t_err_codes px_hash64_file(const char* path, uint64_t seed, uint64_t* out);
@@ -1,7 +1,32 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include <err-codes.h>
 
-t_err_codes image_init_png(void);
-void image_free_png(void);
+// Every decode produces 8-bit RGBA, whatever the source format
+#define IMAGE_CHANNELS 4
+
+typedef struct {
+    int width;
+    int height;
+    int bit_depth; // source
+    int color_type; // source
+} PX_ImageInfo;
+
+typedef struct {
+    const char* path;
+    PX_ImageInfo info;
+    unsigned char* pixels; // malloc'd by the batch when left NULL
+    t_err_codes err;
+} PX_ImageJob;
+
+// All decoders keep their state per call and may run on any thread
+t_err_codes image_png_info(const unsigned char* data, size_t size, PX_ImageInfo* info);
+// dst holds height rows of stride bytes (>= width * 4), e.g. a mapped PBO
+t_err_codes image_png_decode(const unsigned char* data, size_t size, PX_ImageInfo* info, unsigned char* dst, size_t stride);
+// Decodes every job on the job system and returns once all of them are done
+t_err_codes image_png_decode_batch(PX_ImageJob* jobs, int count);
+
 t_err_codes image_get_png(const char* file, int* w, int* h, int* bit_depth, int* color_type, unsigned char** data);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include <err-codes.h>
+
+// Engine-wide job system. Every worker owns a deque: it pushes and pops at
+// one end, idle workers steal from the other. The thread calling
+// px_jobs_init is worker 0 and runs jobs whenever it waits on a counter.
+//
+//     PX_JobCounter done;
+//     px_job_counter_init(&done);
+//     px_job_run(&(PX_JobDesc){ decode, &files[i] }, &done);
+//     px_job_run_after(&(PX_JobDesc){ upload, atlas, PX_JOB_MAIN_THREAD }, &done, NULL);
+//     px_job_wait(&done);
+//
+// Without px_jobs_init every job runs inline on the calling thread.
+
+#define PX_JOB_MAX_WORKERS 64
+#define PX_JOB_DEQUE_SIZE 4096 // per worker, power of two; a full deque runs jobs inline
+#define PX_JOB_GRAIN_SPLIT 4 // chunks per thread when parallel-for picks the grain
+
+typedef void (*px_job_fn)(void* arg);
+typedef void (*px_job_range_fn)(void* ctx, size_t begin, size_t end);
+
+typedef enum {
+    PX_JOB_ANY_THREAD = 0,
+    PX_JOB_MAIN_THREAD // GL and other context-bound work, run by px_jobs_pump_main or a main thread wait
+} PX_JobAffinity;
+
+typedef struct {
+    px_job_fn fn;
+    void* arg;
+    PX_JobAffinity affinity;
+} PX_JobDesc;
+
+struct px_job;
+
+// Unfinished jobs; reaching zero releases the jobs that depend on it
+typedef struct {
+    atomic_int pending;
+    atomic_flag lock; // guards waiters
+    struct px_job* waiters;
+} PX_JobCounter;
+
+typedef struct {
+    uint64_t jobs;
+    uint64_t steals;
+    uint64_t busy_ns;
+} PX_JobWorkerStats;
+
+typedef struct {
+    int thread_count; // workers plus the main thread, which is [0]
+    uint64_t elapsed_ns; // since init or the last reset
+    PX_JobWorkerStats threads[PX_JOB_MAX_WORKERS + 1];
+} PX_JobStats;
+
+int px_cpu_count(void);
+
+// workers <= 0 starts one per core besides the caller, at least one
+t_err_codes px_jobs_init(int workers);
+// Runs what is still queued, then joins
+void px_jobs_shutdown(void);
+// Background workers, 0 when the system is not running
+int px_jobs_worker_count(void);
+
+void px_job_counter_init(PX_JobCounter* counter);
+bool px_job_done(PX_JobCounter* counter);
+
+// counter (may be NULL) goes up now and down when the job has run
+void px_job_run(const PX_JobDesc* job, PX_JobCounter* counter);
+// Held back until dependency reaches zero
+void px_job_run_after(const PX_JobDesc* job, PX_JobCounter* dependency, PX_JobCounter* counter);
+// Runs other jobs until the counter reaches zero
+void px_job_wait(PX_JobCounter* counter);
+
+// Splits [0, count) in halves down to grain (0 picks one) and returns once every part ran
+void px_job_parallel_for(size_t count, size_t grain, px_job_range_fn fn, void* ctx);
+
+// Main thread only; runs the main-thread jobs that are waiting and returns how many
+int px_jobs_pump_main(void);
+
+void px_jobs_stats(PX_JobStats* out);
+void px_jobs_reset_stats(void);
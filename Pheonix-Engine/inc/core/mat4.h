@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 4x4 float matrices, column major (m[col * 4 + row]) as GL takes them.
+// Products have a scalar reference plus SSE/AVX kernels picked at runtime;
+// all of them sum in the same order, so they agree bit for bit.
+
+typedef struct {
+    float m[16];
+} PX_Mat4;
+
+typedef enum {
+    PX_MAT4_ISA_SCALAR = 0,
+    PX_MAT4_ISA_SSE,
+    PX_MAT4_ISA_AVX
+} PX_Mat4ISA;
+
+#define PX_MAT4_NO_PARENT UINT32_MAX
+
+// Best kernel set the CPU supports
+PX_Mat4ISA px_mat4_isa(void);
+// Pins a kernel set (clamped to what the CPU supports), returns the one in use
+PX_Mat4ISA px_mat4_set_isa(PX_Mat4ISA isa);
+const char* px_mat4_isa_name(PX_Mat4ISA isa);
+
+void px_mat4_identity(PX_Mat4* out);
+// Translation, then rotation by the unit quaternion (x, y, z, w), then scale, applied right to left
+void px_mat4_compose(PX_Mat4* out, const float translation[3], const float rotation[4], const float scale[3]);
+
+// out = a * b; out may be a or b
+void px_mat4_mul(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b);
+// out[i] = a[i] * b[i]
+void px_mat4_mul_batch(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b, size_t count);
+// world[i] = world[parent[i]] * local[i] for i in [begin, end), in order, so a
+// parent inside the range has to come before its children. PX_MAT4_NO_PARENT copies local
+void px_mat4_mul_parents(PX_Mat4* world, const PX_Mat4* local, const uint32_t* parent, size_t begin, size_t end);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pixel format conversion and resampling on 8-bit channels. Every kernel
+// has a scalar reference plus SSE2/AVX2 versions picked at runtime.
+// Counts are in pixels, strides in bytes. Unless noted, dst may equal src.
+
+typedef enum {
+    PX_PIXEL_ISA_SCALAR = 0,
+    PX_PIXEL_ISA_SSE2,
+    PX_PIXEL_ISA_AVX2
+} PX_PixelISA;
+
+// Best kernel set the CPU supports
+PX_PixelISA px_pixel_isa(void);
+// Pins a kernel set (clamped to what the CPU supports), returns the one in use
+PX_PixelISA px_pixel_set_isa(PX_PixelISA isa);
+const char* px_pixel_isa_name(PX_PixelISA isa);
+
+// RGBA: c = round(c * a / 255), alpha untouched
+void px_pixel_premultiply(uint8_t* dst, const uint8_t* src, size_t count);
+// 4-channel reorder: dst[i] = src[order[i]], e.g. {2, 1, 0, 3} for RGBA <-> BGRA
+void px_pixel_swizzle(uint8_t* dst, const uint8_t* src, size_t count, const uint8_t order[4]);
+// Premultiply, then RGBA -> BGRA, block by block so the second pass reads from cache (X11 ARGB visuals)
+void px_pixel_premultiply_bgra(uint8_t* dst, const uint8_t* src, size_t count);
+
+// Expansion to RGBA with opaque alpha; dst must not overlap src
+void px_pixel_gray_to_rgba(uint8_t* dst, const uint8_t* src, size_t count);
+void px_pixel_rgb_to_rgba(uint8_t* dst, const uint8_t* src, size_t count);
+
+// RGBA resampling; dst must not overlap src
+// Box: every destination pixel averages its source footprint (dst <= src)
+void px_pixel_downscale_box(uint8_t* dst, int dst_w, int dst_h, size_t dst_stride,
+                            const uint8_t* src, int src_w, int src_h, size_t src_stride);
+// Separable Lanczos-3, for thumbnails and mip levels where sharpness matters
+void px_pixel_downscale_lanczos(uint8_t* dst, int dst_w, int dst_h, size_t dst_stride,
+                                const uint8_t* src, int src_w, int src_h, size_t src_stride);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <err-codes.h>
+
+// Scoped timing instrumentation, exported as Chrome trace JSON (loads in
+// chrome://tracing and ui.perfetto.dev). Build with TRACE=1 to enable;
+// otherwise every PX_TRACE_* macro compiles to nothing.
+//
+//     void px_rs_frame_end(void) {
+//         PX_TRACE_SCOPE("px_rs_frame_end");
+//         ...
+//     }
+//
+// Names must be string literals (or otherwise outlive the trace).
+
+#define PX_TRACE_DEFAULT_PATH "pheonix-trace.json"
+#define PX_TRACE_RING_SIZE (1 << 15) // events kept per thread, oldest dropped first
+
+#ifdef PX_TRACE
+
+struct px_trace_scope {
+    const char* name;
+    uint64_t start_ns;
+};
+
+uint64_t px_trace_now_ns(void);
+void px_trace_record(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+static inline void px_trace_scope_end(struct px_trace_scope* scope) {
+    px_trace_record(scope->name, scope->start_ns, px_trace_now_ns());
+}
+
+#define PX_TRACE_CONCAT_(a, b) a##b
+#define PX_TRACE_CONCAT(a, b) PX_TRACE_CONCAT_(a, b)
+
+// Times from here to the end of the enclosing block
+#define PX_TRACE_SCOPE(name) \
+    struct px_trace_scope PX_TRACE_CONCAT(px_trace_scope_, __LINE__) \
+    __attribute__((cleanup(px_trace_scope_end))) = { (name), px_trace_now_ns() }
+// Labels the calling thread in the exported trace
+#define PX_TRACE_THREAD(name) px_trace_thread_name(name)
+
+#else
+
+#define PX_TRACE_SCOPE(name) ((void)0)
+#define PX_TRACE_THREAD(name) ((void)0)
+
+#endif
+
+void px_trace_thread_name(const char* name);
+// Writes everything still in the rings; a no-op without TRACE=1
+t_err_codes px_trace_dump(const char* path);
+// Dumps to $PX_TRACE_FILE (or PX_TRACE_DEFAULT_PATH) and frees the rings
+void px_trace_shutdown(void);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <err-codes.h>
+
+#define PX_JSON_SAX_MAX_DEPTH 64
+
+// Callback reader over an in-memory JSON buffer. No tree is built and
+// nothing is allocated: strings and keys are handed out as slices of
+// the source text (escape sequences are left as-is). Returning false
+// from any callback aborts the parse with ERR_INTERNAL.
+typedef struct {
+    void* user;
+
+    bool (*object_begin)(void* user);
+    bool (*object_end)(void* user);
+    bool (*array_begin)(void* user);
+    bool (*array_end)(void* user);
+
+    bool (*key)(void* user, const char* key, size_t len);
+    bool (*string)(void* user, const char* str, size_t len);
+    bool (*number)(void* user, double value);
+    bool (*boolean)(void* user, bool value);
+    bool (*null)(void* user);
+} PX_JsonSax;
+
+t_err_codes px_json_sax_parse(const char* text, size_t len, const PX_JsonSax* sax);
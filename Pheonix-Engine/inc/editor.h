@@ -1,9 +1,11 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <rendering-sys.h>
 #include <err-codes.h>
+#include <core/mat4.h>
 
 #define PX_EDITOR_CUR_VERSION 1.0f
 
@@ -20,23 +22,84 @@ typedef struct {
 
 typedef struct {
     bool used;
-    char* name;
+    const char* name;
 } PX_EditorMaterial;
 
-typedef struct PX_EditorObject {
-    struct PX_EditorObject* parent;
-    struct PX_EditorObject* child;
-    struct PX_EditorObject* next;
-
-    int child_count;
-
-    char* name;
-    
-    PX_Transform3 transform;
-    PX_EditorMaterial material;
-    PX_EditorComponent* components;
-    int component_count;
-} PX_EditorObject;
+// Objects are referred to by handle: an id in the low half and the id's
+// generation in the high half, so a handle to a removed object goes stale
+// instead of reaching whatever reuses the id. 0 is never a live handle
+typedef uint64_t PX_EditorHandle;
+#define PX_EDITOR_NULL_HANDLE 0
+#define PX_EDITOR_NO_SLOT UINT32_MAX
+#define PX_EDITOR_NAME_CHUNK (64 * 1024) // names are copied into chunks this big
+#define PX_EDITOR_HUGE_POOL (4 * 1024 * 1024) // scene arrays from this size on ask for huge pages
+
+struct editor_name_chunk;
+
+// Structure of arrays, one dense slot per live object. The hierarchy links are
+// slots too; slot 0 is the root. Removal moves the last slot into the hole and
+// editor_scene_sort puts the slots back in pre-order, after which walking
+// 0..count-1 visits the tree depth first through contiguous memory
+typedef struct {
+    uint32_t count;
+    uint32_t capacity;
+
+    PX_EditorHandle* handle;
+    uint32_t* parent;
+    uint32_t* first_child;
+    uint32_t* last_child;
+    uint32_t* next;
+    uint32_t* prev;
+    uint32_t* child_count;
+    uint32_t* depth; // root is 0
+    bool* collapsed; // children hidden in the hierarchy panel
+
+    const char** name;
+    PX_Transform3* transform; // local
+    PX_Mat4* local; // transform as a matrix
+    PX_Mat4* world; // parent's world * local, as of the last transform update
+    bool* transform_dirty; // local changed since then, so world is stale here and below
+    bool world_stale; // no local or world computed yet (fresh load), the next update does them all
+    uint32_t transform_mapped; // transforms read in place from the mapping, 0 once copied out
+    PX_EditorMaterial* material;
+    PX_EditorComponent** components;
+    int* component_count;
+
+    // Per id: where it lives and its generation; freed ids chain through id_slot
+    uint32_t* id_slot;
+    uint32_t* id_generation;
+    uint32_t id_count;
+    uint32_t id_capacity;
+    uint32_t free_id;
+
+    // Objects with transform_dirty set; subtrees under them are recomputed, nothing else
+    PX_EditorHandle* dirty;
+    uint32_t dirty_count;
+    uint32_t dirty_capacity;
+
+    bool sorted; // slots are in pre-order
+    uint64_t revision; // bumped by anything that adds, removes or moves slots
+    struct editor_name_chunk* names;
+    // Project file the loaded names point into, unmapped with the scene
+    void* mapping;
+    size_t mapping_size;
+} PX_EditorScene;
+
+// The hierarchy panel's rows: slots of the objects not under a collapsed one,
+// in pre-order. Kept across frames and patched on add, collapse and expand,
+// anything else rebuilds them on the next draw. Only the rows in view are drawn
+typedef struct {
+    uint32_t* rows;
+    uint32_t row_count;
+    uint32_t row_capacity;
+    uint64_t revision; // of the scene the rows match
+    bool valid;
+
+    uint32_t scroll; // first row in view
+    uint32_t rows_in_view;
+    uint32_t drawn; // rows drawn by the last frame
+    PX_Transform2 viewport; // panel rect of the last frame
+} PX_EditorHierarchy;
 
 typedef struct {
     bool initialized;
@@ -45,49 +108,130 @@ typedef struct {
 
     bool saved;
     char* project_dir;
-    char* project_name;
+    const char* project_name;
+    char* project_path; // file last opened or saved, owned
 
-    PX_EditorObject* objects;
-    int total_object_count;
+    PX_EditorScene scene;
+    PX_EditorHierarchy hierarchy;
 } PX_EditorState;
 
+#define PX_PXPROJ_MAGIC 0x4A505850 // PXPJ
+#define PX_PXPROJ_CUR_VERSION 1
+#define PX_PXPROJ_ALIGN 64
+#define PX_PXPROJ_NONE UINT32_MAX
+#define PX_PXPROJ_WRITE_BUFFER (1024 * 1024)
+
+typedef enum {
+    PX_PXPROJ_SECTION_OBJECTS = 1, // PX_PXProj_Object per object, in pre-order
+    PX_PXPROJ_SECTION_STRINGS, // NUL terminated, referred to by offset
+    PX_PXPROJ_SECTION_TRANSFORMS // PX_Transform3 per object, same order; the scene's array as is
+} PX_PXProjSectionType;
+
+#define PX_PXPROJ_OBJECT_COLLAPSED 0x1
+
+// Layout: header | section table | sections (each aligned). Nothing in the file
+// is a pointer, so a mapped file is used where it lies: objects link by index,
+// names are offsets into the string table and the transforms are the scene's
+// own array. Unknown sections are skipped
 #pragma pack(push, 1)
 typedef struct {
-    long unsigned int name;
-} PX_PXProj_Material;
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+
+    float opengl_version;
+    float editor_version;
+    float engine_version;
+
+    uint32_t project_name; // string offset
+    uint32_t object_count;
+    uint32_t section_count;
+    uint32_t reserved;
+    uint64_t sections_offset;
+    uint64_t file_size;
+} PX_PXProj_Hdr;
 #pragma pack(pop)
 
 #pragma pack(push, 1)
 typedef struct {
-    long unsigned int parent;
-    long unsigned int child;
-    long unsigned int next;
-    int child_count;
+    uint32_t type; // PX_PXProjSectionType
+    uint32_t flags;
+    uint64_t offset; // from the start of the file
+    uint64_t size;
+} PX_PXProj_Section;
+#pragma pack(pop)
 
-    long unsigned int name;
+#pragma pack(push, 1)
+typedef struct {
+    uint32_t name; // string offset, PX_PXPROJ_NONE without a material
+} PX_PXProj_Material;
+#pragma pack(pop)
 
-    PX_Transform3 transform;
+// Pre-order means the parent is the only link stored: children follow their
+// parent in sibling order, and the rest of the links are rebuilt from that
+#pragma pack(push, 1)
+typedef struct {
+    uint32_t parent; // object index, always lower; PX_PXPROJ_NONE for the root
+    uint32_t name; // string offset
+    uint32_t flags;
     PX_PXProj_Material material;
-    //PX_PXProj_Components components;
-    int component_count;
 } PX_PXProj_Object;
 #pragma pack(pop)
 
-#pragma pack(push, 1)
 typedef struct {
     float opengl_version;
     float editor_version;
     float engine_version;
-    
-    long unsigned int project_dir;
-    long unsigned int project_name;
-
-    PX_PXProj_Object* objects;
-    int total_object_count;
-} PX_PXProj_Hdr;
-#pragma pack(pop)
+    const char* name;
+} PX_EditorProjectInfo;
 
 t_err_codes editor_new_project(char* proj_name);
 PX_EditorState* editor_get_state(void);
-bool editor_add_object(PX_EditorObject* parent, PX_EditorObject* obj);
+// Into the open project; PX_EDITOR_NULL_HANDLE as parent adds at the top level
+PX_EditorHandle editor_add_object(PX_EditorHandle parent, const char* name);
+// The open project to and from .pxproj files
+t_err_codes editor_save_project(const char* path);
+t_err_codes editor_open_project(const char* path);
+
+// capacity is a hint, the pools grow as needed
+t_err_codes editor_scene_init(PX_EditorScene* scene, uint32_t capacity);
+void editor_scene_free(PX_EditorScene* scene);
+t_err_codes editor_scene_reserve(PX_EditorScene* scene, uint32_t capacity);
+PX_EditorHandle editor_scene_root(const PX_EditorScene* scene);
+// Appended after the parent's last child; the name is copied. NULL handle on failure
+PX_EditorHandle editor_scene_add(PX_EditorScene* scene, PX_EditorHandle parent, const char* name);
+// Also removes everything under it
+bool editor_scene_remove(PX_EditorScene* scene, PX_EditorHandle object);
+// PX_EDITOR_NO_SLOT when the handle is stale; slots move on remove and sort
+uint32_t editor_scene_slot(const PX_EditorScene* scene, PX_EditorHandle object);
+void editor_scene_sort(PX_EditorScene* scene);
+
+// Sorts the scene, then streams it out to a temporary file renamed over path
+t_err_codes editor_scene_save(PX_EditorScene* scene, const PX_EditorProjectInfo* info, const char* path);
+// Maps path and fills an uninitialized scene from it. Names, info->name and the
+// transforms stay in the mapping for as long as the scene lives; local and world
+// matrices are left stale until the first editor_scene_update_transforms
+// (or editor_scene_world, which runs it)
+t_err_codes editor_scene_load(PX_EditorScene* scene, const char* path, PX_EditorProjectInfo* info);
+
+#define PX_EDITOR_TRANSFORM_GRAIN 4096 // objects per parallel transform task
+
+// Sets the local transform; the world matrices under it follow on the next update
+bool editor_scene_set_transform(PX_EditorScene* scene, PX_EditorHandle object, const PX_Transform3* transform);
+// Recomputes the world matrices under every changed object, in pre-order, and
+// returns how many that was. Disjoint subtrees are spread over the job system
+uint32_t editor_scene_update_transforms(PX_EditorScene* scene);
+// Up to date world matrix, running the update first if anything is pending
+bool editor_scene_world(PX_EditorScene* scene, PX_EditorHandle object, PX_Mat4* out);
+
+void editor_hierarchy_free(PX_EditorHierarchy* hierarchy);
+// Rebuilds the rows if the scene changed in a way they were not patched for
+void editor_hierarchy_sync(PX_EditorHierarchy* hierarchy, const PX_EditorScene* scene);
+// Patches the rows for an object just added to the scene, or leaves them to be rebuilt
+void editor_hierarchy_added(PX_EditorHierarchy* hierarchy, const PX_EditorScene* scene, PX_EditorHandle object);
+void editor_hierarchy_set_collapsed(PX_EditorHierarchy* hierarchy, PX_EditorScene* scene, PX_EditorHandle object, bool collapsed);
+
+// Input for the panel of the open project; false when the point is not over it
+bool editor_scene_panel_scroll(PX_Vector2 point, int rows);
+bool editor_scene_panel_click(PX_Vector2 point);
 void editor_draw_scene_panel(PX_Transform2 transform, PX_Color4 iline_color, PX_Color4 text_color, PX_Color4 color, float noise, float cradius, PX_Font* font, float font_size, int xspacing, int yspacing);
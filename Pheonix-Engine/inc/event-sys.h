@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 #include <rendering-sys.h>
 
 typedef enum {
@@ -132,16 +134,18 @@ typedef struct {
 
 typedef struct {
     PX_Event_GSignals type;
+    const void* source; // object that raised it, subscribers are routed on type and source
     union {
         PX_Event_GSignal_UIDropdownClick ui_dropdown_click;
         bool core_quit;
     };
 } PX_Event_GSignal;
 
-typedef struct {
-    void* ptr;
-    const char* identifier;
-} PX_Event_Identifier;
+// Power of two; sends past it are dropped and counted
+#define PX_GSIGNAL_QUEUE_SIZE 1024
+#define PX_GSIGNAL_MAX_SUBSCRIBERS 64
+
+typedef void (*px_gsignal_fn)(const PX_Event_GSignal* signal, void* user);
 
 // Include subsystems
 #include <event-sys/menu-events.h>
@@ -151,6 +155,17 @@ void event_resize(PX_Scale2 main_window_scale);
 void event_mouse_move(PX_Vector2 mouse_position);
 void event_hover_dropdown(PX_Dropdown* dd);
 void event_click_dropdown(PX_Dropdown* dd);
-void event_send_gsignal(PX_Event_GSignal* signal);
-void event_pop_gsignal(PX_Event_GSignal* out);
-void event_handle_gsignals(PX_Event_Identifier** identifiers, int identifiers_len, PX_Event_GSignal* core_signal, bool* core_signal_active);
+// Safe from any thread, never blocks, wakes a waiting main loop; false when the queue is full
+bool event_send_gsignal(const PX_Event_GSignal* signal);
+// Main thread only, oldest first
+bool event_pop_gsignal(PX_Event_GSignal* out);
+bool event_gsignals_pending(void);
+uint64_t event_gsignals_dropped(void);
+
+// A NULL source receives the type from every source. Main thread only
+t_err_codes event_subscribe_gsignal(PX_Event_GSignals type, const void* source, px_gsignal_fn fn, void* user);
+// May be called from a callback, for any subscriber: it is not called again from then on
+void event_unsubscribe_gsignal(PX_Event_GSignals type, const void* source, px_gsignal_fn fn, void* user);
+// Delivers everything queued, including what the subscribers send meanwhile, in
+// the order it was sent; returns how many signals were handled
+int event_dispatch_gsignals(void);
@@ -4,4 +4,4 @@
 #include <event-sys.h>
 
 void menu_evs_init(PX_Dropdown* menu_dd, char* path_to_save);
-void menu_evs_handle_events(PX_Event_GSignal* signal);
+void menu_evs_handle_events(const PX_Event_GSignal* signal, void* user);
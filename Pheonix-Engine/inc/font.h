@@ -35,11 +35,17 @@ typedef struct {
     float softness;
 } PX_FontStyle;
 
+typedef enum {
+    PX_SDF_JSON_STREAM = 0, // SAX reader, glyphs decoded in place
+    PX_SDF_JSON_DOM = 1 // cJSON tree, kept as the reference path
+} PX_SDFJsonMode;
+
 typedef struct {
     uint32_t pixel_size; // base font size
     uint32_t atlas_size; // atlas width/height (square)
     uint32_t sdf_range; // distance range in pixels
     bool ascii_only; // true = 32–126
+    PX_SDFJsonMode json_mode;
 } PX_SDFBuildDesc;
 
 PX_Font* px_font_load(const char* path);
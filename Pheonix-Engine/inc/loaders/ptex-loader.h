@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <rendering-sys/opengl.h>
+#include <asset-sys/vfs.h>
+#include <err-codes.h>
+
+#define PX_PTEX_MAGIC 0x58455450 // PTEX
+#define PX_PTEX_CUR_VERSION 1
+#define PX_PTEX_MAX_MIPS 16
+#define PX_PTEX_MAX_SIZE 16384 // per side, keeps level sizes well inside size_t
+#define PX_PTEX_ALIGN 16
+
+typedef enum {
+    PX_PTEX_FORMAT_RGBA8 = 0,
+    PX_PTEX_FORMAT_BGRA8 = 1,
+    PX_PTEX_FORMAT_BC1 = 2, // opaque, 8 bytes per 4x4 block
+    PX_PTEX_FORMAT_BC3 = 3 // with alpha, 16 bytes per 4x4 block
+} PX_PTexFormat;
+
+#define PX_PTEX_FLAG_PREMULTIPLIED 0x1
+
+#pragma pack(push, 1)
+struct px_ptex_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t format;
+    uint32_t flags;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_count;
+};
+#pragma pack(pop)
+
+// Follows the header, one per level from full size down
+#pragma pack(push, 1)
+struct px_ptex_mip {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+#pragma pack(pop)
+
+typedef struct {
+    bool premultiply;
+    bool mipmaps;
+    bool compress; // BC1 when fully opaque, BC3 otherwise
+    bool bgra; // channel order of uncompressed output
+} PX_PTexBuildDesc;
+
+// Validated view of a PTEX file; mip data stays in the mapping
+struct px_ptex_source {
+    struct px_ptex_header header;
+    struct px_ptex_mip mips[PX_PTEX_MAX_MIPS];
+    PX_VFile file;
+};
+
+struct px_ptex_texture {
+    GLuint texture;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mip_count;
+    uint16_t format;
+    uint32_t flags;
+};
+
+t_err_codes px_ptex_read(const char* path, struct px_ptex_source* out);
+void px_ptex_source_free(struct px_ptex_source* src);
+// GL thread only
+t_err_codes px_ptex_upload(const struct px_ptex_source* src, GLuint* out_texture);
+
+t_err_codes px_ptex_load(const char* path, struct px_ptex_texture* out);
+void px_ptex_free(struct px_ptex_texture* tex);
+
+t_err_codes px_ptex_build(const char* input_png, const char* output_ptex, const PX_PTexBuildDesc* desc);
+
+// Block codecs, shared by the builder and the upload fallback
+size_t px_ptex_level_size(PX_PTexFormat format, uint32_t width, uint32_t height);
+void px_ptex_encode_bc(PX_PTexFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out);
+void px_ptex_decode_bc(PX_PTexFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba);
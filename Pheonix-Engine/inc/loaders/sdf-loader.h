@@ -1,8 +1,10 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <rendering-sys/opengl.h>
+#include <asset-sys/vfs.h>
 #include <err-codes.h>
 #include <font.h>
 
@@ -53,7 +55,32 @@ struct px_sdf_font_data {
     float sdf_range;
 };
 
+// CPU half of a PSDF load, safe to run off the GL thread. The atlas points
+// into the file view until the source is finished or freed.
+struct px_sdf_font_source {
+    struct px_sdf_header header;
+    struct px_sdf_glyph* glyphs;
+    const unsigned char* atlas;
+    PX_VFile file;
+};
+
+// Parsed msdf-atlas-gen description, ready to be written as a PSDF
+struct px_sdf_json_font {
+    struct px_sdf_header header;
+    struct px_sdf_glyph* glyphs;
+};
+
+t_err_codes px_sdf_parse_json_dom(const char* text, size_t len, const PX_SDFBuildDesc* desc, struct px_sdf_json_font* out);
+t_err_codes px_sdf_parse_json_stream(const char* text, size_t len, const PX_SDFBuildDesc* desc, struct px_sdf_json_font* out);
+void px_sdf_json_free(struct px_sdf_json_font* font);
+
+t_err_codes px_sdf_read(const char* path, struct px_sdf_font_source* out);
+void px_sdf_source_free(struct px_sdf_font_source* src);
+// Hands the glyphs over to out and releases the file view
+void px_sdf_source_finish(struct px_sdf_font_source* src, GLuint texture, struct px_sdf_font_data* out);
+
 t_err_codes px_sdf_load(const char* path, struct px_sdf_font_data* out);
+PX_Font* px_sdf_font_create(const struct px_sdf_font_data* sdf);
 void px_sdf_free(struct px_sdf_font_data* data);
 float px_sdf_ascent(const PX_Font* font);
 float px_sdf_descent(const PX_Font* font);
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include <err-codes.h>
 #include <font.h>
+#include <window-sys.h>
 
-#define PX_RS_MAX_DROPDOWN_ITEMS 16
-#define PX_RS_MAX_DROPDOWN_OPTIONS 16
+#define PX_RS_MAX_TARGETS 10 // one per window, see MAX_WINDOWS
+#define PX_RS_DEFAULT_TARGET 0
+#define PX_RS_HIT_CELL 64 // pixels per side of a hit grid cell
 
 typedef struct {
     unsigned char r, g, b, a;
@@ -32,14 +36,22 @@ typedef struct {
     int w, h, l;
 } PX_Scale3;
 
+typedef struct {
+    float x, y, z;
+} PX_Vector3f;
+
+typedef struct {
+    float w, h, l;
+} PX_Scale3f;
+
 typedef struct {
     float x, y, z, w;
 } PX_Orientation3;
 
 typedef struct {
-    PX_Vector3 pos;
-    PX_Scale3 scale;
-    PX_Orientation3 rot;
+    PX_Vector3f pos;
+    PX_Scale3f scale;
+    PX_Orientation3 rot; // unit quaternion
 } PX_Transform3;
 
 typedef struct {
@@ -47,27 +59,49 @@ typedef struct {
     PX_Scale2 scale;
 } PX_Transform2;
 
+// Retained layout: every widget rect is a node of one tree. Nodes measure once
+// and cache their rects; a text, size or visibility change dirties the node and
+// its ancestors, and the next update re-lays out only those
+typedef int PX_LayoutNode; // index into the node pool
+#define PX_LAYOUT_NONE -1
+
+typedef enum {
+    PX_LAYOUT_STACK = 0, // children at their own offsets
+    PX_LAYOUT_ROW,
+    PX_LAYOUT_COLUMN
+} PX_LayoutFlow;
+
+typedef struct {
+    PX_LayoutFlow flow;
+    PX_Vector2 offset; // from the parent's origin; in rows and columns only the cross axis
+    PX_Scale2 size; // 0 in an axis fits the content
+    PX_Scale2 min_size;
+    PX_Vector2 padding; // both sides of each axis
+    int spacing; // between children of a row or column
+    bool overlay; // popups: placed at offset, take no part in the parent's flow or size
+} PX_LayoutDesc;
+
+typedef struct {
+    int nodes;
+    int laid_out; // by the last update
+    int text_measures; // by the last update
+    uint64_t updates; // that had something to do
+} PX_LayoutStats;
+
 typedef struct {
     char* label;
-    int width;
-    int height;
+    PX_LayoutNode node;
 } PX_DropdownOption;
 
 typedef struct {
     char* label;
-    int width;
-    int height;
-    int spacing;
+    PX_LayoutNode node; // label in the bar
+    PX_LayoutNode panel; // hidden unless open, under the label
 
-    PX_DropdownOption options[PX_RS_MAX_DROPDOWN_OPTIONS];
+    PX_DropdownOption* options;
     int option_count;
 
     bool is_open;
-    
-    PX_Transform2 panel_tran;
-    PX_Vector2 stext_pos;
-    
-    float font_size;
 
     PX_Color4 text_color;
     PX_Color4 panel_color;
@@ -79,6 +113,7 @@ typedef struct {
     int hover_index;
 } PX_DropdownItem;
 
+// Set the fields, then px_rs_dropdown_init builds the layout nodes
 typedef struct {
     PX_Vector2 pos;
     PX_Vector2 stext_pos;
@@ -91,24 +126,113 @@ typedef struct {
     
     PX_Font* font;
     float font_size;
+    float option_font_size; // 0 uses font_size
     
     float noise;
     float cradius;
 
-    PX_DropdownItem items[PX_RS_MAX_DROPDOWN_ITEMS];
+    PX_DropdownItem* items;
     int item_count;
+    int item_capacity;
+
+    PX_LayoutNode node;
+    PX_LayoutNode bar;
 
     int hover_index;
+    uint64_t hover_key; // pointer and layout state the hover indices were found for
 } PX_Dropdown;
 
+typedef enum {
+    PX_RS_HIT_NONE = 0,
+    PX_RS_HIT_DROPDOWN, // the bar, index and sub unused
+    PX_RS_HIT_DROPDOWN_ITEM, // index is the item
+    PX_RS_HIT_DROPDOWN_PANEL, // index is the open item
+    PX_RS_HIT_DROPDOWN_OPTION, // index is the open item, sub the option
+    PX_RS_HIT_LIST, // a scrolling list's area, index and sub unused
+    PX_RS_HIT_LIST_ROW // index and sub are up to the list
+} PX_RSHitKind;
+
+// One interactive rect of the last drawn frame; the layout has no padding so it hashes as bytes
+typedef struct {
+    const void* owner; // widget that drew it
+    PX_RSHitKind kind;
+    int index;
+    int sub;
+    int z; // draw order, later draws are on top
+    PX_Transform2 rect;
+} PX_RSHit;
+
+typedef struct {
+    int draw_calls;
+    int batches;
+    int vertices;
+    int dropped_quads; // did not fit in the vertex buffer and were not drawn
+    size_t bytes_uploaded;
+} PX_RSFrameStats;
+
+typedef struct {
+    PX_Window* window; // its context moves to the render thread, which presents it
+    void (*gl_work)(void); // runs on the render thread before each frame, e.g. texture uploads
+} PX_RSRenderThreadDesc;
+
 t_err_codes px_rs_init_ui(PX_Scale2 screen_scale);
+// No GL context needed: draws only build vertices and batches (benchmarks, tools)
+t_err_codes px_rs_init_ui_headless(PX_Scale2 screen_scale);
 void px_rs_shutdown_ui(void);
 void px_rs_frame_start(void);
 void px_rs_frame_end(void);
+// Optional threading: the caller keeps handling events and building frames
+// while a render thread owning the GL context draws and presents them.
+// px_rs_frame_end then hands the frame over instead of drawing, and only
+// blocks while an earlier frame is still waiting to be drawn
+t_err_codes px_rs_start_render_thread(const PX_RSRenderThreadDesc* desc);
+// Draws what was handed over, joins, and makes the context current on the caller again
+void px_rs_stop_render_thread(void);
+bool px_rs_render_threaded(void);
+// What the last px_rs_frame_end submitted (or would have, when headless)
+void px_rs_frame_stats(PX_RSFrameStats* out);
 void px_rs_ui_frame_update(void);
 void px_rs_ui_resize(PX_Scale2 screen_scale);
+// Draws go to another window: make its context current (px_ws_make_current) first.
+// Buffers, textures and programs are shared, each target only adds a VAO
+t_err_codes px_rs_ui_bind_target(int target, PX_Scale2 screen_scale);
+// Call with the target's context current
+void px_rs_ui_release_target(int target);
 t_err_codes px_rs_draw_panel(PX_Transform2 tran, PX_Color4 color, float noise, float cradius);
 int px_rs_text_width(PX_Font* font, const char* text, float pixel_height);
 t_err_codes px_rs_render_text(const char* text, float pixel_height, PX_Vector2 pos, PX_Color4 color, PX_Font* font);
 t_err_codes px_rs_draw_line(PX_Vector2 start, PX_Vector2 end, float thickness, PX_Color4 color);
 t_err_codes px_rs_draw_dropdown(PX_Dropdown* dd);
+t_err_codes px_rs_dropdown_init(PX_Dropdown* dd);
+// Label and options are copied; the item is returned for styling (valid until
+// the next add), NULL when out of memory
+PX_DropdownItem* px_rs_dropdown_add_item(PX_Dropdown* dd, const char* label, const char** options, int option_count);
+void px_rs_dropdown_set_open(PX_Dropdown* dd, int index, bool open);
+void px_rs_dropdown_resize(PX_Dropdown* dd, int width);
+void px_rs_dropdown_free(PX_Dropdown* dd);
+
+PX_LayoutNode px_layout_create(PX_LayoutNode parent, const PX_LayoutDesc* desc);
+// Also destroys the subtree
+void px_layout_destroy(PX_LayoutNode node);
+// The node's content becomes the text's extent; text must outlive the node or the next call
+void px_layout_set_text(PX_LayoutNode node, PX_Font* font, const char* text, float pixel_height);
+void px_layout_set_size(PX_LayoutNode node, PX_Scale2 size);
+void px_layout_set_offset(PX_LayoutNode node, PX_Vector2 offset);
+void px_layout_set_hidden(PX_LayoutNode node, bool hidden);
+// Re-lays out what was dirtied and returns how many nodes that took
+int px_layout_update(void);
+// Screen rect, brought up to date first; false for hidden nodes and ones under a hidden node
+bool px_layout_rect(PX_LayoutNode node, PX_Transform2* out);
+void px_layout_stats(PX_LayoutStats* out);
+void px_layout_shutdown(void);
+
+// Widgets record their interactive rects while drawing; px_rs_frame_end
+// files them into a uniform grid that point queries go through until the next one
+void px_rs_hit_begin(PX_Scale2 screen_scale);
+void px_rs_hit_add(PX_Transform2 rect, PX_RSHitKind kind, const void* owner, int index, int sub);
+void px_rs_hit_end(void);
+void px_rs_hit_shutdown(void);
+// Topmost rect of the last frame under the point
+bool px_rs_hit_query(PX_Vector2 point, PX_RSHit* out);
+// Changes whenever a frame ends with a layout different from the one before
+uint64_t px_rs_hit_generation(void);
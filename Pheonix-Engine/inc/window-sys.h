@@ -6,7 +6,10 @@
 #include <err-codes.h>
 
 #define MAX_WINDOWS 10
-#define PX_WE_QUEUE_SIZE 64
+#define PX_WE_QUEUE_SIZE 64 // first allocation, the queue doubles from there
+#define PX_WE_QUEUE_MAX 4096 // past this motion is evicted first, then events are dropped
+#define PX_WE_HISTORY_MAX 1024 // raw motion samples kept per poll
+#define PX_WS_LATENCY_SAMPLES 512 // percentiles cover this many recent frames
 
 typedef enum {
     PX_WE_NONE = 0,
@@ -16,22 +19,76 @@ typedef enum {
     PX_WE_KEYUP,
     PX_WE_MOUSE_DOWN,
     PX_WE_MOUSE_UP,
-    PX_WE_MOUSE_MOVE
+    PX_WE_MOUSE_MOVE,
+    PX_WE_FOCUS_IN,
+    PX_WE_FOCUS_OUT,
+    PX_WE_SHOWN,
+    PX_WE_HIDDEN, // unmapped or minimised, nothing drawn is visible
+    PX_WE_EXPOSE // contents were lost and have to be redrawn
 } PX_WE_Type;
 
+typedef enum {
+    PX_WS_VSYNC_ADAPTIVE = -1, // syncs, but tears instead of waiting a whole refresh for a late frame
+    PX_WS_VSYNC_OFF = 0,
+    PX_WS_VSYNC_ON = 1
+} PX_WS_SwapInterval;
+
 typedef struct {
     PX_WE_Type type;
     int keycode; // Mapped using event-sys keys
     int x, y;
     int w, h;
+    int merged; // earlier events of the same kind folded into this one
+    float fx, fy; // sub-pixel pointer position where the backend has one, else x and y
+    uint32_t time_ms; // server timestamp, 0 for events that carry none
+    uint64_t arrival_ns; // CLOCK_MONOTONIC when the backend read it (oldest one for merged moves)
 } PX_WEvent;
 
 typedef struct {
-    PX_WEvent events[PX_WE_QUEUE_SIZE];
-    int head;
-    int tail;
+    int x, y;
+} PX_WE_MotionSample;
+
+typedef struct {
+    uint64_t pushed;
+    uint64_t coalesced;
+    uint64_t dropped;
+    int high_water;
+} PX_WE_QueueStats;
+
+// Consecutive moves (and resizes) coalesce into the newest one, so a fast
+// mouse costs one queued event per poll however many it reports
+typedef struct {
+    PX_WEvent* events;
+    int capacity;
+    int head; // oldest event
+    int count;
+    PX_WE_QueueStats stats;
+
+    bool keep_history;
+    PX_WE_MotionSample* history;
+    int history_count;
+    int history_capacity;
 } PX_WE_Queue;
 
+// Input-to-swap latency: from the arrival of the oldest input event handed
+// out since the last swap to the return of the swap that shows its result
+typedef struct {
+    uint64_t pending_ns;
+    float samples_ms[PX_WS_LATENCY_SAMPLES];
+    uint64_t count;
+    double sum_ms;
+    double max_ms;
+} PX_WS_Latency;
+
+typedef struct {
+    uint64_t frames;
+    double last_ms;
+    double mean_ms;
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+} PX_WS_LatencyStats;
+
 typedef struct {
     unsigned int width;
     unsigned int height;
@@ -39,6 +96,7 @@ typedef struct {
     unsigned int flags;
     int handle;
     PX_WE_Queue queue;
+    PX_WS_Latency latency;
 } PX_Window;
 
 typedef struct {
@@ -52,6 +110,11 @@ typedef struct {
     uint32_t title_text_color;
 } PX_WindowDesign;
 
+typedef struct {
+    const char* image; // PNG, a cooked .ptex next to it is preferred
+    int min_ms; // shortest time on screen, 0 closes with the first frame
+} PX_SplashDesc;
+
 t_err_codes px_ws_init(void);
 void px_ws_shutdown(void);
 
@@ -60,13 +123,39 @@ t_err_codes px_ws_show(PX_Window* win);
 t_err_codes px_ws_hide(PX_Window* win);
 void px_ws_destroy(PX_Window* win);
 
+// Reads pending events for every window, each one lands in its own window's queue
 t_err_codes px_ws_poll(PX_Window* win);
 bool px_ws_pop_event(PX_Window* win, PX_WEvent* out);
+// Blocks until the window has events, px_ws_wake is called or timeout_ms passes
+// (< 0 waits forever); true when there is something to poll
+bool px_ws_wait_events(PX_Window* win, int timeout_ms);
+// Safe from any thread, never blocks: the wait in progress, or else the next one, returns early
+void px_ws_wake(void);
+void px_ws_queue_stats(PX_Window* win, PX_WE_QueueStats* out);
+// Off by default; when on, every raw pointer position of the last poll is
+// kept in arrival order (strokes, gestures) even though moves coalesce
+void px_ws_set_motion_history(PX_Window* win, bool enabled);
+int px_ws_motion_history(PX_Window* win, const PX_WE_MotionSample** out);
+void px_ws_input_latency(PX_Window* win, PX_WS_LatencyStats* out);
 
-t_err_codes px_ws_show_splash(void);
+// The splash draws on its own thread and returns right away
+t_err_codes px_ws_show_splash(const PX_SplashDesc* desc);
+void px_ws_splash_progress(float progress, const char* stage);
+// Does not block; the splash stays up until min_ms has passed
+void px_ws_close_splash(void);
 t_err_codes px_ws_window_design(PX_Window* win, PX_WindowDesign* design);
 
+// Contexts of all windows share one object namespace (buffers, textures, programs)
 t_err_codes px_ws_create_ctx(PX_Window* win);
+// Binds the window's context before drawing into it, a no-op when it is already current.
+// NULL releases the calling thread's context so another thread can take it
+t_err_codes px_ws_make_current(PX_Window* win);
+// ERR_WS_UNSUPPORTED when the driver exposes no swap control; adaptive falls back to on
+t_err_codes px_ws_set_swap_interval(PX_Window* win, PX_WS_SwapInterval interval);
 t_err_codes px_ws_swap_buffers(PX_Window* win);
+// Split swap for a render thread: the thread handling events takes the stamp of the
+// input a frame answers, the thread owning the context presents the frame with it
+uint64_t px_ws_take_input_stamp(PX_Window* win);
+t_err_codes px_ws_present(PX_Window* win, uint64_t input_ns);
 
 char* px_ws_open_file_selector_dialog(void);
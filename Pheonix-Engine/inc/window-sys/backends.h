@@ -4,26 +4,13 @@
 #include <window-sys.h>
 
 static inline bool px_we_queue_empty(PX_WE_Queue* q) {
-    return q->head == q->tail;
+    return q->count == 0;
 }
 
-static inline bool px_we_queue_full(PX_WE_Queue* q) {
-    return ((q->head + 1) % PX_WE_QUEUE_SIZE) == q->tail;
-}
-
-static inline bool px_we_queue_push(PX_WE_Queue* q, PX_WEvent* ev) {
-    if (px_we_queue_full(q)) return false;
-    q->events[q->head] = *ev;
-    q->head = (q->head + 1) % PX_WE_QUEUE_SIZE;
-    return true;
-}
-
-static inline bool px_we_queue_pop(PX_WE_Queue* q, PX_WEvent* ev) {
-    if (px_we_queue_empty(q)) return false;
-    *ev = q->events[q->tail];
-    q->tail = (q->tail + 1) % PX_WE_QUEUE_SIZE;
-    return true;
-}
+// False only when the event had to be dropped
+bool px_we_queue_push(PX_WE_Queue* q, const PX_WEvent* ev);
+bool px_we_queue_pop(PX_WE_Queue* q, PX_WEvent* ev);
+void px_we_queue_free(PX_WE_Queue* q);
 
 typedef struct px_ws_backend {
     t_err_codes (*init)(void);
@@ -36,11 +23,17 @@ typedef struct px_ws_backend {
     t_err_codes (*hide)(PX_Window*);
 
     t_err_codes (*poll_events)(PX_Window*);
+    bool (*wait_events)(PX_Window*, int);
+    void (*wake)(void);
 
-    t_err_codes (*show_splash)(void);
+    t_err_codes (*show_splash)(const PX_SplashDesc*);
+    void (*splash_progress)(float, const char*);
+    void (*close_splash)(void);
     t_err_codes (*window_design)(PX_Window*, PX_WindowDesign*);
     
     t_err_codes (*create_ctx)(PX_Window*);
+    t_err_codes (*make_current)(PX_Window*);
+    t_err_codes (*set_swap_interval)(PX_Window*, PX_WS_SwapInterval);
     t_err_codes (*swap_buffers)(PX_Window*);
 
     char* (*open_file_selector_dialog)(void);
@@ -0,0 +1,577 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <asset-sys/cooker.h>
+#include <core/hash.h>
+#include <core/jobs.h>
+#include <font.h>
+#include <err-codes.h>
+
+#define COOK_PATH_MAX 512
+#define COOK_MAX_INPUTS 2
+
+static const char* cook_kind_names[PX_COOK_KIND_COUNT] = {
+    "sdf font",
+    "ttf",
+    "image",
+    "shader"
+};
+
+typedef enum {
+    COOK_STATUS_PENDING = 0,
+    COOK_STATUS_COOKED,
+    COOK_STATUS_UP_TO_DATE,
+    COOK_STATUS_FAILED,
+    COOK_STATUS_NO_COOKER
+} t_cook_status;
+
+struct cook_input {
+    char path[COOK_PATH_MAX];
+    uint64_t size;
+    uint64_t mtime_ns;
+    uint64_t hash;
+};
+
+struct cook_job {
+    PX_CookKind kind;
+    struct cook_input inputs[COOK_MAX_INPUTS];
+    int input_count;
+    char output[COOK_PATH_MAX];
+
+    uint64_t key;
+    t_cook_status status;
+    int index;
+};
+
+struct cook_list {
+    struct cook_job* jobs;
+    int count;
+    int capacity;
+};
+
+// Manifest entries, sorted by path for lookup
+struct manifest_input {
+    char* path;
+    uint64_t size;
+    uint64_t mtime_ns;
+    uint64_t hash;
+};
+
+struct manifest_output {
+    char* path;
+    uint64_t key;
+};
+
+struct manifest {
+    struct manifest_input* inputs;
+    int input_count;
+    struct manifest_output* outputs;
+    int output_count;
+};
+
+struct cook_ctx {
+    const PX_CookDesc* desc;
+    const struct manifest* manifest;
+    uint64_t settings_hash;
+};
+
+struct cook_task {
+    struct cook_ctx* ctx;
+    struct cook_job* job;
+};
+
+// ===== Paths =====
+
+static bool has_ext(const char* path, const char* ext) {
+    const char* dot = strrchr(path, '.');
+    return dot && strcmp(dot, ext) == 0;
+}
+
+static void path_stem(const char* path, char* out, size_t out_size) {
+    const char* base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    snprintf(out, out_size, "%s", base);
+    char* dot = strrchr(out, '.');
+    if (dot) *dot = '\0';
+}
+
+static bool file_stat(const char* path, uint64_t* size, uint64_t* mtime_ns) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    if (size) *size = (uint64_t)st.st_size;
+    if (mtime_ns) *mtime_ns = (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+    return true;
+}
+
+static t_err_codes make_parent_dirs(const char* path) {
+    char tmp[COOK_PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s", path);
+
+    for (char* p = tmp + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(tmp, 0755) != 0 && errno != EEXIST) {
+            return ERR_COULD_NOT_OPEN_FILE;
+        }
+        *p = '/';
+    }
+    return ERR_SUCCESS;
+}
+
+// ===== Discovery =====
+
+static struct cook_job* cook_list_push(struct cook_list* list) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 32;
+        struct cook_job* jobs = (struct cook_job*)realloc(list->jobs, sizeof(*jobs) * capacity);
+        if (!jobs)
+            return NULL;
+        list->jobs = jobs;
+        list->capacity = capacity;
+    }
+
+    struct cook_job* job = &list->jobs[list->count];
+    memset(job, 0, sizeof(*job));
+    job->index = list->count++;
+    return job;
+}
+
+static t_err_codes discover_dir(const char* dir, struct cook_list* list) {
+    DIR* d = opendir(dir);
+    if (!d)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.')
+            continue;
+
+        char path[COOK_PATH_MAX];
+        if (snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name) >= (int)sizeof(path))
+            continue;
+
+        // Symlinked files are cooked, symlinked directories are not walked:
+        // a link back up the tree would recurse forever
+        struct stat st;
+        if (lstat(path, &st) != 0)
+            continue;
+        if (S_ISLNK(st.st_mode) && (stat(path, &st) != 0 || S_ISDIR(st.st_mode)))
+            continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            discover_dir(path, list);
+            continue;
+        }
+
+        PX_CookKind kind;
+        if (has_ext(path, ".json"))
+            kind = PX_COOK_KIND_SDF_FONT;
+        else if (has_ext(path, ".ttf") || has_ext(path, ".otf"))
+            kind = PX_COOK_KIND_TTF;
+        else if (has_ext(path, ".png"))
+            kind = PX_COOK_KIND_IMAGE;
+        else if (has_ext(path, ".glsl") || has_ext(path, ".vert") || has_ext(path, ".frag"))
+            kind = PX_COOK_KIND_SHADER;
+        else
+            continue;
+
+        struct cook_job* job = cook_list_push(list);
+        if (!job) {
+            closedir(d);
+            return ERR_ALLOC_FAILED;
+        }
+        job->kind = kind;
+        job->input_count = 1;
+        snprintf(job->inputs[0].path, sizeof(job->inputs[0].path), "%s", path);
+    }
+
+    closedir(d);
+    return ERR_SUCCESS;
+}
+
+// Pairs every SDF description with its atlas image. The PNG stops being
+// a standalone image source; a JSON without an atlas is not cookable.
+static void resolve_sdf_pairs(const char* asset_dir, struct cook_list* list) {
+    for (int i = 0; i < list->count; i++) {
+        struct cook_job* job = &list->jobs[i];
+        if (job->kind != PX_COOK_KIND_SDF_FONT)
+            continue;
+
+        char png[COOK_PATH_MAX];
+        snprintf(png, sizeof(png), "%s", job->inputs[0].path);
+        strcpy(strrchr(png, '.'), ".png");
+
+        int atlas = -1;
+        for (int j = 0; j < list->count; j++) {
+            if (list->jobs[j].kind == PX_COOK_KIND_IMAGE && strcmp(list->jobs[j].inputs[0].path, png) == 0) {
+                atlas = j;
+                break;
+            }
+        }
+
+        if (atlas < 0) {
+            job->status = COOK_STATUS_NO_COOKER;
+            continue;
+        }
+
+        list->jobs[atlas].kind = PX_COOK_KIND_COUNT; // consumed by the pair
+        snprintf(job->inputs[1].path, sizeof(job->inputs[1].path), "%s", png);
+        job->input_count = 2;
+
+        char stem[COOK_PATH_MAX];
+        path_stem(job->inputs[0].path, stem, sizeof(stem));
+        if (snprintf(job->output, sizeof(job->output), "%s/fonts/psdf/%s.psdf", asset_dir, stem) >= (int)sizeof(job->output))
+            job->status = COOK_STATUS_NO_COOKER;
+    }
+
+    // Drop consumed atlas entries and mark kinds that have no cooker yet.
+    // Remaining images cook in place to a sibling .ptex.
+    int w = 0;
+    for (int i = 0; i < list->count; i++) {
+        struct cook_job* job = &list->jobs[i];
+        if (job->kind == PX_COOK_KIND_COUNT)
+            continue;
+        if (job->kind == PX_COOK_KIND_IMAGE) {
+            snprintf(job->output, sizeof(job->output), "%s", job->inputs[0].path);
+            strcpy(strrchr(job->output, '.'), ".ptex");
+        } else if (job->kind != PX_COOK_KIND_SDF_FONT) {
+            job->status = COOK_STATUS_NO_COOKER;
+        }
+
+        list->jobs[w] = *job;
+        list->jobs[w].index = w;
+        w++;
+    }
+    list->count = w;
+}
+
+// ===== Manifest =====
+
+static int manifest_input_cmp(const void* a, const void* b) {
+    return strcmp(((const struct manifest_input*)a)->path, ((const struct manifest_input*)b)->path);
+}
+
+static int manifest_output_cmp(const void* a, const void* b) {
+    return strcmp(((const struct manifest_output*)a)->path, ((const struct manifest_output*)b)->path);
+}
+
+static void manifest_free(struct manifest* m) {
+    for (int i = 0; i < m->input_count; i++)
+        free(m->inputs[i].path);
+    for (int i = 0; i < m->output_count; i++)
+        free(m->outputs[i].path);
+    free(m->inputs);
+    free(m->outputs);
+    memset(m, 0, sizeof(*m));
+}
+
+static char* cook_strdup(const char* s) {
+    size_t len = strlen(s);
+    char* out = (char*)malloc(len + 1);
+    if (out)
+        memcpy(out, s, len + 1);
+    return out;
+}
+
+static void manifest_load(const char* path, struct manifest* m) {
+    memset(m, 0, sizeof(*m));
+
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return;
+
+    char line[COOK_PATH_MAX + 128];
+    int version = 0;
+    if (!fgets(line, sizeof(line), f) || sscanf(line, "pxcook %d", &version) != 1 || version != PX_COOK_VERSION) {
+        fclose(f);
+        return;
+    }
+
+    int input_cap = 0, output_cap = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+
+        unsigned long long a = 0, b = 0, c = 0;
+        int consumed = 0;
+        if (line[0] == 'I' && sscanf(line, "I %llu %llu %llx %n", &a, &b, &c, &consumed) == 3 && consumed > 0) {
+            if (m->input_count == input_cap) {
+                input_cap = input_cap ? input_cap * 2 : 64;
+                struct manifest_input* inputs = (struct manifest_input*)realloc(m->inputs, sizeof(*inputs) * input_cap);
+                if (!inputs) break;
+                m->inputs = inputs;
+            }
+            char* p = cook_strdup(line + consumed);
+            if (!p) break;
+            m->inputs[m->input_count++] = (struct manifest_input){ p, a, b, c };
+        } else if (line[0] == 'O' && sscanf(line, "O %llx %n", &a, &consumed) == 1 && consumed > 0) {
+            if (m->output_count == output_cap) {
+                output_cap = output_cap ? output_cap * 2 : 32;
+                struct manifest_output* outputs = (struct manifest_output*)realloc(m->outputs, sizeof(*outputs) * output_cap);
+                if (!outputs) break;
+                m->outputs = outputs;
+            }
+            char* p = cook_strdup(line + consumed);
+            if (!p) break;
+            m->outputs[m->output_count++] = (struct manifest_output){ p, a };
+        }
+    }
+    fclose(f);
+
+    qsort(m->inputs, m->input_count, sizeof(*m->inputs), manifest_input_cmp);
+    qsort(m->outputs, m->output_count, sizeof(*m->outputs), manifest_output_cmp);
+}
+
+static const struct manifest_input* manifest_find_input(const struct manifest* m, const char* path) {
+    struct manifest_input key = { (char*)path, 0, 0, 0 };
+    return (const struct manifest_input*)bsearch(&key, m->inputs, m->input_count, sizeof(*m->inputs), manifest_input_cmp);
+}
+
+static const struct manifest_output* manifest_find_output(const struct manifest* m, const char* path) {
+    struct manifest_output key = { (char*)path, 0 };
+    return (const struct manifest_output*)bsearch(&key, m->outputs, m->output_count, sizeof(*m->outputs), manifest_output_cmp);
+}
+
+static t_err_codes manifest_write(const char* path, const struct cook_list* list, const struct manifest* old) {
+    char tmp[COOK_PATH_MAX + 32];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d", path, (int)getpid());
+
+    FILE* f = fopen(tmp, "w");
+    if (!f)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    fprintf(f, "pxcook %d\n", PX_COOK_VERSION);
+    for (int i = 0; i < list->count; i++) {
+        const struct cook_job* job = &list->jobs[i];
+
+        if (job->status == COOK_STATUS_COOKED || job->status == COOK_STATUS_UP_TO_DATE) {
+            for (int j = 0; j < job->input_count; j++) {
+                const struct cook_input* in = &job->inputs[j];
+                fprintf(f, "I %llu %llu %016llx %s\n", (unsigned long long)in->size, (unsigned long long)in->mtime_ns, (unsigned long long)in->hash, in->path);
+            }
+            fprintf(f, "O %016llx %s\n", (unsigned long long)job->key, job->output);
+        } else if (job->status == COOK_STATUS_FAILED && job->output[0]) {
+            // Keep the last good key so a transient failure does not force a re-cook later
+            const struct manifest_output* prev = manifest_find_output(old, job->output);
+            if (prev)
+                fprintf(f, "O %016llx %s\n", (unsigned long long)prev->key, prev->path);
+        }
+    }
+
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        remove(tmp);
+        return ERR_COULD_NOT_OPEN_FILE;
+    }
+    return ERR_SUCCESS;
+}
+
+// ===== Cooking =====
+
+static uint64_t settings_hash(const PX_CookDesc* desc) {
+    uint32_t fields[] = {
+        PX_COOK_VERSION,
+        desc->sdf.pixel_size,
+        desc->sdf.atlas_size,
+        desc->sdf.sdf_range,
+        (uint32_t)desc->sdf.ascii_only,
+        (uint32_t)desc->ptex.premultiply,
+        (uint32_t)desc->ptex.mipmaps,
+        (uint32_t)desc->ptex.compress,
+        (uint32_t)desc->ptex.bgra
+    };
+    return px_hash64(fields, sizeof(fields), 0);
+}
+
+static bool cook_hash_inputs(struct cook_ctx* ctx, struct cook_job* job) {
+    uint64_t key = px_hash64(&job->kind, sizeof(job->kind), ctx->settings_hash);
+
+    for (int i = 0; i < job->input_count; i++) {
+        struct cook_input* in = &job->inputs[i];
+        if (!file_stat(in->path, &in->size, &in->mtime_ns))
+            return false;
+
+        // Unchanged size and mtime: trust the recorded content hash
+        const struct manifest_input* prev = manifest_find_input(ctx->manifest, in->path);
+        if (prev && prev->size == in->size && prev->mtime_ns == in->mtime_ns) {
+            in->hash = prev->hash;
+        } else if (px_hash64_file(in->path, 0, &in->hash) != ERR_SUCCESS) {
+            return false;
+        }
+
+        key = px_hash64(&in->hash, sizeof(in->hash), key);
+    }
+
+    job->key = key;
+    return true;
+}
+
+static t_err_codes cook_run(struct cook_ctx* ctx, struct cook_job* job, const char* out_path) {
+    switch (job->kind) {
+        case PX_COOK_KIND_SDF_FONT:
+            return px_sdf_build_font(job->inputs[0].path, out_path, &ctx->desc->sdf);
+        case PX_COOK_KIND_IMAGE:
+            return px_ptex_build(job->inputs[0].path, out_path, &ctx->desc->ptex);
+        default:
+            return ERR_INTERNAL;
+    }
+}
+
+static void cook_task(void* arg) {
+    struct cook_task* task = (struct cook_task*)arg;
+    struct cook_ctx* ctx = task->ctx;
+    struct cook_job* job = task->job;
+
+    if (!cook_hash_inputs(ctx, job)) {
+        fprintf(stderr, "Cook: could not read inputs of %s\n", job->output);
+        job->status = COOK_STATUS_FAILED;
+        return;
+    }
+
+    const struct manifest_output* prev = manifest_find_output(ctx->manifest, job->output);
+    if (!ctx->desc->force && prev && prev->key == job->key && file_stat(job->output, NULL, NULL)) {
+        job->status = COOK_STATUS_UP_TO_DATE;
+        return;
+    }
+
+    if (make_parent_dirs(job->output) != ERR_SUCCESS) {
+        fprintf(stderr, "Cook: could not create directory for %s\n", job->output);
+        job->status = COOK_STATUS_FAILED;
+        return;
+    }
+
+    // Cook into a temporary file and publish it with an atomic rename
+    char tmp[COOK_PATH_MAX + 32];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d.%d", job->output, (int)getpid(), job->index);
+
+    t_err_codes err = cook_run(ctx, job, tmp);
+    if (err != ERR_SUCCESS || rename(tmp, job->output) != 0) {
+        fprintf(stderr, "Cook: failed to cook %s (%d)\n", job->output, err);
+        remove(tmp);
+        job->status = COOK_STATUS_FAILED;
+        return;
+    }
+
+    printf("Cooked %s\n", job->output);
+    job->status = COOK_STATUS_COOKED;
+}
+
+t_err_codes px_cook_assets(const char* asset_dir, const PX_CookDesc* desc, PX_CookReport* report) {
+    if (!asset_dir || !desc)
+        return ERR_INTERNAL;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    char root[COOK_PATH_MAX];
+    snprintf(root, sizeof(root), "%s", asset_dir);
+    size_t root_len = strlen(root);
+    while (root_len > 1 && root[root_len - 1] == '/')
+        root[--root_len] = '\0';
+    asset_dir = root;
+
+    PX_CookReport local = {0};
+    if (!report)
+        report = &local;
+    memset(report, 0, sizeof(*report));
+
+    struct cook_list list = {0};
+    t_err_codes err = discover_dir(asset_dir, &list);
+    if (err != ERR_SUCCESS) {
+        fprintf(stderr, "Cook: could not open asset directory %s\n", asset_dir);
+        free(list.jobs);
+        return err;
+    }
+    if (desc->shader_dir)
+        discover_dir(desc->shader_dir, &list);
+    resolve_sdf_pairs(asset_dir, &list);
+
+    char manifest_path[COOK_PATH_MAX + 16];
+    snprintf(manifest_path, sizeof(manifest_path), "%s/%s", asset_dir, PX_COOK_MANIFEST);
+
+    struct manifest manifest;
+    manifest_load(manifest_path, &manifest);
+
+    struct cook_ctx ctx = {
+        .desc = desc,
+        .manifest = &manifest,
+        .settings_hash = settings_hash(desc)
+    };
+
+    struct cook_task* tasks = (struct cook_task*)calloc(list.count ? list.count : 1, sizeof(*tasks));
+    if (!tasks) {
+        manifest_free(&manifest);
+        free(list.jobs);
+        return ERR_ALLOC_FAILED;
+    }
+
+    int pending = 0;
+    for (int i = 0; i < list.count; i++)
+        if (list.jobs[i].status == COOK_STATUS_PENDING)
+            pending++;
+
+    int workers = desc->workers > 0 ? desc->workers : px_cpu_count();
+    if (workers > pending)
+        workers = pending;
+
+    // Run from the command line nothing else started the job system; this
+    // thread cooks too, so it needs one worker less than asked for
+    bool own_jobs = px_jobs_worker_count() == 0 && workers > 1;
+    if (own_jobs && px_jobs_init(workers - 1) != ERR_SUCCESS)
+        own_jobs = false;
+
+    PX_JobCounter cooked;
+    px_job_counter_init(&cooked);
+    for (int i = 0; i < list.count; i++) {
+        struct cook_job* job = &list.jobs[i];
+        if (job->status != COOK_STATUS_PENDING)
+            continue;
+
+        tasks[i] = (struct cook_task){ &ctx, job };
+        px_job_run(&(PX_JobDesc){ cook_task, &tasks[i], PX_JOB_ANY_THREAD }, &cooked);
+    }
+    px_job_wait(&cooked);
+    if (own_jobs)
+        px_jobs_shutdown();
+
+    for (int i = 0; i < list.count; i++) {
+        struct cook_job* job = &list.jobs[i];
+        report->discovered[job->kind]++;
+        switch (job->status) {
+            case COOK_STATUS_COOKED: report->cooked++; break;
+            case COOK_STATUS_UP_TO_DATE: report->up_to_date++; break;
+            case COOK_STATUS_FAILED: report->failed++; break;
+            case COOK_STATUS_NO_COOKER: report->no_cooker++; break;
+            default: break;
+        }
+    }
+
+    if (report->cooked > 0 || report->failed > 0 || manifest.output_count != report->up_to_date)
+        err = manifest_write(manifest_path, &list, &manifest);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report->elapsed_ms = (double)(end.tv_sec - start.tv_sec) * 1000.0 + (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+
+    printf("Cook: discovered ");
+    for (int k = 0; k < PX_COOK_KIND_COUNT; k++)
+        printf("%s%d %s", k ? ", " : "", report->discovered[k], cook_kind_names[k]);
+    printf("\nCook: %d cooked, %d up to date, %d failed, %d without a cooker in %.2f ms\n", report->cooked, report->up_to_date, report->failed, report->no_cooker, report->elapsed_ms);
+
+    free(tasks);
+    manifest_free(&manifest);
+    free(list.jobs);
+
+    if (err == ERR_SUCCESS && report->failed > 0)
+        err = ERR_FALUIRE;
+    return err;
+}
@@ -0,0 +1,426 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <asset-sys/loader.h>
+#include <loaders/sdf-loader.h>
+#include <loaders/ptex-loader.h>
+#include <core/jobs.h>
+#include <core/image.h>
+#include <core/trace.h>
+#include <err-codes.h>
+
+#define LOADER_PATH_MAX 512
+#define LOADER_STAGING_SIZE (1024 * 1024)
+
+struct px_asset {
+    PX_AssetKind kind;
+    PX_AssetState state;
+    bool released;
+    char path[LOADER_PATH_MAX];
+
+    // Filled by the worker
+    struct px_sdf_font_source sdf;
+    struct px_ptex_source ptex; // cooked images upload straight from the mapping
+    bool cooked;
+    unsigned char* decoded;
+    const unsigned char* pixels;
+    int width, height, channels;
+
+    // Filled by the upload
+    GLuint texture;
+    int rows_uploaded;
+    PX_Font* font;
+
+    struct px_asset* next;
+};
+
+struct loader_state {
+    bool initialized;
+    PX_JobCounter jobs; // reads and decodes still running
+
+    // Assets whose CPU work is done, waiting for the GL thread
+    PX_Asset* queue_head;
+    PX_Asset* queue_tail;
+    PX_Asset* uploading;
+
+    GLuint staging;
+    size_t staging_size;
+};
+
+static struct loader_state g_loader = {0};
+// Guards asset states and the staged queue; outlives init/shutdown cycles
+static pthread_mutex_t g_loader_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_loader_staged = PTHREAD_COND_INITIALIZER;
+
+static double loader_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+static void asset_free_cpu(PX_Asset* asset) {
+    px_sdf_source_free(&asset->sdf);
+    px_ptex_source_free(&asset->ptex);
+    free(asset->decoded);
+    asset->decoded = NULL;
+    asset->pixels = NULL;
+}
+
+// GL thread only
+static void asset_destroy(PX_Asset* asset) {
+    asset_free_cpu(asset);
+
+    if (asset->font)
+        px_font_destroy(asset->font);
+    else if (asset->texture)
+        glDeleteTextures(1, &asset->texture);
+
+    free(asset);
+}
+
+static bool loader_is_ptex(const char* path) {
+    size_t len = strlen(path);
+    return len >= 5 && strcmp(path + len - 5, ".ptex") == 0;
+}
+
+static void loader_worker(void* arg) {
+    PX_TRACE_SCOPE("loader_worker");
+    PX_Asset* asset = (PX_Asset*)arg;
+    t_err_codes err;
+
+    if (asset->kind == PX_ASSET_FONT) {
+        err = px_sdf_read(asset->path, &asset->sdf);
+        if (err == ERR_SUCCESS) {
+            asset->pixels = asset->sdf.atlas;
+            asset->width = asset->sdf.header.atlas_width;
+            asset->height = asset->sdf.header.atlas_height;
+            asset->channels = 1;
+        }
+    } else if (loader_is_ptex(asset->path)) {
+        err = px_ptex_read(asset->path, &asset->ptex);
+        if (err == ERR_SUCCESS) {
+            asset->cooked = true;
+            asset->width = (int)asset->ptex.header.width;
+            asset->height = (int)asset->ptex.header.height;
+            asset->channels = 4;
+        }
+    } else {
+        int bit_depth, color_type;
+        err = image_get_png(asset->path, &asset->width, &asset->height, &bit_depth, &color_type, &asset->decoded);
+        if (err == ERR_SUCCESS) {
+            asset->pixels = asset->decoded;
+            asset->channels = 4;
+        }
+    }
+
+    if (err != ERR_SUCCESS)
+        fprintf(stderr, "Loader: could not load %s\n", asset->path);
+
+    pthread_mutex_lock(&g_loader_lock);
+    if (asset->released) {
+        // Nothing touched GL yet, so the handle can go from here
+        asset_free_cpu(asset);
+        free(asset);
+    } else if (err != ERR_SUCCESS) {
+        asset_free_cpu(asset);
+        asset->state = PX_ASSET_FAILED;
+    } else {
+        if (g_loader.queue_tail)
+            g_loader.queue_tail->next = asset;
+        else
+            g_loader.queue_head = asset;
+        g_loader.queue_tail = asset;
+    }
+    pthread_cond_broadcast(&g_loader_staged);
+    pthread_mutex_unlock(&g_loader_lock);
+}
+
+t_err_codes px_loader_init(void) {
+    if (g_loader.initialized)
+        return ERR_SUCCESS;
+
+    px_job_counter_init(&g_loader.jobs);
+    g_loader.initialized = true;
+
+    return ERR_SUCCESS;
+}
+
+void px_loader_shutdown(void) {
+    if (!g_loader.initialized)
+        return;
+
+    px_job_wait(&g_loader.jobs);
+
+    // Staged but never uploaded handles belong to nobody once released;
+    // live ones are left to their owners.
+    for (PX_Asset* a = g_loader.queue_head; a; ) {
+        PX_Asset* next = a->next;
+        a->next = NULL;
+        asset_free_cpu(a);
+        if (a->released)
+            asset_destroy(a);
+        else
+            a->state = PX_ASSET_FAILED;
+        a = next;
+    }
+    if (g_loader.uploading) {
+        asset_free_cpu(g_loader.uploading);
+        if (g_loader.uploading->released)
+            asset_destroy(g_loader.uploading);
+        else
+            g_loader.uploading->state = PX_ASSET_FAILED;
+    }
+
+    if (g_loader.staging)
+        glDeleteBuffers(1, &g_loader.staging);
+    memset(&g_loader, 0, sizeof(g_loader));
+}
+
+static PX_Asset* loader_submit(PX_AssetKind kind, const char* path) {
+    if (!g_loader.initialized || !path)
+        return NULL;
+
+    PX_Asset* asset = (PX_Asset*)calloc(1, sizeof(PX_Asset));
+    if (!asset)
+        return NULL;
+
+    asset->kind = kind;
+    asset->state = PX_ASSET_PENDING;
+    if (snprintf(asset->path, sizeof(asset->path), "%s", path) >= (int)sizeof(asset->path)) {
+        free(asset);
+        return NULL;
+    }
+
+    px_job_run(&(PX_JobDesc){ loader_worker, asset, PX_JOB_ANY_THREAD }, &g_loader.jobs);
+
+    return asset;
+}
+
+PX_Asset* px_asset_load_font(const char* path) {
+    return loader_submit(PX_ASSET_FONT, path);
+}
+
+PX_Asset* px_asset_load_image(const char* path) {
+    return loader_submit(PX_ASSET_IMAGE, path);
+}
+
+static void upload_begin(PX_Asset* asset) {
+    // The mip chain is already in GPU layout; it goes up in one step
+    if (asset->cooked) {
+        if (px_ptex_upload(&asset->ptex, &asset->texture) != ERR_SUCCESS)
+            asset->texture = 0;
+        asset->rows_uploaded = asset->height;
+        return;
+    }
+
+    GLenum format = asset->channels == 1 ? GL_LUMINANCE : GL_RGBA;
+
+    glGenTextures(1, &asset->texture);
+    glBindTexture(GL_TEXTURE_2D, asset->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, asset->width, asset->height, 0, format, GL_UNSIGNED_BYTE, NULL);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    asset->rows_uploaded = 0;
+}
+
+// Copies one band of rows into the staging PBO and schedules the texture
+// update from it. The buffer is orphaned every band so the driver never
+// waits on the previous transfer.
+static void upload_band(PX_Asset* asset) {
+    GLenum format = asset->channels == 1 ? GL_LUMINANCE : GL_RGBA;
+    size_t row_bytes = (size_t)asset->width * asset->channels;
+
+    int rows = (int)(LOADER_STAGING_SIZE / (row_bytes ? row_bytes : 1));
+    if (rows < 1) rows = 1;
+    if (rows > asset->height - asset->rows_uploaded)
+        rows = asset->height - asset->rows_uploaded;
+    size_t bytes = row_bytes * rows;
+
+    if (!g_loader.staging)
+        glGenBuffers(1, &g_loader.staging);
+    if (bytes > g_loader.staging_size)
+        g_loader.staging_size = bytes;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_loader.staging);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, g_loader.staging_size, NULL, GL_STREAM_DRAW);
+
+    const unsigned char* src = asset->pixels + row_bytes * asset->rows_uploaded;
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        memcpy(dst, src, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        src = NULL;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, asset->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // A failed map falls back to a plain client memory upload
+    if (src) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, asset->rows_uploaded, asset->width, rows, format, GL_UNSIGNED_BYTE, src);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    asset->rows_uploaded += rows;
+}
+
+static void upload_finish(PX_Asset* asset) {
+    PX_AssetState state = asset->texture ? PX_ASSET_READY : PX_ASSET_FAILED;
+
+    if (asset->kind == PX_ASSET_FONT) {
+        struct px_sdf_font_data sdf;
+        px_sdf_source_finish(&asset->sdf, asset->texture, &sdf);
+        asset->font = px_sdf_font_create(&sdf);
+        if (!asset->font) {
+            px_sdf_free(&sdf);
+            state = PX_ASSET_FAILED;
+        }
+        asset->texture = 0;
+    }
+    asset_free_cpu(asset);
+
+    pthread_mutex_lock(&g_loader_lock);
+    asset->state = state;
+    pthread_mutex_unlock(&g_loader_lock);
+}
+
+bool px_loader_busy(void) {
+    if (!g_loader.initialized)
+        return false;
+
+    if (!px_job_done(&g_loader.jobs))
+        return true;
+
+    pthread_mutex_lock(&g_loader_lock);
+    bool busy = g_loader.queue_head || g_loader.uploading;
+    pthread_mutex_unlock(&g_loader_lock);
+    return busy;
+}
+
+void px_loader_pump(double budget_ms) {
+    if (!g_loader.initialized)
+        return;
+    PX_TRACE_SCOPE("px_loader_pump");
+
+    double start = loader_now_ms();
+    for (;;) {
+        PX_Asset* asset = g_loader.uploading;
+        if (!asset) {
+            pthread_mutex_lock(&g_loader_lock);
+            asset = g_loader.queue_head;
+            if (asset) {
+                g_loader.queue_head = asset->next;
+                if (!g_loader.queue_head)
+                    g_loader.queue_tail = NULL;
+                asset->next = NULL;
+            }
+            g_loader.uploading = asset;
+            bool released = asset && asset->released;
+            pthread_mutex_unlock(&g_loader_lock);
+
+            if (!asset)
+                return;
+            if (released) {
+                g_loader.uploading = NULL;
+                asset_destroy(asset);
+                continue;
+            }
+            upload_begin(asset);
+        }
+
+        // At least one band goes through per pump so big textures always progress
+        if (asset->rows_uploaded < asset->height)
+            upload_band(asset);
+        if (asset->rows_uploaded >= asset->height) {
+            pthread_mutex_lock(&g_loader_lock);
+            g_loader.uploading = NULL;
+            bool released = asset->released;
+            pthread_mutex_unlock(&g_loader_lock);
+
+            if (released)
+                asset_destroy(asset);
+            else
+                upload_finish(asset);
+        }
+
+        if (budget_ms > 0.0 && loader_now_ms() - start >= budget_ms)
+            return;
+    }
+}
+
+PX_AssetState px_asset_state(const PX_Asset* asset) {
+    if (!asset)
+        return PX_ASSET_FAILED;
+
+    pthread_mutex_lock(&g_loader_lock);
+    PX_AssetState state = asset->state;
+    pthread_mutex_unlock(&g_loader_lock);
+
+    return state;
+}
+
+t_err_codes px_asset_wait(PX_Asset* asset) {
+    if (!asset || !g_loader.initialized)
+        return ERR_INTERNAL;
+
+    for (;;) {
+        pthread_mutex_lock(&g_loader_lock);
+        while (asset->state == PX_ASSET_PENDING && !g_loader.queue_head && !g_loader.uploading)
+            pthread_cond_wait(&g_loader_staged, &g_loader_lock);
+        PX_AssetState state = asset->state;
+        pthread_mutex_unlock(&g_loader_lock);
+
+        if (state == PX_ASSET_READY)
+            return ERR_SUCCESS;
+        if (state == PX_ASSET_FAILED)
+            return ERR_COULD_NOT_OPEN_FILE;
+
+        px_loader_pump(0.0);
+    }
+}
+
+PX_Font* px_asset_take_font(PX_Asset* asset) {
+    if (!asset || asset->kind != PX_ASSET_FONT || px_asset_state(asset) != PX_ASSET_READY)
+        return NULL;
+
+    PX_Font* font = asset->font;
+    asset->font = NULL;
+    return font;
+}
+
+GLuint px_asset_texture(const PX_Asset* asset) {
+    if (!asset || asset->kind != PX_ASSET_IMAGE || px_asset_state(asset) != PX_ASSET_READY)
+        return 0;
+    return asset->texture;
+}
+
+int px_asset_width(const PX_Asset* asset) {
+    return (asset && px_asset_state(asset) == PX_ASSET_READY) ? asset->width : 0;
+}
+
+int px_asset_height(const PX_Asset* asset) {
+    return (asset && px_asset_state(asset) == PX_ASSET_READY) ? asset->height : 0;
+}
+
+void px_asset_release(PX_Asset* asset) {
+    if (!asset) return;
+
+    pthread_mutex_lock(&g_loader_lock);
+    // Still owned by a worker or the upload queue, whoever holds it frees it
+    bool in_flight = asset->state == PX_ASSET_PENDING && g_loader.initialized;
+    asset->released = true;
+    pthread_mutex_unlock(&g_loader_lock);
+
+    if (!in_flight)
+        asset_destroy(asset);
+}
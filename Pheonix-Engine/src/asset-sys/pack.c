@@ -0,0 +1,260 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <asset-sys/pack.h>
+#include <core/hash.h>
+#include <err-codes.h>
+
+#define PACK_PATH_MAX 512
+
+struct pack_file {
+    char path[PACK_PATH_MAX];
+    uint64_t size;
+};
+
+struct pack_list {
+    struct pack_file* files;
+    int count;
+    int capacity;
+};
+
+uint64_t px_pack_path_hash(const char* path, uint32_t len) {
+    return px_hash64(path, len, PX_PACK_MAGIC);
+}
+
+static t_err_codes pack_collect(const char* path, struct pack_list* list) {
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    if (S_ISREG(st.st_mode)) {
+        if (list->count == list->capacity) {
+            int capacity = list->capacity ? list->capacity * 2 : 64;
+            struct pack_file* files = (struct pack_file*)realloc(list->files, sizeof(*files) * capacity);
+            if (!files)
+                return ERR_ALLOC_FAILED;
+            list->files = files;
+            list->capacity = capacity;
+        }
+
+        struct pack_file* f = &list->files[list->count++];
+        snprintf(f->path, sizeof(f->path), "%s", path);
+        f->size = (uint64_t)st.st_size;
+        return ERR_SUCCESS;
+    }
+
+    if (!S_ISDIR(st.st_mode))
+        return ERR_SUCCESS;
+
+    DIR* d = opendir(path);
+    if (!d)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    struct dirent* ent;
+    t_err_codes err = ERR_SUCCESS;
+    while ((ent = readdir(d)) != NULL && err == ERR_SUCCESS) {
+        // Hidden files (cook manifests, temporaries) and raw source trees never ship
+        if (ent->d_name[0] == '.' || strcmp(ent->d_name, "raw") == 0 || strstr(ent->d_name, ".tmp."))
+            continue;
+
+        char child[PACK_PATH_MAX];
+        if (snprintf(child, sizeof(child), "%s/%s", path, ent->d_name) >= (int)sizeof(child))
+            continue;
+        err = pack_collect(child, list);
+    }
+    closedir(d);
+
+    return err;
+}
+
+static int pack_file_cmp(const void* a, const void* b) {
+    return strcmp(((const struct pack_file*)a)->path, ((const struct pack_file*)b)->path);
+}
+
+static uint64_t pack_align(uint64_t v) {
+    return (v + PX_PACK_ALIGN - 1) & ~(uint64_t)(PX_PACK_ALIGN - 1);
+}
+
+static bool pack_pad(FILE* f, uint64_t from, uint64_t to) {
+    static const unsigned char zeros[PX_PACK_ALIGN] = {0};
+    while (from < to) {
+        uint64_t n = to - from;
+        if (n > sizeof(zeros)) n = sizeof(zeros);
+        if (fwrite(zeros, 1, n, f) != n)
+            return false;
+        from += n;
+    }
+    return true;
+}
+
+static t_err_codes pack_write(const char* out_path, struct pack_list* list) {
+    uint32_t bucket_count = 16;
+    while (bucket_count < (uint32_t)list->count * 2)
+        bucket_count <<= 1;
+
+    struct px_pack_entry* entries = (struct px_pack_entry*)calloc(list->count ? list->count : 1, sizeof(*entries));
+    uint32_t* buckets = (uint32_t*)calloc(bucket_count, sizeof(*buckets));
+    if (!entries || !buckets) {
+        free(entries);
+        free(buckets);
+        return ERR_ALLOC_FAILED;
+    }
+
+    struct px_pack_header h = {
+        .magic = PX_PACK_MAGIC,
+        .version = PX_PACK_CUR_VERSION,
+        .entry_count = (uint32_t)list->count,
+        .bucket_count = bucket_count
+    };
+
+    uint64_t strings_size = 0;
+    for (int i = 0; i < list->count; i++)
+        strings_size += strlen(list->files[i].path) + 1;
+
+    h.entries_offset = sizeof(h);
+    h.buckets_offset = h.entries_offset + sizeof(*entries) * (uint64_t)list->count;
+    h.strings_offset = h.buckets_offset + sizeof(*buckets) * (uint64_t)bucket_count;
+    h.strings_size = strings_size;
+    h.data_offset = pack_align(h.strings_offset + strings_size);
+
+    uint64_t offset = h.data_offset;
+    uint32_t path_offset = 0;
+    for (int i = 0; i < list->count; i++) {
+        struct px_pack_entry* e = &entries[i];
+        uint32_t len = (uint32_t)strlen(list->files[i].path);
+
+        e->path_hash = px_pack_path_hash(list->files[i].path, len);
+        e->path_offset = path_offset;
+        e->path_len = len;
+        e->offset = offset;
+        e->size = list->files[i].size;
+
+        path_offset += len + 1;
+        offset = pack_align(offset + e->size);
+
+        uint32_t b = (uint32_t)e->path_hash & (bucket_count - 1);
+        while (buckets[b] != 0)
+            b = (b + 1) & (bucket_count - 1);
+        buckets[b] = (uint32_t)i + 1;
+    }
+    h.file_size = offset;
+
+    char tmp[PACK_PATH_MAX + 32];
+    snprintf(tmp, sizeof(tmp), "%s.tmp.%d", out_path, (int)getpid());
+    FILE* f = fopen(tmp, "wb");
+    if (!f) {
+        free(entries);
+        free(buckets);
+        return ERR_COULD_NOT_OPEN_FILE;
+    }
+
+    t_err_codes err = ERR_SUCCESS;
+    unsigned char* buf = NULL;
+    size_t buf_size = 0;
+    uint64_t pos = 0;
+
+    // Content hashes are filled while streaming the data, so the index is
+    // written last over its reserved space.
+    if (fwrite(&h, sizeof(h), 1, f) != 1 ||
+        fwrite(entries, sizeof(*entries), list->count, f) != (size_t)list->count ||
+        fwrite(buckets, sizeof(*buckets), bucket_count, f) != bucket_count) {
+        err = ERR_COULD_NOT_OPEN_FILE;
+    }
+    for (int i = 0; i < list->count && err == ERR_SUCCESS; i++) {
+        if (fwrite(list->files[i].path, 1, entries[i].path_len + 1, f) != entries[i].path_len + 1)
+            err = ERR_COULD_NOT_OPEN_FILE;
+    }
+    pos = h.strings_offset + strings_size;
+
+    for (int i = 0; i < list->count && err == ERR_SUCCESS; i++) {
+        struct px_pack_entry* e = &entries[i];
+        if (!pack_pad(f, pos, e->offset)) {
+            err = ERR_COULD_NOT_OPEN_FILE;
+            break;
+        }
+        pos = e->offset;
+
+        if (e->size > buf_size) {
+            unsigned char* nbuf = (unsigned char*)realloc(buf, e->size);
+            if (!nbuf) {
+                err = ERR_ALLOC_FAILED;
+                break;
+            }
+            buf = nbuf;
+            buf_size = e->size;
+        }
+
+        FILE* in = fopen(list->files[i].path, "rb");
+        if (!in || fread(buf, 1, e->size, in) != e->size) {
+            fprintf(stderr, "Pack: could not read %s\n", list->files[i].path);
+            if (in) fclose(in);
+            err = ERR_COULD_NOT_OPEN_FILE;
+            break;
+        }
+        fclose(in);
+
+        e->content_hash = px_hash64(buf, e->size, 0);
+        if (fwrite(buf, 1, e->size, f) != e->size) {
+            err = ERR_COULD_NOT_OPEN_FILE;
+            break;
+        }
+        pos += e->size;
+    }
+    if (err == ERR_SUCCESS && !pack_pad(f, pos, h.file_size))
+        err = ERR_COULD_NOT_OPEN_FILE;
+
+    if (err == ERR_SUCCESS) {
+        if (fseek(f, (long)h.entries_offset, SEEK_SET) != 0 ||
+            fwrite(entries, sizeof(*entries), list->count, f) != (size_t)list->count)
+            err = ERR_COULD_NOT_OPEN_FILE;
+    }
+
+    free(buf);
+    free(entries);
+    free(buckets);
+
+    if (fclose(f) != 0 && err == ERR_SUCCESS)
+        err = ERR_COULD_NOT_OPEN_FILE;
+    if (err == ERR_SUCCESS && rename(tmp, out_path) != 0)
+        err = ERR_COULD_NOT_OPEN_FILE;
+    if (err != ERR_SUCCESS)
+        remove(tmp);
+
+    return err;
+}
+
+t_err_codes px_pack_build(const char* out_path, const char* const* roots, int root_count) {
+    if (!out_path || !roots)
+        return ERR_INTERNAL;
+
+    struct pack_list list = {0};
+    for (int i = 0; i < root_count; i++) {
+        t_err_codes err = pack_collect(roots[i], &list);
+        if (err != ERR_SUCCESS) {
+            fprintf(stderr, "Pack: could not read %s\n", roots[i]);
+            free(list.files);
+            return err;
+        }
+    }
+
+    qsort(list.files, list.count, sizeof(*list.files), pack_file_cmp);
+
+    t_err_codes err = pack_write(out_path, &list);
+    if (err == ERR_SUCCESS) {
+        uint64_t total = 0;
+        for (int i = 0; i < list.count; i++)
+            total += list.files[i].size;
+        printf("Packed %d files (%llu bytes) into %s\n", list.count, (unsigned long long)total, out_path);
+    }
+
+    free(list.files);
+    return err;
+}
@@ -0,0 +1,193 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <asset-sys/vfs.h>
+#include <asset-sys/pack.h>
+#include <err-codes.h>
+
+struct vfs_pack {
+    bool mounted;
+    const unsigned char* base;
+    size_t size;
+
+    const struct px_pack_header* header;
+    const struct px_pack_entry* entries;
+    const uint32_t* buckets;
+    const char* strings;
+};
+
+static struct vfs_pack g_pack = {0};
+#ifdef NDEBUG
+static bool g_loose_override = false;
+#else
+static bool g_loose_override = true;
+#endif
+
+// count items of item_size bytes at offset lie within size, without wrapping on crafted values
+static bool vfs_range_fits(uint64_t offset, uint64_t count, uint64_t item_size, uint64_t size) {
+    return offset <= size && count <= (size - offset) / item_size;
+}
+
+static t_err_codes vfs_map_fd(int fd, void** map, size_t* size) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    *size = (size_t)st.st_size;
+    if (*size == 0) {
+        *map = NULL;
+        return ERR_SUCCESS;
+    }
+
+    void* p = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    *map = p;
+    return ERR_SUCCESS;
+}
+
+t_err_codes px_vfs_mount(const char* pack_path) {
+    if (g_pack.mounted)
+        px_vfs_unmount();
+
+    int fd = open(pack_path, O_RDONLY);
+    if (fd < 0)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    void* map = NULL;
+    size_t size = 0;
+    t_err_codes err = vfs_map_fd(fd, &map, &size);
+    close(fd);
+    if (err != ERR_SUCCESS)
+        return err;
+
+    const struct px_pack_header* h = (const struct px_pack_header*)map;
+    if (size < sizeof(*h) || h->magic != PX_PACK_MAGIC) {
+        if (map) munmap(map, size);
+        return ERR_MAGIC_INVALID;
+    }
+    if (h->version > PX_PACK_CUR_VERSION) {
+        munmap(map, size);
+        return ERR_VERSION_INVALID;
+    }
+    if (h->file_size > size || h->bucket_count == 0 || (h->bucket_count & (h->bucket_count - 1)) != 0 ||
+        !vfs_range_fits(h->entries_offset, h->entry_count, sizeof(struct px_pack_entry), size) ||
+        !vfs_range_fits(h->buckets_offset, h->bucket_count, sizeof(uint32_t), size) ||
+        !vfs_range_fits(h->strings_offset, h->strings_size, 1, size)) {
+        munmap(map, size);
+        return ERR_INTERNAL;
+    }
+
+    g_pack.base = (const unsigned char*)map;
+    g_pack.size = size;
+    g_pack.header = h;
+    g_pack.entries = (const struct px_pack_entry*)(g_pack.base + h->entries_offset);
+    g_pack.buckets = (const uint32_t*)(g_pack.base + h->buckets_offset);
+    g_pack.strings = (const char*)(g_pack.base + h->strings_offset);
+    g_pack.mounted = true;
+
+    return ERR_SUCCESS;
+}
+
+void px_vfs_unmount(void) {
+    if (!g_pack.mounted)
+        return;
+
+    munmap((void*)g_pack.base, g_pack.size);
+    memset(&g_pack, 0, sizeof(g_pack));
+}
+
+bool px_vfs_mounted(void) {
+    return g_pack.mounted;
+}
+
+void px_vfs_set_loose_override(bool enabled) {
+    g_loose_override = enabled;
+}
+
+static const struct px_pack_entry* vfs_pack_find(const char* path) {
+    if (!g_pack.mounted)
+        return NULL;
+
+    uint32_t len = (uint32_t)strlen(path);
+    uint64_t hash = px_pack_path_hash(path, len);
+    uint32_t mask = g_pack.header->bucket_count - 1;
+
+    for (uint32_t b = (uint32_t)hash & mask, probes = 0; probes <= mask; b = (b + 1) & mask, probes++) {
+        uint32_t slot = g_pack.buckets[b];
+        if (slot == 0 || slot > g_pack.header->entry_count)
+            return NULL;
+
+        const struct px_pack_entry* e = &g_pack.entries[slot - 1];
+        if (e->path_hash == hash && e->path_len == len &&
+            vfs_range_fits(e->path_offset, len, 1, g_pack.header->strings_size) &&
+            memcmp(g_pack.strings + e->path_offset, path, len) == 0) {
+            if (!vfs_range_fits(e->offset, e->size, 1, g_pack.size))
+                return NULL;
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+static t_err_codes vfs_open_loose(const char* path, PX_VFile* out) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    void* map = NULL;
+    size_t size = 0;
+    t_err_codes err = vfs_map_fd(fd, &map, &size);
+    close(fd);
+    if (err != ERR_SUCCESS)
+        return err;
+
+    out->data = (const unsigned char*)map;
+    out->size = size;
+    out->source = PX_VFS_SOURCE_LOOSE;
+    out->map = map;
+    out->map_size = size;
+    return ERR_SUCCESS;
+}
+
+t_err_codes px_vfs_open(const char* path, PX_VFile* out) {
+    if (!path || !out)
+        return ERR_INTERNAL;
+    memset(out, 0, sizeof(*out));
+
+    if (g_loose_override && vfs_open_loose(path, out) == ERR_SUCCESS)
+        return ERR_SUCCESS;
+
+    const struct px_pack_entry* e = vfs_pack_find(path);
+    if (e) {
+        out->data = g_pack.base + e->offset;
+        out->size = (size_t)e->size;
+        out->source = PX_VFS_SOURCE_PACK;
+        return ERR_SUCCESS;
+    }
+
+    // Without a pack (or for files it does not carry) disk is the only source
+    if (!g_loose_override)
+        return vfs_open_loose(path, out);
+
+    return ERR_COULD_NOT_OPEN_FILE;
+}
+
+void px_vfs_close(PX_VFile* file) {
+    if (!file) return;
+
+    if (file->source == PX_VFS_SOURCE_LOOSE && file->map)
+        munmap(file->map, file->map_size);
+    memset(file, 0, sizeof(*file));
+}
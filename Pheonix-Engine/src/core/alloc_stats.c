@@ -0,0 +1,61 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include <core/alloc-stats.h>
+
+#ifdef PX_ALLOC_STATS
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t count, size_t size);
+void* __wrap_realloc(void* ptr, size_t size);
+void __wrap_free(void* ptr);
+
+static atomic_uint_fast64_t g_alloc_count = 0;
+static atomic_uint_fast64_t g_free_count = 0;
+static atomic_uint_fast64_t g_alloc_bytes = 0;
+
+static inline void alloc_note(size_t size) {
+    atomic_fetch_add_explicit(&g_alloc_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_alloc_bytes, size, memory_order_relaxed);
+}
+
+void* __wrap_malloc(size_t size) {
+    alloc_note(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    alloc_note(count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    alloc_note(size);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr)
+        atomic_fetch_add_explicit(&g_free_count, 1, memory_order_relaxed);
+    __real_free(ptr);
+}
+
+void px_alloc_stats(PX_AllocStats* out) {
+    out->allocs = atomic_load_explicit(&g_alloc_count, memory_order_relaxed);
+    out->frees = atomic_load_explicit(&g_free_count, memory_order_relaxed);
+    out->bytes = atomic_load_explicit(&g_alloc_bytes, memory_order_relaxed);
+}
+
+#else
+
+void px_alloc_stats(PX_AllocStats* out) {
+    *out = (PX_AllocStats){0};
+}
+
+#endif
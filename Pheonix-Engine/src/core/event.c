@@ -1,87 +1,93 @@
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <stdatomic.h>
 
 #include <err-codes.h>
 #include <event-sys.h>
 #include <window-sys.h>
 #include <rendering-sys.h>
 
-#define MAX_GLOBAL_SIGNALS 64
+#define GSIGNAL_MASK (PX_GSIGNAL_QUEUE_SIZE - 1)
+#define GSIGNAL_ROUTES (PX_GSIGNAL_MAX_SUBSCRIBERS * 2) // power of two, probes stay short
+
+_Static_assert((PX_GSIGNAL_QUEUE_SIZE & GSIGNAL_MASK) == 0, "PX_GSIGNAL_QUEUE_SIZE must be a power of two");
+
+// Bounded MPSC ring. A cell's seq is its lap (position minus index): equal to
+// the lap when free for that position, one past it once written, so a zeroed
+// ring is empty without any setup
+struct gsignal_cell {
+    atomic_size_t seq;
+    PX_Event_GSignal signal;
+};
+
+// Subscribers of one (type, source) pair, linked in registration order
+struct gsignal_route {
+    bool used;
+    PX_Event_GSignals type;
+    const void* source;
+    int first;
+};
+
+struct gsignal_subscriber {
+    px_gsignal_fn fn;
+    void* user;
+    int next;
+    bool removed; // unsubscribed during delivery, unlinked once it is over
+};
 
 static PX_Scale2 mwindow_s = {0};
 static PX_Vector2 mouse_pos = {0};
-static PX_Event_GSignal gsignal_queue[MAX_GLOBAL_SIGNALS];
-static int gsignals_count = 0;
+static uint32_t pointer_generation = 1; // bumped when the pointer or the window moves
+
+static struct gsignal_cell gsignal_ring[PX_GSIGNAL_QUEUE_SIZE];
+static atomic_size_t gsignal_tail = 0; // producers
+static size_t gsignal_head = 0; // consumer only
+static atomic_uint_fast64_t gsignals_dropped = 0;
+
+static struct gsignal_route gsignal_routes[GSIGNAL_ROUTES];
+static struct gsignal_subscriber gsignal_subscribers[PX_GSIGNAL_MAX_SUBSCRIBERS];
+static int gsignal_delivering = 0; // dispatch depth, callbacks may dispatch again
+static bool gsignal_removed_pending = false;
 
 void event_sys_init(PX_Scale2 main_window_scale, PX_Vector2 mouse_position) {
     mwindow_s = main_window_scale;
     mouse_pos = mouse_position;
+    memset(gsignal_routes, 0, sizeof(gsignal_routes));
+    memset(gsignal_subscribers, 0, sizeof(gsignal_subscribers));
+    gsignal_removed_pending = false;
 }
 
 void event_resize(PX_Scale2 main_window_scale) {
     mwindow_s = main_window_scale;
+    pointer_generation++;
 }
 
 void event_mouse_move(PX_Vector2 mouse_position) {
     mouse_pos = mouse_position;
-}
-
-static bool is_mouse_on(PX_Transform2 tran) {
-    PX_Vector2 pos = tran.pos;
-    PX_Scale2 scale = tran.scale;
-    return (bool)(
-        mouse_pos.x >= pos.x &&
-        mouse_pos.x <= pos.x + scale.w &&
-        mouse_pos.y >= pos.y &&
-        mouse_pos.y <= pos.y + scale.h
-    );
+    pointer_generation++;
 }
 
 void event_hover_dropdown(PX_Dropdown* dd) {
-    int open_index = -1;
-    for (int i = 0; i < dd->item_count; i++) {
-        (&dd->items[i])->hover_index = -1;
-        if ((&dd->items[i])->is_open) {
-            open_index = i;
-        }
-    }
+    // Hover only moves when the pointer or what is under it did
+    uint64_t key = px_rs_hit_generation() << 32 | (uint32_t)pointer_generation;
+    if (dd->hover_key == key)
+        return;
+    dd->hover_key = key;
 
-    PX_Scale2 dd_scale = (PX_Scale2){dd->width, dd->height};
-    PX_Transform2 dd_tran = (PX_Transform2){dd->pos, dd_scale};
+    for (int i = 0; i < dd->item_count; i++)
+        (&dd->items[i])->hover_index = -1;
     dd->hover_index = -1;
 
-    if (!is_mouse_on(dd_tran)  && open_index == -1)
+    PX_RSHit hit;
+    if (!px_rs_hit_query(mouse_pos, &hit) || hit.owner != dd)
         return;
 
-    if (is_mouse_on(dd_tran)) {
-        // It is on dropdown
-        int x = dd->stext_pos.x;
-        for (int i = 0; i < dd->item_count; i++) {
-            PX_DropdownItem* item = &dd->items[i];
-
-            PX_Transform2 tran = (PX_Transform2){(PX_Vector2){x, dd->stext_pos.y}, (PX_Scale2){item->width, item->height}};
-            if (is_mouse_on(tran)) {
-                dd->hover_index = i;
-                return;
-            }
-
-            x += dd->spacing + px_rs_text_width(dd->font, item->label, dd->font_size);
-        }
-    } else {
-        // It is on a panel
-        PX_DropdownItem* opened_panel = &dd->items[open_index];
-        int y = opened_panel->stext_pos.y;
-        for (int i = 0; i < opened_panel->option_count; i++) {
-            PX_DropdownOption* op = &opened_panel->options[i];
-
-            PX_Transform2 tran = (PX_Transform2){(PX_Vector2){opened_panel->stext_pos.x, y}, (PX_Scale2){op->width, op->height}};
-            if (is_mouse_on(tran)) {
-                opened_panel->hover_index = i;
-            }
-            y += opened_panel->spacing;
-        }
-    }
+    if (hit.kind == PX_RS_HIT_DROPDOWN_ITEM)
+        dd->hover_index = hit.index;
+    else if (hit.kind == PX_RS_HIT_DROPDOWN_OPTION && hit.index < dd->item_count && (&dd->items[hit.index])->is_open)
+        (&dd->items[hit.index])->hover_index = hit.sub;
 }
 
 void event_click_dropdown(PX_Dropdown* dd) {
@@ -93,98 +99,211 @@ void event_click_dropdown(PX_Dropdown* dd) {
         }
     }
 
-    if (open_index > -1) {
-        PX_DropdownItem* opened_panel = &dd->items[open_index];
-        int y = opened_panel->stext_pos.y;
-
-        for (int j = 0; j < opened_panel->option_count; j++) {
-            PX_DropdownOption* op = &opened_panel->options[j];
-            PX_Transform2 op_tran = (PX_Transform2){(PX_Vector2){opened_panel->stext_pos.x, y}, (PX_Scale2){op->width, op->height}};
-            if (is_mouse_on(op_tran)) {
-                PX_Event_GSignal signal = {0};
-                signal.type = EVENT_GSIGNAL_UI_DROPDOWN_CLICK;
-                signal.ui_dropdown_click = (PX_Event_GSignal_UIDropdownClick){dd, open_index, j};
-                event_send_gsignal(&signal);
-                opened_panel->is_open = false;
-                return;
-            }
-            y += opened_panel->spacing;
-        }
-    }
-
-    PX_Scale2 dd_scale = (PX_Scale2){dd->width, dd->height};
-    PX_Transform2 dd_tran = (PX_Transform2){dd->pos, dd_scale};
+    PX_RSHit hit;
+    bool on_dd = px_rs_hit_query(mouse_pos, &hit) && hit.owner == dd;
 
-    if (!is_mouse_on(dd_tran) && open_index == -1)
+    if (on_dd && hit.kind == PX_RS_HIT_DROPDOWN_OPTION && hit.index == open_index) {
+        PX_Event_GSignal signal = {0};
+        signal.type = EVENT_GSIGNAL_UI_DROPDOWN_CLICK;
+        signal.source = dd;
+        signal.ui_dropdown_click = (PX_Event_GSignal_UIDropdownClick){dd, open_index, hit.sub};
+        event_send_gsignal(&signal);
+        px_rs_dropdown_set_open(dd, open_index, false);
         return;
+    }
 
-    if (is_mouse_on(dd_tran)) {
-        // It is on dropdown
-        int x = dd->stext_pos.x;
-        for (int i = 0; i < dd->item_count; i++) {
-            PX_DropdownItem* item = &dd->items[i];
-
-            PX_Transform2 tran = (PX_Transform2){(PX_Vector2){x, dd->stext_pos.y}, (PX_Scale2){item->width, item->height}};
-            if (is_mouse_on(tran) && open_index != i) {
-                item->is_open = true;
-                (&dd->items[open_index])->is_open = false;
-                open_index = -1;
-            } else {
-                item->is_open = false;
-            }
+    // Any other click closes the open panel, one on a closed item opens that instead
+    if (on_dd && hit.kind == PX_RS_HIT_DROPDOWN_ITEM && hit.index != open_index)
+        px_rs_dropdown_set_open(dd, hit.index, true);
+    if (open_index > -1)
+        px_rs_dropdown_set_open(dd, open_index, false);
+}
+
+bool event_send_gsignal(const PX_Event_GSignal* signal) {
+    if (!signal || signal->type == EVENT_GSIGNAL_UNKNOWN) return false;
 
-            x += dd->spacing + px_rs_text_width(dd->font, item->label, dd->font_size);
+    size_t pos = atomic_load_explicit(&gsignal_tail, memory_order_relaxed);
+    struct gsignal_cell* cell;
+    for (;;) {
+        cell = &gsignal_ring[pos & GSIGNAL_MASK];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos & ~(size_t)GSIGNAL_MASK);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&gsignal_tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            // The consumer is a whole lap behind
+            atomic_fetch_add_explicit(&gsignals_dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&gsignal_tail, memory_order_relaxed);
         }
     }
 
-    if (open_index > -1) (&dd->items[open_index])->is_open = false;
+    cell->signal = *signal;
+    atomic_store_explicit(&cell->seq, (pos & ~(size_t)GSIGNAL_MASK) + 1, memory_order_release);
+    // The main thread may be asleep in px_ws_wait_events with nothing else to wake it
+    px_ws_wake();
+    return true;
 }
 
-void event_send_gsignal(PX_Event_GSignal* signal) {
-    if (!signal || signal->type == EVENT_GSIGNAL_UNKNOWN || gsignals_count >= MAX_GLOBAL_SIGNALS) return;
-    memcpy(&gsignal_queue[gsignals_count], signal, sizeof(PX_Event_GSignal));
-    gsignals_count++;
+bool event_pop_gsignal(PX_Event_GSignal* out) {
+    struct gsignal_cell* cell = &gsignal_ring[gsignal_head & GSIGNAL_MASK];
+    size_t lap = gsignal_head & ~(size_t)GSIGNAL_MASK;
+    // Also false while a producer has claimed the cell but not written it yet
+    if (atomic_load_explicit(&cell->seq, memory_order_acquire) != lap + 1)
+        return false;
+
+    *out = cell->signal;
+    atomic_store_explicit(&cell->seq, lap + PX_GSIGNAL_QUEUE_SIZE, memory_order_release);
+    gsignal_head++;
+    return true;
 }
 
-void event_pop_gsignal(PX_Event_GSignal* out) {
-    if (gsignals_count < 1 || gsignals_count > MAX_GLOBAL_SIGNALS) {
-        PX_Event_GSignal zeroed = {0};
-        memcpy(out, &zeroed, sizeof(PX_Event_GSignal));
-        return;
-    }
-    gsignals_count--;
-    memcpy(out, &gsignal_queue[gsignals_count], sizeof(PX_Event_GSignal));
+bool event_gsignals_pending(void) {
+    const struct gsignal_cell* cell = &gsignal_ring[gsignal_head & GSIGNAL_MASK];
+    return atomic_load_explicit(&cell->seq, memory_order_acquire) == (gsignal_head & ~(size_t)GSIGNAL_MASK) + 1;
+}
+
+uint64_t event_gsignals_dropped(void) {
+    return (uint64_t)atomic_load_explicit(&gsignals_dropped, memory_order_relaxed);
 }
 
-static char* get_identifier(PX_Event_Identifier** identifiers, int size, void* ptr) {
-    for (int i = 0; i < size; i++) {
-        if (identifiers[i]->ptr == ptr)
-            return identifiers[i]->identifier;
+static int route_home(PX_Event_GSignals type, const void* source) {
+    uint64_t h = ((uint64_t)(uintptr_t)source >> 4) ^ ((uint64_t)type << 56);
+    h *= 0x9E3779B97F4A7C15ull;
+    return (int)(h >> 32) & (GSIGNAL_ROUTES - 1);
+}
+
+static struct gsignal_route* find_route(PX_Event_GSignals type, const void* source, bool create) {
+    int slot = route_home(type, source);
+
+    for (int probe = 0; probe < GSIGNAL_ROUTES; probe++) {
+        struct gsignal_route* route = &gsignal_routes[(slot + probe) & (GSIGNAL_ROUTES - 1)];
+        if (!route->used) {
+            if (!create) return NULL;
+            *route = (struct gsignal_route){true, type, source, -1};
+            return route;
+        }
+        if (route->type == type && route->source == source)
+            return route;
     }
     return NULL;
 }
 
-void event_handle_gsignals(PX_Event_Identifier** identifiers, int identifiers_len, PX_Event_GSignal* core_signal, bool* core_signal_active) {
-    PX_Event_GSignal sig = {0};
-    PX_Event_GSignal* s = &sig;
-    event_pop_gsignal(s);
-    if (s->type == EVENT_GSIGNAL_UNKNOWN) return;
+// Backward shift: later routes of the same probe run move up into the hole, so
+// lookups never stop early on it and the table needs no tombstones
+static void remove_route(struct gsignal_route* route) {
+    int hole = (int)(route - gsignal_routes);
+    route->used = false;
+    for (int i = (hole + 1) & (GSIGNAL_ROUTES - 1); gsignal_routes[i].used; i = (i + 1) & (GSIGNAL_ROUTES - 1)) {
+        int home = route_home(gsignal_routes[i].type, gsignal_routes[i].source);
+        if (((i - home) & (GSIGNAL_ROUTES - 1)) >= ((i - hole) & (GSIGNAL_ROUTES - 1))) {
+            gsignal_routes[hole] = gsignal_routes[i];
+            gsignal_routes[i].used = false;
+            hole = i;
+        }
+    }
+}
 
-    switch (s->type) {
-        case EVENT_GSIGNAL_UI_DROPDOWN_CLICK:
-            char* iden = get_identifier(identifiers, identifiers_len, (void*)s->ui_dropdown_click.dropdown);
-            if (!iden) break;
+t_err_codes event_subscribe_gsignal(PX_Event_GSignals type, const void* source, px_gsignal_fn fn, void* user) {
+    if (!fn || type == EVENT_GSIGNAL_UNKNOWN) return ERR_USAGE;
 
-            if (strcmp(iden, "menubar") == 0) {
-                menu_evs_handle_events(s);
-            }
+    int free_index = -1;
+    for (int i = 0; i < PX_GSIGNAL_MAX_SUBSCRIBERS; i++) {
+        if (!gsignal_subscribers[i].fn) {
+            free_index = i;
             break;
-        case EVENT_GSIGNAL_CORE_QUIT:
-            memcpy(core_signal, &s, sizeof(PX_Event_GSignal));
-            *core_signal_active = true;
+        }
+    }
+    if (free_index < 0) return ERR_INTERNAL;
+
+    // A route goes with its last subscriber, so there are never more routes than subscribers
+    struct gsignal_route* route = find_route(type, source, true);
+    if (!route) return ERR_INTERNAL;
+
+    gsignal_subscribers[free_index] = (struct gsignal_subscriber){fn, user, -1, false};
+    int* link = &route->first;
+    while (*link >= 0)
+        link = &gsignal_subscribers[*link].next;
+    *link = free_index;
+    return ERR_SUCCESS;
+}
+
+void event_unsubscribe_gsignal(PX_Event_GSignals type, const void* source, px_gsignal_fn fn, void* user) {
+    struct gsignal_route* route = find_route(type, source, false);
+    if (!route) return;
+
+    int* link = &route->first;
+    while (*link >= 0) {
+        struct gsignal_subscriber* sub = &gsignal_subscribers[*link];
+        if (sub->fn == fn && sub->user == user && !sub->removed) {
+            // Delivery may be walking this list or holding the route, both stay as they are until it ends
+            if (gsignal_delivering > 0) {
+                sub->removed = true;
+                gsignal_removed_pending = true;
+                return;
+            }
+            int index = *link;
+            *link = sub->next;
+            gsignal_subscribers[index] = (struct gsignal_subscriber){0};
+            if (route->first < 0)
+                remove_route(route);
             return;
-        default: break;
+        }
+        link = &sub->next;
     }
+}
 
-    *core_signal_active = false;
+// Unlinks everything unsubscribed during delivery, and the routes left empty
+static void sweep_removed(void) {
+    gsignal_removed_pending = false;
+    for (int r = 0; r < GSIGNAL_ROUTES;) {
+        struct gsignal_route* route = &gsignal_routes[r];
+        if (route->used) {
+            int* link = &route->first;
+            while (*link >= 0) {
+                struct gsignal_subscriber* sub = &gsignal_subscribers[*link];
+                if (sub->removed) {
+                    int index = *link;
+                    *link = sub->next;
+                    gsignal_subscribers[index] = (struct gsignal_subscriber){0};
+                } else {
+                    link = &sub->next;
+                }
+            }
+            // The backward shift may move another route into this slot
+            if (route->first < 0) {
+                remove_route(route);
+                continue;
+            }
+        }
+        r++;
+    }
+}
+
+static void deliver(const struct gsignal_route* route, const PX_Event_GSignal* signal) {
+    if (!route) return;
+    // Removals are deferred, so links and slots hold still while callbacks run
+    for (int i = route->first; i >= 0; i = gsignal_subscribers[i].next) {
+        const struct gsignal_subscriber* sub = &gsignal_subscribers[i];
+        if (!sub->removed)
+            sub->fn(signal, sub->user);
+    }
+}
+
+int event_dispatch_gsignals(void) {
+    int handled = 0;
+    PX_Event_GSignal signal;
+    // Bounded, subscribers that keep resending cannot hold the frame forever
+    gsignal_delivering++;
+    while (handled < PX_GSIGNAL_QUEUE_SIZE && event_pop_gsignal(&signal)) {
+        deliver(find_route(signal.type, signal.source, false), &signal);
+        if (signal.source)
+            deliver(find_route(signal.type, NULL, false), &signal);
+        handled++;
+    }
+    if (--gsignal_delivering == 0 && gsignal_removed_pending)
+        sweep_removed();
+    return handled;
 }
@@ -0,0 +1,68 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <time.h>
+
+#include <core/frame-sched.h>
+
+uint64_t px_frame_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void px_frame_sched_init(PX_FrameSched* s, const PX_FrameSchedDesc* desc) {
+    memset(s, 0, sizeof(*s));
+    if (desc)
+        s->desc = *desc;
+    s->dirty_frames = PX_FRAME_SETTLE_FRAMES;
+    s->focused = true;
+    s->visible = true;
+}
+
+void px_frame_sched_invalidate(PX_FrameSched* s) {
+    s->dirty_frames = PX_FRAME_SETTLE_FRAMES;
+}
+
+void px_frame_sched_set_focus(PX_FrameSched* s, bool focused) {
+    s->focused = focused;
+    px_frame_sched_invalidate(s);
+}
+
+void px_frame_sched_set_visible(PX_FrameSched* s, bool visible) {
+    s->visible = visible;
+    if (visible)
+        px_frame_sched_invalidate(s);
+}
+
+static int frame_sched_cap(const PX_FrameSched* s) {
+    int cap = s->desc.fps_cap;
+    if (!s->focused && s->desc.unfocused_fps > 0 && (cap <= 0 || s->desc.unfocused_fps < cap))
+        cap = s->desc.unfocused_fps;
+    return cap;
+}
+
+int px_frame_sched_timeout_ms(const PX_FrameSched* s, uint64_t now_ns) {
+    if (!s->visible || s->dirty_frames <= 0)
+        return -1;
+
+    int cap = frame_sched_cap(s);
+    if (cap <= 0 || s->frames == 0)
+        return 0;
+
+    uint64_t due_ns = s->last_frame_ns + 1000000000ull / (uint64_t)cap;
+    if (now_ns >= due_ns)
+        return 0;
+    // Rounded up, waking early would only spin through another wait
+    return (int)((due_ns - now_ns + 999999ull) / 1000000ull);
+}
+
+bool px_frame_sched_begin(PX_FrameSched* s, uint64_t now_ns) {
+    if (px_frame_sched_timeout_ms(s, now_ns) != 0)
+        return false;
+
+    s->dirty_frames--;
+    s->last_frame_ns = now_ns;
+    s->frames++;
+    return true;
+}
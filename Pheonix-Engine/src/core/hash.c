@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <core/hash.h>
+#include <err-codes.h>
+
+#define PX_HASH_P1 11400714785074694791ull
+#define PX_HASH_P2 14029467366897019727ull
+#define PX_HASH_P3 1609587929392839161ull
+#define PX_HASH_P4 9650029242287828579ull
+#define PX_HASH_P5 2870177450012600261ull
+
+#define PX_HASH_FILE_CHUNK (256 * 1024)
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t input) {
+    acc += input * PX_HASH_P2;
+    acc = rotl64(acc, 31);
+    return acc * PX_HASH_P1;
+}
+
+static inline uint64_t hash_merge(uint64_t acc, uint64_t val) {
+    acc ^= hash_round(0, val);
+    return acc * PX_HASH_P1 + PX_HASH_P4;
+}
+
+uint64_t px_hash64(const void* data, size_t len, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = seed + PX_HASH_P1 + PX_HASH_P2;
+        uint64_t v2 = seed + PX_HASH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PX_HASH_P1;
+
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = hash_round(v1, read64(p)); p += 8;
+            v2 = hash_round(v2, read64(p)); p += 8;
+            v3 = hash_round(v3, read64(p)); p += 8;
+            v4 = hash_round(v4, read64(p)); p += 8;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = hash_merge(h, v1);
+        h = hash_merge(h, v2);
+        h = hash_merge(h, v3);
+        h = hash_merge(h, v4);
+    } else {
+        h = seed + PX_HASH_P5;
+    }
+
+    h += (uint64_t)len;
+
+    while (p + 8 <= end) {
+        h ^= hash_round(0, read64(p));
+        h = rotl64(h, 27) * PX_HASH_P1 + PX_HASH_P4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * PX_HASH_P1;
+        h = rotl64(h, 23) * PX_HASH_P2 + PX_HASH_P3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * PX_HASH_P5;
+        h = rotl64(h, 11) * PX_HASH_P1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= PX_HASH_P2;
+    h ^= h >> 29;
+    h *= PX_HASH_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Chunks are hashed independently and chained through the seed, so large
+// files never need to be resident in memory at once.
+t_err_codes px_hash64_file(const char* path, uint64_t seed, uint64_t* out) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    unsigned char* buf = (unsigned char*)malloc(PX_HASH_FILE_CHUNK);
+    if (!buf) {
+        fclose(f);
+        return ERR_ALLOC_FAILED;
+    }
+
+    uint64_t h = seed;
+    size_t n;
+    while ((n = fread(buf, 1, PX_HASH_FILE_CHUNK, f)) > 0)
+        h = px_hash64(buf, n, h);
+
+    free(buf);
+    fclose(f);
+
+    *out = h;
+    return ERR_SUCCESS;
+}
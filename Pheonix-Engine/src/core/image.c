@@ -2,105 +2,209 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <png.h>
 
 #include <core/image.h>
+#include <core/jobs.h>
+#include <asset-sys/vfs.h>
+#include <core/trace.h>
 #include <err-codes.h>
 
-static png_structp png_ptr;
-static png_infop info_ptr;
-static bool initialized_png_ptr = false;
-static bool initialized_info_ptr = false;
-
-void image_free_png(void) {
-    if (!initialized_info_ptr && initialized_png_ptr) {
-        png_destroy_read_struct(&png_ptr, NULL, NULL);
-        initialized_png_ptr = false;
-        return;
-    } else if (!initialized_png_ptr && initialized_info_ptr) {
-        png_destroy_read_struct(NULL, &info_ptr, NULL);
-        initialized_info_ptr = false;
-        return;
-    } else if (!initialized_png_ptr && !initialized_info_ptr) {
-        return;
+// One libpng read struct per call, nothing is shared between decodes
+struct png_decoder {
+    png_structp png;
+    png_infop info;
+
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+};
+
+static void png_mem_read(png_structp png, png_bytep out, png_size_t len) {
+    struct png_decoder* d = (struct png_decoder*)png_get_io_ptr(png);
+    if (len > d->size - d->pos)
+        png_error(png, "Read past end of PNG data");
+
+    memcpy(out, d->data + d->pos, len);
+    d->pos += len;
+}
+
+static t_err_codes png_begin(struct png_decoder* d, const unsigned char* data, size_t size) {
+    memset(d, 0, sizeof(*d));
+    if (!data || size < 8 || png_sig_cmp((png_const_bytep)data, 0, 8) != 0)
+        return ERR_MAGIC_INVALID;
+
+    d->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!d->png)
+        return ERR_ALLOC_FAILED;
+    d->info = png_create_info_struct(d->png);
+    if (!d->info) {
+        png_destroy_read_struct(&d->png, NULL, NULL);
+        return ERR_ALLOC_FAILED;
     }
-    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-    initialized_info_ptr = false;
-    initialized_png_ptr = false;
+
+    d->data = data;
+    d->size = size;
+    d->pos = 8;
+    png_set_read_fn(d->png, d, png_mem_read);
+    png_set_sig_bytes(d->png, 8);
+
+    return ERR_SUCCESS;
 }
 
-t_err_codes image_init_png(void) {
-    if (!initialized_png_ptr) {
-        png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-        if (!png_ptr) return ERR_ALLOC_FAILED;
-        initialized_png_ptr = true;
+static void png_end(struct png_decoder* d) {
+    if (d->png)
+        png_destroy_read_struct(&d->png, d->info ? &d->info : NULL, NULL);
+}
+
+static void png_read_header(struct png_decoder* d, PX_ImageInfo* info) {
+    png_uint_32 w, h;
+
+    png_read_info(d->png, d->info);
+    png_get_IHDR(d->png, d->info, &w, &h, &info->bit_depth, &info->color_type, NULL, NULL, NULL);
+    if (w > INT32_MAX / IMAGE_CHANNELS || h > INT32_MAX)
+        png_error(d->png, "Image too large");
+
+    info->width = (int)w;
+    info->height = (int)h;
+}
+
+// Reads the header and sets up the RGBA8 transforms, returns the pass count
+static int png_setup(struct png_decoder* d, PX_ImageInfo* info) {
+    png_read_header(d, info);
+
+    png_set_expand(d->png);
+    png_set_strip_16(d->png);
+    if (!(info->color_type & PNG_COLOR_MASK_ALPHA)) {
+        png_set_add_alpha(d->png, 0xff, PNG_FILLER_AFTER);
+    } else {
+        png_set_tRNS_to_alpha(d->png);
     }
-    if (!initialized_info_ptr) {
-        info_ptr = png_create_info_struct(png_ptr);
-        if (!info_ptr) {
-            image_free_png();
-            return ERR_ALLOC_FAILED;
-        }
-        initialized_info_ptr = true;
+    png_set_gray_to_rgb(d->png);
+
+    int passes = png_set_interlace_handling(d->png);
+    png_read_update_info(d->png, d->info);
+    if (png_get_rowbytes(d->png, d->info) != (size_t)info->width * IMAGE_CHANNELS)
+        png_error(d->png, "Unexpected row layout");
+
+    return passes;
+}
+
+t_err_codes image_png_info(const unsigned char* data, size_t size, PX_ImageInfo* info) {
+    struct png_decoder d;
+    t_err_codes err = png_begin(&d, data, size);
+    if (err != ERR_SUCCESS)
+        return err;
+
+    if (setjmp(png_jmpbuf(d.png))) {
+        png_end(&d);
+        return ERR_INTERNAL;
     }
+
+    png_read_header(&d, info);
+    png_end(&d);
+
     return ERR_SUCCESS;
 }
 
-t_err_codes image_get_png(const char* file, int* w, int* h, int* bit_depth, int* color_type, unsigned char** data) {
-    FILE* f = fopen(file, "rb");
-    if (!f)
-        return ERR_COULD_NOT_OPEN_FILE;
-    unsigned char sig[8];
-    fread(sig, 1, 8, f);
-    if (!png_check_sig(sig, 8)) {
-        fclose(f);
-        return ERR_MAGIC_INVALID;
-    }
+t_err_codes image_png_decode(const unsigned char* data, size_t size, PX_ImageInfo* info, unsigned char* dst, size_t stride) {
+    struct png_decoder d;
+    t_err_codes err = png_begin(&d, data, size);
+    if (err != ERR_SUCCESS)
+        return err;
 
-    if (!initialized_png_ptr || !initialized_info_ptr)
-        image_init_png();
+    if (setjmp(png_jmpbuf(d.png))) {
+        png_end(&d);
+        return ERR_INTERNAL;
+    }
 
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        image_free_png();
-        fclose(f);
+    int passes = png_setup(&d, info);
+    if (!dst || stride < (size_t)info->width * IMAGE_CHANNELS) {
+        png_end(&d);
         return ERR_INTERNAL;
     }
 
-    png_init_io(png_ptr, f);
-    png_set_sig_bytes(png_ptr, 8);
-    png_read_info(png_ptr, info_ptr);
-    png_get_IHDR(png_ptr, info_ptr, (png_uint_32*)w, (png_uint_32*)h, bit_depth, color_type, NULL, NULL, NULL);
+    // Rows go straight to their destination, interlaced passes are merged there
+    for (int pass = 0; pass < passes; pass++) {
+        for (int y = 0; y < info->height; y++)
+            png_read_row(d.png, dst + (size_t)y * stride, NULL);
+    }
+    png_read_end(d.png, NULL);
+    png_end(&d);
 
-    png_uint_32 i, row_bytes;
-    png_bytep* row_pointers = malloc(sizeof(png_bytep) * (*h));
-    if (!row_pointers) {
-        image_free_png();
-        fclose(f);
-        return ERR_ALLOC_FAILED;
+    return ERR_SUCCESS;
+}
+
+static t_err_codes image_png_load(const char* path, PX_ImageInfo* info, unsigned char** pixels) {
+    PX_TRACE_SCOPE("image_png_load");
+    PX_VFile f;
+    if (px_vfs_open(path, &f) != ERR_SUCCESS)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    t_err_codes err = image_png_info(f.data, f.size, info);
+    if (err != ERR_SUCCESS) {
+        px_vfs_close(&f);
+        return err;
     }
 
-    png_set_expand(png_ptr);
-    png_set_strip_16(png_ptr);
-    if (!(*color_type & PNG_COLOR_MASK_ALPHA)) {
-        png_set_add_alpha(png_ptr, 0xff, PNG_FILLER_AFTER);
-    } else {
-        png_set_tRNS_to_alpha(png_ptr);
+    bool owned = false;
+    size_t stride = (size_t)info->width * IMAGE_CHANNELS;
+    if (!*pixels) {
+        *pixels = (unsigned char*)malloc(stride * info->height);
+        if (!*pixels) {
+            px_vfs_close(&f);
+            return ERR_ALLOC_FAILED;
+        }
+        owned = true;
     }
-    png_set_gray_to_rgb(png_ptr);
-    png_read_update_info(png_ptr, info_ptr);
-    row_bytes = png_get_rowbytes(png_ptr, info_ptr);
-    if ((*data = (unsigned char*)malloc(row_bytes * (*h))) == NULL){
-        image_free_png();
-        fclose(f);
-        return ERR_INTERNAL;
+
+    err = image_png_decode(f.data, f.size, info, *pixels, stride);
+    if (err != ERR_SUCCESS && owned) {
+        free(*pixels);
+        *pixels = NULL;
     }
-    for (i = 0; i < (png_uint_32)*h; i++) {
-        row_pointers[i] = *data + i*row_bytes;
+    px_vfs_close(&f);
+
+    return err;
+}
+
+static void image_batch_run(void* arg) {
+    PX_ImageJob* job = (PX_ImageJob*)arg;
+    job->err = image_png_load(job->path, &job->info, &job->pixels);
+}
+
+t_err_codes image_png_decode_batch(PX_ImageJob* jobs, int count) {
+    if (!jobs || count < 0)
+        return ERR_INTERNAL;
+
+    // Without the job system the decodes run one after another on this thread
+    PX_JobCounter done;
+    px_job_counter_init(&done);
+    for (int i = 0; i < count; i++)
+        px_job_run(&(PX_JobDesc){ image_batch_run, &jobs[i], PX_JOB_ANY_THREAD }, &done);
+    px_job_wait(&done);
+
+    for (int i = 0; i < count; i++) {
+        if (jobs[i].err != ERR_SUCCESS)
+            return jobs[i].err;
     }
-    png_read_image(png_ptr, row_pointers);
-    png_read_end(png_ptr, NULL);
-    fclose(f);
+    return ERR_SUCCESS;
+}
+
+t_err_codes image_get_png(const char* file, int* w, int* h, int* bit_depth, int* color_type, unsigned char** data) {
+    PX_ImageInfo info;
+    *data = NULL;
+
+    t_err_codes err = image_png_load(file, &info, data);
+    if (err != ERR_SUCCESS)
+        return err;
+
+    *w = info.width;
+    *h = info.height;
+    *bit_depth = info.bit_depth;
+    *color_type = info.color_type;
 
     return ERR_SUCCESS;
 }
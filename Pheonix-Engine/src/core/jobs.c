@@ -0,0 +1,620 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <core/jobs.h>
+#include <core/trace.h>
+#include <window-sys.h>
+#include <err-codes.h>
+
+#define JOB_RING_SIZE 4096 // jobs a worker allocates without the heap
+#define JOB_DEQUE_MASK (PX_JOB_DEQUE_SIZE - 1)
+#define JOB_SPIN 256 // looks for work this often before sleeping
+
+struct px_job {
+    px_job_fn fn;
+    void* arg;
+    // Parallel-for part, used instead of fn when range_fn is set
+    px_job_range_fn range_fn;
+    size_t begin, end, grain;
+
+    PX_JobAffinity affinity;
+    PX_JobCounter* counter;
+    struct px_job* next; // dependency waiters and the shared lists
+
+    atomic_int in_use; // ring slots only
+    bool heap;
+};
+
+// Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models"), fixed size: the owner pushes and pops at bottom, thieves
+// take from top
+struct job_deque {
+    _Alignas(64) atomic_int_fast64_t top;
+    _Alignas(64) atomic_int_fast64_t bottom;
+    _Atomic(struct px_job*) items[PX_JOB_DEQUE_SIZE];
+};
+
+struct job_worker {
+    int index;
+    pthread_t thread;
+    struct job_deque deque;
+
+    struct px_job* ring;
+    int ring_next;
+    uint32_t rng; // victim selection
+
+    _Alignas(64) atomic_uint_fast64_t jobs;
+    atomic_uint_fast64_t steals;
+    atomic_uint_fast64_t busy_ns;
+};
+
+struct job_list {
+    pthread_mutex_t lock;
+    struct px_job* head;
+    struct px_job* tail;
+};
+
+struct job_system {
+    bool running;
+    atomic_bool stopping;
+    struct job_worker* workers; // [0] is the thread that called px_jobs_init
+    int thread_count; // fixed while running, thieves read it without a lock
+    int started;
+
+    // Work from threads outside the system, and work only the main thread may run
+    struct job_list injected;
+    struct job_list main_queue;
+
+    // Jobs in deques and the injected list; sleepers wait for it to leave zero
+    atomic_int queued;
+    atomic_int sleepers;
+    pthread_mutex_t sleep_lock;
+    pthread_cond_t wake;
+
+    uint64_t stats_start_ns;
+};
+
+static struct job_system g_jobs = {
+    .injected = { .lock = PTHREAD_MUTEX_INITIALIZER },
+    .main_queue = { .lock = PTHREAD_MUTEX_INITIALIZER },
+    .sleep_lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER
+};
+static _Thread_local struct job_worker* t_worker = NULL;
+
+static uint64_t job_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int px_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1)
+        return 1;
+    if (n > PX_JOB_MAX_WORKERS)
+        return PX_JOB_MAX_WORKERS;
+    return (int)n;
+}
+
+// ===== Deque =====
+
+static bool deque_push(struct job_deque* d, struct px_job* job) {
+    int_fast64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    int_fast64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - t >= PX_JOB_DEQUE_SIZE)
+        return false;
+
+    // Release on the slot itself publishes the job's fields to whichever thief takes it
+    atomic_store_explicit(&d->items[b & JOB_DEQUE_MASK], job, memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return true;
+}
+
+static struct px_job* deque_pop(struct job_deque* d) {
+    int_fast64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int_fast64_t t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    struct px_job* job = atomic_load_explicit(&d->items[b & JOB_DEQUE_MASK], memory_order_relaxed);
+    if (t == b) {
+        // Last one, a thief may be after it too
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+            job = NULL;
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+static struct px_job* deque_steal(struct job_deque* d) {
+    int_fast64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int_fast64_t b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b)
+        return NULL;
+
+    struct px_job* job = atomic_load_explicit(&d->items[t & JOB_DEQUE_MASK], memory_order_acquire);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+        return NULL;
+    return job;
+}
+
+// ===== Lists =====
+
+static void list_push(struct job_list* l, struct px_job* job) {
+    job->next = NULL;
+    pthread_mutex_lock(&l->lock);
+    if (l->tail)
+        l->tail->next = job;
+    else
+        l->head = job;
+    l->tail = job;
+    pthread_mutex_unlock(&l->lock);
+}
+
+static struct px_job* list_pop(struct job_list* l) {
+    pthread_mutex_lock(&l->lock);
+    struct px_job* job = l->head;
+    if (job) {
+        l->head = job->next;
+        if (!l->head)
+            l->tail = NULL;
+        job->next = NULL;
+    }
+    pthread_mutex_unlock(&l->lock);
+    return job;
+}
+
+// ===== Jobs =====
+
+static void counter_lock(PX_JobCounter* c) {
+    while (atomic_flag_test_and_set_explicit(&c->lock, memory_order_acquire))
+        sched_yield();
+}
+
+static void counter_unlock(PX_JobCounter* c) {
+    atomic_flag_clear_explicit(&c->lock, memory_order_release);
+}
+
+static struct px_job* job_alloc(void) {
+    struct job_worker* w = t_worker;
+    if (w && w->ring) {
+        struct px_job* job = &w->ring[w->ring_next];
+        if (!atomic_load_explicit(&job->in_use, memory_order_acquire)) {
+            w->ring_next = (w->ring_next + 1) % JOB_RING_SIZE;
+            memset(job, 0, offsetof(struct px_job, in_use));
+            atomic_store_explicit(&job->in_use, 1, memory_order_relaxed);
+            job->heap = false;
+            return job;
+        }
+    }
+
+    // Threads outside the system, or a ring still full of unfinished jobs
+    struct px_job* job = (struct px_job*)calloc(1, sizeof(struct px_job));
+    if (job)
+        job->heap = true;
+    return job;
+}
+
+static void job_free(struct px_job* job) {
+    if (job->heap)
+        free(job);
+    else
+        atomic_store_explicit(&job->in_use, 0, memory_order_release);
+}
+
+static void job_wake(void) {
+    if (atomic_load(&g_jobs.sleepers) > 0) {
+        pthread_mutex_lock(&g_jobs.sleep_lock);
+        pthread_cond_signal(&g_jobs.wake);
+        pthread_mutex_unlock(&g_jobs.sleep_lock);
+    }
+}
+
+static void job_execute(struct job_worker* w, struct px_job* job);
+
+static void job_submit(struct px_job* job) {
+    if (!g_jobs.running) {
+        job_execute(t_worker, job);
+        return;
+    }
+
+    if (job->affinity == PX_JOB_MAIN_THREAD) {
+        list_push(&g_jobs.main_queue, job);
+        // The main loop pumps these after px_ws_wait_events, which may be asleep with nothing to wake it
+        px_ws_wake();
+        return;
+    }
+
+    struct job_worker* w = t_worker;
+    if (w) {
+        // A full deque means plenty of work is already out, doing this one now keeps memory bounded
+        if (!deque_push(&w->deque, job)) {
+            job_execute(w, job);
+            return;
+        }
+    } else {
+        list_push(&g_jobs.injected, job);
+    }
+
+    atomic_fetch_add(&g_jobs.queued, 1);
+    job_wake();
+}
+
+static void counter_finish(PX_JobCounter* c) {
+    // Everything touching the counter happens under its lock, so a waiter
+    // that saw zero can free it as soon as it gets the lock itself
+    counter_lock(c);
+    struct px_job* released = NULL;
+    if (atomic_fetch_sub(&c->pending, 1) == 1) {
+        released = c->waiters;
+        c->waiters = NULL;
+    }
+    counter_unlock(c);
+
+    while (released) {
+        struct px_job* next = released->next;
+        released->next = NULL;
+        job_submit(released);
+        released = next;
+    }
+}
+
+static void job_run_range(struct px_job* job) {
+    size_t begin = job->begin;
+    size_t end = job->end;
+
+    // Halves go back to the deque for thieves, this thread keeps the front
+    while (end - begin > job->grain) {
+        size_t mid = begin + (end - begin) / 2;
+        struct px_job* half = job_alloc();
+        if (!half)
+            break;
+        half->range_fn = job->range_fn;
+        half->arg = job->arg;
+        half->begin = mid;
+        half->end = end;
+        half->grain = job->grain;
+        half->counter = job->counter;
+        atomic_fetch_add(&job->counter->pending, 1);
+        job_submit(half);
+        end = mid;
+    }
+
+    job->range_fn(job->arg, begin, end);
+}
+
+static void job_execute(struct job_worker* w, struct px_job* job) {
+    uint64_t start = w ? job_now_ns() : 0;
+
+    if (job->range_fn)
+        job_run_range(job);
+    else
+        job->fn(job->arg);
+
+    if (w) {
+        atomic_fetch_add_explicit(&w->busy_ns, job_now_ns() - start, memory_order_relaxed);
+        atomic_fetch_add_explicit(&w->jobs, 1, memory_order_relaxed);
+    }
+
+    PX_JobCounter* counter = job->counter;
+    job_free(job);
+    if (counter)
+        counter_finish(counter);
+}
+
+static struct px_job* job_find(struct job_worker* w) {
+    struct px_job* job = NULL;
+    if (w && (job = deque_pop(&w->deque)))
+        goto taken;
+
+    if (w && w->index == 0 && (job = list_pop(&g_jobs.main_queue)))
+        return job; // never counted in queued
+
+    if ((job = list_pop(&g_jobs.injected)))
+        goto taken;
+
+    // Random first victim so thieves spread over the workers
+    uint32_t seed = w ? w->rng : (uint32_t)job_now_ns();
+    seed = seed * 1664525u + 1013904223u;
+    if (w)
+        w->rng = seed;
+    int n = g_jobs.thread_count;
+    int first = (int)((seed >> 16) % (uint32_t)n);
+    for (int i = 0; i < n; i++) {
+        struct job_worker* victim = &g_jobs.workers[(first + i) % n];
+        if (victim == w)
+            continue;
+        if ((job = deque_steal(&victim->deque))) {
+            if (w)
+                atomic_fetch_add_explicit(&w->steals, 1, memory_order_relaxed);
+            goto taken;
+        }
+    }
+    return NULL;
+
+taken:
+    atomic_fetch_sub(&g_jobs.queued, 1);
+    return job;
+}
+
+static void* job_worker_main(void* arg) {
+    struct job_worker* w = (struct job_worker*)arg;
+    t_worker = w;
+    PX_TRACE_THREAD("job worker");
+
+    for (;;) {
+        struct px_job* job = job_find(w);
+        if (job) {
+            job_execute(w, job);
+            continue;
+        }
+
+        int spins = 0;
+        // queued dips below zero while a thief beats the push to its increment
+        while (spins < JOB_SPIN && atomic_load(&g_jobs.queued) <= 0 && !atomic_load(&g_jobs.stopping))
+            spins++;
+        if (atomic_load(&g_jobs.queued) > 0)
+            continue;
+        if (atomic_load(&g_jobs.stopping))
+            break;
+
+        pthread_mutex_lock(&g_jobs.sleep_lock);
+        atomic_fetch_add(&g_jobs.sleepers, 1);
+        while (atomic_load(&g_jobs.queued) <= 0 && !atomic_load(&g_jobs.stopping))
+            pthread_cond_wait(&g_jobs.wake, &g_jobs.sleep_lock);
+        atomic_fetch_sub(&g_jobs.sleepers, 1);
+        pthread_mutex_unlock(&g_jobs.sleep_lock);
+    }
+
+    return NULL;
+}
+
+// ===== API =====
+
+t_err_codes px_jobs_init(int workers) {
+    if (g_jobs.running)
+        return ERR_SUCCESS;
+
+    if (workers <= 0)
+        workers = px_cpu_count() - 1;
+    if (workers < 1)
+        workers = 1;
+    if (workers > PX_JOB_MAX_WORKERS)
+        workers = PX_JOB_MAX_WORKERS;
+
+    g_jobs.workers = (struct job_worker*)aligned_alloc(64, sizeof(struct job_worker) * (workers + 1));
+    if (!g_jobs.workers)
+        return ERR_ALLOC_FAILED;
+    memset(g_jobs.workers, 0, sizeof(struct job_worker) * (workers + 1));
+
+    for (int i = 0; i <= workers; i++) {
+        struct job_worker* w = &g_jobs.workers[i];
+        w->index = i;
+        w->rng = 0x9E3779B9u * (uint32_t)(i + 1);
+        w->ring = (struct px_job*)calloc(JOB_RING_SIZE, sizeof(struct px_job));
+        if (!w->ring) {
+            for (int j = 0; j < i; j++)
+                free(g_jobs.workers[j].ring);
+            free(g_jobs.workers);
+            g_jobs.workers = NULL;
+            return ERR_ALLOC_FAILED;
+        }
+    }
+
+    atomic_store(&g_jobs.stopping, false);
+    atomic_store(&g_jobs.queued, 0);
+    g_jobs.thread_count = workers + 1;
+    g_jobs.started = 1;
+    g_jobs.stats_start_ns = job_now_ns();
+    g_jobs.running = true;
+    t_worker = &g_jobs.workers[0];
+
+    // A slot whose thread failed to start only ever has an empty deque
+    for (int i = 1; i <= workers; i++) {
+        if (pthread_create(&g_jobs.workers[i].thread, NULL, job_worker_main, &g_jobs.workers[i]) != 0)
+            break;
+        g_jobs.started++;
+    }
+
+    if (g_jobs.started == 1) {
+        px_jobs_shutdown();
+        return ERR_INTERNAL;
+    }
+
+    return ERR_SUCCESS;
+}
+
+void px_jobs_shutdown(void) {
+    if (!g_jobs.running)
+        return;
+
+    // Whatever is still queued runs before the workers go
+    struct px_job* job;
+    while ((job = job_find(t_worker)))
+        job_execute(t_worker, job);
+    px_jobs_pump_main();
+
+    pthread_mutex_lock(&g_jobs.sleep_lock);
+    atomic_store(&g_jobs.stopping, true);
+    pthread_cond_broadcast(&g_jobs.wake);
+    pthread_mutex_unlock(&g_jobs.sleep_lock);
+
+    for (int i = 1; i < g_jobs.started; i++)
+        pthread_join(g_jobs.workers[i].thread, NULL);
+
+    g_jobs.running = false;
+    for (int i = 0; i < g_jobs.thread_count; i++)
+        free(g_jobs.workers[i].ring);
+    free(g_jobs.workers);
+    g_jobs.workers = NULL;
+    g_jobs.thread_count = 0;
+    g_jobs.started = 0;
+    t_worker = NULL;
+}
+
+int px_jobs_worker_count(void) {
+    return g_jobs.running ? g_jobs.started - 1 : 0;
+}
+
+void px_job_counter_init(PX_JobCounter* counter) {
+    atomic_init(&counter->pending, 0);
+    atomic_flag_clear(&counter->lock);
+    counter->waiters = NULL;
+}
+
+bool px_job_done(PX_JobCounter* counter) {
+    if (atomic_load(&counter->pending) > 0)
+        return false;
+
+    // The last job may still be inside counter_finish
+    counter_lock(counter);
+    counter_unlock(counter);
+    return true;
+}
+
+void px_job_run(const PX_JobDesc* desc, PX_JobCounter* counter) {
+    px_job_run_after(desc, NULL, counter);
+}
+
+void px_job_run_after(const PX_JobDesc* desc, PX_JobCounter* dependency, PX_JobCounter* counter) {
+    if (!desc || !desc->fn)
+        return;
+
+    if (counter)
+        atomic_fetch_add(&counter->pending, 1);
+
+    struct px_job* job = g_jobs.running ? job_alloc() : NULL;
+    if (!job) {
+        // Inline (or out of memory): dependencies are honoured by waiting for them here
+        if (dependency)
+            px_job_wait(dependency);
+        desc->fn(desc->arg);
+        if (counter)
+            counter_finish(counter);
+        return;
+    }
+    job->fn = desc->fn;
+    job->arg = desc->arg;
+    job->affinity = desc->affinity;
+    job->counter = counter;
+
+    if (dependency) {
+        counter_lock(dependency);
+        if (atomic_load(&dependency->pending) > 0) {
+            job->next = dependency->waiters;
+            dependency->waiters = job;
+            counter_unlock(dependency);
+            return;
+        }
+        counter_unlock(dependency);
+    }
+
+    job_submit(job);
+}
+
+void px_job_wait(PX_JobCounter* counter) {
+    PX_TRACE_SCOPE("px_job_wait");
+    struct job_worker* w = t_worker;
+
+    while (atomic_load(&counter->pending) > 0) {
+        struct px_job* job = g_jobs.running ? job_find(w) : NULL;
+        if (job)
+            job_execute(w, job);
+        else
+            sched_yield();
+    }
+
+    counter_lock(counter);
+    counter_unlock(counter);
+}
+
+void px_job_parallel_for(size_t count, size_t grain, px_job_range_fn fn, void* ctx) {
+    if (!fn || count == 0)
+        return;
+
+    if (grain == 0) {
+        size_t parts = (size_t)(g_jobs.running ? g_jobs.thread_count : 1) * PX_JOB_GRAIN_SPLIT;
+        grain = (count + parts - 1) / parts;
+    }
+    if (!g_jobs.running || count <= grain) {
+        fn(ctx, 0, count);
+        return;
+    }
+
+    PX_JobCounter done;
+    px_job_counter_init(&done);
+
+    struct px_job* job = job_alloc();
+    if (!job) {
+        fn(ctx, 0, count);
+        return;
+    }
+    job->range_fn = fn;
+    job->arg = ctx;
+    job->begin = 0;
+    job->end = count;
+    job->grain = grain;
+    job->counter = &done;
+    atomic_fetch_add(&done.pending, 1);
+
+    // The caller starts splitting right away instead of waiting for a thief
+    job_execute(t_worker, job);
+    px_job_wait(&done);
+}
+
+int px_jobs_pump_main(void) {
+    if (!g_jobs.running || t_worker != &g_jobs.workers[0])
+        return 0;
+
+    int ran = 0;
+    struct px_job* job;
+    while ((job = list_pop(&g_jobs.main_queue))) {
+        job_execute(t_worker, job);
+        ran++;
+    }
+    return ran;
+}
+
+void px_jobs_stats(PX_JobStats* out) {
+    memset(out, 0, sizeof(*out));
+    if (!g_jobs.running)
+        return;
+
+    out->thread_count = g_jobs.thread_count;
+    out->elapsed_ns = job_now_ns() - g_jobs.stats_start_ns;
+    for (int i = 0; i < g_jobs.thread_count; i++) {
+        struct job_worker* w = &g_jobs.workers[i];
+        out->threads[i].jobs = atomic_load_explicit(&w->jobs, memory_order_relaxed);
+        out->threads[i].steals = atomic_load_explicit(&w->steals, memory_order_relaxed);
+        out->threads[i].busy_ns = atomic_load_explicit(&w->busy_ns, memory_order_relaxed);
+    }
+}
+
+void px_jobs_reset_stats(void) {
+    if (!g_jobs.running)
+        return;
+
+    for (int i = 0; i < g_jobs.thread_count; i++) {
+        struct job_worker* w = &g_jobs.workers[i];
+        atomic_store_explicit(&w->jobs, 0, memory_order_relaxed);
+        atomic_store_explicit(&w->steals, 0, memory_order_relaxed);
+        atomic_store_explicit(&w->busy_ns, 0, memory_order_relaxed);
+    }
+    g_jobs.stats_start_ns = job_now_ns();
+}
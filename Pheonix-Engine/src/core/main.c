@@ -1,8 +1,12 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 
 #include <err-codes.h>
 #include <window-sys.h>
@@ -11,17 +15,68 @@
 #include <font.h>
 #include <editor.h>
 #include <event.h>
+#include <asset-sys/cooker.h>
+#include <asset-sys/pack.h>
+#include <asset-sys/vfs.h>
+#include <asset-sys/loader.h>
+#include <core/trace.h>
+#include <core/alloc-stats.h>
+#include <core/frame-sched.h>
+#include <core/jobs.h>
+#include <loaders/sdf-loader.h>
+#include <external/cJSON.h>
 
 typedef struct {
     bool valid;
     bool build_psdf;
     char* build_psdf_json;
     char* build_psdf_out;
+    bool cook;
+    char* cook_dir;
+    int cook_jobs;
+    bool cook_force;
+    bool build_pack;
+    char* build_pack_out;
+    int splash_min_ms;
+    bool benchmark;
+    int benchmark_frames;
+    int benchmark_objects;
+    int benchmark_depth;
+    double benchmark_budget_ms;
+    char* benchmark_json;
+    PX_WS_SwapInterval vsync;
+    int fps_cap;
+    int unfocused_fps;
+    bool render_thread;
     bool help;
 } t_args;
 
 // Main
 static bool engine_running = false;
+static PX_FrameSched engine_frame_sched = {0};
+// Asset Cooking
+static const PX_SDFBuildDesc engine_psdf_desc = {
+    .pixel_size = 64, // 128 - HIGH DPI
+    .atlas_size = 512, // 1024 - EXT
+    .sdf_range = 8, // 16 - EXT
+    .ascii_only = true // false - EXT
+};
+static const PX_PTexBuildDesc engine_ptex_desc = {
+    .premultiply = true,
+    .mipmaps = true,
+    .compress = false,
+    .bgra = false
+};
+static const char* engine_pack_roots[] = { "assets", "shaders" };
+// Splash
+static const char* engine_splash_image = "assets/icons/logo.png";
+// Benchmark
+#define ENGINE_BENCH_WARMUP_FRAMES 30
+#define ENGINE_BENCH_SCRIPT_PERIOD 120
+#define ENGINE_BENCH_LABEL_MAX 64
+#define ENGINE_BENCH_MENUS 16
+#define ENGINE_BENCH_MENU_OPTIONS 16
+static const char* engine_font_ui_path = "assets/fonts/psdf/roboto.psdf";
 // Window Info
 static int engine_window_main_w = 1000;
 static int engine_window_main_h = 800;
@@ -47,18 +102,31 @@ static PX_Font* engine_font_ui = NULL;
 // Mouse Info
 static int engine_mouse_x = 0;
 static int engine_mouse_y = 0;
+#define ENGINE_SCROLL_ROWS 3 // per wheel step
 // Rendering Objects
 static PX_Dropdown engine_menu_dropdown = {0};
 // Colors
 static PX_Color4 engine_ui_black_panel_color = (PX_Color4){0x1A, 0x1A, 0x1A, 0xFF};
-// Identifiers
-static PX_Event_Identifier engine_obj_identifiers[10];
-static int engine_obj_identifier_count = 0;
 
 static void print_help(void) {
     printf("Usage: pheonix-engine [--COMMANDS]\n");
     printf("Commands:\n");
     printf("\tbuild-psdf <.json file containing SDF info> <output PSDF path>: Builds PSDF files from SDF files\n");
+    printf("\tcook <asset dir>: Cooks every out of date asset under the directory (and shaders/)\n");
+    printf("\t\tjobs <n>: Number of cooking threads (default: one per core)\n");
+    printf("\t\tforce: Cook everything, ignoring the cook manifest\n");
+    printf("\tbuild-pack <output>: Packs assets/ and shaders/ into a single asset pack\n");
+    printf("\tsplash-min-ms <ms>: Keeps the splash screen up for at least this long (default: 0)\n");
+    printf("\tvsync <on|off|adaptive>: Swap interval, adaptive tears instead of stalling on late frames (default: on)\n");
+    printf("\tfps-cap <n>: Draws at most this many frames per second (default: 0, no cap)\n");
+    printf("\tunfocused-fps <n>: Frame rate while another window has focus (default: %d)\n", PX_FRAME_UNFOCUSED_FPS);
+    printf("\trender-thread: Draws and swaps on a thread of its own while the main thread handles input\n");
+    printf("\tbenchmark: Runs the editor headless on a synthetic scene and reports frame statistics\n");
+    printf("\t\tframes <n>: Frames to measure (default: 600)\n");
+    printf("\t\tobjects <n>: Objects in the synthetic scene tree (default: 200)\n");
+    printf("\t\tdepth <n>: Deepest nesting level of the scene tree (default: 6)\n");
+    printf("\t\tbudget-ms <ms>: Fails when the 99th percentile frame time is above this\n");
+    printf("\t\tjson <path>: Also writes the report as JSON\n");
     printf("\thelp: Prints this help message\n");
 }
 
@@ -68,7 +136,24 @@ static void parse_args(t_args* args, int argc, char** argv) {
     args->build_psdf = false;
     args->build_psdf_json = NULL;
     args->build_psdf_out = NULL;
-    
+    args->cook = false;
+    args->cook_dir = NULL;
+    args->cook_jobs = 0;
+    args->cook_force = false;
+    args->build_pack = false;
+    args->build_pack_out = NULL;
+    args->splash_min_ms = 0;
+    args->benchmark = false;
+    args->benchmark_frames = 600;
+    args->benchmark_objects = 200;
+    args->benchmark_depth = 6;
+    args->benchmark_budget_ms = 0.0;
+    args->benchmark_json = NULL;
+    args->vsync = PX_WS_VSYNC_ON;
+    args->fps_cap = 0;
+    args->unfocused_fps = PX_FRAME_UNFOCUSED_FPS;
+    args->render_thread = false;
+
     for (int i = 1; i < argc; i++) {
         char* opt = argv[i];
 
@@ -85,6 +170,109 @@ static void parse_args(t_args* args, int argc, char** argv) {
             args->build_psdf_json = argv[i + 1];
             args->build_psdf_out = argv[i + 2];
             i += 2;
+        } else if (strcmp(opt, "--cook") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Usage: pheonix-engine --cook <asset dir>\n\tUse --help for more info!\n");
+                args->valid = false;
+                break;
+            }
+
+            args->cook = true;
+            args->cook_dir = argv[i + 1];
+            i += 1;
+        } else if (strcmp(opt, "--jobs") == 0) {
+            if (i + 1 >= argc || atoi(argv[i + 1]) < 1) {
+                fprintf(stderr, "Usage: pheonix-engine --cook <asset dir> --jobs <n>\n\tUse --help for more info!\n");
+                args->valid = false;
+                break;
+            }
+
+            args->cook_jobs = atoi(argv[i + 1]);
+            i += 1;
+        } else if (strcmp(opt, "--force") == 0) {
+            args->cook_force = true;
+        } else if (strcmp(opt, "--build-pack") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Usage: pheonix-engine --build-pack <output>\n\tUse --help for more info!\n");
+                args->valid = false;
+                break;
+            }
+
+            args->build_pack = true;
+            args->build_pack_out = argv[i + 1];
+            i += 1;
+        } else if (strcmp(opt, "--splash-min-ms") == 0) {
+            if (i + 1 >= argc || atoi(argv[i + 1]) < 0) {
+                fprintf(stderr, "Usage: pheonix-engine --splash-min-ms <ms>\n\tUse --help for more info!\n");
+                args->valid = false;
+                break;
+            }
+
+            args->splash_min_ms = atoi(argv[i + 1]);
+            i += 1;
+        } else if (strcmp(opt, "--vsync") == 0) {
+            const char* mode = i + 1 < argc ? argv[i + 1] : "";
+            if (strcmp(mode, "on") == 0)
+                args->vsync = PX_WS_VSYNC_ON;
+            else if (strcmp(mode, "off") == 0)
+                args->vsync = PX_WS_VSYNC_OFF;
+            else if (strcmp(mode, "adaptive") == 0)
+                args->vsync = PX_WS_VSYNC_ADAPTIVE;
+            else {
+                fprintf(stderr, "Usage: pheonix-engine --vsync <on|off|adaptive>\n\tUse --help for more info!\n");
+                args->valid = false;
+                break;
+            }
+            i += 1;
+        } else if (strcmp(opt, "--fps-cap") == 0 || strcmp(opt, "--unfocused-fps") == 0) {
+            if (i + 1 >= argc || atoi(argv[i + 1]) < 0) {
+                fprintf(stderr, "Usage: pheonix-engine %s <n>\n\tUse --help for more info!\n", opt);
+                args->valid = false;
+                break;
+            }
+
+            if (strcmp(opt, "--fps-cap") == 0)
+                args->fps_cap = atoi(argv[i + 1]);
+            else
+                args->unfocused_fps = atoi(argv[i + 1]);
+            i += 1;
+        } else if (strcmp(opt, "--render-thread") == 0) {
+            args->render_thread = true;
+        } else if (strcmp(opt, "--benchmark") == 0) {
+            args->benchmark = true;
+        } else if (strcmp(opt, "--frames") == 0 || strcmp(opt, "--objects") == 0 || strcmp(opt, "--depth") == 0) {
+            if (i + 1 >= argc || atoi(argv[i + 1]) < 1) {
+                fprintf(stderr, "Usage: pheonix-engine --benchmark %s <n>\n\tUse --help for more info!\n", opt);
+                args->valid = false;
+                break;
+            }
+
+            int value = atoi(argv[i + 1]);
+            if (strcmp(opt, "--frames") == 0)
+                args->benchmark_frames = value;
+            else if (strcmp(opt, "--objects") == 0)
+                args->benchmark_objects = value;
+            else
+                args->benchmark_depth = value;
+            i += 1;
+        } else if (strcmp(opt, "--budget-ms") == 0) {
+            if (i + 1 >= argc || atof(argv[i + 1]) <= 0.0) {
+                fprintf(stderr, "Usage: pheonix-engine --benchmark --budget-ms <ms>\n\tUse --help for more info!\n");
+                args->valid = false;
+                break;
+            }
+
+            args->benchmark_budget_ms = atof(argv[i + 1]);
+            i += 1;
+        } else if (strcmp(opt, "--json") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Usage: pheonix-engine --benchmark --json <path>\n\tUse --help for more info!\n");
+                args->valid = false;
+                break;
+            }
+
+            args->benchmark_json = argv[i + 1];
+            i += 1;
         } else {
             fprintf(stderr, "Usage: pheonix-engine [--COMMANDS]\n\tUse --help for more info!\n");
             args->valid = false;
@@ -93,118 +281,91 @@ static void parse_args(t_args* args, int argc, char** argv) {
     }
 }
 
-static char* enginef_helper_strdup(const char* s) {
-    char* out = (char*)malloc(strlen(s) + 1);
-    if (!out)
-        return NULL;
-
-    strcpy(out, s);
-    out[strlen(s) + 1] = '\0';
-    return out;
-}
-
 static void enginef_cleanup(void) {
-    for (int i = 0; i < engine_menu_dropdown.item_count; i++) {
-        if (engine_menu_dropdown.items[i].label)
-            free(engine_menu_dropdown.items[i].label);
-
-        for (int j = 0; j < engine_menu_dropdown.items[i].option_count; j++) {
-            if (engine_menu_dropdown.items[i].options[j].label)
-                free(engine_menu_dropdown.items[i].options[j].label);
-        }
-    }
-
+    // Takes the context back before anything GL is freed
+    px_rs_stop_render_thread();
+
+    PX_WS_LatencyStats latency;
+    px_ws_input_latency(&engine_window_main, &latency);
+    if (latency.frames > 0)
+        printf("Input latency: p50 %.2f ms, p99 %.2f ms, max %.2f ms over %llu frames\n",
+               latency.p50_ms, latency.p99_ms, latency.max_ms, (unsigned long long)latency.frames);
+
+    px_rs_dropdown_free(&engine_menu_dropdown);
+    editor_scene_free(&editor_get_state()->scene);
+    editor_hierarchy_free(&editor_get_state()->hierarchy);
+    free(editor_get_state()->project_path);
+    editor_get_state()->project_path = NULL;
+
+    px_loader_shutdown();
+    px_jobs_shutdown();
     px_font_destroy(engine_font_ui);
     px_rs_shutdown_ui();
     px_ws_destroy(&engine_window_main);
     px_ws_shutdown();
+    px_vfs_unmount();
+    px_trace_shutdown();
+}
+
+// Appends an item to the menubar, the layout puts it after the previous one
+static void enginef_add_dropdown_item(const char* label, const char** options, int option_count) {
+    PX_DropdownItem* item = px_rs_dropdown_add_item(&engine_menu_dropdown, label, options, option_count);
+    if (!item) {
+        fprintf(stderr, "Failed to add menu %s\n", label);
+        return;
+    }
+
+    item->panel_color = engine_ui_black_panel_color;
+    item->hover_color = (PX_Color4){0xD4, 0xD4, 0xD4, 0xFF};
+    item->text_color = (PX_Color4){0xFF, 0xFF, 0xFF, 0xFF};
+    item->panel_noise = 0.03f;
+    item->panel_cradius = 16.0f;
 }
 
 static void enginef_init_dropdowns(void) {
     engine_menu_dropdown.font = engine_font_ui;
     engine_menu_dropdown.font_size = 16.0f;
+    engine_menu_dropdown.option_font_size = 14.0f;
     engine_menu_dropdown.pos = (PX_Vector2){0, 0};
     engine_menu_dropdown.width = engine_window_main_w;
     engine_menu_dropdown.height = 30;
     engine_menu_dropdown.color = engine_ui_black_panel_color;
     engine_menu_dropdown.hover_color = (PX_Color4){0xD4, 0xD4, 0xD4, 0xD4};
     engine_menu_dropdown.text_color = (PX_Color4){0xFF, 0xFF, 0xFF, 0xFF};
-    engine_menu_dropdown.hover_index = -1;
-    engine_menu_dropdown.item_count = 4;
     engine_menu_dropdown.stext_pos = (PX_Vector2){4, 8};
     engine_menu_dropdown.spacing = 64;
     engine_menu_dropdown.noise = 0.03f;
     engine_menu_dropdown.cradius = 0.0f;
+    if (px_rs_dropdown_init(&engine_menu_dropdown) != ERR_SUCCESS)
+        fprintf(stderr, "Failed to lay out the menu bar\n");
 
-    const char* menu_labels[] = {"File", "Edit", "View", "Help"};
     const char* file_menu[] = {"New", "Open", "Save", "Save As", "Exit"};
     const char* edit_menu[] = {"Undo", "Redo"};
     const char* view_menu[] = {"Fullscreen"};
     const char* help_menu[] = {"About"};
 
-    engine_menu_dropdown.items[0].option_count = 5;
-    engine_menu_dropdown.items[1].option_count = 2;
-    engine_menu_dropdown.items[2].option_count = 1;
-    engine_menu_dropdown.items[3].option_count = 1;
-
-    int x = engine_menu_dropdown.stext_pos.x;
-    for (int i = 0; i < 4; i++) {
-        PX_DropdownItem* item = &engine_menu_dropdown.items[i];
-        item->label = enginef_helper_strdup(menu_labels[i]);
-        item->height = 16;
-        item->width = px_rs_text_width(engine_font_ui, menu_labels[i], engine_menu_dropdown.font_size);
-        item->spacing = 16;
-        item->font_size = 14.0f;;
-        item->panel_color = engine_ui_black_panel_color;
-        item->hover_color = (PX_Color4){0xD4, 0xD4, 0xD4, 0xFF};
-        item->text_color = (PX_Color4){0xFF, 0xFF, 0xFF, 0xFF};
-        item->is_open = false;
-        item->hover_index = -1;
-        item->panel_noise = 0.03f;
-        item->panel_cradius = 16.0f;
-        item->panel_tran = (PX_Transform2){
-            (PX_Vector2){x, 32},
-            (PX_Scale2){100, item->spacing * item->option_count + 16}
-        };
-        item->stext_pos = (PX_Vector2){x + 6, 42};
-
-        x += engine_menu_dropdown.spacing + px_rs_text_width(engine_menu_dropdown.font, item->label, engine_menu_dropdown.font_size);
-
-        for (int j = 0; j < item->option_count; j++) {
-            PX_DropdownOption* option = &item->options[j];
-            const char** labels;
-
-            switch(i) {
-                case 0: labels = file_menu; break;
-                case 1: labels = edit_menu; break;
-                case 2: labels = view_menu; break;
-                case 3: labels = help_menu; break;
-                default: break;
-            }
-
-            option->label = enginef_helper_strdup(labels[j]);
-            option->height = 8;
-            option->width = px_rs_text_width(engine_font_ui, labels[j], engine_menu_dropdown.font_size);
-        }
-    }
-
-    engine_obj_identifiers[engine_obj_identifier_count++] = (PX_Event_Identifier){
-        .ptr = (void*)&engine_menu_dropdown,
-        .identifier = "menubar"
-    };
+    enginef_add_dropdown_item("File", file_menu, 5);
+    enginef_add_dropdown_item("Edit", edit_menu, 2);
+    enginef_add_dropdown_item("View", view_menu, 1);
+    enginef_add_dropdown_item("Help", help_menu, 1);
 }
 
 static void enginef_event_mouse_click(void) {
+    PX_TRACE_SCOPE("enginef_event_mouse_click");
     // Dropdowns
     event_click_dropdown(&engine_menu_dropdown);
+    // Scene Panel
+    editor_scene_panel_click((PX_Vector2){engine_mouse_x, engine_mouse_y});
 }
 
 static void enginef_event_hover_check(void) {
+    PX_TRACE_SCOPE("enginef_event_hover_check");
     // Dropdowns
     event_hover_dropdown(&engine_menu_dropdown);
 }
 
 static void enginef_core_render(void) {
+    PX_TRACE_SCOPE("enginef_core_render");
     // Core call
     px_rs_frame_start();
 
@@ -220,12 +381,13 @@ static void enginef_core_render(void) {
     );
 
     // Dropdowns
-    engine_menu_dropdown.width = engine_window_main_w;
+    px_rs_dropdown_resize(&engine_menu_dropdown, engine_window_main_w);
     px_rs_draw_dropdown(&engine_menu_dropdown);
 }
 
-static void enginef_core_handle_core_signals(PX_Event_GSignal* core_signal, bool core_signal_active) {
-    if (!core_signal || !core_signal_active) return;
+static void enginef_core_handle_core_signals(const PX_Event_GSignal* core_signal, void* user) {
+    PX_TRACE_SCOPE("enginef_core_handle_core_signals");
+    (void)user;
 
     switch (core_signal->type) {
         case EVENT_GSIGNAL_CORE_QUIT:
@@ -235,7 +397,368 @@ static void enginef_core_handle_core_signals(PX_Event_GSignal* core_signal, bool
     }
 }
 
+static void enginef_pump_loader(void) {
+    px_loader_pump(PX_LOADER_FRAME_BUDGET_MS);
+}
+
+static void enginef_core_update(void) {
+    // Global Signals, before drawing so the frame shows what they changed
+    event_dispatch_gsignals();
+
+    px_rs_ui_frame_update();
+    // World matrices of whatever moved since the last frame
+    editor_scene_update_transforms(&editor_get_state()->scene);
+    enginef_core_render();
+    enginef_event_hover_check();
+}
+
+static void enginef_handle_wevent(const PX_WEvent* ev) {
+    switch (ev->type) {
+        case PX_WE_CLOSE: engine_running = false; break;
+        case PX_WE_RESIZE:
+            engine_window_main_w = ev->w;
+            engine_window_main_h = ev->h;
+            engine_window_main.width = ev->w;
+            engine_window_main.height = ev->h;
+            px_rs_ui_resize((PX_Scale2){ev->w, ev->h});
+            event_resize((PX_Scale2){ev->w, ev->h});
+            break;
+        case PX_WE_MOUSE_MOVE:
+            engine_mouse_x = ev->x;
+            engine_mouse_y = ev->y;
+            event_mouse_move((PX_Vector2){ev->x, ev->y});
+            break;
+        case PX_WE_MOUSE_DOWN:
+            if (ev->keycode == EKeycode_MouseScrollUp || ev->keycode == EKeycode_MouseScrollDown)
+                editor_scene_panel_scroll((PX_Vector2){engine_mouse_x, engine_mouse_y},
+                                          ev->keycode == EKeycode_MouseScrollUp ? -ENGINE_SCROLL_ROWS : ENGINE_SCROLL_ROWS);
+            else
+                enginef_event_mouse_click();
+            break;
+        case PX_WE_FOCUS_IN: px_frame_sched_set_focus(&engine_frame_sched, true); break;
+        case PX_WE_FOCUS_OUT: px_frame_sched_set_focus(&engine_frame_sched, false); break;
+        case PX_WE_SHOWN: px_frame_sched_set_visible(&engine_frame_sched, true); break;
+        case PX_WE_HIDDEN: px_frame_sched_set_visible(&engine_frame_sched, false); break;
+        case PX_WE_KEYDOWN:
+            if (ev->keycode == EKeycode_F12)
+                px_trace_dump(PX_TRACE_DEFAULT_PATH);
+            break;
+        default: break;
+    }
+}
+
+// Benchmark
+struct engine_bench_frame {
+    uint64_t ns;
+    uint64_t allocs;
+    uint64_t alloc_bytes;
+    PX_RSFrameStats rs;
+};
+
+static uint64_t enginef_bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Glyphs only, there is no context to upload the atlas to
+static PX_Font* enginef_bench_load_font(const char* path) {
+    struct px_sdf_font_source src;
+    if (px_sdf_read(path, &src) != ERR_SUCCESS)
+        return NULL;
+
+    struct px_sdf_font_data sdf;
+    px_sdf_source_finish(&src, 0, &sdf);
+    PX_Font* font = px_sdf_font_create(&sdf);
+    if (!font)
+        free(sdf.glyphs);
+    return font;
+}
+
+// Fills the rest of the menubar, every menu as tall as allowed with long option labels
+static void enginef_bench_wide_menus(void) {
+    char label[ENGINE_BENCH_LABEL_MAX];
+    char option_text[ENGINE_BENCH_MENU_OPTIONS][ENGINE_BENCH_LABEL_MAX];
+    const char* options[ENGINE_BENCH_MENU_OPTIONS];
+
+    while (engine_menu_dropdown.item_count < ENGINE_BENCH_MENUS) {
+        int index = engine_menu_dropdown.item_count;
+        snprintf(label, sizeof(label), "Menu %d", index);
+        for (int j = 0; j < ENGINE_BENCH_MENU_OPTIONS; j++) {
+            snprintf(option_text[j], sizeof(option_text[j]), "Synthetic option %d of menu %d with a long label", j, index);
+            options[j] = option_text[j];
+        }
+        int count = engine_menu_dropdown.item_count;
+        enginef_add_dropdown_item(label, options, ENGINE_BENCH_MENU_OPTIONS);
+        if (engine_menu_dropdown.item_count == count)
+            break;
+    }
+}
+
+// Object i sits at depth i % depth, under the latest object one level up
+static t_err_codes enginef_bench_populate(int count, int depth) {
+    char name[ENGINE_BENCH_LABEL_MAX];
+    PX_EditorHandle* last = (PX_EditorHandle*)calloc(depth, sizeof(PX_EditorHandle));
+    if (!last)
+        return ERR_ALLOC_FAILED;
+
+    for (int i = 0; i < count; i++) {
+        int level = i % depth;
+        snprintf(name, sizeof(name), "Synthetic object %d at depth %d", i, level);
+        last[level] = editor_add_object(level == 0 ? PX_EDITOR_NULL_HANDLE : last[level - 1], name);
+        if (last[level] == PX_EDITOR_NULL_HANDLE) {
+            free(last);
+            return ERR_ALLOC_FAILED;
+        }
+    }
+
+    free(last);
+    return ERR_SUCCESS;
+}
+
+// Middle of a laid out rect, off screen when it is hidden
+static PX_Vector2 enginef_bench_center(PX_LayoutNode node) {
+    PX_Transform2 r;
+    if (!px_layout_rect(node, &r))
+        return (PX_Vector2){-1, -1};
+    return (PX_Vector2){r.pos.x + r.scale.w / 2, r.pos.y + r.scale.h / 2};
+}
+
+static void enginef_bench_mouse(int x, int y, bool click) {
+    PX_WEvent ev = {0};
+    ev.type = PX_WE_MOUSE_MOVE;
+    ev.x = x;
+    ev.y = y;
+    enginef_handle_wevent(&ev);
+
+    if (click) {
+        ev.type = PX_WE_MOUSE_DOWN;
+        enginef_handle_wevent(&ev);
+    }
+}
+
+// Each period sweeps the menubar, opens the next menu, hovers down its
+// options, picks the first one (never Exit) and then wanders over the scene
+// panel, scrolling it and toggling whichever row is under the pointer halfway
+static void enginef_bench_script(int frame) {
+    PX_Dropdown* dd = &engine_menu_dropdown;
+    int phase = frame % ENGINE_BENCH_SCRIPT_PERIOD;
+    PX_DropdownItem* item = &dd->items[(frame / ENGINE_BENCH_SCRIPT_PERIOD) % dd->item_count];
+
+    if (phase < 40) {
+        enginef_bench_mouse(phase * engine_window_main_w / 40, dd->height / 2, false);
+    } else if (phase == 40) {
+        PX_Vector2 p = enginef_bench_center(item->node);
+        enginef_bench_mouse(p.x, p.y, true);
+    } else if (phase < 80) {
+        int option = phase == 79 ? 0 : (phase - 41) % item->option_count;
+        PX_Vector2 p = enginef_bench_center(item->options[option].node);
+        enginef_bench_mouse(p.x, p.y, phase == 79);
+    } else {
+        int t = phase - 80;
+        int span = ENGINE_BENCH_SCRIPT_PERIOD - 80;
+        int x = t * (engine_window_main_w / 4) / span;
+        int y = dd->height + t * (engine_window_main_h - dd->height) / span;
+        enginef_bench_mouse(x, y, t == span / 2);
+        // Down the scene panel and back up
+        if (t % 4 == 0) {
+            PX_WEvent ev = {0};
+            ev.type = PX_WE_MOUSE_DOWN;
+            ev.keycode = t < span / 2 ? EKeycode_MouseScrollDown : EKeycode_MouseScrollUp;
+            enginef_handle_wevent(&ev);
+        }
+    }
+}
+
+static int enginef_bench_cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double enginef_bench_percentile_ms(const uint64_t* sorted, int count, double p) {
+    int index = (int)(p * count);
+    if (index >= count)
+        index = count - 1;
+    return (double)sorted[index] / 1e6;
+}
+
+static cJSON* enginef_bench_json_range(cJSON* parent, const char* name, double mean, double max) {
+    cJSON* o = cJSON_AddObjectToObject(parent, name);
+    cJSON_AddNumberToObject(o, "mean", mean);
+    cJSON_AddNumberToObject(o, "max", max);
+    return o;
+}
+
+static t_err_codes enginef_bench_report(const t_args* args, const struct engine_bench_frame* frames, int count) {
+    uint64_t* sorted = (uint64_t*)malloc(sizeof(uint64_t) * count);
+    if (!sorted)
+        return ERR_ALLOC_FAILED;
+
+    double sum_ns = 0.0, sum_allocs = 0.0, sum_alloc_bytes = 0.0, sum_draws = 0.0, sum_upload = 0.0;
+    uint64_t max_allocs = 0, max_alloc_bytes = 0;
+    int max_draws = 0, max_vertices = 0, max_dropped = 0;
+    size_t max_upload = 0;
+    for (int i = 0; i < count; i++) {
+        const struct engine_bench_frame* f = &frames[i];
+        sorted[i] = f->ns;
+        sum_ns += (double)f->ns;
+        sum_allocs += (double)f->allocs;
+        sum_alloc_bytes += (double)f->alloc_bytes;
+        sum_draws += f->rs.draw_calls;
+        sum_upload += (double)f->rs.bytes_uploaded;
+        if (f->allocs > max_allocs) max_allocs = f->allocs;
+        if (f->alloc_bytes > max_alloc_bytes) max_alloc_bytes = f->alloc_bytes;
+        if (f->rs.draw_calls > max_draws) max_draws = f->rs.draw_calls;
+        if (f->rs.vertices > max_vertices) max_vertices = f->rs.vertices;
+        if (f->rs.dropped_quads > max_dropped) max_dropped = f->rs.dropped_quads;
+        if (f->rs.bytes_uploaded > max_upload) max_upload = f->rs.bytes_uploaded;
+    }
+    qsort(sorted, count, sizeof(uint64_t), enginef_bench_cmp_u64);
+
+    double p50 = enginef_bench_percentile_ms(sorted, count, 0.50);
+    double p90 = enginef_bench_percentile_ms(sorted, count, 0.90);
+    double p99 = enginef_bench_percentile_ms(sorted, count, 0.99);
+    double max_ms = (double)sorted[count - 1] / 1e6;
+    double mean_ms = sum_ns / count / 1e6;
+    free(sorted);
+
+    printf("Benchmark: %d frames, %d objects %d deep, %d menus, %dx%d headless\n",
+           count, args->benchmark_objects, args->benchmark_depth, engine_menu_dropdown.item_count, engine_window_main_w, engine_window_main_h);
+    printf("\tframe time:   p50 %.3f ms  p90 %.3f ms  p99 %.3f ms  max %.3f ms  mean %.3f ms\n", p50, p90, p99, max_ms, mean_ms);
+#ifdef PX_ALLOC_STATS
+    printf("\tallocations:  %.1f per frame (max %llu), %.0f bytes per frame (max %llu)\n",
+           sum_allocs / count, (unsigned long long)max_allocs, sum_alloc_bytes / count, (unsigned long long)max_alloc_bytes);
+#else
+    printf("\tallocations:  not counted (build with ALLOC_STATS=1)\n");
+#endif
+    printf("\tdraw calls:   %.1f per frame (max %d)\n", sum_draws / count, max_draws);
+    printf("\tuploaded:     %.0f bytes per frame (max %zu), up to %d vertices\n", sum_upload / count, max_upload, max_vertices);
+    if (max_dropped > 0)
+        printf("\tWarning: up to %d quads per frame did not fit in the vertex buffer\n", max_dropped);
+
+    t_err_codes result = ERR_SUCCESS;
+    if (args->benchmark_json) {
+        cJSON* root = cJSON_CreateObject();
+        cJSON_AddNumberToObject(root, "frames", count);
+        cJSON_AddNumberToObject(root, "objects", args->benchmark_objects);
+        cJSON_AddNumberToObject(root, "depth", args->benchmark_depth);
+        cJSON_AddNumberToObject(root, "menus", engine_menu_dropdown.item_count);
+        cJSON* frame_ms = cJSON_AddObjectToObject(root, "frame_ms");
+        cJSON_AddNumberToObject(frame_ms, "p50", p50);
+        cJSON_AddNumberToObject(frame_ms, "p90", p90);
+        cJSON_AddNumberToObject(frame_ms, "p99", p99);
+        cJSON_AddNumberToObject(frame_ms, "max", max_ms);
+        cJSON_AddNumberToObject(frame_ms, "mean", mean_ms);
+#ifdef PX_ALLOC_STATS
+        enginef_bench_json_range(root, "allocs_per_frame", sum_allocs / count, (double)max_allocs);
+        enginef_bench_json_range(root, "alloc_bytes_per_frame", sum_alloc_bytes / count, (double)max_alloc_bytes);
+#endif
+        enginef_bench_json_range(root, "draw_calls", sum_draws / count, max_draws);
+        enginef_bench_json_range(root, "bytes_uploaded", sum_upload / count, (double)max_upload);
+        cJSON_AddNumberToObject(root, "max_vertices", max_vertices);
+        cJSON_AddNumberToObject(root, "max_dropped_quads", max_dropped);
+
+        char* json = cJSON_Print(root);
+        cJSON_Delete(root);
+        FILE* f = json ? fopen(args->benchmark_json, "wb") : NULL;
+        if (f) {
+            fputs(json, f);
+            fputc('\n', f);
+            fclose(f);
+        } else {
+            fprintf(stderr, "Error: Could not write %s\n", args->benchmark_json);
+            result = ERR_COULD_NOT_OPEN_FILE;
+        }
+        cJSON_free(json);
+    }
+
+    if (args->benchmark_budget_ms > 0.0 && p99 > args->benchmark_budget_ms) {
+        fprintf(stderr, "Error: p99 frame time %.3f ms is over the %.3f ms budget\n", p99, args->benchmark_budget_ms);
+        result = ERR_FALUIRE;
+    }
+
+    return result;
+}
+
+// The editor without a window or GL context: same update, event and batching
+// code as the main loop, driven by a scripted mouse instead of the platform
+static t_err_codes enginef_benchmark(const t_args* args) {
+    PX_TRACE_SCOPE("enginef_benchmark");
+    engine_window_main_w = 1920;
+    engine_window_main_h = 1080;
+    px_vfs_mount(PX_PACK_DEFAULT_PATH);
+
+    engine_font_ui = enginef_bench_load_font(engine_font_ui_path);
+    if (!engine_font_ui) {
+        fprintf(stderr, "Error: Failed to load UI font\n");
+        px_vfs_unmount();
+        return ERR_COULD_NOT_OPEN_FILE;
+    }
+
+    t_err_codes last_err = px_rs_init_ui_headless((PX_Scale2){engine_window_main_w, engine_window_main_h});
+    if (last_err != ERR_SUCCESS) {
+        fprintf(stderr, "Error: Failed to initialize rendering system!\n");
+        px_font_destroy(engine_font_ui);
+        px_vfs_unmount();
+        return last_err;
+    }
+    event_sys_init((PX_Scale2){engine_window_main_w, engine_window_main_h}, (PX_Vector2){0});
+
+    enginef_init_dropdowns();
+    enginef_bench_wide_menus();
+    menu_evs_init(&engine_menu_dropdown, NULL);
+    editor_new_project("Benchmark");
+
+    int total = ENGINE_BENCH_WARMUP_FRAMES + args->benchmark_frames;
+    struct engine_bench_frame* frames = (struct engine_bench_frame*)calloc(args->benchmark_frames, sizeof(struct engine_bench_frame));
+    last_err = frames ? enginef_bench_populate(args->benchmark_objects, args->benchmark_depth) : ERR_ALLOC_FAILED;
+
+    int measured = 0;
+    engine_running = last_err == ERR_SUCCESS;
+    for (int i = 0; i < total && engine_running; i++) {
+        PX_TRACE_SCOPE("frame");
+        PX_AllocStats before, after;
+        px_alloc_stats(&before);
+        uint64_t start = enginef_bench_now_ns();
+
+        enginef_core_update();
+        enginef_bench_script(i);
+        px_rs_frame_end();
+
+        uint64_t end = enginef_bench_now_ns();
+        px_alloc_stats(&after);
+        if (i < ENGINE_BENCH_WARMUP_FRAMES)
+            continue;
+
+        struct engine_bench_frame* f = &frames[measured++];
+        f->ns = end - start;
+        f->allocs = after.allocs - before.allocs;
+        f->alloc_bytes = after.bytes - before.bytes;
+        px_rs_frame_stats(&f->rs);
+    }
+
+    if (last_err == ERR_SUCCESS && measured > 0)
+        last_err = enginef_bench_report(args, frames, measured);
+    else if (last_err == ERR_SUCCESS)
+        last_err = ERR_INTERNAL;
+
+    // Cleanup
+    free(frames);
+    editor_scene_free(&editor_get_state()->scene);
+    editor_hierarchy_free(&editor_get_state()->hierarchy);
+    free(editor_get_state()->project_path);
+    editor_get_state()->project_path = NULL;
+    px_rs_dropdown_free(&engine_menu_dropdown);
+    px_font_destroy(engine_font_ui);
+    px_rs_shutdown_ui();
+    px_vfs_unmount();
+    px_trace_shutdown();
+
+    return last_err;
+}
+
 int main(int argc, char** argv) {
+    PX_TRACE_THREAD("main");
     // Important Variables
     t_err_codes last_err = ERR_SUCCESS;
 
@@ -250,38 +773,72 @@ int main(int argc, char** argv) {
     if (passed_args.build_psdf) {
         if (!passed_args.build_psdf_json || !passed_args.build_psdf_out)
             return ERR_USAGE;
-        PX_SDFBuildDesc psdf_desc = {
-            .pixel_size = 64, // 128 - HIGH DPI
-            .atlas_size = 512, // 1024 - EXT
-            .sdf_range = 8, // 16 - EXT
-            .ascii_only = true // false - EXT
+        return px_sdf_build_font(passed_args.build_psdf_json, passed_args.build_psdf_out, &engine_psdf_desc);
+    }
+
+    if (passed_args.cook) {
+        PX_CookDesc cook_desc = {
+            .workers = passed_args.cook_jobs,
+            .force = passed_args.cook_force,
+            .shader_dir = "shaders",
+            .sdf = engine_psdf_desc,
+            .ptex = engine_ptex_desc
         };
-        return px_sdf_build_font(passed_args.build_psdf_json, passed_args.build_psdf_out, &psdf_desc);
+        return px_cook_assets(passed_args.cook_dir, &cook_desc, NULL);
     }
 
+    if (passed_args.build_pack)
+        return px_pack_build(passed_args.build_pack_out, engine_pack_roots, (int)(sizeof(engine_pack_roots) / sizeof(engine_pack_roots[0])));
+
     if (passed_args.help) {
         print_help();
         return ERR_SUCCESS;
     }
 
-    // Initialize SubSystems
-    last_err = px_ws_init();
+    if (passed_args.benchmark)
+        return enginef_benchmark(&passed_args);
+
+    // Mount Assets (loose files are used when no pack ships)
+    px_vfs_mount(PX_PACK_DEFAULT_PATH);
+
+    // Jobs (this thread is worker 0 and keeps main-thread work)
+    if (px_jobs_init(0) != ERR_SUCCESS)
+        fprintf(stderr, "Warning: Failed to start job workers, jobs run inline\n");
+
+    // Start Loading (file reads overlap window and context setup)
+    last_err = px_loader_init();
     if (last_err != ERR_SUCCESS) {
-        fprintf(stderr, "Error: Failed to initialize window system!\n");
+        fprintf(stderr, "Error: Failed to start asset loader!\n");
+        px_jobs_shutdown();
         return last_err;
-    } 
+    }
+    PX_Asset* font_ui_asset = px_asset_load_font("assets/fonts/psdf/roboto.psdf");
 
-    last_err = px_ws_show_splash();
+    // Initialize SubSystems
+    last_err = px_ws_init();
     if (last_err != ERR_SUCCESS) {
-        fprintf(stderr, "Error: Failed to display splash screen!\n");
-        px_ws_destroy(&engine_window_main);
-        px_ws_shutdown();
+        fprintf(stderr, "Error: Failed to initialize window system!\n");
+        px_asset_release(font_ui_asset);
+        px_loader_shutdown();
+        px_jobs_shutdown();
         return last_err;
     }
 
+    // Splash (runs alongside the rest of startup, not fatal)
+    PX_SplashDesc splash_desc = {
+        .image = engine_splash_image,
+        .min_ms = passed_args.splash_min_ms
+    };
+    if (px_ws_show_splash(&splash_desc) != ERR_SUCCESS)
+        fprintf(stderr, "Warning: Failed to display splash screen!\n");
+    px_ws_splash_progress(0.1f, "Creating window");
+
     last_err = px_ws_create(&engine_window_main);
     if (last_err != ERR_SUCCESS) {
         fprintf(stderr, "Error: Failed to create window!\n");
+        px_asset_release(font_ui_asset);
+        px_loader_shutdown();
+        px_jobs_shutdown();
         px_ws_shutdown();
         return last_err;
     }
@@ -289,20 +846,32 @@ int main(int argc, char** argv) {
     px_ws_window_design(&engine_window_main, &engine_window_main_design);
     
     px_ws_create_ctx(&engine_window_main);
+    if (px_ws_set_swap_interval(&engine_window_main, passed_args.vsync) != ERR_SUCCESS)
+        fprintf(stderr, "Warning: No swap control, frames are paced by the driver\n");
+    px_ws_splash_progress(0.3f, "Compiling shaders");
     last_err = px_rs_init_ui((PX_Scale2){engine_window_main_w, engine_window_main_h});
     if (last_err != ERR_SUCCESS) {
         fprintf(stderr, "Error: Failed to initialize rendering system!\n");
+        px_asset_release(font_ui_asset);
+        px_loader_shutdown();
+        px_jobs_shutdown();
         px_ws_destroy(&engine_window_main);
         px_ws_shutdown();
         return last_err;
     }
 
     event_sys_init((PX_Scale2){engine_window_main_w, engine_window_main_h}, (PX_Vector2){0});
+    event_subscribe_gsignal(EVENT_GSIGNAL_CORE_QUIT, NULL, enginef_core_handle_core_signals, NULL);
 
     // Load Fonts
-    engine_font_ui = px_font_load("assets/fonts/psdf/roboto.psdf");
+    px_ws_splash_progress(0.6f, "Loading fonts");
+    if (px_asset_wait(font_ui_asset) == ERR_SUCCESS)
+        engine_font_ui = px_asset_take_font(font_ui_asset);
+    px_asset_release(font_ui_asset);
     if (!engine_font_ui) {
         fprintf(stderr, "Error: Failed to load UI font\n");
+        px_loader_shutdown();
+        px_jobs_shutdown();
         px_rs_shutdown_ui();
         px_ws_destroy(&engine_window_main);
         px_ws_shutdown();
@@ -314,21 +883,31 @@ int main(int argc, char** argv) {
     enginef_init_dropdowns();
     menu_evs_init(&engine_menu_dropdown, NULL);
     // Project
+    px_ws_splash_progress(0.9f, "Loading project");
     editor_new_project("Untitled");
 
+    // Assets are waited for above on this thread, from here on uploads go where the context is
+    if (passed_args.render_thread) {
+        PX_RSRenderThreadDesc rt_desc = {
+            .window = &engine_window_main,
+            .gl_work = enginef_pump_loader
+        };
+        if (px_rs_start_render_thread(&rt_desc) != ERR_SUCCESS)
+            fprintf(stderr, "Warning: Failed to start render thread, rendering on the main thread\n");
+    }
+
     // Render
     engine_running = true;
+    bool first_frame = true;
+    px_frame_sched_init(&engine_frame_sched, &(PX_FrameSchedDesc){
+        .fps_cap = passed_args.fps_cap,
+        .unfocused_fps = passed_args.unfocused_fps
+    });
     while (engine_running) {
-        px_rs_ui_frame_update();
-        enginef_core_render();
-        enginef_event_hover_check();
-
-        // Global Signals
-        PX_Event_GSignal core_signal = {0};
-        bool core_signal_active = false;
-        event_handle_gsignals((PX_Event_Identifier**)&engine_obj_identifiers, engine_obj_identifier_count, &core_signal, &core_signal_active);
-        // Global Core Signals
-        enginef_core_handle_core_signals(&core_signal, core_signal_active);
+        // Nothing to draw: sleep on the X connection, input wakes it straight away
+        int timeout_ms = px_frame_sched_timeout_ms(&engine_frame_sched, px_frame_now_ns());
+        if (timeout_ms != 0)
+            px_ws_wait_events(&engine_window_main, timeout_ms);
 
         last_err = px_ws_poll(&engine_window_main);
         if (last_err != ERR_SUCCESS) {
@@ -339,30 +918,30 @@ int main(int argc, char** argv) {
 
         PX_WEvent ev;
         while (px_ws_pop_event(&engine_window_main, &ev)) {
-            switch (ev.type) {
-                case PX_WE_CLOSE: engine_running = false; break;
-                case PX_WE_RESIZE:
-                    engine_window_main_w = ev.w;
-                    engine_window_main_h = ev.h;
-                    engine_window_main.width = ev.w;
-                    engine_window_main.height = ev.h;
-                    px_rs_ui_resize((PX_Scale2){ev.w, ev.h});
-                    event_resize((PX_Scale2){ev.w, ev.h});
-                    break;
-                case PX_WE_MOUSE_MOVE:
-                    engine_mouse_x = ev.x;
-                    engine_mouse_y = ev.y;
-                    event_mouse_move((PX_Vector2){ev.x, ev.y});
-                    break;
-                case PX_WE_MOUSE_DOWN:
-                    enginef_event_mouse_click();
-                    break;
-                default: break;
-            }
-        } 
-
+            enginef_handle_wevent(&ev);
+            px_frame_sched_invalidate(&engine_frame_sched);
+        }
+        // Main-thread jobs and queued signals may change what is on screen
+        if (px_jobs_pump_main() > 0 || px_loader_busy() || event_gsignals_pending())
+            px_frame_sched_invalidate(&engine_frame_sched);
+
+        if (!px_frame_sched_begin(&engine_frame_sched, px_frame_now_ns()))
+            continue;
+
+        PX_TRACE_SCOPE("frame");
+        bool threaded = px_rs_render_threaded();
+        if (!threaded)
+            enginef_pump_loader();
+        enginef_core_update();
         px_rs_frame_end();
-        px_ws_swap_buffers(&engine_window_main);
+        if (!threaded)
+            px_ws_swap_buffers(&engine_window_main);
+
+        if (first_frame) {
+            px_ws_splash_progress(1.0f, "");
+            px_ws_close_splash();
+            first_frame = false;
+        }
     }
 
     // Cleanup
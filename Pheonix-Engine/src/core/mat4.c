@@ -0,0 +1,249 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include <core/mat4.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MAT4_X86 1
+#include <immintrin.h>
+#endif
+
+struct mat4_kernels {
+    PX_Mat4ISA isa;
+    void (*mul)(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b);
+    void (*mul_batch)(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b, size_t count);
+    void (*mul_parents)(PX_Mat4* world, const PX_Mat4* local, const uint32_t* parent, size_t begin, size_t end);
+};
+
+// ---- Scalar ----
+
+// Column j of the product is a's columns weighted by b's column j, summed left to right
+static void mul_scalar(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b) {
+    PX_Mat4 r;
+    for (int j = 0; j < 4; j++) {
+        const float* bj = b->m + j * 4;
+        for (int i = 0; i < 4; i++)
+            r.m[j * 4 + i] = a->m[i] * bj[0] + a->m[4 + i] * bj[1] + a->m[8 + i] * bj[2] + a->m[12 + i] * bj[3];
+    }
+    *out = r;
+}
+
+static void mul_batch_scalar(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        mul_scalar(&out[i], &a[i], &b[i]);
+}
+
+static void mul_parents_scalar(PX_Mat4* world, const PX_Mat4* local, const uint32_t* parent, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (parent[i] == PX_MAT4_NO_PARENT)
+            world[i] = local[i];
+        else
+            mul_scalar(&world[i], &world[parent[i]], &local[i]);
+    }
+}
+
+#ifdef MAT4_X86
+
+// ---- SSE ----
+
+__attribute__((target("sse")))
+static inline void mul_sse_inline(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b) {
+    __m128 a0 = _mm_loadu_ps(a->m), a1 = _mm_loadu_ps(a->m + 4);
+    __m128 a2 = _mm_loadu_ps(a->m + 8), a3 = _mm_loadu_ps(a->m + 12);
+    __m128 b0 = _mm_loadu_ps(b->m), b1 = _mm_loadu_ps(b->m + 4);
+    __m128 b2 = _mm_loadu_ps(b->m + 8), b3 = _mm_loadu_ps(b->m + 12);
+    __m128 bj[4] = { b0, b1, b2, b3 };
+
+    for (int j = 0; j < 4; j++) {
+        __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(bj[j], bj[j], _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(bj[j], bj[j], _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(bj[j], bj[j], _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(bj[j], bj[j], _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(out->m + j * 4, r);
+    }
+}
+
+__attribute__((target("sse")))
+static void mul_sse(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b) {
+    mul_sse_inline(out, a, b);
+}
+
+__attribute__((target("sse")))
+static void mul_batch_sse(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        mul_sse_inline(&out[i], &a[i], &b[i]);
+}
+
+__attribute__((target("sse")))
+static void mul_parents_sse(PX_Mat4* world, const PX_Mat4* local, const uint32_t* parent, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (parent[i] == PX_MAT4_NO_PARENT)
+            world[i] = local[i];
+        else
+            mul_sse_inline(&world[i], &world[parent[i]], &local[i]);
+    }
+}
+
+// ---- AVX ----
+
+// Two product columns per register: a's columns repeated in both halves, each
+// half of b broadcasting its own column's weights
+__attribute__((target("avx")))
+static inline void mul_avx_inline(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b) {
+    __m256 a0 = _mm256_broadcast_ps((const __m128*)a->m);
+    __m256 a1 = _mm256_broadcast_ps((const __m128*)(a->m + 4));
+    __m256 a2 = _mm256_broadcast_ps((const __m128*)(a->m + 8));
+    __m256 a3 = _mm256_broadcast_ps((const __m128*)(a->m + 12));
+    __m256 b01 = _mm256_loadu_ps(b->m), b23 = _mm256_loadu_ps(b->m + 8);
+
+    __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(0, 0, 0, 0)));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(1, 1, 1, 1))));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(2, 2, 2, 2))));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(3, 3, 3, 3))));
+
+    __m256 s = _mm256_mul_ps(a0, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(0, 0, 0, 0)));
+    s = _mm256_add_ps(s, _mm256_mul_ps(a1, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(1, 1, 1, 1))));
+    s = _mm256_add_ps(s, _mm256_mul_ps(a2, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(2, 2, 2, 2))));
+    s = _mm256_add_ps(s, _mm256_mul_ps(a3, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(3, 3, 3, 3))));
+
+    _mm256_storeu_ps(out->m, r);
+    _mm256_storeu_ps(out->m + 8, s);
+}
+
+__attribute__((target("avx")))
+static void mul_avx(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b) {
+    mul_avx_inline(out, a, b);
+}
+
+__attribute__((target("avx")))
+static void mul_batch_avx(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        mul_avx_inline(&out[i], &a[i], &b[i]);
+}
+
+__attribute__((target("avx")))
+static void mul_parents_avx(PX_Mat4* world, const PX_Mat4* local, const uint32_t* parent, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (parent[i] == PX_MAT4_NO_PARENT)
+            world[i] = local[i];
+        else
+            mul_avx_inline(&world[i], &world[parent[i]], &local[i]);
+    }
+}
+
+#endif
+
+static const struct mat4_kernels mat4_kernels_scalar = {
+    PX_MAT4_ISA_SCALAR, mul_scalar, mul_batch_scalar, mul_parents_scalar
+};
+
+#ifdef MAT4_X86
+static const struct mat4_kernels mat4_kernels_sse = {
+    PX_MAT4_ISA_SSE, mul_sse, mul_batch_sse, mul_parents_sse
+};
+
+static const struct mat4_kernels mat4_kernels_avx = {
+    PX_MAT4_ISA_AVX, mul_avx, mul_batch_avx, mul_parents_avx
+};
+#endif
+
+static pthread_once_t mat4_once = PTHREAD_ONCE_INIT;
+static PX_Mat4ISA mat4_best = PX_MAT4_ISA_SCALAR;
+// Swapped by px_mat4_set_isa while px_job_parallel_for tasks may be multiplying
+static _Atomic(const struct mat4_kernels*) mat4_active = &mat4_kernels_scalar;
+
+static const struct mat4_kernels* mat4_kernels_for(PX_Mat4ISA isa) {
+#ifdef MAT4_X86
+    if (isa == PX_MAT4_ISA_AVX) return &mat4_kernels_avx;
+    if (isa == PX_MAT4_ISA_SSE) return &mat4_kernels_sse;
+#endif
+    (void)isa;
+    return &mat4_kernels_scalar;
+}
+
+static void mat4_detect(void) {
+#ifdef MAT4_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+        mat4_best = PX_MAT4_ISA_AVX;
+    else if (__builtin_cpu_supports("sse"))
+        mat4_best = PX_MAT4_ISA_SSE;
+#endif
+    atomic_store_explicit(&mat4_active, mat4_kernels_for(mat4_best), memory_order_release);
+}
+
+static inline const struct mat4_kernels* mat4_k(void) {
+    pthread_once(&mat4_once, mat4_detect);
+    return atomic_load_explicit(&mat4_active, memory_order_acquire);
+}
+
+PX_Mat4ISA px_mat4_isa(void) {
+    pthread_once(&mat4_once, mat4_detect);
+    return mat4_best;
+}
+
+PX_Mat4ISA px_mat4_set_isa(PX_Mat4ISA isa) {
+    pthread_once(&mat4_once, mat4_detect);
+    if (isa > mat4_best)
+        isa = mat4_best;
+    const struct mat4_kernels* k = mat4_kernels_for(isa);
+    atomic_store_explicit(&mat4_active, k, memory_order_release);
+    return k->isa;
+}
+
+const char* px_mat4_isa_name(PX_Mat4ISA isa) {
+    switch (isa) {
+        case PX_MAT4_ISA_SCALAR: return "scalar";
+        case PX_MAT4_ISA_SSE: return "sse";
+        case PX_MAT4_ISA_AVX: return "avx";
+        default: return "unknown";
+    }
+}
+
+void px_mat4_identity(PX_Mat4* out) {
+    memset(out, 0, sizeof(*out));
+    out->m[0] = out->m[5] = out->m[10] = out->m[15] = 1.0f;
+}
+
+void px_mat4_compose(PX_Mat4* out, const float t[3], const float q[4], const float s[3]) {
+    float x = q[0], y = q[1], z = q[2], w = q[3];
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+
+    out->m[0] = (1.0f - 2.0f * (yy + zz)) * s[0];
+    out->m[1] = 2.0f * (xy + wz) * s[0];
+    out->m[2] = 2.0f * (xz - wy) * s[0];
+    out->m[3] = 0.0f;
+
+    out->m[4] = 2.0f * (xy - wz) * s[1];
+    out->m[5] = (1.0f - 2.0f * (xx + zz)) * s[1];
+    out->m[6] = 2.0f * (yz + wx) * s[1];
+    out->m[7] = 0.0f;
+
+    out->m[8] = 2.0f * (xz + wy) * s[2];
+    out->m[9] = 2.0f * (yz - wx) * s[2];
+    out->m[10] = (1.0f - 2.0f * (xx + yy)) * s[2];
+    out->m[11] = 0.0f;
+
+    out->m[12] = t[0];
+    out->m[13] = t[1];
+    out->m[14] = t[2];
+    out->m[15] = 1.0f;
+}
+
+void px_mat4_mul(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b) {
+    mat4_k()->mul(out, a, b);
+}
+
+void px_mat4_mul_batch(PX_Mat4* out, const PX_Mat4* a, const PX_Mat4* b, size_t count) {
+    mat4_k()->mul_batch(out, a, b, count);
+}
+
+void px_mat4_mul_parents(PX_Mat4* world, const PX_Mat4* local, const uint32_t* parent, size_t begin, size_t end) {
+    mat4_k()->mul_parents(world, local, parent, begin, end);
+}
@@ -0,0 +1,602 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include <core/pixel.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXEL_X86 1
+#include <immintrin.h>
+#endif
+
+#define PIXEL_LANCZOS_LOBES 3
+// Pixels per block when a conversion is split into two in-cache passes
+#define PIXEL_BLOCK 1024
+
+struct pixel_kernels {
+    PX_PixelISA isa;
+    void (*premultiply)(uint8_t* dst, const uint8_t* src, size_t count);
+    void (*swizzle)(uint8_t* dst, const uint8_t* src, size_t count, const uint8_t order[4]);
+    void (*gray_to_rgba)(uint8_t* dst, const uint8_t* src, size_t count);
+    void (*rgb_to_rgba)(uint8_t* dst, const uint8_t* src, size_t count);
+    // acc[i] += row[i]
+    void (*accumulate)(uint32_t* acc, const uint8_t* row, size_t n);
+    // out[i] = sum over k of rows[k][i] * weights[k]
+    void (*filter_rows)(float* out, const float* const* rows, const float* weights, int taps, size_t n);
+    void (*store_u8)(uint8_t* dst, const float* src, size_t n);
+};
+
+// c * a / 255 rounded to nearest, exact for every 8-bit pair
+static inline uint8_t pixel_mul_div255(unsigned c, unsigned a) {
+    unsigned t = c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+// ---- Scalar ----
+
+static void premultiply_scalar(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++, src += 4, dst += 4) {
+        uint8_t a = src[3];
+        dst[0] = pixel_mul_div255(src[0], a);
+        dst[1] = pixel_mul_div255(src[1], a);
+        dst[2] = pixel_mul_div255(src[2], a);
+        dst[3] = a;
+    }
+}
+
+static void swizzle_scalar(uint8_t* dst, const uint8_t* src, size_t count, const uint8_t order[4]) {
+    for (size_t i = 0; i < count; i++, src += 4, dst += 4) {
+        uint8_t px[4] = { src[0], src[1], src[2], src[3] };
+        dst[0] = px[order[0] & 3];
+        dst[1] = px[order[1] & 3];
+        dst[2] = px[order[2] & 3];
+        dst[3] = px[order[3] & 3];
+    }
+}
+
+static void gray_to_rgba_scalar(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++, dst += 4) {
+        dst[0] = dst[1] = dst[2] = src[i];
+        dst[3] = 0xFF;
+    }
+}
+
+static void rgb_to_rgba_scalar(uint8_t* dst, const uint8_t* src, size_t count) {
+    for (size_t i = 0; i < count; i++, src += 3, dst += 4) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xFF;
+    }
+}
+
+static void accumulate_scalar(uint32_t* acc, const uint8_t* row, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        acc[i] += row[i];
+}
+
+static void filter_rows_scalar(float* out, const float* const* rows, const float* weights, int taps, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+            acc += rows[k][i] * weights[k];
+        out[i] = acc;
+    }
+}
+
+static void store_u8_scalar(uint8_t* dst, const float* src, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float v = src[i];
+        if (!(v > 0.0f)) v = 0.0f;
+        if (v > 255.0f) v = 255.0f;
+        dst[i] = (uint8_t)lrintf(v);
+    }
+}
+
+#ifdef PIXEL_X86
+
+// ---- SSE2 ----
+
+__attribute__((target("sse2")))
+static inline __m128i premultiply_lanes_sse2(__m128i lanes) {
+    // Alpha of each pixel broadcast over its four 16-bit lanes
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lanes, 0xFF), 0xFF);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(lanes, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("sse2")))
+static void premultiply_sse2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i lo = premultiply_lanes_sse2(_mm_unpacklo_epi8(px, zero));
+        __m128i hi = premultiply_lanes_sse2(_mm_unpackhi_epi8(px, zero));
+        __m128i out = _mm_packus_epi16(lo, hi);
+        out = _mm_or_si128(_mm_andnot_si128(alpha, out), _mm_and_si128(alpha, px));
+        _mm_storeu_si128((__m128i*)(dst + i * 4), out);
+    }
+    premultiply_scalar(dst + i * 4, src + i * 4, count - i);
+}
+
+// No byte shuffle before SSSE3: each channel is moved with a 32-bit shift
+__attribute__((target("sse2")))
+static void swizzle_sse2(uint8_t* dst, const uint8_t* src, size_t count, const uint8_t order[4]) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i from[4], to[4];
+    for (int k = 0; k < 4; k++) {
+        from[k] = _mm_cvtsi32_si128((order[k] & 3) * 8);
+        to[k] = _mm_cvtsi32_si128(k * 8);
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i*)(src + i * 4));
+        __m128i out = _mm_setzero_si128();
+        for (int k = 0; k < 4; k++) {
+            __m128i ch = _mm_and_si128(_mm_srl_epi32(px, from[k]), mask);
+            out = _mm_or_si128(out, _mm_sll_epi32(ch, to[k]));
+        }
+        _mm_storeu_si128((__m128i*)(dst + i * 4), out);
+    }
+    swizzle_scalar(dst + i * 4, src + i * 4, count - i, order);
+}
+
+__attribute__((target("sse2")))
+static void gray_to_rgba_sse2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m128i opaque = _mm_set1_epi8((char)0xFF);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i g = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i gg_lo = _mm_unpacklo_epi8(g, g);
+        __m128i gg_hi = _mm_unpackhi_epi8(g, g);
+        __m128i ga_lo = _mm_unpacklo_epi8(g, opaque);
+        __m128i ga_hi = _mm_unpackhi_epi8(g, opaque);
+
+        __m128i* out = (__m128i*)(dst + i * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(gg_lo, ga_lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gg_lo, ga_lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(gg_hi, ga_hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(gg_hi, ga_hi));
+    }
+    gray_to_rgba_scalar(dst + i * 4, src + i, count - i);
+}
+
+__attribute__((target("sse2")))
+static void accumulate_sse2(uint32_t* acc, const uint8_t* row, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i lo = _mm_unpacklo_epi8(b, zero);
+        __m128i hi = _mm_unpackhi_epi8(b, zero);
+        __m128i* a = (__m128i*)(acc + i);
+
+        _mm_storeu_si128(a + 0, _mm_add_epi32(_mm_loadu_si128(a + 0), _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(a + 2, _mm_add_epi32(_mm_loadu_si128(a + 2), _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(a + 3, _mm_add_epi32(_mm_loadu_si128(a + 3), _mm_unpackhi_epi16(hi, zero)));
+    }
+    accumulate_scalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void filter_rows_sse2(float* out, const float* const* rows, const float* weights, int taps, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < taps; k++)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(rows[k] + i), _mm_set1_ps(weights[k])));
+        _mm_storeu_ps(out + i, acc);
+    }
+    for (; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+            acc += rows[k][i] * weights[k];
+        out[i] = acc;
+    }
+}
+
+// Conversion rounds to nearest even like lrintf, the packs saturate to 0..255
+__attribute__((target("sse2")))
+static void store_u8_sse2(uint8_t* dst, const float* src, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 0));
+        __m128i b = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 4));
+        __m128i c = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 8));
+        __m128i d = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 12));
+        __m128i ab = _mm_packs_epi32(a, b);
+        __m128i cd = _mm_packs_epi32(c, d);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(ab, cd));
+    }
+    store_u8_scalar(dst + i, src + i, n - i);
+}
+
+// ---- AVX2 ----
+
+__attribute__((target("avx2")))
+static inline __m256i premultiply_lanes_avx2(__m256i lanes) {
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lanes, 0xFF), 0xFF);
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(lanes, a), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+static void premultiply_avx2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000u);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i px = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+        // Unpack and pack both work per 128-bit lane, so pixel order holds
+        __m256i lo = premultiply_lanes_avx2(_mm256_unpacklo_epi8(px, zero));
+        __m256i hi = premultiply_lanes_avx2(_mm256_unpackhi_epi8(px, zero));
+        __m256i out = _mm256_packus_epi16(lo, hi);
+        out = _mm256_or_si256(_mm256_andnot_si256(alpha, out), _mm256_and_si256(alpha, px));
+        _mm256_storeu_si256((__m256i*)(dst + i * 4), out);
+    }
+    premultiply_sse2(dst + i * 4, src + i * 4, count - i);
+}
+
+__attribute__((target("avx2")))
+static void swizzle_avx2(uint8_t* dst, const uint8_t* src, size_t count, const uint8_t order[4]) {
+    uint8_t table[32];
+    for (int b = 0; b < 32; b++)
+        table[b] = (uint8_t)((b & 0x0C) + (order[b & 3] & 3));
+    const __m256i shuffle = _mm256_loadu_si256((const __m256i*)table);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i px = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+        _mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_shuffle_epi8(px, shuffle));
+    }
+    swizzle_sse2(dst + i * 4, src + i * 4, count - i, order);
+}
+
+__attribute__((target("avx2")))
+static void gray_to_rgba_avx2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m256i spread = _mm256_set1_epi32(0x00010101);
+    const __m256i opaque = _mm256_set1_epi32((int)0xFF000000u);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i g = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        __m256i out = _mm256_or_si256(_mm256_mullo_epi32(g, spread), opaque);
+        _mm256_storeu_si256((__m256i*)(dst + i * 4), out);
+    }
+    gray_to_rgba_sse2(dst + i * 4, src + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void rgb_to_rgba_avx2(uint8_t* dst, const uint8_t* src, size_t count) {
+    const __m256i shuffle = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1
+    );
+    const __m256i opaque = _mm256_set1_epi32((int)0xFF000000u);
+
+    // Each lane takes four pixels out of a 16-byte load, so the last load
+    // reads 4 bytes past the 24 consumed: keep 10 pixels of headroom.
+    size_t i = 0;
+    for (; i + 10 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i * 3));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i * 3 + 12));
+        __m256i px = _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+        __m256i out = _mm256_or_si256(_mm256_shuffle_epi8(px, shuffle), opaque);
+        _mm256_storeu_si256((__m256i*)(dst + i * 4), out);
+    }
+    rgb_to_rgba_scalar(dst + i * 4, src + i * 3, count - i);
+}
+
+__attribute__((target("avx2")))
+static void accumulate_avx2(uint32_t* acc, const uint8_t* row, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i b = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(row + i)));
+        __m256i* a = (__m256i*)(acc + i);
+        _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a), b));
+    }
+    accumulate_scalar(acc + i, row + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void filter_rows_avx2(float* out, const float* const* rows, const float* weights, int taps, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < taps; k++)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(rows[k] + i), _mm256_set1_ps(weights[k])));
+        _mm256_storeu_ps(out + i, acc);
+    }
+    for (; i < n; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++)
+            acc += rows[k][i] * weights[k];
+        out[i] = acc;
+    }
+}
+
+__attribute__((target("avx2")))
+static void store_u8_avx2(uint8_t* dst, const float* src, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_cvtps_epi32(_mm256_loadu_ps(src + i + 0));
+        __m256i b = _mm256_cvtps_epi32(_mm256_loadu_ps(src + i + 8));
+        __m256i c = _mm256_cvtps_epi32(_mm256_loadu_ps(src + i + 16));
+        __m256i d = _mm256_cvtps_epi32(_mm256_loadu_ps(src + i + 24));
+        // In-lane packs leave a0-3 b0-3 c0-3 d0-3 a4-7 b4-7 c4-7 d4-7
+        __m256i out = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        out = _mm256_permutevar8x32_epi32(out, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        _mm256_storeu_si256((__m256i*)(dst + i), out);
+    }
+    store_u8_sse2(dst + i, src + i, n - i);
+}
+
+#endif
+
+static const struct pixel_kernels pixel_kernels_scalar = {
+    PX_PIXEL_ISA_SCALAR,
+    premultiply_scalar, swizzle_scalar, gray_to_rgba_scalar, rgb_to_rgba_scalar,
+    accumulate_scalar, filter_rows_scalar, store_u8_scalar
+};
+
+#ifdef PIXEL_X86
+// RGB expansion needs a byte shuffle, so SSE2 keeps the scalar loop there
+static const struct pixel_kernels pixel_kernels_sse2 = {
+    PX_PIXEL_ISA_SSE2,
+    premultiply_sse2, swizzle_sse2, gray_to_rgba_sse2, rgb_to_rgba_scalar,
+    accumulate_sse2, filter_rows_sse2, store_u8_sse2
+};
+
+static const struct pixel_kernels pixel_kernels_avx2 = {
+    PX_PIXEL_ISA_AVX2,
+    premultiply_avx2, swizzle_avx2, gray_to_rgba_avx2, rgb_to_rgba_avx2,
+    accumulate_avx2, filter_rows_avx2, store_u8_avx2
+};
+#endif
+
+static pthread_once_t pixel_once = PTHREAD_ONCE_INIT;
+static PX_PixelISA pixel_best = PX_PIXEL_ISA_SCALAR;
+// Swapped by px_pixel_set_isa while loader and cook jobs may be converting
+static _Atomic(const struct pixel_kernels*) pixel_active = &pixel_kernels_scalar;
+
+static const struct pixel_kernels* pixel_kernels_for(PX_PixelISA isa) {
+#ifdef PIXEL_X86
+    if (isa == PX_PIXEL_ISA_AVX2) return &pixel_kernels_avx2;
+    if (isa == PX_PIXEL_ISA_SSE2) return &pixel_kernels_sse2;
+#endif
+    (void)isa;
+    return &pixel_kernels_scalar;
+}
+
+static void pixel_detect(void) {
+#ifdef PIXEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        pixel_best = PX_PIXEL_ISA_AVX2;
+    else if (__builtin_cpu_supports("sse2"))
+        pixel_best = PX_PIXEL_ISA_SSE2;
+#endif
+    atomic_store_explicit(&pixel_active, pixel_kernels_for(pixel_best), memory_order_release);
+}
+
+static inline const struct pixel_kernels* pixel_k(void) {
+    pthread_once(&pixel_once, pixel_detect);
+    return atomic_load_explicit(&pixel_active, memory_order_acquire);
+}
+
+PX_PixelISA px_pixel_isa(void) {
+    pthread_once(&pixel_once, pixel_detect);
+    return pixel_best;
+}
+
+PX_PixelISA px_pixel_set_isa(PX_PixelISA isa) {
+    pthread_once(&pixel_once, pixel_detect);
+    if (isa > pixel_best)
+        isa = pixel_best;
+    const struct pixel_kernels* k = pixel_kernels_for(isa);
+    atomic_store_explicit(&pixel_active, k, memory_order_release);
+    return k->isa;
+}
+
+const char* px_pixel_isa_name(PX_PixelISA isa) {
+    switch (isa) {
+        case PX_PIXEL_ISA_SCALAR: return "scalar";
+        case PX_PIXEL_ISA_SSE2: return "sse2";
+        case PX_PIXEL_ISA_AVX2: return "avx2";
+        default: return "unknown";
+    }
+}
+
+void px_pixel_premultiply(uint8_t* dst, const uint8_t* src, size_t count) {
+    pixel_k()->premultiply(dst, src, count);
+}
+
+void px_pixel_swizzle(uint8_t* dst, const uint8_t* src, size_t count, const uint8_t order[4]) {
+    pixel_k()->swizzle(dst, src, count, order);
+}
+
+void px_pixel_premultiply_bgra(uint8_t* dst, const uint8_t* src, size_t count) {
+    static const uint8_t bgra[4] = { 2, 1, 0, 3 };
+    const struct pixel_kernels* k = pixel_k();
+
+    // Blocked so the swizzle pass still finds its input in cache
+    for (size_t i = 0; i < count; i += PIXEL_BLOCK) {
+        size_t n = count - i < PIXEL_BLOCK ? count - i : PIXEL_BLOCK;
+        k->premultiply(dst + i * 4, src + i * 4, n);
+        k->swizzle(dst + i * 4, dst + i * 4, n, bgra);
+    }
+}
+
+void px_pixel_gray_to_rgba(uint8_t* dst, const uint8_t* src, size_t count) {
+    pixel_k()->gray_to_rgba(dst, src, count);
+}
+
+void px_pixel_rgb_to_rgba(uint8_t* dst, const uint8_t* src, size_t count) {
+    pixel_k()->rgb_to_rgba(dst, src, count);
+}
+
+void px_pixel_downscale_box(uint8_t* dst, int dst_w, int dst_h, size_t dst_stride,
+                            const uint8_t* src, int src_w, int src_h, size_t src_stride) {
+    if (dst_w <= 0 || dst_h <= 0 || src_w <= 0 || src_h <= 0)
+        return;
+
+    const struct pixel_kernels* k = pixel_k();
+    size_t row_bytes = (size_t)src_w * 4;
+    uint32_t* acc = (uint32_t*)malloc(sizeof(uint32_t) * row_bytes);
+    if (!acc)
+        return;
+
+    for (int dy = 0; dy < dst_h; dy++) {
+        int sy0 = (int)((int64_t)dy * src_h / dst_h);
+        int sy1 = (int)((int64_t)(dy + 1) * src_h / dst_h);
+        if (sy1 <= sy0) sy1 = sy0 + 1;
+
+        // Column sums over the footprint rows first, then each span of them
+        memset(acc, 0, sizeof(uint32_t) * row_bytes);
+        for (int sy = sy0; sy < sy1; sy++)
+            k->accumulate(acc, src + (size_t)sy * src_stride, row_bytes);
+
+        uint8_t* out = dst + (size_t)dy * dst_stride;
+        for (int dx = 0; dx < dst_w; dx++) {
+            int sx0 = (int)((int64_t)dx * src_w / dst_w);
+            int sx1 = (int)((int64_t)(dx + 1) * src_w / dst_w);
+            if (sx1 <= sx0) sx1 = sx0 + 1;
+
+            uint64_t n = (uint64_t)(sx1 - sx0) * (uint64_t)(sy1 - sy0);
+            for (int c = 0; c < 4; c++) {
+                uint64_t sum = 0;
+                for (int sx = sx0; sx < sx1; sx++)
+                    sum += acc[(size_t)sx * 4 + c];
+                out[dx * 4 + c] = (uint8_t)((sum + n / 2) / n);
+            }
+        }
+    }
+
+    free(acc);
+}
+
+// Per destination coordinate: taps source indices (edge clamped) and weights
+struct lanczos_axis {
+    int taps;
+    int* index;
+    float* weight;
+};
+
+static float lanczos_kernel(float x) {
+    const float pi = 3.14159265358979f;
+    if (x == 0.0f)
+        return 1.0f;
+    if (x <= -PIXEL_LANCZOS_LOBES || x >= PIXEL_LANCZOS_LOBES)
+        return 0.0f;
+
+    float px = pi * x;
+    return PIXEL_LANCZOS_LOBES * sinf(px) * sinf(px / PIXEL_LANCZOS_LOBES) / (px * px);
+}
+
+static bool lanczos_axis_build(struct lanczos_axis* axis, int src_n, int dst_n) {
+    float scale = (float)src_n / (float)dst_n;
+    // Downscaling stretches the kernel over the source so it also low-passes
+    float stretch = scale > 1.0f ? scale : 1.0f;
+    float support = PIXEL_LANCZOS_LOBES * stretch;
+
+    axis->taps = (int)ceilf(support) * 2 + 1;
+    axis->index = (int*)malloc(sizeof(int) * axis->taps * dst_n);
+    axis->weight = (float*)malloc(sizeof(float) * axis->taps * dst_n);
+    if (!axis->index || !axis->weight)
+        return false;
+
+    for (int d = 0; d < dst_n; d++) {
+        float center = ((float)d + 0.5f) * scale - 0.5f;
+        int first = (int)floorf(center - support) + 1;
+        int* index = axis->index + (size_t)d * axis->taps;
+        float* weight = axis->weight + (size_t)d * axis->taps;
+
+        float total = 0.0f;
+        for (int t = 0; t < axis->taps; t++) {
+            int s = first + t;
+            float w = lanczos_kernel(((float)s - center) / stretch);
+            index[t] = s < 0 ? 0 : (s >= src_n ? src_n - 1 : s);
+            weight[t] = w;
+            total += w;
+        }
+        if (total != 0.0f) {
+            for (int t = 0; t < axis->taps; t++)
+                weight[t] /= total;
+        }
+    }
+
+    return true;
+}
+
+static void lanczos_axis_free(struct lanczos_axis* axis) {
+    free(axis->index);
+    free(axis->weight);
+}
+
+void px_pixel_downscale_lanczos(uint8_t* dst, int dst_w, int dst_h, size_t dst_stride,
+                                const uint8_t* src, int src_w, int src_h, size_t src_stride) {
+    if (dst_w <= 0 || dst_h <= 0 || src_w <= 0 || src_h <= 0)
+        return;
+
+    const struct pixel_kernels* k = pixel_k();
+    struct lanczos_axis ax = {0}, ay = {0};
+    size_t out_n = (size_t)dst_w * 4;
+    float* horiz = (float*)malloc(sizeof(float) * out_n * src_h);
+    float* line = (float*)malloc(sizeof(float) * out_n);
+    const float** rows = NULL;
+
+    if (!horiz || !line || !lanczos_axis_build(&ax, src_w, dst_w) || !lanczos_axis_build(&ay, src_h, dst_h))
+        goto done;
+    rows = (const float**)malloc(sizeof(float*) * ay.taps);
+    if (!rows)
+        goto done;
+
+    // Horizontal pass over every source row into a float buffer
+    for (int sy = 0; sy < src_h; sy++) {
+        const uint8_t* in = src + (size_t)sy * src_stride;
+        float* out = horiz + (size_t)sy * out_n;
+
+        for (int dx = 0; dx < dst_w; dx++) {
+            const int* index = ax.index + (size_t)dx * ax.taps;
+            const float* weight = ax.weight + (size_t)dx * ax.taps;
+            float acc[4] = {0};
+
+            for (int t = 0; t < ax.taps; t++) {
+                const uint8_t* px = in + (size_t)index[t] * 4;
+                acc[0] += px[0] * weight[t];
+                acc[1] += px[1] * weight[t];
+                acc[2] += px[2] * weight[t];
+                acc[3] += px[3] * weight[t];
+            }
+            memcpy(out + dx * 4, acc, sizeof(acc));
+        }
+    }
+
+    // Vertical pass works on whole rows, which is where the SIMD goes
+    for (int dy = 0; dy < dst_h; dy++) {
+        for (int t = 0; t < ay.taps; t++)
+            rows[t] = horiz + (size_t)ay.index[(size_t)dy * ay.taps + t] * out_n;
+
+        k->filter_rows(line, rows, ay.weight + (size_t)dy * ay.taps, ay.taps, out_n);
+        k->store_u8(dst + (size_t)dy * dst_stride, line, out_n);
+    }
+
+done:
+    free(rows);
+    lanczos_axis_free(&ax);
+    lanczos_axis_free(&ay);
+    free(line);
+    free(horiz);
+}
@@ -0,0 +1,219 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <core/trace.h>
+#include <err-codes.h>
+
+#ifdef PX_TRACE
+
+#include <time.h>
+#include <stdatomic.h>
+
+#include <external/cJSON.h>
+
+struct trace_event {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+// Single writer (the owning thread), read by whoever dumps. head counts
+// every event ever written; slot head % size is the next to be reused.
+struct trace_ring {
+    struct trace_event events[PX_TRACE_RING_SIZE];
+    _Atomic uint64_t head;
+    int tid;
+    char name[32];
+    struct trace_ring* next;
+};
+
+struct trace_snapshot {
+    const struct trace_ring* ring;
+    struct trace_event* events;
+    size_t count;
+};
+
+// Rings are pushed lock-free and only unlinked by px_trace_shutdown
+static _Atomic(struct trace_ring*) g_trace_rings = NULL;
+static atomic_int g_trace_next_tid = 1;
+static _Thread_local struct trace_ring* t_trace_ring = NULL;
+
+uint64_t px_trace_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static struct trace_ring* trace_ring(void) {
+    if (t_trace_ring)
+        return t_trace_ring;
+
+    struct trace_ring* ring = (struct trace_ring*)calloc(1, sizeof(struct trace_ring));
+    if (!ring)
+        return NULL;
+
+    ring->tid = atomic_fetch_add(&g_trace_next_tid, 1);
+    snprintf(ring->name, sizeof(ring->name), "thread %d", ring->tid);
+
+    ring->next = atomic_load(&g_trace_rings);
+    while (!atomic_compare_exchange_weak(&g_trace_rings, &ring->next, ring))
+        ;
+
+    t_trace_ring = ring;
+    return ring;
+}
+
+void px_trace_record(const char* name, uint64_t start_ns, uint64_t end_ns) {
+    struct trace_ring* ring = trace_ring();
+    if (!ring)
+        return;
+
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    struct trace_event* ev = &ring->events[head % PX_TRACE_RING_SIZE];
+    ev->name = name;
+    ev->start_ns = start_ns;
+    ev->end_ns = end_ns;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void px_trace_thread_name(const char* name) {
+    struct trace_ring* ring = trace_ring();
+    if (ring)
+        snprintf(ring->name, sizeof(ring->name), "%s", name);
+}
+
+// Copies what a ring holds without stopping its writer. Anything the
+// writer lapped while copying is dropped rather than reported torn.
+static bool trace_snapshot(const struct trace_ring* ring, struct trace_snapshot* out) {
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t first = head > PX_TRACE_RING_SIZE ? head - PX_TRACE_RING_SIZE : 0;
+
+    out->ring = ring;
+    out->count = 0;
+    out->events = (struct trace_event*)malloc(sizeof(struct trace_event) * (size_t)(head - first + 1));
+    if (!out->events)
+        return false;
+
+    for (uint64_t i = first; i < head; i++)
+        out->events[i - first] = ring->events[i % PX_TRACE_RING_SIZE];
+
+    uint64_t after = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t valid = after + 1 > PX_TRACE_RING_SIZE ? after + 1 - PX_TRACE_RING_SIZE : 0;
+    if (valid > first) {
+        uint64_t skip = valid - first < head - first ? valid - first : head - first;
+        memmove(out->events, out->events + skip, sizeof(struct trace_event) * (size_t)(head - first - skip));
+        first += skip;
+    }
+    out->count = (size_t)(head - first);
+
+    return true;
+}
+
+t_err_codes px_trace_dump(const char* path) {
+    int ring_count = 0;
+    for (struct trace_ring* r = atomic_load(&g_trace_rings); r; r = r->next)
+        ring_count++;
+
+    struct trace_snapshot* snaps = (struct trace_snapshot*)calloc(ring_count ? ring_count : 1, sizeof(struct trace_snapshot));
+    if (!snaps)
+        return ERR_ALLOC_FAILED;
+
+    // Timestamps are reported relative to the oldest event kept
+    int n = 0;
+    uint64_t epoch = UINT64_MAX;
+    for (struct trace_ring* r = atomic_load(&g_trace_rings); r && n < ring_count; r = r->next) {
+        if (!trace_snapshot(r, &snaps[n]))
+            continue;
+        for (size_t i = 0; i < snaps[n].count; i++) {
+            if (snaps[n].events[i].start_ns < epoch)
+                epoch = snaps[n].events[i].start_ns;
+        }
+        n++;
+    }
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON* events = cJSON_AddArrayToObject(root, "traceEvents");
+    cJSON_AddStringToObject(root, "displayTimeUnit", "ms");
+
+    for (int s = 0; s < n; s++) {
+        cJSON* meta = cJSON_CreateObject();
+        cJSON_AddStringToObject(meta, "name", "thread_name");
+        cJSON_AddStringToObject(meta, "ph", "M");
+        cJSON_AddNumberToObject(meta, "pid", 1);
+        cJSON_AddNumberToObject(meta, "tid", snaps[s].ring->tid);
+        cJSON* args = cJSON_AddObjectToObject(meta, "args");
+        cJSON_AddStringToObject(args, "name", snaps[s].ring->name);
+        cJSON_AddItemToArray(events, meta);
+
+        for (size_t i = 0; i < snaps[s].count; i++) {
+            const struct trace_event* e = &snaps[s].events[i];
+            cJSON* ev = cJSON_CreateObject();
+            cJSON_AddStringToObject(ev, "name", e->name);
+            cJSON_AddStringToObject(ev, "ph", "X");
+            cJSON_AddNumberToObject(ev, "ts", (double)(e->start_ns - epoch) / 1000.0);
+            cJSON_AddNumberToObject(ev, "dur", (double)(e->end_ns - e->start_ns) / 1000.0);
+            cJSON_AddNumberToObject(ev, "pid", 1);
+            cJSON_AddNumberToObject(ev, "tid", snaps[s].ring->tid);
+            cJSON_AddItemToArray(events, ev);
+        }
+        free(snaps[s].events);
+    }
+    free(snaps);
+
+    char* json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!json)
+        return ERR_ALLOC_FAILED;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "Trace: could not open %s\n", path);
+        cJSON_free(json);
+        return ERR_COULD_NOT_OPEN_FILE;
+    }
+    size_t len = strlen(json);
+    bool ok = fwrite(json, 1, len, f) == len;
+    ok &= fclose(f) == 0;
+    cJSON_free(json);
+
+    if (!ok)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    printf("Trace written to %s\n", path);
+    return ERR_SUCCESS;
+}
+
+void px_trace_shutdown(void) {
+    const char* path = getenv("PX_TRACE_FILE");
+    px_trace_dump(path && path[0] ? path : PX_TRACE_DEFAULT_PATH);
+
+    // Every other thread that recorded has been joined by now
+    struct trace_ring* r = atomic_exchange(&g_trace_rings, NULL);
+    while (r) {
+        struct trace_ring* next = r->next;
+        free(r);
+        r = next;
+    }
+    t_trace_ring = NULL;
+}
+
+#else
+
+void px_trace_thread_name(const char* name) {
+    (void)name;
+}
+
+t_err_codes px_trace_dump(const char* path) {
+    (void)path;
+    return ERR_SUCCESS;
+}
+
+void px_trace_shutdown(void) {
+}
+
+#endif
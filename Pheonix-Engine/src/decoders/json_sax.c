@@ -0,0 +1,211 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <decoders/json-sax.h>
+#include <err-codes.h>
+
+struct sax_reader {
+    const char* p;
+    const char* end;
+    const PX_JsonSax* sax;
+};
+
+static void skip_ws(struct sax_reader* r) {
+    while (r->p < r->end && (*r->p == ' ' || *r->p == '\t' || *r->p == '\n' || *r->p == '\r'))
+        r->p++;
+}
+
+static bool scan_string(struct sax_reader* r, const char** out, size_t* len) {
+    if (r->p >= r->end || *r->p != '"')
+        return false;
+
+    const char* start = ++r->p;
+    while (r->p < r->end && *r->p != '"') {
+        if (*r->p == '\\') {
+            if (r->p + 1 >= r->end)
+                return false;
+            r->p++;
+        }
+        r->p++;
+    }
+    if (r->p >= r->end)
+        return false;
+
+    *out = start;
+    *len = (size_t)(r->p - start);
+    r->p++;
+    return true;
+}
+
+static bool scan_number(struct sax_reader* r, double* out) {
+    char buf[64];
+    size_t n = 0;
+
+    while (r->p < r->end && n < sizeof(buf) - 1) {
+        char c = *r->p;
+        if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'))
+            break;
+        buf[n++] = c;
+        r->p++;
+    }
+    if (n == 0)
+        return false;
+    buf[n] = '\0';
+
+    char* stop = NULL;
+    *out = strtod(buf, &stop);
+    return stop == buf + n;
+}
+
+static bool scan_literal(struct sax_reader* r, const char* lit) {
+    size_t n = strlen(lit);
+    if ((size_t)(r->end - r->p) < n || memcmp(r->p, lit, n) != 0)
+        return false;
+    r->p += n;
+    return true;
+}
+
+static bool read_key(struct sax_reader* r) {
+    const char* key;
+    size_t len;
+
+    skip_ws(r);
+    if (!scan_string(r, &key, &len))
+        return false;
+    if (r->sax->key && !r->sax->key(r->sax->user, key, len))
+        return false;
+
+    skip_ws(r);
+    if (r->p >= r->end || *r->p != ':')
+        return false;
+    r->p++;
+    return true;
+}
+
+t_err_codes px_json_sax_parse(const char* text, size_t len, const PX_JsonSax* sax) {
+    if (!text || !sax)
+        return ERR_INTERNAL;
+
+    struct sax_reader r = { text, text + len, sax };
+    char stack[PX_JSON_SAX_MAX_DEPTH];
+    int depth = 0;
+
+    for (;;) {
+        skip_ws(&r);
+        if (r.p >= r.end)
+            return ERR_INTERNAL;
+
+        bool closed = false;
+        switch (*r.p) {
+            case '{':
+                if (depth >= PX_JSON_SAX_MAX_DEPTH)
+                    return ERR_INTERNAL;
+                r.p++;
+                if (sax->object_begin && !sax->object_begin(sax->user))
+                    return ERR_INTERNAL;
+                stack[depth++] = '{';
+
+                skip_ws(&r);
+                if (r.p < r.end && *r.p == '}') {
+                    closed = true;
+                    break;
+                }
+                if (!read_key(&r))
+                    return ERR_INTERNAL;
+                continue;
+
+            case '[':
+                if (depth >= PX_JSON_SAX_MAX_DEPTH)
+                    return ERR_INTERNAL;
+                r.p++;
+                if (sax->array_begin && !sax->array_begin(sax->user))
+                    return ERR_INTERNAL;
+                stack[depth++] = '[';
+
+                skip_ws(&r);
+                if (r.p < r.end && *r.p == ']') {
+                    closed = true;
+                    break;
+                }
+                continue;
+
+            case '"': {
+                const char* str;
+                size_t str_len;
+                if (!scan_string(&r, &str, &str_len))
+                    return ERR_INTERNAL;
+                if (sax->string && !sax->string(sax->user, str, str_len))
+                    return ERR_INTERNAL;
+                break;
+            }
+
+            case 't':
+            case 'f':
+                if (scan_literal(&r, "true")) {
+                    if (sax->boolean && !sax->boolean(sax->user, true))
+                        return ERR_INTERNAL;
+                } else if (scan_literal(&r, "false")) {
+                    if (sax->boolean && !sax->boolean(sax->user, false))
+                        return ERR_INTERNAL;
+                } else {
+                    return ERR_INTERNAL;
+                }
+                break;
+
+            case 'n':
+                if (!scan_literal(&r, "null"))
+                    return ERR_INTERNAL;
+                if (sax->null && !sax->null(sax->user))
+                    return ERR_INTERNAL;
+                break;
+
+            default: {
+                double value;
+                if (!scan_number(&r, &value))
+                    return ERR_INTERNAL;
+                if (sax->number && !sax->number(sax->user, value))
+                    return ERR_INTERNAL;
+                break;
+            }
+        }
+
+        // A value is complete: consume separators and closing brackets
+        // until the next value starts or the document ends.
+        for (;;) {
+            if (closed) {
+                char open = stack[--depth];
+                r.p++;
+                if (open == '{') {
+                    if (sax->object_end && !sax->object_end(sax->user))
+                        return ERR_INTERNAL;
+                } else {
+                    if (sax->array_end && !sax->array_end(sax->user))
+                        return ERR_INTERNAL;
+                }
+                closed = false;
+            }
+
+            skip_ws(&r);
+            if (depth == 0) {
+                if (r.p < r.end && *r.p != '\0')
+                    return ERR_INTERNAL;
+                return ERR_SUCCESS;
+            }
+            if (r.p >= r.end)
+                return ERR_INTERNAL;
+
+            char top = stack[depth - 1];
+            if (*r.p == ',') {
+                r.p++;
+                if (top == '{' && !read_key(&r))
+                    return ERR_INTERNAL;
+                break;
+            } else if ((top == '{' && *r.p == '}') || (top == '[' && *r.p == ']')) {
+                closed = true;
+            } else {
+                return ERR_INTERNAL;
+            }
+        }
+    }
+}
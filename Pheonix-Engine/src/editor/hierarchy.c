@@ -0,0 +1,209 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rendering-sys.h>
+#include <err-codes.h>
+#include <editor.h>
+#include <core/trace.h>
+
+#define NO_SLOT PX_EDITOR_NO_SLOT
+
+static bool hierarchy_reserve(PX_EditorHierarchy* h, uint32_t capacity) {
+    if (capacity <= h->row_capacity)
+        return true;
+
+    uint32_t cap = h->row_capacity ? h->row_capacity : 64;
+    while (cap < capacity)
+        cap *= 2;
+    uint32_t* grown = (uint32_t*)realloc(h->rows, sizeof(uint32_t) * (size_t)cap);
+    if (!grown) {
+        fprintf(stderr, "Failed to allocate memory for the hierarchy rows\n");
+        return false;
+    }
+    h->rows = grown;
+    h->row_capacity = cap;
+    return true;
+}
+
+// Shown descendants of top in pre-order, counted only when out is NULL
+static uint32_t hierarchy_walk(const PX_EditorScene* s, uint32_t top, uint32_t* out) {
+    if (s->collapsed[top])
+        return 0;
+
+    uint32_t n = 0;
+    uint32_t cur = s->first_child[top];
+    while (cur != NO_SLOT) {
+        if (out)
+            out[n] = cur;
+        n++;
+        if (!s->collapsed[cur] && s->first_child[cur] != NO_SLOT) {
+            cur = s->first_child[cur];
+            continue;
+        }
+        while (cur != top && s->next[cur] == NO_SLOT)
+            cur = s->parent[cur];
+        cur = cur == top ? NO_SLOT : s->next[cur];
+    }
+    return n;
+}
+
+static void hierarchy_rebuild(PX_EditorHierarchy* h, const PX_EditorScene* s) {
+    PX_TRACE_SCOPE("editor_hierarchy_rebuild");
+    h->row_count = 0;
+    h->revision = s->revision;
+    h->valid = s->count == 0 || hierarchy_reserve(h, s->count);
+    if (!h->valid || s->count == 0)
+        return;
+
+    h->rows[0] = 0;
+    h->row_count = 1 + hierarchy_walk(s, 0, h->rows + 1);
+}
+
+void editor_hierarchy_free(PX_EditorHierarchy* h) {
+    free(h->rows);
+    memset(h, 0, sizeof(*h));
+}
+
+void editor_hierarchy_sync(PX_EditorHierarchy* h, const PX_EditorScene* s) {
+    if (!h->valid || h->revision != s->revision)
+        hierarchy_rebuild(h, s);
+}
+
+void editor_hierarchy_added(PX_EditorHierarchy* h, const PX_EditorScene* s, PX_EditorHandle object) {
+    // Anything else changed since the rows were built and they are rebuilt anyway
+    uint32_t slot = editor_scene_slot(s, object);
+    if (!h->valid || h->revision + 1 != s->revision || slot == NO_SLOT || h->row_count == 0)
+        return;
+
+    uint32_t parent = s->parent[slot];
+    for (uint32_t p = parent; p != NO_SLOT; p = s->parent[p]) {
+        if (s->collapsed[p]) {
+            h->revision = s->revision;
+            return;
+        }
+    }
+
+    // It is the parent's last child, so its row ends the parent's rows; that is
+    // the end of the list when the last row is the parent or under it
+    uint32_t last = h->rows[h->row_count - 1];
+    while (last != NO_SLOT && s->depth[last] > s->depth[parent])
+        last = s->parent[last];
+    if (last != parent || !hierarchy_reserve(h, h->row_count + 1))
+        return;
+
+    h->rows[h->row_count++] = slot;
+    h->revision = s->revision;
+}
+
+void editor_hierarchy_set_collapsed(PX_EditorHierarchy* h, PX_EditorScene* s, PX_EditorHandle object, bool collapsed) {
+    uint32_t slot = editor_scene_slot(s, object);
+    if (slot == NO_SLOT || s->collapsed[slot] == collapsed)
+        return;
+
+    editor_hierarchy_sync(h, s);
+    s->collapsed[slot] = collapsed;
+    if (!h->valid)
+        return;
+
+    uint32_t row = 0;
+    while (row < h->row_count && h->rows[row] != slot)
+        row++;
+    // Under something collapsed, its rows come back with that
+    if (row == h->row_count)
+        return;
+
+    uint32_t after = row + 1;
+    if (collapsed) {
+        uint32_t end = after;
+        while (end < h->row_count && s->depth[h->rows[end]] > s->depth[slot])
+            end++;
+        memmove(h->rows + after, h->rows + end, sizeof(uint32_t) * (h->row_count - end));
+        h->row_count -= end - after;
+        return;
+    }
+
+    uint32_t n = hierarchy_walk(s, slot, NULL);
+    if (!hierarchy_reserve(h, h->row_count + n)) {
+        h->valid = false;
+        return;
+    }
+    memmove(h->rows + after + n, h->rows + after, sizeof(uint32_t) * (h->row_count - after));
+    hierarchy_walk(s, slot, h->rows + after);
+    h->row_count += n;
+}
+
+// Only the rows in view are drawn and recorded for hit testing, whatever the scene size
+void editor_draw_scene_panel(PX_Transform2 transform, PX_Color4 iline_color, PX_Color4 text_color, PX_Color4 color, float noise, float cradius, PX_Font* font, float font_size, int xspacing, int yspacing) {
+    PX_TRACE_SCOPE("editor_draw_scene_panel");
+    (void)iline_color;
+    px_rs_draw_panel(transform, color, noise, cradius);
+
+    PX_EditorState* state = editor_get_state();
+    PX_EditorHierarchy* h = &state->hierarchy;
+    h->drawn = 0;
+    if (!state->initialized || yspacing <= 0)
+        return;
+
+    const PX_EditorScene* s = &state->scene;
+    editor_hierarchy_sync(h, s);
+    h->viewport = transform;
+    px_rs_hit_add(transform, PX_RS_HIT_LIST, h, -1, -1);
+
+    int x = transform.pos.x + 8;
+    int y = transform.pos.y + 8;
+    h->rows_in_view = transform.scale.h > 16 ? (uint32_t)((transform.scale.h - 16) / yspacing) : 0;
+    uint32_t max_scroll = h->row_count > h->rows_in_view ? h->row_count - h->rows_in_view : 0;
+    if (h->scroll > max_scroll)
+        h->scroll = max_scroll;
+
+    // Rows with children carry their expand marker in a column before the name
+    int marker_w = px_rs_text_width(font, "+ ", font_size);
+    uint32_t end = h->scroll + h->rows_in_view < h->row_count ? h->scroll + h->rows_in_view : h->row_count;
+    for (uint32_t r = h->scroll; r < end; r++, y += yspacing) {
+        uint32_t slot = h->rows[r];
+        int rx = x + (s->depth[slot] > 0 ? (int)s->depth[slot] - 1 : 0) * xspacing;
+        if (s->child_count[slot] > 0)
+            px_rs_render_text(s->collapsed[slot] ? "+" : "-", font_size, (PX_Vector2){rx, y}, text_color, font);
+        px_rs_render_text(s->name[slot], font_size, (PX_Vector2){rx + marker_w, y}, text_color, font);
+
+        // The handle halves, a click on a frame old row still finds its object or nothing
+        PX_EditorHandle handle = s->handle[slot];
+        PX_Transform2 rect = {{transform.pos.x, y}, {transform.scale.w, yspacing}};
+        px_rs_hit_add(rect, PX_RS_HIT_LIST_ROW, h, (int)(uint32_t)handle, (int)(uint32_t)(handle >> 32));
+    }
+    h->drawn = end - h->scroll;
+}
+
+bool editor_scene_panel_scroll(PX_Vector2 point, int rows) {
+    PX_EditorState* state = editor_get_state();
+    PX_EditorHierarchy* h = &state->hierarchy;
+    PX_RSHit hit;
+    if (!state->initialized || !px_rs_hit_query(point, &hit) || hit.owner != h)
+        return false;
+
+    // Clamped against the rows in view when drawn
+    if (rows < 0)
+        h->scroll = (uint32_t)-rows > h->scroll ? 0 : h->scroll - (uint32_t)-rows;
+    else
+        h->scroll = h->scroll + (uint32_t)rows < h->scroll ? UINT32_MAX : h->scroll + (uint32_t)rows;
+    return true;
+}
+
+bool editor_scene_panel_click(PX_Vector2 point) {
+    PX_EditorState* state = editor_get_state();
+    PX_EditorHierarchy* h = &state->hierarchy;
+    PX_RSHit hit;
+    if (!state->initialized || !px_rs_hit_query(point, &hit) || hit.owner != h)
+        return false;
+
+    if (hit.kind == PX_RS_HIT_LIST_ROW) {
+        PX_EditorHandle object = (PX_EditorHandle)(uint32_t)hit.sub << 32 | (uint32_t)hit.index;
+        uint32_t slot = editor_scene_slot(&state->scene, object);
+        if (slot != NO_SLOT && state->scene.child_count[slot] > 0)
+            editor_hierarchy_set_collapsed(h, &state->scene, object, !state->scene.collapsed[slot]);
+    }
+    return true;
+}
@@ -0,0 +1,317 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <err-codes.h>
+#include <editor.h>
+#include <core/trace.h>
+
+#define NO_SLOT PX_EDITOR_NO_SLOT
+#define PROJECT_PATH_MAX 4096
+#define PROJECT_WRITE_RECORDS 256 // object records gathered per fwrite
+
+static uint64_t project_align(uint64_t v) {
+    return (v + PX_PXPROJ_ALIGN - 1) & ~(uint64_t)(PX_PXPROJ_ALIGN - 1);
+}
+
+static bool project_pad(FILE* f, uint64_t from, uint64_t to) {
+    static const unsigned char zeros[PX_PXPROJ_ALIGN] = {0};
+    while (from < to) {
+        uint64_t n = to - from;
+        if (n > sizeof(zeros)) n = sizeof(zeros);
+        if (fwrite(zeros, 1, n, f) != n)
+            return false;
+        from += n;
+    }
+    return true;
+}
+
+static bool project_write_string(FILE* f, const char* str) {
+    size_t len = strlen(str) + 1;
+    return fwrite(str, 1, len, f) == len;
+}
+
+static const char* project_material_name(const PX_EditorScene* s, uint32_t slot) {
+    return s->material[slot].used ? s->material[slot].name : NULL;
+}
+
+t_err_codes editor_scene_save(PX_EditorScene* s, const PX_EditorProjectInfo* info, const char* path) {
+    PX_TRACE_SCOPE("editor_scene_save");
+    if (!s || !info || !path || s->count == 0)
+        return ERR_USAGE;
+
+    // Indices stand in for links only when the slots are in pre-order
+    editor_scene_sort(s);
+    if (!s->sorted)
+        return ERR_ALLOC_FAILED;
+
+    const char* project_name = info->name ? info->name : "";
+    PX_PXProj_Hdr h = {0};
+    h.magic = PX_PXPROJ_MAGIC;
+    h.version = PX_PXPROJ_CUR_VERSION;
+    h.opengl_version = info->opengl_version;
+    h.editor_version = info->editor_version;
+    h.engine_version = info->engine_version;
+    h.project_name = 0; // first in the string table
+    h.object_count = s->count;
+    h.section_count = 3;
+    h.sections_offset = project_align(sizeof(h));
+
+    PX_PXProj_Section sections[3] = {0};
+    sections[0].type = PX_PXPROJ_SECTION_OBJECTS;
+    sections[0].offset = project_align(h.sections_offset + sizeof(sections));
+    sections[0].size = (uint64_t)s->count * sizeof(PX_PXProj_Object);
+    sections[1].type = PX_PXPROJ_SECTION_TRANSFORMS;
+    sections[1].offset = project_align(sections[0].offset + sections[0].size);
+    sections[1].size = (uint64_t)s->count * sizeof(PX_Transform3);
+    sections[2].type = PX_PXPROJ_SECTION_STRINGS;
+    sections[2].offset = project_align(sections[1].offset + sections[1].size);
+
+    char tmp[PROJECT_PATH_MAX + 32];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp.%d", path, (int)getpid()) >= (int)sizeof(tmp))
+        return ERR_USAGE;
+    FILE* f = fopen(tmp, "wb");
+    if (!f)
+        return ERR_COULD_NOT_OPEN_FILE;
+    setvbuf(f, NULL, _IOFBF, PX_PXPROJ_WRITE_BUFFER);
+
+    // String offsets are handed out as the records go, the strings follow in
+    // the same order and the header is written last over its reserved space
+    t_err_codes err = ERR_SUCCESS;
+    if (!project_pad(f, 0, sections[0].offset))
+        err = ERR_COULD_NOT_OPEN_FILE;
+
+    PX_PXProj_Object records[PROJECT_WRITE_RECORDS];
+    uint32_t pending = 0;
+    uint64_t strings = strlen(project_name) + 1;
+    for (uint32_t i = 0; i < s->count && err == ERR_SUCCESS; i++) {
+        PX_PXProj_Object* o = &records[pending++];
+        o->parent = s->parent[i]; // the root's NO_SLOT is PX_PXPROJ_NONE
+        o->name = (uint32_t)strings;
+        strings += strlen(s->name[i]) + 1;
+        o->flags = s->collapsed[i] ? PX_PXPROJ_OBJECT_COLLAPSED : 0;
+        o->material.name = PX_PXPROJ_NONE;
+        const char* material = project_material_name(s, i);
+        if (material) {
+            o->material.name = (uint32_t)strings;
+            strings += strlen(material) + 1;
+        }
+
+        if (strings >= PX_PXPROJ_NONE) {
+            fprintf(stderr, "Project strings do not fit in 4GB\n");
+            err = ERR_INTERNAL;
+        } else if ((pending == PROJECT_WRITE_RECORDS || i + 1 == s->count) &&
+                   fwrite(records, sizeof(*records), pending, f) != pending) {
+            err = ERR_COULD_NOT_OPEN_FILE;
+        }
+        if (pending == PROJECT_WRITE_RECORDS)
+            pending = 0;
+    }
+    sections[2].size = strings;
+    h.file_size = sections[2].offset + strings;
+
+    // Sorted, so the scene's transforms are already in record order
+    if (err == ERR_SUCCESS &&
+        (!project_pad(f, sections[0].offset + sections[0].size, sections[1].offset) ||
+         fwrite(s->transform, sizeof(*s->transform), s->count, f) != s->count ||
+         !project_pad(f, sections[1].offset + sections[1].size, sections[2].offset) || !project_write_string(f, project_name)))
+        err = ERR_COULD_NOT_OPEN_FILE;
+    for (uint32_t i = 0; i < s->count && err == ERR_SUCCESS; i++) {
+        const char* material = project_material_name(s, i);
+        if (!project_write_string(f, s->name[i]) || (material && !project_write_string(f, material)))
+            err = ERR_COULD_NOT_OPEN_FILE;
+    }
+
+    if (err == ERR_SUCCESS &&
+        (fseek(f, 0, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, f) != 1 ||
+         fseek(f, (long)h.sections_offset, SEEK_SET) != 0 || fwrite(sections, sizeof(sections), 1, f) != 1))
+        err = ERR_COULD_NOT_OPEN_FILE;
+
+    if (fclose(f) != 0 && err == ERR_SUCCESS)
+        err = ERR_COULD_NOT_OPEN_FILE;
+    if (err == ERR_SUCCESS && rename(tmp, path) != 0)
+        err = ERR_COULD_NOT_OPEN_FILE;
+    if (err != ERR_SUCCESS)
+        remove(tmp);
+    return err;
+}
+
+// Sections start on PX_PXPROJ_ALIGN, so their records can be read in place
+static bool project_section_fits(const PX_PXProj_Section* sec, size_t size) {
+    return sec->offset % PX_PXPROJ_ALIGN == 0 && sec->offset <= size && sec->size <= size - sec->offset;
+}
+
+static t_err_codes project_map(const char* path, void** map, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return ERR_COULD_NOT_OPEN_FILE;
+    }
+    *size = (size_t)st.st_size;
+    if (*size < sizeof(PX_PXProj_Hdr)) {
+        close(fd);
+        return ERR_MAGIC_INVALID;
+    }
+
+    // Private and writable: transforms are edited where they lie, the file never sees it
+    void* p = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return ERR_COULD_NOT_OPEN_FILE;
+    // Every byte is read once, so the readahead may as well start now
+    posix_madvise(p, *size, POSIX_MADV_WILLNEED);
+    *map = p;
+    return ERR_SUCCESS;
+}
+
+// One pass over the records: links are rebuilt from the parent indices, names
+// point into the mapped string table and transforms are used where they lie.
+// Local and world matrices are left to the first transform update
+static t_err_codes project_fill(PX_EditorScene* s, const PX_PXProj_Object* objects, PX_Transform3* transforms, uint32_t count, const char* strings, uint64_t strings_size) {
+    s->transform = transforms;
+    s->transform_mapped = count;
+    // Fresh arrays come zeroed: child counts, flags, materials and components are only written when set
+    if (editor_scene_reserve(s, count) != ERR_SUCCESS)
+        return ERR_ALLOC_FAILED;
+    s->id_slot = (uint32_t*)malloc(sizeof(uint32_t) * (size_t)count);
+    s->id_generation = (uint32_t*)malloc(sizeof(uint32_t) * (size_t)count);
+    if (!s->id_slot || !s->id_generation)
+        return ERR_ALLOC_FAILED;
+    s->id_capacity = count;
+
+    bool sorted = true;
+    for (uint32_t i = 0; i < count; i++) {
+        const PX_PXProj_Object* o = &objects[i];
+        uint32_t p = o->parent;
+        uint32_t material = o->material.name;
+        if ((i == 0) != (p == PX_PXPROJ_NONE) || (i > 0 && p >= i) || o->name >= strings_size ||
+            (material != PX_PXPROJ_NONE && material >= strings_size))
+            return ERR_INTERNAL;
+
+        s->id_slot[i] = i;
+        s->id_generation[i] = 1;
+        s->handle[i] = (PX_EditorHandle)1 << 32 | i;
+        s->parent[i] = p;
+        s->first_child[i] = NO_SLOT;
+        s->last_child[i] = NO_SLOT;
+        s->next[i] = NO_SLOT;
+        s->prev[i] = NO_SLOT;
+        s->depth[i] = 0;
+        if (p != NO_SLOT) {
+            uint32_t tail = s->last_child[p];
+            s->prev[i] = tail;
+            if (tail != NO_SLOT)
+                s->next[tail] = i;
+            else
+                s->first_child[p] = i;
+            s->last_child[p] = i;
+            s->child_count[p]++;
+            s->depth[i] = s->depth[p] + 1;
+
+            // Still pre-order if the parent is the previous object or above it;
+            // the slots walked past here are finished and never walked again
+            uint32_t a = i - 1;
+            while (sorted && a != p && a != NO_SLOT)
+                a = s->parent[a];
+            sorted = sorted && a == p;
+        }
+
+        s->name[i] = strings + o->name;
+        if (o->flags & PX_PXPROJ_OBJECT_COLLAPSED)
+            s->collapsed[i] = true;
+        if (material != PX_PXPROJ_NONE)
+            s->material[i] = (PX_EditorMaterial){ true, strings + material };
+    }
+    s->world_stale = true;
+    s->count = count;
+    s->id_count = count;
+    s->sorted = sorted;
+    s->revision = 1;
+    return ERR_SUCCESS;
+}
+
+t_err_codes editor_scene_load(PX_EditorScene* s, const char* path, PX_EditorProjectInfo* info) {
+    PX_TRACE_SCOPE("editor_scene_load");
+    if (!s || !path)
+        return ERR_USAGE;
+    memset(s, 0, sizeof(*s));
+    s->free_id = NO_SLOT;
+
+    void* map = NULL;
+    size_t size = 0;
+    t_err_codes err = project_map(path, &map, &size);
+    if (err != ERR_SUCCESS)
+        return err;
+    // Owned by the scene from here, so freeing the scene on failure unmaps it
+    s->mapping = map;
+    s->mapping_size = size;
+
+    const unsigned char* base = (const unsigned char*)map;
+    const PX_PXProj_Hdr* h = (const PX_PXProj_Hdr*)map;
+    if (h->magic != PX_PXPROJ_MAGIC) {
+        editor_scene_free(s);
+        return ERR_MAGIC_INVALID;
+    }
+    if (h->version > PX_PXPROJ_CUR_VERSION) {
+        editor_scene_free(s);
+        return ERR_VERSION_INVALID;
+    }
+
+    const PX_PXProj_Section* objects = NULL;
+    const PX_PXProj_Section* transforms = NULL;
+    const PX_PXProj_Section* strings = NULL;
+    bool valid = h->file_size <= size && h->sections_offset % PX_PXPROJ_ALIGN == 0 && h->sections_offset <= size &&
+                 (uint64_t)h->section_count * sizeof(PX_PXProj_Section) <= size - h->sections_offset;
+    for (uint32_t i = 0; valid && i < h->section_count; i++) {
+        const PX_PXProj_Section* sec = (const PX_PXProj_Section*)(base + h->sections_offset) + i;
+        if (!project_section_fits(sec, size))
+            valid = false;
+        else if (sec->type == PX_PXPROJ_SECTION_OBJECTS)
+            objects = sec;
+        else if (sec->type == PX_PXPROJ_SECTION_TRANSFORMS)
+            transforms = sec;
+        else if (sec->type == PX_PXPROJ_SECTION_STRINGS)
+            strings = sec;
+    }
+    // Every string ends inside the table once its last byte is a NUL
+    valid = valid && objects && transforms && strings && h->object_count > 0 &&
+            objects->size == (uint64_t)h->object_count * sizeof(PX_PXProj_Object) &&
+            transforms->size == (uint64_t)h->object_count * sizeof(PX_Transform3) &&
+            strings->size > 0 && base[strings->offset + strings->size - 1] == '\0' &&
+            h->project_name < strings->size;
+    if (!valid) {
+        fprintf(stderr, "Project %s is malformed\n", path);
+        editor_scene_free(s);
+        return ERR_INTERNAL;
+    }
+
+    const char* table = (const char*)(base + strings->offset);
+    err = project_fill(s, (const PX_PXProj_Object*)(base + objects->offset), (PX_Transform3*)((unsigned char*)map + transforms->offset),
+                       h->object_count, table, strings->size);
+    if (err != ERR_SUCCESS) {
+        if (err == ERR_INTERNAL)
+            fprintf(stderr, "Project %s has a broken object record\n", path);
+        editor_scene_free(s);
+        return err;
+    }
+
+    if (info) {
+        info->opengl_version = h->opengl_version;
+        info->editor_version = h->editor_version;
+        info->engine_version = h->engine_version;
+        info->name = table + h->project_name;
+    }
+    return ERR_SUCCESS;
+}
@@ -0,0 +1,414 @@
+#define _DEFAULT_SOURCE // madvise
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <err-codes.h>
+#include <editor.h>
+#include <core/trace.h>
+
+#define NO_SLOT PX_EDITOR_NO_SLOT
+
+struct editor_name_chunk {
+    struct editor_name_chunk* next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+static uint32_t handle_id(PX_EditorHandle h) {
+    return (uint32_t)(h & 0xFFFFFFFFu);
+}
+
+static uint32_t handle_generation(PX_EditorHandle h) {
+    return (uint32_t)(h >> 32);
+}
+
+// Pools this big are first touched a page at a time, huge pages cut those faults
+// 512 fold where the kernel only hands them out on request
+static void scene_advise_huge(void* p, size_t size) {
+#ifdef MADV_HUGEPAGE
+    if (size < PX_EDITOR_HUGE_POOL)
+        return;
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t begin = ((uintptr_t)p + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t)p + size) & ~(page - 1);
+    if (end > begin)
+        madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+#else
+    (void)p;
+    (void)size;
+#endif
+}
+
+// First allocations come zeroed, so a load only writes the fields that are not
+static bool grow(void** array, size_t elem, uint32_t capacity) {
+    void* grown = *array ? realloc(*array, elem * (size_t)capacity) : calloc(capacity, elem);
+    if (!grown)
+        return false;
+    scene_advise_huge(grown, elem * (size_t)capacity);
+    *array = grown;
+    return true;
+}
+
+// Names never move once copied, removed objects leave theirs until the scene is freed
+static const char* scene_copy_name(PX_EditorScene* s, const char* name) {
+    size_t len = strlen(name) + 1;
+    struct editor_name_chunk* c = s->names;
+    if (!c || c->size - c->used < len) {
+        size_t size = len > PX_EDITOR_NAME_CHUNK ? len : PX_EDITOR_NAME_CHUNK;
+        c = (struct editor_name_chunk*)malloc(sizeof(struct editor_name_chunk) + size);
+        if (!c)
+            return NULL;
+        c->next = s->names;
+        c->used = 0;
+        c->size = size;
+        s->names = c;
+    }
+
+    char* out = c->data + c->used;
+    memcpy(out, name, len);
+    c->used += len;
+    return out;
+}
+
+// Loaded transforms stay in the mapping (copy on write) until the scene outgrows them
+static bool grow_transform(PX_EditorScene* s, uint32_t capacity) {
+    if (!s->transform_mapped)
+        return grow((void**)&s->transform, sizeof(*s->transform), capacity);
+    if (capacity <= s->transform_mapped)
+        return true;
+
+    PX_Transform3* copy = NULL;
+    if (!grow((void**)&copy, sizeof(*copy), capacity))
+        return false;
+    memcpy(copy, s->transform, sizeof(*copy) * (size_t)s->count);
+    s->transform = copy;
+    s->transform_mapped = 0;
+    return true;
+}
+
+t_err_codes editor_scene_reserve(PX_EditorScene* s, uint32_t capacity) {
+    if (capacity <= s->capacity)
+        return ERR_SUCCESS;
+
+    bool ok = grow((void**)&s->handle, sizeof(*s->handle), capacity) &&
+              grow((void**)&s->parent, sizeof(*s->parent), capacity) &&
+              grow((void**)&s->first_child, sizeof(*s->first_child), capacity) &&
+              grow((void**)&s->last_child, sizeof(*s->last_child), capacity) &&
+              grow((void**)&s->next, sizeof(*s->next), capacity) &&
+              grow((void**)&s->prev, sizeof(*s->prev), capacity) &&
+              grow((void**)&s->child_count, sizeof(*s->child_count), capacity) &&
+              grow((void**)&s->depth, sizeof(*s->depth), capacity) &&
+              grow((void**)&s->collapsed, sizeof(*s->collapsed), capacity) &&
+              grow((void**)&s->name, sizeof(*s->name), capacity) &&
+              grow_transform(s, capacity) &&
+              grow((void**)&s->local, sizeof(*s->local), capacity) &&
+              grow((void**)&s->world, sizeof(*s->world), capacity) &&
+              grow((void**)&s->transform_dirty, sizeof(*s->transform_dirty), capacity) &&
+              grow((void**)&s->material, sizeof(*s->material), capacity) &&
+              grow((void**)&s->components, sizeof(*s->components), capacity) &&
+              grow((void**)&s->component_count, sizeof(*s->component_count), capacity);
+    // Arrays that did grow keep their new size, capacity only moves once all have
+    if (!ok)
+        return ERR_ALLOC_FAILED;
+    s->capacity = capacity;
+    return ERR_SUCCESS;
+}
+
+static uint32_t scene_new_id(PX_EditorScene* s) {
+    if (s->free_id != NO_SLOT) {
+        uint32_t id = s->free_id;
+        s->free_id = s->id_slot[id];
+        return id;
+    }
+
+    if (s->id_count >= s->id_capacity) {
+        uint32_t cap = s->id_capacity ? s->id_capacity * 2 : 64;
+        if (!grow((void**)&s->id_slot, sizeof(*s->id_slot), cap) ||
+            !grow((void**)&s->id_generation, sizeof(*s->id_generation), cap))
+            return NO_SLOT;
+        s->id_capacity = cap;
+    }
+    s->id_generation[s->id_count] = 1;
+    return s->id_count++;
+}
+
+// Whether slot is ancestor or self of the last slot, i.e. the subtree of slot ends the array
+static bool scene_ends_with_subtree(const PX_EditorScene* s, uint32_t slot) {
+    for (uint32_t i = s->count - 1; i != NO_SLOT; i = s->parent[i]) {
+        if (i == slot)
+            return true;
+    }
+    return false;
+}
+
+static uint32_t scene_insert(PX_EditorScene* s, uint32_t parent, const char* name) {
+    if (s->count >= s->capacity &&
+        editor_scene_reserve(s, s->capacity ? s->capacity * 2 : 64) != ERR_SUCCESS)
+        return NO_SLOT;
+
+    const char* copy = scene_copy_name(s, name ? name : "");
+    uint32_t id = copy ? scene_new_id(s) : NO_SLOT;
+    if (id == NO_SLOT)
+        return NO_SLOT;
+
+    // Appending keeps pre-order only when the parent's subtree is what ends the array
+    if (parent != NO_SLOT && s->sorted)
+        s->sorted = scene_ends_with_subtree(s, parent);
+
+    uint32_t slot = s->count++;
+    s->id_slot[id] = slot;
+    s->handle[slot] = (PX_EditorHandle)s->id_generation[id] << 32 | id;
+    s->parent[slot] = parent;
+    s->first_child[slot] = NO_SLOT;
+    s->last_child[slot] = NO_SLOT;
+    s->next[slot] = NO_SLOT;
+    s->prev[slot] = NO_SLOT;
+    s->child_count[slot] = 0;
+    s->depth[slot] = parent == NO_SLOT ? 0 : s->depth[parent] + 1;
+    s->collapsed[slot] = false;
+    s->name[slot] = copy;
+    s->transform[slot] = (PX_Transform3){ .scale = { 1.0f, 1.0f, 1.0f }, .rot = { 0.0f, 0.0f, 0.0f, 1.0f } };
+    px_mat4_identity(&s->local[slot]);
+    // Identity local, so the parent's world is this one's; if that is stale the parent is pending and so is this
+    if (parent != NO_SLOT)
+        s->world[slot] = s->world[parent];
+    else
+        px_mat4_identity(&s->world[slot]);
+    s->transform_dirty[slot] = false;
+    memset(&s->material[slot], 0, sizeof(s->material[slot]));
+    s->components[slot] = NULL;
+    s->component_count[slot] = 0;
+
+    if (parent != NO_SLOT) {
+        uint32_t tail = s->last_child[parent];
+        s->prev[slot] = tail;
+        if (tail != NO_SLOT)
+            s->next[tail] = slot;
+        else
+            s->first_child[parent] = slot;
+        s->last_child[parent] = slot;
+        s->child_count[parent]++;
+    }
+    s->revision++;
+    return slot;
+}
+
+t_err_codes editor_scene_init(PX_EditorScene* s, uint32_t capacity) {
+    memset(s, 0, sizeof(*s));
+    s->free_id = NO_SLOT;
+    s->sorted = true;
+
+    if (editor_scene_reserve(s, capacity > 0 ? capacity : 64) != ERR_SUCCESS ||
+        scene_insert(s, NO_SLOT, "root") == NO_SLOT) {
+        editor_scene_free(s);
+        return ERR_ALLOC_FAILED;
+    }
+    return ERR_SUCCESS;
+}
+
+void editor_scene_free(PX_EditorScene* s) {
+    free(s->handle);
+    free(s->parent);
+    free(s->first_child);
+    free(s->last_child);
+    free(s->next);
+    free(s->prev);
+    free(s->child_count);
+    free(s->depth);
+    free(s->collapsed);
+    free(s->name);
+    if (!s->transform_mapped)
+        free(s->transform);
+    free(s->local);
+    free(s->world);
+    free(s->transform_dirty);
+    free(s->dirty);
+    free(s->material);
+    free(s->components);
+    free(s->component_count);
+    free(s->id_slot);
+    free(s->id_generation);
+    for (struct editor_name_chunk* c = s->names; c;) {
+        struct editor_name_chunk* next = c->next;
+        free(c);
+        c = next;
+    }
+    if (s->mapping)
+        munmap(s->mapping, s->mapping_size);
+    memset(s, 0, sizeof(*s));
+    s->free_id = NO_SLOT;
+}
+
+PX_EditorHandle editor_scene_root(const PX_EditorScene* s) {
+    return s->count > 0 ? s->handle[0] : PX_EDITOR_NULL_HANDLE;
+}
+
+uint32_t editor_scene_slot(const PX_EditorScene* s, PX_EditorHandle object) {
+    uint32_t id = handle_id(object);
+    if (object == PX_EDITOR_NULL_HANDLE || id >= s->id_count || s->id_generation[id] != handle_generation(object))
+        return NO_SLOT;
+    return s->id_slot[id];
+}
+
+PX_EditorHandle editor_scene_add(PX_EditorScene* s, PX_EditorHandle parent, const char* name) {
+    uint32_t p = parent == PX_EDITOR_NULL_HANDLE ? 0 : editor_scene_slot(s, parent);
+    if (p == NO_SLOT || p >= s->count)
+        return PX_EDITOR_NULL_HANDLE;
+
+    uint32_t slot = scene_insert(s, p, name);
+    return slot == NO_SLOT ? PX_EDITOR_NULL_HANDLE : s->handle[slot];
+}
+
+// The last slot fills the hole, everything that linked to it is pointed at its new slot
+static void scene_move_slot(PX_EditorScene* s, uint32_t from, uint32_t to) {
+    s->handle[to] = s->handle[from];
+    s->parent[to] = s->parent[from];
+    s->first_child[to] = s->first_child[from];
+    s->last_child[to] = s->last_child[from];
+    s->next[to] = s->next[from];
+    s->prev[to] = s->prev[from];
+    s->child_count[to] = s->child_count[from];
+    s->depth[to] = s->depth[from];
+    s->collapsed[to] = s->collapsed[from];
+    s->name[to] = s->name[from];
+    s->transform[to] = s->transform[from];
+    s->local[to] = s->local[from];
+    s->world[to] = s->world[from];
+    s->transform_dirty[to] = s->transform_dirty[from];
+    s->material[to] = s->material[from];
+    s->components[to] = s->components[from];
+    s->component_count[to] = s->component_count[from];
+
+    uint32_t p = s->parent[to];
+    if (p != NO_SLOT) {
+        if (s->first_child[p] == from) s->first_child[p] = to;
+        if (s->last_child[p] == from) s->last_child[p] = to;
+    }
+    if (s->prev[to] != NO_SLOT) s->next[s->prev[to]] = to;
+    if (s->next[to] != NO_SLOT) s->prev[s->next[to]] = to;
+    for (uint32_t c = s->first_child[to]; c != NO_SLOT; c = s->next[c])
+        s->parent[c] = to;
+    s->id_slot[handle_id(s->handle[to])] = to;
+}
+
+static void scene_remove_leaf(PX_EditorScene* s, uint32_t slot) {
+    uint32_t p = s->parent[slot];
+    uint32_t prev = s->prev[slot], next = s->next[slot];
+    if (prev != NO_SLOT) s->next[prev] = next;
+    else s->first_child[p] = next;
+    if (next != NO_SLOT) s->prev[next] = prev;
+    else s->last_child[p] = prev;
+    s->child_count[p]--;
+
+    // A new generation makes every handle to this object stale
+    uint32_t id = handle_id(s->handle[slot]);
+    if (++s->id_generation[id] == 0)
+        s->id_generation[id] = 1;
+    s->id_slot[id] = s->free_id;
+    s->free_id = id;
+
+    s->revision++;
+    uint32_t last = --s->count;
+    if (slot != last) {
+        scene_move_slot(s, last, slot);
+        s->sorted = false;
+    }
+}
+
+bool editor_scene_remove(PX_EditorScene* s, PX_EditorHandle object) {
+    uint32_t slot = editor_scene_slot(s, object);
+    if (slot == NO_SLOT || slot == 0)
+        return false;
+
+    // Leaves first; slots shift as holes are filled, so the object is looked up again each time
+    for (;;) {
+        slot = editor_scene_slot(s, object);
+        uint32_t leaf = slot;
+        while (s->first_child[leaf] != NO_SLOT)
+            leaf = s->first_child[leaf];
+        scene_remove_leaf(s, leaf);
+        if (leaf == slot)
+            return true;
+    }
+}
+
+// Gathers array[order[k]] into scratch and copies it back, so a sort never leaves the arrays half permuted
+static void scene_permute(void* array, size_t elem, const uint32_t* order, uint32_t count, void* scratch) {
+    for (uint32_t k = 0; k < count; k++)
+        memcpy((char*)scratch + elem * k, (const char*)array + elem * order[k], elem);
+    memcpy(array, scratch, elem * count);
+}
+
+static void scene_permute_links(uint32_t* array, const uint32_t* order, const uint32_t* remap, uint32_t count, uint32_t* scratch) {
+    for (uint32_t k = 0; k < count; k++) {
+        uint32_t v = array[order[k]];
+        scratch[k] = v == NO_SLOT ? NO_SLOT : remap[v];
+    }
+    memcpy(array, scratch, sizeof(uint32_t) * count);
+}
+
+void editor_scene_sort(PX_EditorScene* s) {
+    if (s->sorted || s->count == 0)
+        return;
+    PX_TRACE_SCOPE("editor_scene_sort");
+
+    size_t widest = sizeof(PX_Mat4) > sizeof(PX_EditorMaterial) ? sizeof(PX_Mat4) : sizeof(PX_EditorMaterial);
+    uint32_t* order = (uint32_t*)malloc(sizeof(uint32_t) * (size_t)s->count);
+    uint32_t* remap = (uint32_t*)malloc(sizeof(uint32_t) * (size_t)s->count);
+    void* scratch = malloc(widest * (size_t)s->count);
+    if (!order || !remap || !scratch) {
+        fprintf(stderr, "Failed to allocate memory for sorting the scene\n");
+        goto cleanup;
+    }
+
+    // Depth first without a stack: down to the first child, else on to the next sibling of the nearest ancestor with one
+    uint32_t k = 0;
+    for (uint32_t cur = 0; cur != NO_SLOT;) {
+        order[k] = cur;
+        remap[cur] = k++;
+        if (s->first_child[cur] != NO_SLOT) {
+            cur = s->first_child[cur];
+            continue;
+        }
+        while (cur != NO_SLOT && s->next[cur] == NO_SLOT)
+            cur = s->parent[cur];
+        if (cur != NO_SLOT)
+            cur = s->next[cur];
+    }
+
+    uint32_t n = s->count;
+    scene_permute(s->handle, sizeof(*s->handle), order, n, scratch);
+    scene_permute(s->child_count, sizeof(*s->child_count), order, n, scratch);
+    scene_permute(s->depth, sizeof(*s->depth), order, n, scratch);
+    scene_permute(s->collapsed, sizeof(*s->collapsed), order, n, scratch);
+    scene_permute(s->name, sizeof(*s->name), order, n, scratch);
+    scene_permute(s->transform, sizeof(*s->transform), order, n, scratch);
+    scene_permute(s->local, sizeof(*s->local), order, n, scratch);
+    scene_permute(s->world, sizeof(*s->world), order, n, scratch);
+    scene_permute(s->transform_dirty, sizeof(*s->transform_dirty), order, n, scratch);
+    scene_permute(s->material, sizeof(*s->material), order, n, scratch);
+    scene_permute(s->components, sizeof(*s->components), order, n, scratch);
+    scene_permute(s->component_count, sizeof(*s->component_count), order, n, scratch);
+    scene_permute_links(s->parent, order, remap, n, scratch);
+    scene_permute_links(s->first_child, order, remap, n, scratch);
+    scene_permute_links(s->last_child, order, remap, n, scratch);
+    scene_permute_links(s->next, order, remap, n, scratch);
+    scene_permute_links(s->prev, order, remap, n, scratch);
+
+    for (uint32_t i = 0; i < n; i++)
+        s->id_slot[handle_id(s->handle[i])] = i;
+    s->sorted = true;
+    s->revision++;
+
+cleanup:
+    free(order);
+    free(remap);
+    free(scratch);
+}
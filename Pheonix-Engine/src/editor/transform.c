@@ -0,0 +1,214 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <err-codes.h>
+#include <editor.h>
+#include <core/mat4.h>
+#include <core/jobs.h>
+#include <core/trace.h>
+
+#define NO_SLOT PX_EDITOR_NO_SLOT
+
+// A run of slots whose parents are either earlier in the run or already up to date
+struct transform_task {
+    uint32_t begin;
+    uint32_t end;
+};
+
+struct transform_update {
+    PX_EditorScene* scene;
+    struct transform_task* tasks;
+    uint32_t task_count;
+    uint32_t task_capacity;
+    struct transform_task* stack;
+    uint32_t stack_count;
+    uint32_t stack_capacity;
+};
+
+static bool transform_push(struct transform_task** array, uint32_t* count, uint32_t* capacity, uint32_t begin, uint32_t end) {
+    if (*count >= *capacity) {
+        uint32_t cap = *capacity ? *capacity * 2 : 64;
+        struct transform_task* grown = (struct transform_task*)realloc(*array, sizeof(struct transform_task) * (size_t)cap);
+        if (!grown)
+            return false;
+        *array = grown;
+        *capacity = cap;
+    }
+    (*array)[(*count)++] = (struct transform_task){ begin, end };
+    return true;
+}
+
+static void transform_compose(PX_EditorScene* s, uint32_t slot) {
+    const PX_Transform3* t = &s->transform[slot];
+    const float translation[3] = { t->pos.x, t->pos.y, t->pos.z };
+    const float rotation[4] = { t->rot.x, t->rot.y, t->rot.z, t->rot.w };
+    const float scale[3] = { t->scale.w, t->scale.h, t->scale.l };
+    px_mat4_compose(&s->local[slot], translation, rotation, scale);
+}
+
+static void transform_compose_range(void* ctx, size_t begin, size_t end) {
+    PX_EditorScene* s = ctx;
+    for (size_t i = begin; i < end; i++)
+        transform_compose(s, (uint32_t)i);
+}
+
+bool editor_scene_set_transform(PX_EditorScene* s, PX_EditorHandle object, const PX_Transform3* transform) {
+    uint32_t slot = editor_scene_slot(s, object);
+    if (slot == NO_SLOT)
+        return false;
+    // Every local is composed by the first update anyway
+    if (s->world_stale) {
+        s->transform[slot] = *transform;
+        return true;
+    }
+
+    if (!s->transform_dirty[slot]) {
+        if (s->dirty_count >= s->dirty_capacity) {
+            uint32_t cap = s->dirty_capacity ? s->dirty_capacity * 2 : 64;
+            PX_EditorHandle* grown = (PX_EditorHandle*)realloc(s->dirty, sizeof(PX_EditorHandle) * (size_t)cap);
+            if (!grown) {
+                fprintf(stderr, "Failed to allocate memory for the transform dirty list\n");
+                return false;
+            }
+            s->dirty = grown;
+            s->dirty_capacity = cap;
+        }
+        s->dirty[s->dirty_count++] = object;
+        s->transform_dirty[slot] = true;
+    }
+
+    s->transform[slot] = *transform;
+    transform_compose(s, slot);
+    return true;
+}
+
+// Cuts the subtree [begin, end) into tasks of about PX_EDITOR_TRANSFORM_GRAIN.
+// A subtree too big for one task has its root computed here, then its children
+// are packed into tasks, the ones still too big split the same way
+static bool transform_split(struct transform_update* u, uint32_t begin, uint32_t end) {
+    PX_EditorScene* s = u->scene;
+    u->stack_count = 0;
+    if (!transform_push(&u->stack, &u->stack_count, &u->stack_capacity, begin, end))
+        return false;
+
+    while (u->stack_count > 0) {
+        struct transform_task t = u->stack[--u->stack_count];
+        if (t.end - t.begin <= PX_EDITOR_TRANSFORM_GRAIN) {
+            if (!transform_push(&u->tasks, &u->task_count, &u->task_capacity, t.begin, t.end))
+                return false;
+            continue;
+        }
+
+        px_mat4_mul_parents(s->world, s->local, s->parent, t.begin, t.begin + 1);
+        uint32_t piece = t.begin + 1;
+        for (uint32_t c = s->first_child[t.begin]; c != NO_SLOT; c = s->next[c]) {
+            // Pre-order: a child's subtree runs up to its next sibling
+            uint32_t c_end = s->next[c] != NO_SLOT ? s->next[c] : t.end;
+            bool ok = true;
+            if (c_end - c > PX_EDITOR_TRANSFORM_GRAIN) {
+                if (piece < c)
+                    ok = transform_push(&u->tasks, &u->task_count, &u->task_capacity, piece, c);
+                ok = ok && transform_push(&u->stack, &u->stack_count, &u->stack_capacity, c, c_end);
+                piece = c_end;
+            } else if (c_end - piece >= PX_EDITOR_TRANSFORM_GRAIN) {
+                ok = transform_push(&u->tasks, &u->task_count, &u->task_capacity, piece, c_end);
+                piece = c_end;
+            }
+            if (!ok)
+                return false;
+        }
+        if (piece < t.end && !transform_push(&u->tasks, &u->task_count, &u->task_capacity, piece, t.end))
+            return false;
+    }
+    return true;
+}
+
+static void transform_run(void* ctx, size_t begin, size_t end) {
+    struct transform_update* u = ctx;
+    PX_EditorScene* s = u->scene;
+    for (size_t i = begin; i < end; i++)
+        px_mat4_mul_parents(s->world, s->local, s->parent, u->tasks[i].begin, u->tasks[i].end);
+}
+
+static int transform_cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+uint32_t editor_scene_update_transforms(PX_EditorScene* s) {
+    if (s->dirty_count == 0 && !s->world_stale)
+        return 0;
+    PX_TRACE_SCOPE("editor_scene_update_transforms");
+
+    // Pre-order makes every subtree one run of slots with its parents first
+    editor_scene_sort(s);
+    uint32_t* roots = (uint32_t*)malloc(sizeof(uint32_t) * (size_t)(s->dirty_count + 1));
+    if (!s->sorted || !roots) {
+        fprintf(stderr, "Failed to update the scene transforms, kept for the next update\n");
+        free(roots);
+        return 0;
+    }
+
+    // Every flagged slot is on the list once, so past a few percent a scan beats sorting the list.
+    // Nothing computed yet means the whole tree from the root, after every local
+    uint32_t n = 0;
+    if (s->world_stale) {
+        px_job_parallel_for(s->count, PX_EDITOR_TRANSFORM_GRAIN, transform_compose_range, s);
+        roots[n++] = 0;
+    } else if ((uint64_t)s->dirty_count * 32 > s->count) {
+        for (uint32_t i = 0; i < s->count; i++)
+            if (s->transform_dirty[i])
+                roots[n++] = i;
+    } else {
+        for (uint32_t i = 0; i < s->dirty_count; i++) {
+            uint32_t slot = editor_scene_slot(s, s->dirty[i]);
+            if (slot != NO_SLOT && s->transform_dirty[slot])
+                roots[n++] = slot;
+        }
+        qsort(roots, n, sizeof(uint32_t), transform_cmp_u32);
+    }
+
+    struct transform_update u = { .scene = s };
+    uint32_t total = 0, covered = 0;
+    bool ok = true;
+    for (uint32_t i = 0; i < n && ok; i++) {
+        uint32_t root = roots[i];
+        if (root < covered)
+            continue; // under an earlier changed object
+
+        uint32_t end = root + 1;
+        while (end < s->count && s->depth[end] > s->depth[root])
+            end++;
+        ok = transform_split(&u, root, end);
+        total += end - root;
+        covered = end;
+    }
+
+    if (ok) {
+        px_job_parallel_for(u.task_count, 1, transform_run, &u);
+        for (uint32_t i = 0; i < n; i++)
+            s->transform_dirty[roots[i]] = false;
+        s->dirty_count = 0;
+        s->world_stale = false;
+    } else {
+        fprintf(stderr, "Failed to allocate memory for the transform update, kept for the next update\n");
+        total = 0;
+    }
+
+    free(u.tasks);
+    free(u.stack);
+    free(roots);
+    return total;
+}
+
+bool editor_scene_world(PX_EditorScene* s, PX_EditorHandle object, PX_Mat4* out) {
+    if (editor_scene_slot(s, object) == NO_SLOT)
+        return false;
+    editor_scene_update_transforms(s);
+    // The update may have sorted the scene, so the slot is looked up after it
+    *out = s->world[editor_scene_slot(s, object)];
+    return true;
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdio.h>
 #include <stdbool.h>
 
 #include <window-sys.h>
@@ -10,30 +11,59 @@
 static char* save_path = NULL;
 static PX_Dropdown* menu_dropdown = NULL;
 
-// FILE Options
-static void handle_file_open(void) {
-
+static void menu_save_project(const char* path) {
+    t_err_codes err = editor_save_project(path);
+    if (err != ERR_SUCCESS)
+        fprintf(stderr, "Failed to save the project to %s (%d)\n", path, (int)err);
 }
-static void handle_file_save(void) {
 
+// FILE Options
+static void handle_file_open(void) {
+    char* path = px_ws_open_file_selector_dialog();
+    if (!path)
+        return;
+    t_err_codes err = editor_open_project(path);
+    if (err != ERR_SUCCESS)
+        fprintf(stderr, "Failed to open the project %s (%d)\n", path, (int)err);
+    free(path);
 }
 static void handle_file_save_as(void) {
-
+    char* path = px_ws_open_file_selector_dialog();
+    if (!path)
+        return;
+    menu_save_project(path);
+    free(path);
+}
+static void handle_file_save(void) {
+    // The file it came from or was last saved to, else the one given at init, else ask
+    PX_EditorState* state = editor_get_state();
+    const char* path = state->project_path ? state->project_path : save_path;
+    if (!path) {
+        handle_file_save_as();
+        return;
+    }
+    menu_save_project(path);
 }
 static void handle_file_quit(void) {
     PX_Event_GSignal signal = {0};
     signal.type = EVENT_GSIGNAL_CORE_QUIT;
+    signal.source = menu_dropdown;
     signal.core_quit = true;
 
     event_send_gsignal(&signal);
 }
 
 void menu_evs_init(PX_Dropdown* menu_dd, char* path_to_save) {
+    if (menu_dropdown)
+        event_unsubscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, menu_dropdown, menu_evs_handle_events, NULL);
     menu_dropdown = menu_dd;
     save_path = path_to_save;
+    if (event_subscribe_gsignal(EVENT_GSIGNAL_UI_DROPDOWN_CLICK, menu_dd, menu_evs_handle_events, NULL) != ERR_SUCCESS)
+        fprintf(stderr, "Failed to subscribe the menu bar to its clicks\n");
 }
 
-void menu_evs_handle_events(PX_Event_GSignal* signal) {
+void menu_evs_handle_events(const PX_Event_GSignal* signal, void* user) {
+    (void)user;
     switch (signal->type) {
         case EVENT_GSIGNAL_UI_DROPDOWN_CLICK:
             if (signal->ui_dropdown_click.dropdown != menu_dropdown) return;
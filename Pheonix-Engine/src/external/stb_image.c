@@ -0,0 +1,3 @@
+// Vendored stb_image, built alone so its flags stay off the engine code
+#define STB_IMAGE_IMPLEMENTATION
+#include <external/stb_image.h>
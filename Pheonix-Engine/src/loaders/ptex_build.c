@@ -0,0 +1,317 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <loaders/ptex-loader.h>
+#include <core/image.h>
+#include <core/pixel.h>
+#include <err-codes.h>
+
+size_t px_ptex_level_size(PX_PTexFormat format, uint32_t width, uint32_t height) {
+    size_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+
+    switch (format) {
+        case PX_PTEX_FORMAT_BC1: return bw * bh * 8;
+        case PX_PTEX_FORMAT_BC3: return bw * bh * 16;
+        default: return (size_t)width * height * 4;
+    }
+}
+
+// ===== Block codecs =====
+
+static uint16_t bc_pack565(const uint8_t c[3]) {
+    return (uint16_t)(((c[0] * 31 + 127) / 255) << 11 | ((c[1] * 63 + 127) / 255) << 5 | ((c[2] * 31 + 127) / 255));
+}
+
+static void bc_unpack565(uint16_t v, uint8_t out[3]) {
+    uint8_t r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+    out[0] = (uint8_t)((r << 3) | (r >> 2));
+    out[1] = (uint8_t)((g << 2) | (g >> 4));
+    out[2] = (uint8_t)((b << 3) | (b >> 2));
+}
+
+// Edge blocks repeat the last row/column so partial blocks stay well formed
+static void bc_fetch_block(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, uint8_t block[64]) {
+    for (int y = 0; y < 4; y++) {
+        uint32_t sy = by * 4 + y < height ? by * 4 + y : height - 1;
+        for (int x = 0; x < 4; x++) {
+            uint32_t sx = bx * 4 + x < width ? bx * 4 + x : width - 1;
+            memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+        }
+    }
+}
+
+// Range fit: endpoints from the inset bounding box, indices by nearest color
+static void bc_encode_color(const uint8_t block[64], uint8_t out[8]) {
+    uint8_t lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            if (block[i * 4 + c] < lo[c]) lo[c] = block[i * 4 + c];
+            if (block[i * 4 + c] > hi[c]) hi[c] = block[i * 4 + c];
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        int inset = (hi[c] - lo[c]) / 16;
+        lo[c] = (uint8_t)(lo[c] + inset);
+        hi[c] = (uint8_t)(hi[c] - inset);
+    }
+
+    uint16_t c0 = bc_pack565(hi), c1 = bc_pack565(lo);
+    if (c0 < c1) {
+        uint16_t t = c0; c0 = c1; c1 = t;
+    }
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        uint8_t palette[4][3];
+        bc_unpack565(c0, palette[0]);
+        bc_unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+
+        for (int i = 0; i < 16; i++) {
+            int best = 0, best_d = 1 << 30;
+            for (int p = 0; p < 4; p++) {
+                int d = 0;
+                for (int c = 0; c < 3; c++) {
+                    int e = block[i * 4 + c] - palette[p][c];
+                    d += e * e;
+                }
+                if (d < best_d) { best_d = d; best = p; }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+
+    out[0] = (uint8_t)c0; out[1] = (uint8_t)(c0 >> 8);
+    out[2] = (uint8_t)c1; out[3] = (uint8_t)(c1 >> 8);
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (uint8_t)(indices >> (i * 8));
+}
+
+static void bc_encode_alpha(const uint8_t block[64], uint8_t out[8]) {
+    uint8_t a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++) {
+        if (block[i * 4 + 3] > a0) a0 = block[i * 4 + 3];
+        if (block[i * 4 + 3] < a1) a1 = block[i * 4 + 3];
+    }
+
+    uint64_t indices = 0;
+    if (a0 != a1) {
+        int palette[8] = { a0, a1 };
+        for (int p = 1; p < 7; p++)
+            palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+
+        for (int i = 0; i < 16; i++) {
+            int best = 0, best_d = 1 << 30;
+            for (int p = 0; p < 8; p++) {
+                int d = abs(block[i * 4 + 3] - palette[p]);
+                if (d < best_d) { best_d = d; best = p; }
+            }
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (uint8_t)(indices >> (i * 8));
+}
+
+void px_ptex_encode_bc(PX_PTexFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out) {
+    uint8_t block[64];
+    uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+
+    for (uint32_t by = 0; by < bh; by++) {
+        for (uint32_t bx = 0; bx < bw; bx++) {
+            bc_fetch_block(rgba, width, height, bx, by, block);
+            if (format == PX_PTEX_FORMAT_BC3) {
+                bc_encode_alpha(block, out);
+                out += 8;
+            }
+            bc_encode_color(block, out);
+            out += 8;
+        }
+    }
+}
+
+static void bc_decode_color(const uint8_t in[8], bool four_color_only, uint8_t block[64]) {
+    uint16_t c0 = (uint16_t)(in[0] | in[1] << 8), c1 = (uint16_t)(in[2] | in[3] << 8);
+    uint32_t indices = (uint32_t)in[4] | (uint32_t)in[5] << 8 | (uint32_t)in[6] << 16 | (uint32_t)in[7] << 24;
+
+    uint8_t palette[4][4];
+    bc_unpack565(c0, palette[0]);
+    bc_unpack565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = 255;
+    if (c0 > c1 || four_color_only) {
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+        palette[2][3] = palette[3][3] = 255;
+    } else {
+        for (int c = 0; c < 3; c++)
+            palette[2][c] = (uint8_t)((palette[0][c] + palette[1][c]) / 2);
+        palette[2][3] = 255;
+        memset(palette[3], 0, 4);
+    }
+
+    for (int i = 0; i < 16; i++)
+        memcpy(block + i * 4, palette[(indices >> (i * 2)) & 3], 4);
+}
+
+static void bc_decode_alpha(const uint8_t in[8], uint8_t block[64]) {
+    int a0 = in[0], a1 = in[1];
+    int palette[8] = { a0, a1 };
+    if (a0 > a1) {
+        for (int p = 1; p < 7; p++)
+            palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+    } else {
+        for (int p = 1; p < 5; p++)
+            palette[p + 1] = ((5 - p) * a0 + p * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++)
+        indices |= (uint64_t)in[2 + i] << (i * 8);
+    for (int i = 0; i < 16; i++)
+        block[i * 4 + 3] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+}
+
+void px_ptex_decode_bc(PX_PTexFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba) {
+    uint8_t block[64];
+    uint32_t bw = (width + 3) / 4, bh = (height + 3) / 4;
+
+    for (uint32_t by = 0; by < bh; by++) {
+        for (uint32_t bx = 0; bx < bw; bx++) {
+            if (format == PX_PTEX_FORMAT_BC3) {
+                bc_decode_color(blocks + 8, true, block);
+                bc_decode_alpha(blocks, block);
+                blocks += 16;
+            } else {
+                bc_decode_color(blocks, false, block);
+                blocks += 8;
+            }
+
+            for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+                    memcpy(rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, block + (y * 4 + x) * 4, 4);
+            }
+        }
+    }
+}
+
+// ===== Builder =====
+
+static bool ptex_is_opaque(const uint8_t* rgba, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (rgba[i * 4 + 3] != 255)
+            return false;
+    }
+    return true;
+}
+
+static size_t ptex_align(size_t v) {
+    return (v + PX_PTEX_ALIGN - 1) & ~(size_t)(PX_PTEX_ALIGN - 1);
+}
+
+t_err_codes px_ptex_build(const char* input_png, const char* output_ptex, const PX_PTexBuildDesc* desc) {
+    int w, h, bit_depth, color_type;
+    uint8_t* pixels = NULL;
+    t_err_codes err = image_get_png(input_png, &w, &h, &bit_depth, &color_type, &pixels);
+    if (err != ERR_SUCCESS)
+        return err;
+    if (w <= 0 || h <= 0 || w > PX_PTEX_MAX_SIZE || h > PX_PTEX_MAX_SIZE) {
+        free(pixels);
+        return ERR_INTERNAL;
+    }
+
+    // Mips are filtered after premultiplying so edges do not pick up color
+    // from fully transparent texels.
+    if (desc->premultiply)
+        px_pixel_premultiply(pixels, pixels, (size_t)w * h);
+
+    struct px_ptex_header header = {
+        .magic = PX_PTEX_MAGIC,
+        .version = PX_PTEX_CUR_VERSION,
+        .format = desc->bgra ? PX_PTEX_FORMAT_BGRA8 : PX_PTEX_FORMAT_RGBA8,
+        .flags = desc->premultiply ? PX_PTEX_FLAG_PREMULTIPLIED : 0,
+        .width = (uint32_t)w,
+        .height = (uint32_t)h,
+        .mip_count = 1
+    };
+    if (desc->compress)
+        header.format = ptex_is_opaque(pixels, (size_t)w * h) ? PX_PTEX_FORMAT_BC1 : PX_PTEX_FORMAT_BC3;
+
+    if (desc->mipmaps) {
+        uint32_t mw = header.width, mh = header.height;
+        while ((mw > 1 || mh > 1) && header.mip_count < PX_PTEX_MAX_MIPS) {
+            mw = mw > 1 ? mw / 2 : 1;
+            mh = mh > 1 ? mh / 2 : 1;
+            header.mip_count++;
+        }
+    }
+
+    struct px_ptex_mip mips[PX_PTEX_MAX_MIPS] = {0};
+    size_t offset = ptex_align(sizeof(header) + sizeof(struct px_ptex_mip) * header.mip_count);
+    for (uint32_t i = 0; i < header.mip_count; i++) {
+        mips[i].width = i == 0 ? header.width : (mips[i - 1].width > 1 ? mips[i - 1].width / 2 : 1);
+        mips[i].height = i == 0 ? header.height : (mips[i - 1].height > 1 ? mips[i - 1].height / 2 : 1);
+        mips[i].size = px_ptex_level_size((PX_PTexFormat)header.format, mips[i].width, mips[i].height);
+        mips[i].offset = offset;
+        offset = ptex_align(offset + mips[i].size);
+    }
+
+    uint8_t* level = pixels;
+    uint8_t* next = (uint8_t*)malloc((size_t)w * h * 4);
+    uint8_t* encoded = (uint8_t*)malloc(px_ptex_level_size((PX_PTexFormat)header.format, header.width, header.height));
+    FILE* f = fopen(output_ptex, "wb");
+    if (!next || !encoded || !f) {
+        if (f) fclose(f);
+        free(next);
+        free(encoded);
+        free(pixels);
+        return f ? ERR_ALLOC_FAILED : ERR_COULD_NOT_OPEN_FILE;
+    }
+
+    static const uint8_t zeros[PX_PTEX_ALIGN] = {0};
+    size_t pos = sizeof(header) + sizeof(struct px_ptex_mip) * header.mip_count;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+        fwrite(mips, sizeof(struct px_ptex_mip), header.mip_count, f) == header.mip_count;
+
+    for (uint32_t i = 0; i < header.mip_count && ok; i++) {
+        if (i > 0) {
+            px_pixel_downscale_box(next, mips[i].width, mips[i].height, (size_t)mips[i].width * 4,
+                                   level, mips[i - 1].width, mips[i - 1].height, (size_t)mips[i - 1].width * 4);
+            uint8_t* t = level; level = next; next = t;
+        }
+
+        const uint8_t* data = level;
+        if (header.format == PX_PTEX_FORMAT_BC1 || header.format == PX_PTEX_FORMAT_BC3) {
+            px_ptex_encode_bc((PX_PTexFormat)header.format, level, mips[i].width, mips[i].height, encoded);
+            data = encoded;
+        } else if (header.format == PX_PTEX_FORMAT_BGRA8) {
+            static const uint8_t bgra[4] = { 2, 1, 0, 3 };
+            px_pixel_swizzle(encoded, level, (size_t)mips[i].width * mips[i].height, bgra);
+            data = encoded;
+        }
+
+        ok = fwrite(zeros, 1, mips[i].offset - pos, f) == mips[i].offset - pos &&
+            fwrite(data, 1, mips[i].size, f) == mips[i].size;
+        pos = mips[i].offset + mips[i].size;
+    }
+
+    if (fclose(f) != 0)
+        ok = false;
+    free(level);
+    free(next);
+    free(encoded);
+
+    return ok ? ERR_SUCCESS : ERR_COULD_NOT_OPEN_FILE;
+}
@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <loaders/ptex-loader.h>
+#include <asset-sys/vfs.h>
+#include <core/trace.h>
+#include <err-codes.h>
+
+static bool ptex_format_valid(uint16_t format) {
+    return format <= PX_PTEX_FORMAT_BC3;
+}
+
+static bool ptex_format_compressed(uint16_t format) {
+    return format == PX_PTEX_FORMAT_BC1 || format == PX_PTEX_FORMAT_BC3;
+}
+
+t_err_codes px_ptex_read(const char* path, struct px_ptex_source* out) {
+    PX_TRACE_SCOPE("px_ptex_read");
+    memset(out, 0, sizeof(*out));
+    if (px_vfs_open(path, &out->file) != ERR_SUCCESS)
+        return ERR_COULD_NOT_OPEN_FILE;
+
+    struct px_ptex_header* h = &out->header;
+    if (out->file.size < sizeof(*h)) {
+        px_ptex_source_free(out);
+        return ERR_MAGIC_INVALID;
+    }
+    memcpy(h, out->file.data, sizeof(*h));
+
+    if (h->magic != PX_PTEX_MAGIC) {
+        px_ptex_source_free(out);
+        return ERR_MAGIC_INVALID;
+    }
+
+    if (h->version > PX_PTEX_CUR_VERSION) {
+        px_ptex_source_free(out);
+        return ERR_VERSION_INVALID;
+    }
+
+    size_t table = sizeof(*h) + sizeof(struct px_ptex_mip) * (size_t)h->mip_count;
+    if (!ptex_format_valid(h->format) || h->mip_count == 0 || h->mip_count > PX_PTEX_MAX_MIPS ||
+        h->width == 0 || h->height == 0 || h->width > PX_PTEX_MAX_SIZE || h->height > PX_PTEX_MAX_SIZE ||
+        out->file.size < table) {
+        px_ptex_source_free(out);
+        return ERR_INTERNAL;
+    }
+    memcpy(out->mips, out->file.data + sizeof(*h), sizeof(struct px_ptex_mip) * h->mip_count);
+    if (out->mips[0].width != h->width || out->mips[0].height != h->height) {
+        px_ptex_source_free(out);
+        return ERR_INTERNAL;
+    }
+
+    // Every level halves the one above it, so none outgrows the upload's scratch buffer
+    for (uint32_t i = 0; i < h->mip_count; i++) {
+        const struct px_ptex_mip* m = &out->mips[i];
+        const struct px_ptex_mip* up = i > 0 ? &out->mips[i - 1] : NULL;
+        if (up && (m->width != (up->width > 1 ? up->width / 2 : 1) || m->height != (up->height > 1 ? up->height / 2 : 1))) {
+            px_ptex_source_free(out);
+            return ERR_INTERNAL;
+        }
+        if (m->offset > out->file.size || m->size > out->file.size - m->offset ||
+            m->size != px_ptex_level_size((PX_PTexFormat)h->format, m->width, m->height)) {
+            px_ptex_source_free(out);
+            return ERR_INTERNAL;
+        }
+    }
+
+    return ERR_SUCCESS;
+}
+
+void px_ptex_source_free(struct px_ptex_source* src) {
+    if (!src) return;
+
+    px_vfs_close(&src->file);
+    memset(src, 0, sizeof(*src));
+}
+
+static bool ptex_gl_has_s3tc(void) {
+    static int supported = -1;
+    if (supported < 0) {
+        const char* ext = (const char*)glGetString(GL_EXTENSIONS);
+        supported = ext && strstr(ext, "GL_EXT_texture_compression_s3tc") != NULL;
+    }
+    return supported == 1;
+}
+
+t_err_codes px_ptex_upload(const struct px_ptex_source* src, GLuint* out_texture) {
+    PX_TRACE_SCOPE("px_ptex_upload");
+    const struct px_ptex_header* h = &src->header;
+    bool compressed = ptex_format_compressed(h->format);
+    bool native = !compressed || ptex_gl_has_s3tc();
+
+    // Drivers without S3TC get the blocks expanded on the CPU, level by level
+    uint8_t* expanded = NULL;
+    if (!native) {
+        expanded = (uint8_t*)malloc((size_t)src->mips[0].width * src->mips[0].height * 4);
+        if (!expanded)
+            return ERR_ALLOC_FAILED;
+    }
+
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (uint32_t i = 0; i < h->mip_count; i++) {
+        const struct px_ptex_mip* m = &src->mips[i];
+        const uint8_t* data = src->file.data + m->offset;
+
+        if (!native) {
+            px_ptex_decode_bc((PX_PTexFormat)h->format, data, m->width, m->height, expanded);
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, m->width, m->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, expanded);
+        } else if (compressed) {
+            GLenum format = h->format == PX_PTEX_FORMAT_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, format, m->width, m->height, 0, (GLsizei)m->size, data);
+        } else {
+            GLenum order = h->format == PX_PTEX_FORMAT_BGRA8 ? GL_BGRA : GL_RGBA;
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, m->width, m->height, 0, order, GL_UNSIGNED_BYTE, data);
+        }
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    free(expanded);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)h->mip_count - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, h->mip_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    *out_texture = tex;
+    return ERR_SUCCESS;
+}
+
+t_err_codes px_ptex_load(const char* path, struct px_ptex_texture* out) {
+    struct px_ptex_source src;
+    t_err_codes err = px_ptex_read(path, &src);
+    if (err != ERR_SUCCESS)
+        return err;
+
+    GLuint tex = 0;
+    err = px_ptex_upload(&src, &tex);
+    if (err == ERR_SUCCESS) {
+        out->texture = tex;
+        out->width = src.header.width;
+        out->height = src.header.height;
+        out->mip_count = src.header.mip_count;
+        out->format = src.header.format;
+        out->flags = src.header.flags;
+    }
+    px_ptex_source_free(&src);
+
+    return err;
+}
+
+void px_ptex_free(struct px_ptex_texture* tex) {
+    if (!tex) return;
+
+    glDeleteTextures(1, &tex->texture);
+    memset(tex, 0, sizeof(*tex));
+}
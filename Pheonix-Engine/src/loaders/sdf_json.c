@@ -0,0 +1,497 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <loaders/sdf-loader.h>
+#include <decoders/json-sax.h>
+#include <font.h>
+#include <err-codes.h>
+
+#include <external/cJSON.h>
+
+void px_sdf_json_free(struct px_sdf_json_font* font) {
+    if (!font) return;
+
+    free(font->glyphs);
+    memset(font, 0, sizeof(*font));
+}
+
+static void sdf_json_fill_header(struct px_sdf_header* h, int glyph_count, int atlas_w, int atlas_h, float sdf_range, float ascent, float descent, float line_height, const PX_SDFBuildDesc* desc) {
+    *h = (struct px_sdf_header){
+        .magic = PX_SDF_MAGIC,
+        .version = 1,
+        .glyph_count = glyph_count,
+        .atlas_width = atlas_w,
+        .atlas_height = atlas_h,
+        .ascent = ascent * desc->pixel_size,
+        .descent = descent * desc->pixel_size,
+        .line_gap = line_height * desc->pixel_size,
+        .sdf_range = sdf_range
+    };
+}
+
+// ===== DOM =====
+
+t_err_codes px_sdf_parse_json_dom(const char* text, size_t len, const PX_SDFBuildDesc* desc, struct px_sdf_json_font* out) {
+    cJSON* root = cJSON_ParseWithLength(text, len);
+    if (!root) return ERR_INTERNAL;
+
+    cJSON* atlas = cJSON_GetObjectItem(root, "atlas");
+    if (!atlas) {
+        fprintf(stderr, "SDF is missing atlas!\n");
+        cJSON_Delete(root);
+        return ERR_INTERNAL;
+    }
+    cJSON* metrics = cJSON_GetObjectItem(root, "metrics");
+    if (!metrics) {
+        fprintf(stderr, "SDF is missing metrics!\n");
+        cJSON_Delete(root);
+        return ERR_INTERNAL;
+    }
+    cJSON* glyphs_json = cJSON_GetObjectItem(root, "glyphs");
+    if (!glyphs_json) {
+        fprintf(stderr, "SDF is missing glyphs!\n");
+        cJSON_Delete(root);
+        return ERR_INTERNAL;
+    }
+
+    int atlas_w = cJSON_GetObjectItem(atlas, "width")->valueint;
+    int atlas_h = cJSON_GetObjectItem(atlas, "height")->valueint;
+    float sdf_range = (float)cJSON_GetObjectItem(atlas, "distanceRange")->valuedouble;
+
+    int glyph_count = cJSON_GetArraySize(glyphs_json);
+
+    struct px_sdf_glyph* glyphs = (struct px_sdf_glyph*)calloc(glyph_count, sizeof(*glyphs));
+    if (!glyphs) {
+        cJSON_Delete(root);
+        return ERR_ALLOC_FAILED;
+    }
+
+    for (int i = 0; i < glyph_count; i++) {
+        cJSON* g = cJSON_GetArrayItem(glyphs_json, i);
+        if (!g) {
+            fprintf(stderr, "Glyph [%d] itself is missing!\n", i);
+            goto fail;
+        }
+
+        cJSON* plane = cJSON_GetObjectItem(g, "planeBounds");
+        cJSON* atlasb = cJSON_GetObjectItem(g, "atlasBounds");
+        struct px_sdf_glyph* glyph = &glyphs[i];
+
+        if (!plane || !atlasb) {
+            memset(glyph, 0, sizeof(*glyph));
+            continue;
+        }
+
+        cJSON* unicode = cJSON_GetObjectItem(g, "unicode");
+        if (!unicode) {
+            cJSON* index = cJSON_GetObjectItem(g, "index");
+            if (!index) {
+                fprintf(stderr, "Glyph [%d] missing both unicode and index!\n", i);
+                goto fail;
+            }
+            glyph->codepoint = index->valueint;
+        } else {
+            glyph->codepoint = unicode->valueint;
+        }
+        cJSON* advance = cJSON_GetObjectItem(g, "advance");
+        if (!advance) {
+            fprintf(stderr, "Glyph [%d] missing advance!\n", i);
+            goto fail;
+        }
+        glyph->advance = advance->valuedouble * desc->pixel_size;
+        cJSON* leftj = cJSON_GetObjectItem(plane, "left");
+        cJSON* rightj = cJSON_GetObjectItem(plane, "right");
+        cJSON* topj = cJSON_GetObjectItem(plane, "top");
+        cJSON* bottomj = cJSON_GetObjectItem(plane, "bottom");
+
+        if (!leftj || !rightj || !topj || !bottomj) {
+            fprintf(stderr, "Glyph [%d] missing left/right/top/bottom!\n", i);
+            goto fail;
+        }
+
+        float left = (float)leftj->valuedouble;
+        float right = (float)rightj->valuedouble;
+        float top = (float)topj->valuedouble;
+        float bottom = (float)bottomj->valuedouble;
+
+        glyph->bearing_x = left * desc->pixel_size;
+        glyph->bearing_y = top  * desc->pixel_size;
+        glyph->width = (right - left) * desc->pixel_size;
+        glyph->height = (top - bottom) * desc->pixel_size;
+
+        leftj = cJSON_GetObjectItem(atlasb, "left");
+        rightj = cJSON_GetObjectItem(atlasb, "right");
+        topj = cJSON_GetObjectItem(atlasb, "top");
+        bottomj = cJSON_GetObjectItem(atlasb, "bottom");
+
+        if (!leftj || !rightj || !topj || !bottomj) {
+            fprintf(stderr, "Glyph [%d]->atlasBounds missing left/right/top/bottom!\n", i);
+            goto fail;
+        }
+
+        float al = (float)leftj->valuedouble;
+        float ar = (float)rightj->valuedouble;
+        float ab = (float)bottomj->valuedouble;
+        float at = (float)topj->valuedouble;
+
+        glyph->u0 = al / atlas_w;
+        glyph->v0 = ab / atlas_h;
+        glyph->u1 = ar / atlas_w;
+        glyph->v1 = at / atlas_h;
+    }
+
+    cJSON* ascender = cJSON_GetObjectItem(metrics, "ascender");
+    cJSON* descender = cJSON_GetObjectItem(metrics, "descender");
+    cJSON* lineHeight = cJSON_GetObjectItem(metrics, "lineHeight");
+
+    if (!ascender || !descender || !lineHeight) {
+        fprintf(stderr, "Metrics is missing Ascender/Descender/Line height\n");
+        goto fail;
+    }
+
+    sdf_json_fill_header(
+        &out->header, glyph_count, atlas_w, atlas_h, sdf_range,
+        (float)ascender->valuedouble, (float)descender->valuedouble, (float)lineHeight->valuedouble,
+        desc
+    );
+    out->glyphs = glyphs;
+
+    cJSON_Delete(root);
+    return ERR_SUCCESS;
+
+fail:
+    free(glyphs);
+    cJSON_Delete(root);
+    return ERR_INTERNAL;
+}
+
+// ===== Stream =====
+
+enum sdf_sax_section {
+    SDF_SAX_NONE,
+    SDF_SAX_ATLAS,
+    SDF_SAX_METRICS,
+    SDF_SAX_GLYPHS,
+    SDF_SAX_GLYPH,
+    SDF_SAX_PLANE,
+    SDF_SAX_ATLAS_BOUNDS,
+    SDF_SAX_SKIP
+};
+
+#define SDF_BOUND_ALL 0xF // left, bottom, right, top
+
+struct sdf_sax_glyph {
+    bool has_unicode, has_index, has_advance;
+    bool has_plane, has_atlas;
+    int plane_mask, atlas_mask;
+
+    double unicode, index, advance;
+    double plane[4];
+    double atlas[4];
+};
+
+struct sdf_sax_state {
+    const PX_SDFBuildDesc* desc;
+
+    enum sdf_sax_section stack[PX_JSON_SAX_MAX_DEPTH];
+    int depth;
+    const char* key;
+    size_t key_len;
+
+    bool has_atlas, has_metrics, has_glyphs;
+    int found; // bit per required atlas/metrics value
+    double atlas_w, atlas_h, sdf_range;
+    double ascender, descender, line_height;
+
+    struct sdf_sax_glyph cur;
+    struct px_sdf_glyph* glyphs;
+    int glyph_count;
+    int glyph_capacity;
+};
+
+enum {
+    SDF_FOUND_WIDTH = 1 << 0,
+    SDF_FOUND_HEIGHT = 1 << 1,
+    SDF_FOUND_RANGE = 1 << 2,
+    SDF_FOUND_ASCENDER = 1 << 3,
+    SDF_FOUND_DESCENDER = 1 << 4,
+    SDF_FOUND_LINE_HEIGHT = 1 << 5
+};
+
+static bool sdf_key_is(struct sdf_sax_state* s, const char* name) {
+    size_t n = strlen(name);
+    return s->key_len == n && memcmp(s->key, name, n) == 0;
+}
+
+static enum sdf_sax_section sdf_sax_top(struct sdf_sax_state* s) {
+    return s->depth > 0 ? s->stack[s->depth - 1] : SDF_SAX_NONE;
+}
+
+static int sdf_sax_bound_index(struct sdf_sax_state* s) {
+    if (sdf_key_is(s, "left")) return 0;
+    if (sdf_key_is(s, "bottom")) return 1;
+    if (sdf_key_is(s, "right")) return 2;
+    if (sdf_key_is(s, "top")) return 3;
+    return -1;
+}
+
+static bool sdf_sax_push(struct sdf_sax_state* s, enum sdf_sax_section section) {
+    if (s->depth >= PX_JSON_SAX_MAX_DEPTH)
+        return false;
+    s->stack[s->depth++] = section;
+    s->key = NULL;
+    s->key_len = 0;
+    return true;
+}
+
+static bool sdf_sax_container(struct sdf_sax_state* s, bool is_object) {
+    enum sdf_sax_section top = sdf_sax_top(s);
+    enum sdf_sax_section next = SDF_SAX_SKIP;
+
+    if (s->depth == 0) {
+        next = is_object ? SDF_SAX_NONE : SDF_SAX_SKIP;
+    } else if (top == SDF_SAX_NONE && s->depth == 1) {
+        if (is_object && sdf_key_is(s, "atlas")) {
+            s->has_atlas = true;
+            next = SDF_SAX_ATLAS;
+        } else if (is_object && sdf_key_is(s, "metrics")) {
+            s->has_metrics = true;
+            next = SDF_SAX_METRICS;
+        } else if (!is_object && sdf_key_is(s, "glyphs")) {
+            s->has_glyphs = true;
+            next = SDF_SAX_GLYPHS;
+        }
+    } else if (top == SDF_SAX_GLYPHS && is_object) {
+        memset(&s->cur, 0, sizeof(s->cur));
+        next = SDF_SAX_GLYPH;
+    } else if (top == SDF_SAX_GLYPH && is_object) {
+        if (sdf_key_is(s, "planeBounds")) {
+            s->cur.has_plane = true;
+            next = SDF_SAX_PLANE;
+        } else if (sdf_key_is(s, "atlasBounds")) {
+            s->cur.has_atlas = true;
+            next = SDF_SAX_ATLAS_BOUNDS;
+        }
+    }
+
+    return sdf_sax_push(s, next);
+}
+
+static bool sdf_sax_object_begin(void* user) {
+    return sdf_sax_container((struct sdf_sax_state*)user, true);
+}
+
+static bool sdf_sax_array_begin(void* user) {
+    return sdf_sax_container((struct sdf_sax_state*)user, false);
+}
+
+static bool sdf_sax_emit_glyph(struct sdf_sax_state* s) {
+    if (s->glyph_count >= s->glyph_capacity) {
+        int capacity = s->glyph_capacity ? s->glyph_capacity * 2 : 512;
+        struct px_sdf_glyph* glyphs = (struct px_sdf_glyph*)realloc(s->glyphs, sizeof(*glyphs) * capacity);
+        if (!glyphs)
+            return false;
+        s->glyphs = glyphs;
+        s->glyph_capacity = capacity;
+    }
+
+    int i = s->glyph_count++;
+    struct px_sdf_glyph* glyph = &s->glyphs[i];
+    struct sdf_sax_glyph* g = &s->cur;
+    memset(glyph, 0, sizeof(*glyph));
+
+    // Same rules as the DOM path, so both produce identical PSDF files
+    if (!g->has_plane || !g->has_atlas)
+        return true;
+
+    if (g->has_unicode) {
+        glyph->codepoint = (uint32_t)(int)g->unicode;
+    } else if (g->has_index) {
+        glyph->codepoint = (uint32_t)(int)g->index;
+    } else {
+        fprintf(stderr, "Glyph [%d] missing both unicode and index!\n", i);
+        return false;
+    }
+
+    if (!g->has_advance) {
+        fprintf(stderr, "Glyph [%d] missing advance!\n", i);
+        return false;
+    }
+    glyph->advance = g->advance * s->desc->pixel_size;
+
+    if (g->plane_mask != SDF_BOUND_ALL) {
+        fprintf(stderr, "Glyph [%d] missing left/right/top/bottom!\n", i);
+        return false;
+    }
+
+    float left = (float)g->plane[0];
+    float bottom = (float)g->plane[1];
+    float right = (float)g->plane[2];
+    float top = (float)g->plane[3];
+
+    glyph->bearing_x = left * s->desc->pixel_size;
+    glyph->bearing_y = top  * s->desc->pixel_size;
+    glyph->width = (right - left) * s->desc->pixel_size;
+    glyph->height = (top - bottom) * s->desc->pixel_size;
+
+    if (g->atlas_mask != SDF_BOUND_ALL) {
+        fprintf(stderr, "Glyph [%d]->atlasBounds missing left/right/top/bottom!\n", i);
+        return false;
+    }
+
+    // Atlas size may come after the glyphs; normalised in a final pass
+    glyph->u0 = (float)g->atlas[0];
+    glyph->v0 = (float)g->atlas[1];
+    glyph->u1 = (float)g->atlas[2];
+    glyph->v1 = (float)g->atlas[3];
+
+    return true;
+}
+
+static bool sdf_sax_container_end(void* user) {
+    struct sdf_sax_state* s = (struct sdf_sax_state*)user;
+    if (s->depth <= 0)
+        return false;
+
+    enum sdf_sax_section section = s->stack[--s->depth];
+    s->key = NULL;
+    s->key_len = 0;
+
+    if (section == SDF_SAX_GLYPH)
+        return sdf_sax_emit_glyph(s);
+    return true;
+}
+
+static bool sdf_sax_key(void* user, const char* key, size_t len) {
+    struct sdf_sax_state* s = (struct sdf_sax_state*)user;
+    s->key = key;
+    s->key_len = len;
+    return true;
+}
+
+static bool sdf_sax_number(void* user, double value) {
+    struct sdf_sax_state* s = (struct sdf_sax_state*)user;
+    int bound;
+
+    switch (sdf_sax_top(s)) {
+        case SDF_SAX_ATLAS:
+            if (sdf_key_is(s, "width")) {
+                s->atlas_w = value;
+                s->found |= SDF_FOUND_WIDTH;
+            } else if (sdf_key_is(s, "height")) {
+                s->atlas_h = value;
+                s->found |= SDF_FOUND_HEIGHT;
+            } else if (sdf_key_is(s, "distanceRange")) {
+                s->sdf_range = value;
+                s->found |= SDF_FOUND_RANGE;
+            }
+            break;
+        case SDF_SAX_METRICS:
+            if (sdf_key_is(s, "ascender")) {
+                s->ascender = value;
+                s->found |= SDF_FOUND_ASCENDER;
+            } else if (sdf_key_is(s, "descender")) {
+                s->descender = value;
+                s->found |= SDF_FOUND_DESCENDER;
+            } else if (sdf_key_is(s, "lineHeight")) {
+                s->line_height = value;
+                s->found |= SDF_FOUND_LINE_HEIGHT;
+            }
+            break;
+        case SDF_SAX_GLYPH:
+            if (sdf_key_is(s, "unicode")) {
+                s->cur.unicode = value;
+                s->cur.has_unicode = true;
+            } else if (sdf_key_is(s, "index")) {
+                s->cur.index = value;
+                s->cur.has_index = true;
+            } else if (sdf_key_is(s, "advance")) {
+                s->cur.advance = value;
+                s->cur.has_advance = true;
+            }
+            break;
+        case SDF_SAX_PLANE:
+            bound = sdf_sax_bound_index(s);
+            if (bound >= 0) {
+                s->cur.plane[bound] = value;
+                s->cur.plane_mask |= 1 << bound;
+            }
+            break;
+        case SDF_SAX_ATLAS_BOUNDS:
+            bound = sdf_sax_bound_index(s);
+            if (bound >= 0) {
+                s->cur.atlas[bound] = value;
+                s->cur.atlas_mask |= 1 << bound;
+            }
+            break;
+        default: break;
+    }
+
+    return true;
+}
+
+t_err_codes px_sdf_parse_json_stream(const char* text, size_t len, const PX_SDFBuildDesc* desc, struct px_sdf_json_font* out) {
+    struct sdf_sax_state* s = (struct sdf_sax_state*)calloc(1, sizeof(*s));
+    if (!s)
+        return ERR_ALLOC_FAILED;
+    s->desc = desc;
+
+    PX_JsonSax sax = {
+        .user = s,
+        .object_begin = sdf_sax_object_begin,
+        .object_end = sdf_sax_container_end,
+        .array_begin = sdf_sax_array_begin,
+        .array_end = sdf_sax_container_end,
+        .key = sdf_sax_key,
+        .number = sdf_sax_number
+    };
+
+    t_err_codes err = px_json_sax_parse(text, len, &sax);
+    if (err == ERR_SUCCESS) {
+        if (!s->has_atlas) {
+            fprintf(stderr, "SDF is missing atlas!\n");
+            err = ERR_INTERNAL;
+        } else if (!s->has_metrics) {
+            fprintf(stderr, "SDF is missing metrics!\n");
+            err = ERR_INTERNAL;
+        } else if (!s->has_glyphs) {
+            fprintf(stderr, "SDF is missing glyphs!\n");
+            err = ERR_INTERNAL;
+        } else if ((s->found & (SDF_FOUND_WIDTH | SDF_FOUND_HEIGHT | SDF_FOUND_RANGE)) != (SDF_FOUND_WIDTH | SDF_FOUND_HEIGHT | SDF_FOUND_RANGE)) {
+            fprintf(stderr, "SDF atlas is missing width/height/distanceRange!\n");
+            err = ERR_INTERNAL;
+        } else if ((s->found & (SDF_FOUND_ASCENDER | SDF_FOUND_DESCENDER | SDF_FOUND_LINE_HEIGHT)) != (SDF_FOUND_ASCENDER | SDF_FOUND_DESCENDER | SDF_FOUND_LINE_HEIGHT)) {
+            fprintf(stderr, "Metrics is missing Ascender/Descender/Line height\n");
+            err = ERR_INTERNAL;
+        }
+    }
+
+    if (err != ERR_SUCCESS) {
+        free(s->glyphs);
+        free(s);
+        return err;
+    }
+
+    int atlas_w = (int)s->atlas_w;
+    int atlas_h = (int)s->atlas_h;
+    for (int i = 0; i < s->glyph_count; i++) {
+        struct px_sdf_glyph* g = &s->glyphs[i];
+        g->u0 /= atlas_w;
+        g->v0 /= atlas_h;
+        g->u1 /= atlas_w;
+        g->v1 /= atlas_h;
+    }
+
+    sdf_json_fill_header(
+        &out->header, s->glyph_count, atlas_w, atlas_h, (float)s->sdf_range,
+        (float)s->ascender, (float)s->descender, (float)s->line_height,
+        desc
+    );
+    out->glyphs = s->glyphs;
+
+    free(s);
+    return ERR_SUCCESS;
+}
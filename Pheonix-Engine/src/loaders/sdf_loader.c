@@ -4,72 +4,119 @@
 #include <string.h>
 
 #include <loaders/sdf-loader.h>
+#include <asset-sys/vfs.h>
 #include <font.h>
+#include <core/trace.h>
 #include <err-codes.h>
 
-t_err_codes px_sdf_load(const char* path, struct px_sdf_font_data* out) {
-    FILE* f = fopen(path, "rb");
-    if (!f) return ERR_COULD_NOT_OPEN_FILE;
+t_err_codes px_sdf_read(const char* path, struct px_sdf_font_source* out) {
+    PX_TRACE_SCOPE("px_sdf_read");
+    memset(out, 0, sizeof(*out));
+    if (px_vfs_open(path, &out->file) != ERR_SUCCESS)
+        return ERR_COULD_NOT_OPEN_FILE;
 
-    struct px_sdf_header h;
-    fread(&h, sizeof(h), 1, f);
+    struct px_sdf_header* h = &out->header;
+    if (out->file.size < sizeof(*h)) {
+        px_sdf_source_free(out);
+        return ERR_MAGIC_INVALID;
+    }
+    memcpy(h, out->file.data, sizeof(*h));
 
-    if (h.magic != PX_SDF_MAGIC) {
-        fclose(f);
+    if (h->magic != PX_SDF_MAGIC) {
+        px_sdf_source_free(out);
         return ERR_MAGIC_INVALID;
     }
 
-    if (h.version > PX_SDF_CUR_VERSION) {
-        fclose(f);
+    if (h->version > PX_SDF_CUR_VERSION) {
+        px_sdf_source_free(out);
         return ERR_VERSION_INVALID;
     }
 
-    struct px_sdf_glyph* glyphs = (struct px_sdf_glyph*)malloc(sizeof(*glyphs) * h.glyph_count);
-    if (!glyphs) {
-        fclose(f);
-        return ERR_ALLOC_FAILED;
+    size_t glyphs_size = sizeof(struct px_sdf_glyph) * h->glyph_count;
+    size_t atlas_size = (size_t)h->atlas_width * h->atlas_height;
+    if (out->file.size < sizeof(*h) + glyphs_size + atlas_size) {
+        px_sdf_source_free(out);
+        return ERR_INTERNAL;
     }
-    fread(glyphs, sizeof(*glyphs), h.glyph_count, f);
 
-    size_t atlas_size = h.atlas_width * h.atlas_height;
-    unsigned char* pixels = (unsigned char*)malloc(atlas_size);
-    if (!pixels) {
-        free(glyphs);
-        fclose(f);
+    out->glyphs = (struct px_sdf_glyph*)malloc(glyphs_size ? glyphs_size : 1);
+    if (!out->glyphs) {
+        px_sdf_source_free(out);
         return ERR_ALLOC_FAILED;
     }
-    fread(pixels, 1, atlas_size, f);
+    memcpy(out->glyphs, out->file.data + sizeof(*h), glyphs_size);
+
+    // The atlas stays a view into the file, it is only ever read by the upload
+    out->atlas = out->file.data + sizeof(*h) + glyphs_size;
 
-    fclose(f);
+    return ERR_SUCCESS;
+}
+
+void px_sdf_source_free(struct px_sdf_font_source* src) {
+    if (!src) return;
+
+    free(src->glyphs);
+    px_vfs_close(&src->file);
+    memset(src, 0, sizeof(*src));
+}
+
+void px_sdf_source_finish(struct px_sdf_font_source* src, GLuint texture, struct px_sdf_font_data* out) {
+    out->texture = texture;
+    out->glyphs = src->glyphs;
+    out->glyph_count = src->header.glyph_count;
+    out->ascent = src->header.ascent;
+    out->descent = src->header.descent;
+    out->line_gap = src->header.line_gap;
+    out->sdf_range = src->header.sdf_range;
+
+    src->glyphs = NULL;
+    px_sdf_source_free(src);
+}
+
+t_err_codes px_sdf_load(const char* path, struct px_sdf_font_data* out) {
+    struct px_sdf_font_source src;
+    t_err_codes err = px_sdf_read(path, &src);
+    if (err != ERR_SUCCESS)
+        return err;
 
     GLuint tex;
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D, tex);
 
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glTexImage2D(
         GL_TEXTURE_2D, 0, GL_LUMINANCE,
-        h.atlas_width, h.atlas_height,
-        0, GL_LUMINANCE, GL_UNSIGNED_BYTE, pixels
+        src.header.atlas_width, src.header.atlas_height,
+        0, GL_LUMINANCE, GL_UNSIGNED_BYTE, src.atlas
     );
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    free(pixels);
-
-    out->texture = tex;
-    out->glyphs = glyphs;
-    out->glyph_count = h.glyph_count;
-    out->ascent = h.ascent;
-    out->descent = h.descent;
-    out->line_gap = h.line_gap;
-    out->sdf_range = h.sdf_range;
+    px_sdf_source_finish(&src, tex, out);
 
     return ERR_SUCCESS;
 }
 
+PX_Font* px_sdf_font_create(const struct px_sdf_font_data* sdf) {
+    PX_Font* font = calloc(1, sizeof(PX_Font));
+    if (!font) return NULL;
+
+    font->backend = PX_FONT_BACKEND_SDF;
+    font->impl.sdf.texture = sdf->texture;
+    font->impl.sdf.glyphs = sdf->glyphs;
+    font->impl.sdf.glyph_count = sdf->glyph_count;
+    font->impl.sdf.ascent = sdf->ascent;
+    font->impl.sdf.descent = sdf->descent;
+    font->impl.sdf.line_gap = sdf->line_gap;
+    font->impl.sdf.sdf_range = sdf->sdf_range;
+
+    return font;
+}
+
 void px_sdf_free(struct px_sdf_font_data* data) {
     if (!data) return;
 
@@ -0,0 +1,192 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rendering-sys.h>
+#include <core/hash.h>
+#include <core/trace.h>
+
+// Rects recorded over one frame and filed by cell: cell_start[c] .. cell_start[c + 1]
+// are the indices into hits of every rect touching cell c
+struct hit_index {
+    PX_RSHit* hits;
+    int count;
+    int capacity;
+
+    int screen_w, screen_h;
+    int cols, rows;
+    int* cell_start;
+    int cell_capacity;
+    int* cell_hits;
+    int ref_capacity;
+
+    uint64_t hash;
+};
+
+// One index answers queries while the other is recorded into
+static struct hit_index g_hit[2] = {0};
+static int g_hit_front = 0;
+static bool g_hit_recording = false;
+static uint64_t g_hit_generation = 1;
+
+static struct hit_index* hit_back(void) {
+    return &g_hit[g_hit_front ^ 1];
+}
+
+static bool hit_reserve(int** buf, int* capacity, int needed) {
+    if (needed <= *capacity)
+        return true;
+
+    int cap = *capacity ? *capacity : 64;
+    while (cap < needed)
+        cap *= 2;
+    int* grown = (int*)realloc(*buf, sizeof(int) * (size_t)cap);
+    if (!grown)
+        return false;
+    *buf = grown;
+    *capacity = cap;
+    return true;
+}
+
+// Inclusive cell range a rect covers, false when it is entirely off screen
+static bool hit_cells(const struct hit_index* idx, PX_Transform2 r, int* c0, int* r0, int* c1, int* r1) {
+    int x0 = r.pos.x, y0 = r.pos.y;
+    int x1 = r.pos.x + r.scale.w, y1 = r.pos.y + r.scale.h;
+    if (r.scale.w < 0 || r.scale.h < 0 || x1 < 0 || y1 < 0 || x0 >= idx->screen_w || y0 >= idx->screen_h)
+        return false;
+
+    *c0 = x0 < 0 ? 0 : x0 / PX_RS_HIT_CELL;
+    *r0 = y0 < 0 ? 0 : y0 / PX_RS_HIT_CELL;
+    *c1 = x1 / PX_RS_HIT_CELL;
+    *r1 = y1 / PX_RS_HIT_CELL;
+    if (*c1 >= idx->cols) *c1 = idx->cols - 1;
+    if (*r1 >= idx->rows) *r1 = idx->rows - 1;
+    return true;
+}
+
+static bool hit_build(struct hit_index* idx) {
+    int cells = idx->cols * idx->rows;
+    if (!hit_reserve(&idx->cell_start, &idx->cell_capacity, cells + 1))
+        return false;
+    memset(idx->cell_start, 0, sizeof(int) * (size_t)(cells + 1));
+
+    // Count, prefix sum, then fill; the fill walks in draw order so every cell lists bottom to top
+    int c0, r0, c1, r1;
+    for (int i = 0; i < idx->count; i++) {
+        if (!hit_cells(idx, idx->hits[i].rect, &c0, &r0, &c1, &r1))
+            continue;
+        for (int y = r0; y <= r1; y++)
+            for (int x = c0; x <= c1; x++)
+                idx->cell_start[y * idx->cols + x + 1]++;
+    }
+    for (int c = 0; c < cells; c++)
+        idx->cell_start[c + 1] += idx->cell_start[c];
+
+    if (!hit_reserve(&idx->cell_hits, &idx->ref_capacity, idx->cell_start[cells]))
+        return false;
+    for (int i = 0; i < idx->count; i++) {
+        if (!hit_cells(idx, idx->hits[i].rect, &c0, &r0, &c1, &r1))
+            continue;
+        for (int y = r0; y <= r1; y++)
+            for (int x = c0; x <= c1; x++)
+                idx->cell_hits[idx->cell_start[y * idx->cols + x]++] = i;
+    }
+    // The fill advanced every start to the next cell's, shift them back
+    for (int c = cells; c > 0; c--)
+        idx->cell_start[c] = idx->cell_start[c - 1];
+    idx->cell_start[0] = 0;
+    return true;
+}
+
+void px_rs_hit_begin(PX_Scale2 screen_scale) {
+    struct hit_index* idx = hit_back();
+    idx->count = 0;
+    idx->screen_w = screen_scale.w > 0 ? screen_scale.w : 0;
+    idx->screen_h = screen_scale.h > 0 ? screen_scale.h : 0;
+    idx->cols = (idx->screen_w + PX_RS_HIT_CELL - 1) / PX_RS_HIT_CELL;
+    idx->rows = (idx->screen_h + PX_RS_HIT_CELL - 1) / PX_RS_HIT_CELL;
+    g_hit_recording = true;
+}
+
+void px_rs_hit_add(PX_Transform2 rect, PX_RSHitKind kind, const void* owner, int index, int sub) {
+    if (!g_hit_recording)
+        return;
+
+    struct hit_index* idx = hit_back();
+    if (idx->count >= idx->capacity) {
+        int cap = idx->capacity ? idx->capacity * 2 : 64;
+        PX_RSHit* grown = (PX_RSHit*)realloc(idx->hits, sizeof(PX_RSHit) * (size_t)cap);
+        if (!grown)
+            return;
+        idx->hits = grown;
+        idx->capacity = cap;
+    }
+
+    PX_RSHit* hit = &idx->hits[idx->count];
+    hit->owner = owner;
+    hit->kind = kind;
+    hit->index = index;
+    hit->sub = sub;
+    hit->z = idx->count++;
+    hit->rect = rect;
+}
+
+void px_rs_hit_end(void) {
+    PX_TRACE_SCOPE("px_rs_hit_end");
+    if (!g_hit_recording)
+        return;
+    g_hit_recording = false;
+
+    struct hit_index* idx = hit_back();
+    if (!hit_build(idx)) {
+        // Keep answering from the last frame rather than from half an index
+        idx->count = 0;
+        return;
+    }
+
+    idx->hash = px_hash64(idx->hits, sizeof(PX_RSHit) * (size_t)idx->count, (uint64_t)idx->screen_w << 32 | (uint32_t)idx->screen_h);
+    const struct hit_index* front = &g_hit[g_hit_front];
+    if (idx->hash != front->hash || idx->count != front->count)
+        g_hit_generation++;
+    g_hit_front ^= 1;
+}
+
+void px_rs_hit_shutdown(void) {
+    for (int i = 0; i < 2; i++) {
+        free(g_hit[i].hits);
+        free(g_hit[i].cell_start);
+        free(g_hit[i].cell_hits);
+    }
+    memset(g_hit, 0, sizeof(g_hit));
+    g_hit_front = 0;
+    g_hit_recording = false;
+    g_hit_generation++;
+}
+
+bool px_rs_hit_query(PX_Vector2 point, PX_RSHit* out) {
+    const struct hit_index* idx = &g_hit[g_hit_front];
+    if (idx->count == 0 || point.x < 0 || point.y < 0 || point.x >= idx->screen_w || point.y >= idx->screen_h)
+        return false;
+
+    int cell = (point.y / PX_RS_HIT_CELL) * idx->cols + point.x / PX_RS_HIT_CELL;
+    const PX_RSHit* top = NULL;
+    // Later entries were drawn later, the last one containing the point is on top
+    for (int i = idx->cell_start[cell + 1] - 1; i >= idx->cell_start[cell]; i--) {
+        const PX_RSHit* hit = &idx->hits[idx->cell_hits[i]];
+        PX_Transform2 r = hit->rect;
+        if (point.x >= r.pos.x && point.x <= r.pos.x + r.scale.w &&
+            point.y >= r.pos.y && point.y <= r.pos.y + r.scale.h) {
+            top = hit;
+            break;
+        }
+    }
+    if (!top)
+        return false;
+    *out = *top;
+    return true;
+}
+
+uint64_t px_rs_hit_generation(void) {
+    return g_hit_generation;
+}
@@ -0,0 +1,280 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <rendering-sys.h>
+#include <core/trace.h>
+
+struct layout_node {
+    bool used;
+    bool dirty; // this node or something under it changed since the last update
+    bool text_dirty;
+    bool hidden;
+
+    PX_LayoutNode parent;
+    PX_LayoutNode first_child;
+    PX_LayoutNode last_child;
+    PX_LayoutNode next; // sibling, or the next free node
+
+    PX_LayoutDesc desc;
+
+    PX_Font* font;
+    const char* text;
+    float text_height;
+    int text_w;
+
+    PX_Vector2 pos; // from the parent's origin
+    PX_Scale2 size;
+};
+
+static struct {
+    struct layout_node* nodes;
+    int capacity;
+    int count;
+    PX_LayoutNode free_list;
+    PX_LayoutNode first_root;
+    PX_LayoutNode last_root;
+    bool dirty;
+    PX_LayoutStats stats;
+} g_layout = { .free_list = PX_LAYOUT_NONE, .first_root = PX_LAYOUT_NONE, .last_root = PX_LAYOUT_NONE };
+
+static struct layout_node* layout_get(PX_LayoutNode node) {
+    if (node < 0 || node >= g_layout.capacity || !g_layout.nodes[node].used)
+        return NULL;
+    return &g_layout.nodes[node];
+}
+
+// A hidden node dirtied earlier may sit under clean ancestors, so this always walks to the root
+static void layout_mark(PX_LayoutNode node) {
+    while (node != PX_LAYOUT_NONE) {
+        struct layout_node* n = &g_layout.nodes[node];
+        n->dirty = true;
+        node = n->parent;
+    }
+    g_layout.dirty = true;
+}
+
+PX_LayoutNode px_layout_create(PX_LayoutNode parent, const PX_LayoutDesc* desc) {
+    if (parent != PX_LAYOUT_NONE && !layout_get(parent))
+        return PX_LAYOUT_NONE;
+
+    PX_LayoutNode node = g_layout.free_list;
+    if (node != PX_LAYOUT_NONE) {
+        g_layout.free_list = g_layout.nodes[node].next;
+    } else {
+        if (g_layout.count >= g_layout.capacity) {
+            int cap = g_layout.capacity ? g_layout.capacity * 2 : 64;
+            struct layout_node* grown = (struct layout_node*)realloc(g_layout.nodes, sizeof(struct layout_node) * (size_t)cap);
+            if (!grown)
+                return PX_LAYOUT_NONE;
+            g_layout.nodes = grown;
+            g_layout.capacity = cap;
+        }
+        node = g_layout.count++;
+    }
+
+    struct layout_node* n = &g_layout.nodes[node];
+    memset(n, 0, sizeof(*n));
+    n->used = true;
+    n->parent = parent;
+    n->first_child = n->last_child = n->next = PX_LAYOUT_NONE;
+    if (desc)
+        n->desc = *desc;
+
+    PX_LayoutNode* first = parent == PX_LAYOUT_NONE ? &g_layout.first_root : &g_layout.nodes[parent].first_child;
+    PX_LayoutNode* last = parent == PX_LAYOUT_NONE ? &g_layout.last_root : &g_layout.nodes[parent].last_child;
+    if (*last != PX_LAYOUT_NONE)
+        g_layout.nodes[*last].next = node;
+    else
+        *first = node;
+    *last = node;
+
+    g_layout.stats.nodes++;
+    layout_mark(node);
+    return node;
+}
+
+static void layout_free_subtree(PX_LayoutNode node) {
+    struct layout_node* n = &g_layout.nodes[node];
+    for (PX_LayoutNode c = n->first_child; c != PX_LAYOUT_NONE;) {
+        PX_LayoutNode next = g_layout.nodes[c].next;
+        layout_free_subtree(c);
+        c = next;
+    }
+    n->used = false;
+    n->next = g_layout.free_list;
+    g_layout.free_list = node;
+    g_layout.stats.nodes--;
+}
+
+void px_layout_destroy(PX_LayoutNode node) {
+    struct layout_node* n = layout_get(node);
+    if (!n)
+        return;
+
+    PX_LayoutNode parent = n->parent;
+    PX_LayoutNode* first = parent == PX_LAYOUT_NONE ? &g_layout.first_root : &g_layout.nodes[parent].first_child;
+    PX_LayoutNode* last = parent == PX_LAYOUT_NONE ? &g_layout.last_root : &g_layout.nodes[parent].last_child;
+    PX_LayoutNode prev = PX_LAYOUT_NONE;
+    for (PX_LayoutNode c = *first; c != node; c = g_layout.nodes[c].next)
+        prev = c;
+    if (prev == PX_LAYOUT_NONE)
+        *first = n->next;
+    else
+        g_layout.nodes[prev].next = n->next;
+    if (*last == node)
+        *last = prev;
+
+    layout_free_subtree(node);
+    if (parent != PX_LAYOUT_NONE)
+        layout_mark(parent);
+}
+
+void px_layout_set_text(PX_LayoutNode node, PX_Font* font, const char* text, float pixel_height) {
+    struct layout_node* n = layout_get(node);
+    if (!n)
+        return;
+
+    n->font = font;
+    n->text = text;
+    n->text_height = pixel_height;
+    n->text_dirty = true;
+    layout_mark(node);
+}
+
+void px_layout_set_size(PX_LayoutNode node, PX_Scale2 size) {
+    struct layout_node* n = layout_get(node);
+    if (!n || (n->desc.size.w == size.w && n->desc.size.h == size.h))
+        return;
+    n->desc.size = size;
+    layout_mark(node);
+}
+
+void px_layout_set_offset(PX_LayoutNode node, PX_Vector2 offset) {
+    struct layout_node* n = layout_get(node);
+    if (!n || (n->desc.offset.x == offset.x && n->desc.offset.y == offset.y))
+        return;
+    n->desc.offset = offset;
+    layout_mark(node);
+}
+
+void px_layout_set_hidden(PX_LayoutNode node, bool hidden) {
+    struct layout_node* n = layout_get(node);
+    if (!n || n->hidden == hidden)
+        return;
+    n->hidden = hidden;
+    layout_mark(node);
+}
+
+// Measures the node, placing its children as it goes; clean children keep their size
+static void layout_node(PX_LayoutNode node) {
+    struct layout_node* n = &g_layout.nodes[node];
+    n->dirty = false;
+    g_layout.stats.laid_out++;
+
+    PX_LayoutDesc* d = &n->desc;
+    int content_w = 0, content_h = 0;
+    if (n->text) {
+        if (n->text_dirty) {
+            n->text_w = n->font ? px_rs_text_width(n->font, n->text, n->text_height) : 0;
+            n->text_dirty = false;
+            g_layout.stats.text_measures++;
+        }
+        content_w = n->text_w;
+        content_h = (int)(n->text_height + 0.5f);
+    }
+
+    int cursor = 0;
+    bool first = true;
+    for (PX_LayoutNode c = n->first_child; c != PX_LAYOUT_NONE; c = g_layout.nodes[c].next) {
+        struct layout_node* child = &g_layout.nodes[c];
+        if (child->hidden)
+            continue;
+        if (child->dirty)
+            layout_node(c);
+
+        PX_Vector2 off = child->desc.offset;
+        if (child->desc.overlay) {
+            child->pos = off;
+            continue;
+        }
+
+        if (!first)
+            cursor += d->spacing;
+        first = false;
+        switch (d->flow) {
+            case PX_LAYOUT_ROW:
+                child->pos = (PX_Vector2){d->padding.x + cursor, d->padding.y + off.y};
+                cursor += child->size.w;
+                if (content_w < cursor) content_w = cursor;
+                if (content_h < off.y + child->size.h) content_h = off.y + child->size.h;
+                break;
+            case PX_LAYOUT_COLUMN:
+                child->pos = (PX_Vector2){d->padding.x + off.x, d->padding.y + cursor};
+                cursor += child->size.h;
+                if (content_h < cursor) content_h = cursor;
+                if (content_w < off.x + child->size.w) content_w = off.x + child->size.w;
+                break;
+            case PX_LAYOUT_STACK:
+            default:
+                child->pos = (PX_Vector2){d->padding.x + off.x, d->padding.y + off.y};
+                if (content_w < off.x + child->size.w) content_w = off.x + child->size.w;
+                if (content_h < off.y + child->size.h) content_h = off.y + child->size.h;
+                break;
+        }
+    }
+
+    n->size.w = d->size.w > 0 ? d->size.w : content_w + 2 * d->padding.x;
+    n->size.h = d->size.h > 0 ? d->size.h : content_h + 2 * d->padding.y;
+    if (n->size.w < d->min_size.w) n->size.w = d->min_size.w;
+    if (n->size.h < d->min_size.h) n->size.h = d->min_size.h;
+    // Roots go where they are told, children were placed by the loop above in the parent
+    if (n->parent == PX_LAYOUT_NONE)
+        n->pos = d->offset;
+}
+
+int px_layout_update(void) {
+    if (!g_layout.dirty)
+        return 0;
+    PX_TRACE_SCOPE("px_layout_update");
+
+    g_layout.stats.laid_out = 0;
+    g_layout.stats.text_measures = 0;
+    for (PX_LayoutNode r = g_layout.first_root; r != PX_LAYOUT_NONE; r = g_layout.nodes[r].next) {
+        if (g_layout.nodes[r].dirty && !g_layout.nodes[r].hidden)
+            layout_node(r);
+    }
+    g_layout.dirty = false;
+    g_layout.stats.updates++;
+    return g_layout.stats.laid_out;
+}
+
+bool px_layout_rect(PX_LayoutNode node, PX_Transform2* out) {
+    if (!layout_get(node))
+        return false;
+    px_layout_update();
+
+    const struct layout_node* n = &g_layout.nodes[node];
+    PX_Transform2 r = { n->pos, n->size };
+    for (;;) {
+        if (n->hidden)
+            return false;
+        if (n->parent == PX_LAYOUT_NONE)
+            break;
+        n = &g_layout.nodes[n->parent];
+        r.pos.x += n->pos.x;
+        r.pos.y += n->pos.y;
+    }
+    *out = r;
+    return true;
+}
+
+void px_layout_stats(PX_LayoutStats* out) {
+    *out = g_layout.stats;
+}
+
+void px_layout_shutdown(void) {
+    free(g_layout.nodes);
+    memset(&g_layout, 0, sizeof(g_layout));
+    g_layout.free_list = g_layout.first_root = g_layout.last_root = PX_LAYOUT_NONE;
+}
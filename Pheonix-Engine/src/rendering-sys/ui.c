@@ -4,11 +4,14 @@
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <pthread.h>
 
 #include <rendering-sys.h>
 #include <err-codes.h>
 #include <loaders/sdf-loader.h>
 #include <decoders/unicode.h>
+#include <asset-sys/vfs.h>
+#include <core/trace.h>
 
 #include <rendering-sys/opengl.h>
 
@@ -58,8 +61,52 @@ struct ui_batch {
     PX_Color4 text_outline_color;
 };
 
+// VAOs are container objects and are not shared between contexts, so every
+// window context drawing the UI gets its own over the shared VBO/EBO
+struct ui_target {
+    bool used;
+    unsigned int vao;
+    int screen_w;
+    int screen_h;
+};
+
+// What one draw of the UI reads, built on one thread and drawn on another
+struct ui_frame {
+    const struct ui_vertex* vertices;
+    int vertex_count;
+    const struct ui_batch* batches;
+    int batch_count;
+    unsigned int vao;
+    int screen_w;
+    int screen_h;
+};
+
+// Frames are built straight into one of two vertex lists while the other
+// is drawn; a finished frame waits in pending until the thread takes it
+struct ui_thread_frame {
+    struct ui_vertex* vertices;
+    struct ui_batch batches[MAX_BATCHES];
+    struct ui_frame frame;
+    uint64_t input_ns;
+};
+
+struct ui_render_thread {
+    bool running;
+    bool stop;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    PX_RSRenderThreadDesc desc;
+
+    struct ui_thread_frame frames[2];
+    int building;
+    int pending; // -1 when nothing waits
+    int drawing; // -1 while the thread is idle
+};
+
 struct ui_renderer {
     int initialized;
+    bool headless; // geometry and batching only, nothing touches GL
 
     unsigned int program;
     unsigned int text_program;
@@ -98,6 +145,15 @@ struct ui_renderer {
     struct ui_batch batches[MAX_BATCHES];
     int batch_count;
 
+    int dropped_quads; // pushes that did not fit in the vertex buffer this frame
+    PX_RSFrameStats stats;
+
+    struct ui_render_thread render_thread;
+
+    // Current target, vao and screen size mirror targets[target]
+    struct ui_target targets[PX_RS_MAX_TARGETS];
+    int target;
+
     int screen_w;
     int screen_h;
 };
@@ -105,34 +161,19 @@ struct ui_renderer {
 static struct ui_renderer gr_ui_b = {0};
 static struct ui_renderer* gr_ui = &gr_ui_b;
 
-static char* read_shader(const char* name) {
+static t_err_codes read_shader(const char* name, PX_VFile* out) {
     char path[512];
     snprintf(path, sizeof(path), "shaders/%s", name);
 
-    FILE* f = fopen(path, "rb");
-    if (!f)
-        return NULL;
-
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    rewind(f);
-
-    char* src = (char*)malloc(size + 1);
-    if (!src) {
-        fclose(f);
-        return NULL;
-    }
-
-    fread(src, 1, size, f);
-    src[size] = '\0';
-
-    fclose(f);
-    return src;
+    return px_vfs_open(path, out);
 }
 
-static unsigned int pxgl_compile_shader(unsigned int type, const char* source) {
+static unsigned int pxgl_compile_shader(unsigned int type, const PX_VFile* source) {
+    const char* src = (const char*)source->data;
+    int len = (int)source->size;
+
     unsigned int shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
+    glShaderSource(shader, 1, &src, &len);
     glCompileShader(shader);
 
     int ok = 0;
@@ -148,23 +189,25 @@ static unsigned int pxgl_compile_shader(unsigned int type, const char* source) {
 }
 
 static unsigned int pxgl_create_program(const char* vert, const char* frag) {
-    char* vert_src = read_shader(vert);
-    char* frag_src = read_shader(frag);
+    PX_TRACE_SCOPE("pxgl_create_program");
+    PX_VFile vert_src, frag_src;
+    bool vert_ok = read_shader(vert, &vert_src) == ERR_SUCCESS;
+    bool frag_ok = read_shader(frag, &frag_src) == ERR_SUCCESS;
 
-    if (!vert_src || !frag_src) {
+    if (!vert_ok || !frag_ok) {
         fprintf(stderr, "Failed to load shader files\n");
-        if (vert_src)
-            free(vert_src);
-        if (frag_src)
-            free(frag_src);
+        if (vert_ok)
+            px_vfs_close(&vert_src);
+        if (frag_ok)
+            px_vfs_close(&frag_src);
         return 0;
     }
 
-    unsigned int vs = pxgl_compile_shader(GL_VERTEX_SHADER, vert_src);
-    unsigned int fs = pxgl_compile_shader(GL_FRAGMENT_SHADER, frag_src);
+    unsigned int vs = pxgl_compile_shader(GL_VERTEX_SHADER, &vert_src);
+    unsigned int fs = pxgl_compile_shader(GL_FRAGMENT_SHADER, &frag_src);
 
-    free(vert_src);
-    free(frag_src);
+    px_vfs_close(&vert_src);
+    px_vfs_close(&frag_src);
 
     if (!vs || !fs)
         return 0;
@@ -202,8 +245,10 @@ static void pxgl_ui_ortho(float left, float right, float bottom, float top, floa
 }
 
 static void pxgl_ui_push_quad(PX_Vector2 pos, PX_Scale2 scale, PX_Color4 c) {
-    if (gr_ui->vertex_count + 6 > gr_ui->vertex_capacity)
+    if (gr_ui->vertex_count + 6 > gr_ui->vertex_capacity) {
+        gr_ui->dropped_quads++;
         return;
+    }
 
     struct ui_vertex* v = gr_ui->vertices + gr_ui->vertex_count;
     float x2 = (float)pos.x + (float)scale.w;
@@ -218,8 +263,10 @@ static void pxgl_ui_push_quad(PX_Vector2 pos, PX_Scale2 scale, PX_Color4 c) {
 }
 
 static void pxgl_ui_push_glyph(float x0, float y0, float x1, float y1, struct px_sdf_glyph* g, PX_Color4 c) {
-    if (gr_ui->vertex_count + 6 > gr_ui->vertex_capacity)
+    if (gr_ui->vertex_count + 6 > gr_ui->vertex_capacity) {
+        gr_ui->dropped_quads++;
         return;
+    }
 
     struct ui_vertex* v = gr_ui->vertices + gr_ui->vertex_count;
 
@@ -232,8 +279,10 @@ static void pxgl_ui_push_glyph(float x0, float y0, float x1, float y1, struct px
 }
 
 static void pxgl_ui_push_line(float x0, float y0, float x1, float y1, float thickness, PX_Color4 c) {
-    if (gr_ui->vertex_count + 6 > gr_ui->vertex_capacity)
+    if (gr_ui->vertex_count + 6 > gr_ui->vertex_capacity) {
+        gr_ui->dropped_quads++;
         return;
+    }
 
     float dx = x1 - x0;
     float dy = y1 - y0;
@@ -283,6 +332,7 @@ static void push_batch(struct ui_batch* b) {
 }
 
 t_err_codes px_rs_init_ui(PX_Scale2 screen_scale) {
+    PX_TRACE_SCOPE("px_rs_init_ui");
     GLenum err = glewInit();
     if (err != GLEW_OK) {
         fprintf(stderr, "GLEW Error: %s\n", glewGetErrorString(err));
@@ -366,6 +416,8 @@ t_err_codes px_rs_init_ui(PX_Scale2 screen_scale) {
 
     gr_ui->screen_w = screen_scale.w;
     gr_ui->screen_h = screen_scale.h;
+    gr_ui->target = PX_RS_DEFAULT_TARGET;
+    gr_ui->targets[PX_RS_DEFAULT_TARGET] = (struct ui_target){ true, gr_ui->vao, screen_scale.w, screen_scale.h };
     gr_ui->initialized = true;
 
     glViewport(0, 0, screen_scale.w, screen_scale.h);
@@ -373,11 +425,43 @@ t_err_codes px_rs_init_ui(PX_Scale2 screen_scale) {
     return ERR_SUCCESS;
 }
 
+t_err_codes px_rs_init_ui_headless(PX_Scale2 screen_scale) {
+    memset(gr_ui, 0, sizeof(*gr_ui));
+
+    gr_ui->vertex_capacity = MAX_VERTEX_COUNT;
+    gr_ui->vertices = (struct ui_vertex*)malloc(sizeof(struct ui_vertex) * gr_ui->vertex_capacity);
+    if (!gr_ui->vertices)
+        return ERR_ALLOC_FAILED;
+
+    gr_ui->screen_w = screen_scale.w;
+    gr_ui->screen_h = screen_scale.h;
+    gr_ui->target = PX_RS_DEFAULT_TARGET;
+    gr_ui->targets[PX_RS_DEFAULT_TARGET] = (struct ui_target){ true, 0, screen_scale.w, screen_scale.h };
+    gr_ui->headless = true;
+    gr_ui->initialized = true;
+
+    return ERR_SUCCESS;
+}
+
 void px_rs_shutdown_ui(void) {
     if (!gr_ui->initialized)
         return;
+    px_rs_stop_render_thread();
+    px_rs_hit_shutdown();
+    px_layout_shutdown();
+
+    if (gr_ui->headless) {
+        free(gr_ui->vertices);
+        memset(gr_ui, 0, sizeof(*gr_ui));
+        return;
+    }
 
+    // Other targets' VAOs belong to their contexts and go with px_rs_ui_release_target
+    if (gr_ui->targets[PX_RS_DEFAULT_TARGET].vao)
+        glDeleteVertexArrays(1, &gr_ui->targets[PX_RS_DEFAULT_TARGET].vao);
     glDeleteBuffers(1, &gr_ui->vbo);
+    glDeleteBuffers(1, &gr_ui->ebo);
+    glDeleteTextures(1, &gr_ui->blank_tex);
     glDeleteProgram(gr_ui->program);
     glDeleteProgram(gr_ui->text_program);
 
@@ -391,30 +475,44 @@ void px_rs_shutdown_ui(void) {
 void px_rs_frame_start(void) {
     gr_ui->vertex_count = 0;
     gr_ui->batch_count = 0;
+    gr_ui->dropped_quads = 0;
+    px_rs_hit_begin((PX_Scale2){gr_ui->screen_w, gr_ui->screen_h});
+    px_layout_update();
 }
 
-void px_rs_frame_end(void) {
-    if (gr_ui->vertex_count <= 0)
-        return;
+static void ui_clear_target(int screen_w, int screen_h) {
+    glViewport(0, 0, screen_w, screen_h);
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glUseProgram(gr_ui->program);
 
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_SCISSOR_TEST);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+static void ui_draw_frame(const struct ui_frame* f) {
     glBindBuffer(GL_ARRAY_BUFFER, gr_ui->vbo);
     glBufferData(
         GL_ARRAY_BUFFER,
-        sizeof(struct ui_vertex) * gr_ui->vertex_count,
-        gr_ui->vertices,
+        sizeof(struct ui_vertex) * f->vertex_count,
+        f->vertices,
         GL_DYNAMIC_DRAW
     );
 
     float proj[16];
-    pxgl_ui_ortho(0.0f, (float)gr_ui->screen_w, 0.0f, (float)gr_ui->screen_h, proj);
+    pxgl_ui_ortho(0.0f, (float)f->screen_w, 0.0f, (float)f->screen_h, proj);
 
-    glBindVertexArray(gr_ui->vao);
+    glBindVertexArray(f->vao);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gr_ui->ebo);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    for (int i = 0; i < gr_ui->batch_count; i++) {
-        struct ui_batch* b = &gr_ui->batches[i];
+    for (int i = 0; i < f->batch_count; i++) {
+        const struct ui_batch* b = &f->batches[i];
         if (b->vertex_count <= 0) continue;
 
         unsigned int program = 0;
@@ -494,6 +592,182 @@ void px_rs_frame_end(void) {
     glBindVertexArray(0);
 }
 
+
+// ===== Render thread =====
+// Owns the GL context while running: texture uploads (desc.gl_work), draws
+// and swaps all happen here, the caller only builds vertices and batches.
+
+static void* ui_render_thread_main(void* arg) {
+    struct ui_render_thread* rt = (struct ui_render_thread*)arg;
+    px_ws_make_current(rt->desc.window);
+
+    pthread_mutex_lock(&rt->lock);
+    for (;;) {
+        while (rt->pending < 0 && !rt->stop)
+            pthread_cond_wait(&rt->cond, &rt->lock);
+        if (rt->pending < 0)
+            break;
+
+        struct ui_thread_frame* tf = &rt->frames[rt->pending];
+        rt->drawing = rt->pending;
+        rt->pending = -1;
+        pthread_cond_broadcast(&rt->cond);
+        pthread_mutex_unlock(&rt->lock);
+
+        {
+            PX_TRACE_SCOPE("ui_render_thread_frame");
+            if (rt->desc.gl_work)
+                rt->desc.gl_work();
+            ui_clear_target(tf->frame.screen_w, tf->frame.screen_h);
+            if (tf->frame.vertex_count > 0)
+                ui_draw_frame(&tf->frame);
+            px_ws_present(rt->desc.window, tf->input_ns);
+        }
+
+        pthread_mutex_lock(&rt->lock);
+        rt->drawing = -1;
+        pthread_cond_broadcast(&rt->cond);
+    }
+    pthread_mutex_unlock(&rt->lock);
+
+    px_ws_make_current(NULL);
+    return NULL;
+}
+
+static void ui_render_thread_submit(void) {
+    PX_TRACE_SCOPE("ui_render_thread_submit");
+    struct ui_render_thread* rt = &gr_ui->render_thread;
+    struct ui_thread_frame* tf = &rt->frames[rt->building];
+
+    memcpy(tf->batches, gr_ui->batches, sizeof(struct ui_batch) * gr_ui->batch_count);
+    tf->frame = (struct ui_frame){
+        .vertices = tf->vertices,
+        .vertex_count = gr_ui->vertex_count,
+        .batches = tf->batches,
+        .batch_count = gr_ui->batch_count,
+        .vao = gr_ui->vao,
+        .screen_w = gr_ui->screen_w,
+        .screen_h = gr_ui->screen_h
+    };
+    tf->input_ns = px_ws_take_input_stamp(rt->desc.window);
+
+    // At most one frame waits while another is drawn, so input is never
+    // answered more than a frame late
+    int next = rt->building ^ 1;
+    pthread_mutex_lock(&rt->lock);
+    while (rt->pending >= 0)
+        pthread_cond_wait(&rt->cond, &rt->lock);
+    rt->pending = rt->building;
+    pthread_cond_broadcast(&rt->cond);
+    while (rt->drawing == next)
+        pthread_cond_wait(&rt->cond, &rt->lock);
+    pthread_mutex_unlock(&rt->lock);
+
+    rt->building = next;
+    gr_ui->vertices = rt->frames[next].vertices;
+}
+
+t_err_codes px_rs_start_render_thread(const PX_RSRenderThreadDesc* desc) {
+    struct ui_render_thread* rt = &gr_ui->render_thread;
+    if (!gr_ui->initialized || gr_ui->headless || rt->running)
+        return ERR_INTERNAL;
+    else if (!desc || !desc->window)
+        return ERR_INTERNAL;
+
+    struct ui_vertex* second = (struct ui_vertex*)malloc(sizeof(struct ui_vertex) * gr_ui->vertex_capacity);
+    if (!second)
+        return ERR_ALLOC_FAILED;
+
+    rt->desc = *desc;
+    rt->stop = false;
+    rt->building = 0;
+    rt->pending = -1;
+    rt->drawing = -1;
+    rt->frames[0].vertices = gr_ui->vertices;
+    rt->frames[1].vertices = second;
+    pthread_mutex_init(&rt->lock, NULL);
+    pthread_cond_init(&rt->cond, NULL);
+
+    // A context is current on one thread at a time
+    px_ws_make_current(NULL);
+    if (pthread_create(&rt->thread, NULL, ui_render_thread_main, rt) != 0) {
+        px_ws_make_current(desc->window);
+        pthread_mutex_destroy(&rt->lock);
+        pthread_cond_destroy(&rt->cond);
+        free(second);
+        return ERR_INTERNAL;
+    }
+    rt->running = true;
+
+    return ERR_SUCCESS;
+}
+
+void px_rs_stop_render_thread(void) {
+    struct ui_render_thread* rt = &gr_ui->render_thread;
+    if (!rt->running)
+        return;
+
+    // Frames already handed over are still drawn
+    pthread_mutex_lock(&rt->lock);
+    rt->stop = true;
+    pthread_cond_broadcast(&rt->cond);
+    pthread_mutex_unlock(&rt->lock);
+    pthread_join(rt->thread, NULL);
+
+    pthread_mutex_destroy(&rt->lock);
+    pthread_cond_destroy(&rt->cond);
+    px_ws_make_current(rt->desc.window);
+
+    gr_ui->vertices = rt->frames[rt->building].vertices;
+    free(rt->frames[rt->building ^ 1].vertices);
+    memset(rt, 0, sizeof(*rt));
+}
+
+bool px_rs_render_threaded(void) {
+    return gr_ui->render_thread.running;
+}
+
+void px_rs_frame_end(void) {
+    PX_TRACE_SCOPE("px_rs_frame_end");
+    px_rs_hit_end();
+
+    PX_RSFrameStats* stats = &gr_ui->stats;
+    memset(stats, 0, sizeof(*stats));
+    stats->batches = gr_ui->batch_count;
+    stats->vertices = gr_ui->vertex_count;
+    stats->dropped_quads = gr_ui->dropped_quads;
+    stats->bytes_uploaded = sizeof(struct ui_vertex) * gr_ui->vertex_count;
+
+    // One draw per non-empty batch, headless frames report the draws they would have issued
+    for (int i = 0; i < gr_ui->batch_count; i++)
+        stats->draw_calls += gr_ui->batches[i].vertex_count > 0;
+    if (gr_ui->headless)
+        return;
+
+    // Empty frames still go over, the render thread clears and presents them
+    if (gr_ui->render_thread.running) {
+        ui_render_thread_submit();
+        return;
+    }
+    if (gr_ui->vertex_count <= 0)
+        return;
+
+    struct ui_frame frame = {
+        .vertices = gr_ui->vertices,
+        .vertex_count = gr_ui->vertex_count,
+        .batches = gr_ui->batches,
+        .batch_count = gr_ui->batch_count,
+        .vao = gr_ui->vao,
+        .screen_w = gr_ui->screen_w,
+        .screen_h = gr_ui->screen_h
+    };
+    ui_draw_frame(&frame);
+}
+
+void px_rs_frame_stats(PX_RSFrameStats* out) {
+    *out = gr_ui->stats;
+}
+
 t_err_codes px_rs_draw_panel(PX_Transform2 tran, PX_Color4 color, float noise, float cradius) {
     int start_vertex = gr_ui->vertex_count;
     pxgl_ui_push_quad(tran.pos, tran.scale, color);
@@ -596,56 +870,230 @@ t_err_codes px_rs_draw_line(PX_Vector2 start, PX_Vector2 end, float thickness, P
     return ERR_SUCCESS;
 }
 
+#define DROPDOWN_PANEL_GAP 2 // between the bar and an open panel
+#define DROPDOWN_PANEL_MIN_W 100
+#define DROPDOWN_OPTION_GAP 2
+
 t_err_codes px_rs_draw_dropdown(PX_Dropdown* dd) {
-    PX_Color4 color = dd->color; 
-    px_rs_draw_panel((PX_Transform2){dd->pos, (PX_Scale2){dd->width, dd->height}}, color, dd->noise, dd->cradius);
+    PX_Transform2 dd_tran;
+    if (!px_layout_rect(dd->node, &dd_tran))
+        return ERR_SUCCESS;
+    px_rs_draw_panel(dd_tran, dd->color, dd->noise, dd->cradius);
+    px_rs_hit_add(dd_tran, PX_RS_HIT_DROPDOWN, dd, -1, -1);
 
-    int x = dd->stext_pos.x;
+    float option_size = dd->option_font_size > 0.0f ? dd->option_font_size : dd->font_size;
     for (int i = 0; i < dd->item_count; i++) {
         PX_DropdownItem* item = &dd->items[i];
+        PX_Transform2 tran;
+        if (!px_layout_rect(item->node, &tran))
+            continue;
 
         PX_Color4 tcolor = dd->hover_index == i ? dd->hover_color : dd->text_color;
-        px_rs_render_text(item->label, dd->font_size, (PX_Vector2){x, dd->stext_pos.y}, tcolor, dd->font);
+        px_rs_render_text(item->label, dd->font_size, tran.pos, tcolor, dd->font);
+        px_rs_hit_add(tran, PX_RS_HIT_DROPDOWN_ITEM, dd, i, -1);
+
+        if (!item->is_open || !px_layout_rect(item->panel, &tran))
+            continue;
+        px_rs_draw_panel(tran, item->panel_color, item->panel_noise, item->panel_cradius);
+        px_rs_hit_add(tran, PX_RS_HIT_DROPDOWN_PANEL, dd, i, -1);
+
+        for (int j = 0; j < item->option_count; j++) {
+            PX_DropdownOption* option = &item->options[j];
+            if (!px_layout_rect(option->node, &tran))
+                continue;
+
+            PX_Color4 ptcolor = item->hover_index == j ? item->hover_color : item->text_color;
+            px_rs_render_text(option->label, option_size, tran.pos, ptcolor, dd->font);
+            px_rs_hit_add(tran, PX_RS_HIT_DROPDOWN_OPTION, dd, i, j);
+        }
+    }
 
-        x += dd->spacing + px_rs_text_width(dd->font, item->label, dd->font_size);
+    return ERR_SUCCESS;
+}
 
-        if (item->is_open) {
-            px_rs_draw_panel(item->panel_tran, item->panel_color, item->panel_noise, item->panel_cradius);
+t_err_codes px_rs_dropdown_init(PX_Dropdown* dd) {
+    dd->items = NULL;
+    dd->item_count = 0;
+    dd->item_capacity = 0;
+    dd->hover_index = -1;
+
+    dd->node = px_layout_create(PX_LAYOUT_NONE, &(PX_LayoutDesc){
+        .offset = dd->pos,
+        .size = (PX_Scale2){dd->width, dd->height}
+    });
+    dd->bar = px_layout_create(dd->node, &(PX_LayoutDesc){
+        .flow = PX_LAYOUT_ROW,
+        .offset = dd->stext_pos,
+        .spacing = dd->spacing
+    });
+    if (dd->bar == PX_LAYOUT_NONE) {
+        px_layout_destroy(dd->node);
+        dd->node = PX_LAYOUT_NONE;
+        return ERR_ALLOC_FAILED;
+    }
+    return ERR_SUCCESS;
+}
 
-            int y = item->stext_pos.y;
-            for (int j = 0; j < item->option_count; j++) {
-                PX_DropdownOption* option = &item->options[j];
+static char* dropdown_strdup(const char* s) {
+    size_t len = strlen(s) + 1;
+    char* copy = (char*)malloc(len);
+    if (copy)
+        memcpy(copy, s, len);
+    return copy;
+}
 
-                PX_Color4 ptcolor = item->hover_index == j ? item->hover_color : item->text_color;
-                px_rs_render_text(option->label, item->font_size, (PX_Vector2){item->stext_pos.x, y}, ptcolor, dd->font);
+static void dropdown_free_item(PX_DropdownItem* item) {
+    for (int j = 0; j < item->option_count; j++)
+        free(item->options[j].label);
+    free(item->options);
+    free(item->label);
+    px_layout_destroy(item->node);
+}
 
-                y += item->spacing;
-            }
+PX_DropdownItem* px_rs_dropdown_add_item(PX_Dropdown* dd, const char* label, const char** options, int option_count) {
+    if (dd->item_count >= dd->item_capacity) {
+        int cap = dd->item_capacity ? dd->item_capacity * 2 : 8;
+        PX_DropdownItem* grown = (PX_DropdownItem*)realloc(dd->items, sizeof(PX_DropdownItem) * (size_t)cap);
+        if (!grown)
+            return NULL;
+        dd->items = grown;
+        dd->item_capacity = cap;
+    }
+
+    PX_DropdownItem* item = &dd->items[dd->item_count];
+    memset(item, 0, sizeof(*item));
+    item->hover_index = -1;
+    item->label = dropdown_strdup(label);
+    item->options = option_count > 0 ? (PX_DropdownOption*)calloc((size_t)option_count, sizeof(PX_DropdownOption)) : NULL;
+    item->node = px_layout_create(dd->bar, NULL);
+    // Hangs under its label, so it follows wherever the bar puts the label
+    item->panel = px_layout_create(item->node, &(PX_LayoutDesc){
+        .flow = PX_LAYOUT_COLUMN,
+        .offset = (PX_Vector2){0, dd->height - dd->stext_pos.y + DROPDOWN_PANEL_GAP},
+        .min_size = (PX_Scale2){DROPDOWN_PANEL_MIN_W, 0},
+        .padding = (PX_Vector2){6, 10},
+        .spacing = DROPDOWN_OPTION_GAP,
+        .overlay = true
+    });
+    if (!item->label || (option_count > 0 && !item->options) || item->panel == PX_LAYOUT_NONE) {
+        dropdown_free_item(item);
+        return NULL;
+    }
+    px_layout_set_text(item->node, dd->font, item->label, dd->font_size);
+    px_layout_set_hidden(item->panel, true);
+
+    float option_size = dd->option_font_size > 0.0f ? dd->option_font_size : dd->font_size;
+    for (int j = 0; j < option_count; j++) {
+        PX_DropdownOption* option = &item->options[j];
+        option->label = dropdown_strdup(options[j]);
+        option->node = px_layout_create(item->panel, NULL);
+        if (!option->label || option->node == PX_LAYOUT_NONE) {
+            free(option->label);
+            item->option_count = j;
+            dropdown_free_item(item);
+            return NULL;
         }
+        px_layout_set_text(option->node, dd->font, option->label, option_size);
+        item->option_count = j + 1;
     }
 
-    return ERR_SUCCESS;
+    dd->item_count++;
+    return item;
 }
 
-void px_rs_ui_frame_update(void) {
-    if (!gr_ui->initialized)
+void px_rs_dropdown_set_open(PX_Dropdown* dd, int index, bool open) {
+    if (index < 0 || index >= dd->item_count)
         return;
+    PX_DropdownItem* item = &dd->items[index];
+    item->is_open = open;
+    px_layout_set_hidden(item->panel, !open);
+}
 
-    glViewport(0, 0, gr_ui->screen_w, gr_ui->screen_h);
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glUseProgram(gr_ui->program);
+void px_rs_dropdown_resize(PX_Dropdown* dd, int width) {
+    dd->width = width;
+    px_layout_set_size(dd->node, (PX_Scale2){dd->width, dd->height});
+}
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_SCISSOR_TEST);
+void px_rs_dropdown_free(PX_Dropdown* dd) {
+    for (int i = 0; i < dd->item_count; i++)
+        dropdown_free_item(&dd->items[i]);
+    free(dd->items);
+    px_layout_destroy(dd->node);
+    dd->items = NULL;
+    dd->item_count = 0;
+    dd->item_capacity = 0;
+    dd->node = dd->bar = PX_LAYOUT_NONE;
+}
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void px_rs_ui_frame_update(void) {
+    PX_TRACE_SCOPE("px_rs_ui_frame_update");
+    if (!gr_ui->initialized || gr_ui->headless || gr_ui->render_thread.running)
+        return;
+
+    ui_clear_target(gr_ui->screen_w, gr_ui->screen_h);
 }
 
 void px_rs_ui_resize(PX_Scale2 screen_scale) {
     gr_ui->screen_w = screen_scale.w;
     gr_ui->screen_h = screen_scale.h;
-    glViewport(0, 0, screen_scale.w, screen_scale.h);
+    gr_ui->targets[gr_ui->target].screen_w = screen_scale.w;
+    gr_ui->targets[gr_ui->target].screen_h = screen_scale.h;
+    // A render thread sets the viewport from the size each frame carries
+    if (!gr_ui->headless && !gr_ui->render_thread.running)
+        glViewport(0, 0, screen_scale.w, screen_scale.h);
+}
+
+t_err_codes px_rs_ui_bind_target(int target, PX_Scale2 screen_scale) {
+    if (!gr_ui->initialized)
+        return ERR_INTERNAL;
+    else if (target < 0 || target >= PX_RS_MAX_TARGETS)
+        return ERR_INTERNAL;
+    else if (gr_ui->render_thread.running)
+        return ERR_INTERNAL; // the render thread owns the one context it presents
+
+    struct ui_target* t = &gr_ui->targets[target];
+    if (!t->used) {
+        memset(t, 0, sizeof(*t));
+        if (!gr_ui->headless) {
+            // The element buffer binding is VAO state, the shared EBO is attached once here
+            glGenVertexArrays(1, &t->vao);
+            glBindVertexArray(t->vao);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gr_ui->ebo);
+            glBindVertexArray(0);
+        }
+        t->used = true;
+    }
+    t->screen_w = screen_scale.w;
+    t->screen_h = screen_scale.h;
+
+    gr_ui->target = target;
+    gr_ui->vao = t->vao;
+    gr_ui->screen_w = t->screen_w;
+    gr_ui->screen_h = t->screen_h;
+    if (!gr_ui->headless)
+        glViewport(0, 0, t->screen_w, t->screen_h);
+
+    return ERR_SUCCESS;
+}
+
+void px_rs_ui_release_target(int target) {
+    if (!gr_ui->initialized || target <= PX_RS_DEFAULT_TARGET || target >= PX_RS_MAX_TARGETS)
+        return;
+    else if (gr_ui->render_thread.running)
+        return;
+
+    struct ui_target* t = &gr_ui->targets[target];
+    if (!t->used)
+        return;
+    if (!gr_ui->headless && t->vao)
+        glDeleteVertexArrays(1, &t->vao);
+    memset(t, 0, sizeof(*t));
+
+    if (gr_ui->target == target) {
+        struct ui_target* d = &gr_ui->targets[PX_RS_DEFAULT_TARGET];
+        gr_ui->target = PX_RS_DEFAULT_TARGET;
+        gr_ui->vao = d->vao;
+        gr_ui->screen_w = d->screen_w;
+        gr_ui->screen_h = d->screen_h;
+    }
 }
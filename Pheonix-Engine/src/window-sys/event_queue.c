@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <window-sys.h>
+#include <window-sys/backends.h>
+
+static PX_WEvent* queue_at(PX_WE_Queue* q, int i) {
+    return &q->events[(q->head + i) % q->capacity];
+}
+
+static bool queue_grow(PX_WE_Queue* q) {
+    int capacity = q->capacity ? q->capacity * 2 : PX_WE_QUEUE_SIZE;
+    if (capacity > PX_WE_QUEUE_MAX)
+        return false;
+
+    PX_WEvent* events = (PX_WEvent*)malloc(sizeof(PX_WEvent) * capacity);
+    if (!events)
+        return false;
+
+    // Unwrap so the oldest event lands at 0
+    for (int i = 0; i < q->count; i++)
+        events[i] = *queue_at(q, i);
+
+    free(q->events);
+    q->events = events;
+    q->capacity = capacity;
+    q->head = 0;
+    return true;
+}
+
+// At the cap a move is worth less than anything else in the queue
+static bool queue_evict_motion(PX_WE_Queue* q) {
+    for (int i = 0; i < q->count; i++) {
+        if (queue_at(q, i)->type != PX_WE_MOUSE_MOVE)
+            continue;
+
+        for (int j = i; j < q->count - 1; j++)
+            *queue_at(q, j) = *queue_at(q, j + 1);
+        q->count--;
+        return true;
+    }
+    return false;
+}
+
+static void queue_record_motion(PX_WE_Queue* q, const PX_WEvent* ev) {
+    if (q->history_count == q->history_capacity) {
+        int capacity = q->history_capacity ? q->history_capacity * 2 : PX_WE_QUEUE_SIZE;
+        if (capacity > PX_WE_HISTORY_MAX)
+            return;
+
+        PX_WE_MotionSample* history = (PX_WE_MotionSample*)realloc(q->history, sizeof(PX_WE_MotionSample) * capacity);
+        if (!history)
+            return;
+        q->history = history;
+        q->history_capacity = capacity;
+    }
+
+    q->history[q->history_count++] = (PX_WE_MotionSample){ ev->x, ev->y };
+}
+
+bool px_we_queue_push(PX_WE_Queue* q, const PX_WEvent* ev) {
+    q->stats.pushed++;
+    if (ev->type == PX_WE_MOUSE_MOVE && q->keep_history)
+        queue_record_motion(q, ev);
+
+    // Only where the pointer (or window size) ended up matters
+    if (q->count > 0 && (ev->type == PX_WE_MOUSE_MOVE || ev->type == PX_WE_RESIZE)) {
+        PX_WEvent* last = queue_at(q, q->count - 1);
+        if (last->type == ev->type) {
+            int merged = last->merged + ev->merged + 1;
+            uint64_t arrival_ns = last->arrival_ns;
+            *last = *ev;
+            last->merged = merged;
+            // Latency counts from the first move the user made
+            if (arrival_ns && arrival_ns < last->arrival_ns)
+                last->arrival_ns = arrival_ns;
+            q->stats.coalesced++;
+            return true;
+        }
+    }
+
+    if (q->count == q->capacity && !queue_grow(q)) {
+        if (ev->type == PX_WE_MOUSE_MOVE || !queue_evict_motion(q)) {
+            q->stats.dropped++;
+            return false;
+        }
+        q->stats.dropped++;
+    }
+
+    *queue_at(q, q->count) = *ev;
+    q->count++;
+    if (q->count > q->stats.high_water)
+        q->stats.high_water = q->count;
+
+    return true;
+}
+
+bool px_we_queue_pop(PX_WE_Queue* q, PX_WEvent* ev) {
+    if (px_we_queue_empty(q))
+        return false;
+
+    *ev = *queue_at(q, 0);
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    return true;
+}
+
+void px_we_queue_free(PX_WE_Queue* q) {
+    free(q->events);
+    free(q->history);
+    memset(q, 0, sizeof(*q));
+}
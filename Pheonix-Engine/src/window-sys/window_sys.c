@@ -1,9 +1,14 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 #include <window-sys.h>
 #include <window-sys/backends.h>
+#include <core/trace.h>
 #include <err-codes.h>
 
 extern const t_px_ws_backend px_ws_backend_x11;
@@ -11,6 +16,22 @@ extern const t_px_ws_backend px_ws_backend_null;
 
 static const t_px_ws_backend* g_backend = NULL;
 
+static uint64_t ws_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static bool ws_is_input(PX_WE_Type type) {
+    return type == PX_WE_KEYDOWN || type == PX_WE_KEYUP ||
+           type == PX_WE_MOUSE_DOWN || type == PX_WE_MOUSE_UP || type == PX_WE_MOUSE_MOVE;
+}
+
+static int ws_cmp_float(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
 t_err_codes px_ws_init(void) {
     #if defined(__linux__)
         g_backend = &px_ws_backend_x11;
@@ -34,6 +55,8 @@ void px_ws_shutdown(void) {
 void px_ws_destroy(PX_Window* win) {
     if (g_backend && win)
         g_backend->destroy(win);
+    if (win)
+        px_we_queue_free(&win->queue);
 }
 
 t_err_codes px_ws_create(PX_Window* win) {
@@ -64,11 +87,13 @@ t_err_codes px_ws_hide(PX_Window* win) {
 }
 
 t_err_codes px_ws_poll(PX_Window* win) {
+    PX_TRACE_SCOPE("px_ws_poll");
     if (!g_backend)
         return ERR_WS_UNINITIALIZED;
     else if (!win)
         return ERR_INTERNAL;
 
+    win->queue.history_count = 0;
     return g_backend->poll_events(win);
 }
 
@@ -78,14 +103,74 @@ bool px_ws_pop_event(PX_Window* win, PX_WEvent* out) {
     else if (!win)
         return ERR_INTERNAL;
 
-    return px_we_queue_pop(&win->queue, out);
+    if (!px_we_queue_pop(&win->queue, out))
+        return false;
+
+    // Whatever is handed out now is on screen after the next swap
+    PX_WS_Latency* lat = &win->latency;
+    if (ws_is_input(out->type) && out->arrival_ns && (!lat->pending_ns || out->arrival_ns < lat->pending_ns))
+        lat->pending_ns = out->arrival_ns;
+    return true;
+}
+
+bool px_ws_wait_events(PX_Window* win, int timeout_ms) {
+    PX_TRACE_SCOPE("px_ws_wait_events");
+    if (!g_backend || !win)
+        return false;
+
+    // Events polled earlier but not popped yet need no wait
+    if (!px_we_queue_empty(&win->queue))
+        return true;
+    return g_backend->wait_events(win, timeout_ms);
+}
+
+void px_ws_wake(void) {
+    if (g_backend && g_backend->wake)
+        g_backend->wake();
 }
 
-t_err_codes px_ws_show_splash(void) {
+void px_ws_queue_stats(PX_Window* win, PX_WE_QueueStats* out) {
+    if (win)
+        *out = win->queue.stats;
+    else
+        memset(out, 0, sizeof(*out));
+}
+
+void px_ws_set_motion_history(PX_Window* win, bool enabled) {
+    if (!win)
+        return;
+
+    win->queue.keep_history = enabled;
+    win->queue.history_count = 0;
+}
+
+int px_ws_motion_history(PX_Window* win, const PX_WE_MotionSample** out) {
+    if (!win || !win->queue.keep_history) {
+        *out = NULL;
+        return 0;
+    }
+
+    *out = win->queue.history;
+    return win->queue.history_count;
+}
+
+t_err_codes px_ws_show_splash(const PX_SplashDesc* desc) {
     if (!g_backend)
         return ERR_WS_UNINITIALIZED;
+    else if (!desc)
+        return ERR_INTERNAL;
+
+    return g_backend->show_splash(desc);
+}
+
+void px_ws_splash_progress(float progress, const char* stage) {
+    if (g_backend && g_backend->splash_progress)
+        g_backend->splash_progress(progress, stage);
+}
 
-    return g_backend->show_splash();
+void px_ws_close_splash(void) {
+    if (g_backend && g_backend->close_splash)
+        g_backend->close_splash();
 }
 
 t_err_codes px_ws_window_design(PX_Window* win, PX_WindowDesign* design) {
@@ -106,13 +191,74 @@ t_err_codes px_ws_create_ctx(PX_Window* win) {
     return g_backend->create_ctx(win);
 }
 
-t_err_codes px_ws_swap_buffers(PX_Window* win) {
+t_err_codes px_ws_set_swap_interval(PX_Window* win, PX_WS_SwapInterval interval) {
     if (!g_backend)
         return ERR_WS_UNINITIALIZED;
     else if (!win)
         return ERR_INTERNAL;
 
-    return g_backend->swap_buffers(win);
+    return g_backend->set_swap_interval(win, interval);
+}
+
+t_err_codes px_ws_make_current(PX_Window* win) {
+    if (!g_backend)
+        return ERR_WS_UNINITIALIZED;
+
+    return g_backend->make_current(win);
+}
+
+uint64_t px_ws_take_input_stamp(PX_Window* win) {
+    if (!win)
+        return 0;
+
+    uint64_t stamp = win->latency.pending_ns;
+    win->latency.pending_ns = 0;
+    return stamp;
+}
+
+t_err_codes px_ws_present(PX_Window* win, uint64_t input_ns) {
+    PX_TRACE_SCOPE("px_ws_present");
+    if (!g_backend)
+        return ERR_WS_UNINITIALIZED;
+    else if (!win)
+        return ERR_INTERNAL;
+
+    t_err_codes err = g_backend->swap_buffers(win);
+
+    PX_WS_Latency* lat = &win->latency;
+    if (err == ERR_SUCCESS && input_ns) {
+        double ms = (double)(ws_now_ns() - input_ns) / 1e6;
+        lat->samples_ms[lat->count % PX_WS_LATENCY_SAMPLES] = (float)ms;
+        lat->count++;
+        lat->sum_ms += ms;
+        if (ms > lat->max_ms)
+            lat->max_ms = ms;
+    }
+
+    return err;
+}
+
+t_err_codes px_ws_swap_buffers(PX_Window* win) {
+    return px_ws_present(win, px_ws_take_input_stamp(win));
+}
+
+void px_ws_input_latency(PX_Window* win, PX_WS_LatencyStats* out) {
+    memset(out, 0, sizeof(*out));
+    if (!win || win->latency.count == 0)
+        return;
+
+    const PX_WS_Latency* lat = &win->latency;
+    int n = lat->count < PX_WS_LATENCY_SAMPLES ? (int)lat->count : PX_WS_LATENCY_SAMPLES;
+    float sorted[PX_WS_LATENCY_SAMPLES];
+    memcpy(sorted, lat->samples_ms, sizeof(float) * n);
+    qsort(sorted, n, sizeof(float), ws_cmp_float);
+
+    out->frames = lat->count;
+    out->last_ms = lat->samples_ms[(lat->count - 1) % PX_WS_LATENCY_SAMPLES];
+    out->mean_ms = lat->sum_ms / (double)lat->count;
+    out->p50_ms = sorted[n / 2];
+    out->p99_ms = sorted[(int)(n * 0.99)];
+    out->max_ms = lat->max_ms;
 }
 
 char* px_ws_open_file_selector_dialog(void) {
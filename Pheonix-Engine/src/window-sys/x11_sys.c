@@ -7,12 +7,19 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <time.h>
+#include <math.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
 
 #include <window-sys.h>
 #include <window-sys/backends.h>
 #include <err-codes.h>
 #include <event-sys.h>
 #include <core/image.h>
+#include <core/pixel.h>
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
@@ -20,11 +27,27 @@
 #include <X11/keysym.h>
 #include <X11/XKBlib.h>
 #include <X11/extensions/Xrender.h>
+#ifdef PX_HAVE_XI2
+#include <X11/extensions/XInput2.h>
+#endif
 
 #define HAVE_X11
 #include <external/sodf.h>
 
 #include <rendering-sys/opengl.h>
+#include <loaders/ptex-loader.h>
+#include <core/trace.h>
+
+#define SPLASH_W 600
+#define SPLASH_H 300
+#define SPLASH_MARGIN 24
+#define SPLASH_BAR_H 4
+#define SPLASH_POLL_MS 16
+#define SPLASH_STAGE_MAX 64
+#define X11_KEYCODE_COUNT 256
+#define X11_HANDLE_SLOT_BITS 8
+#define X11_HANDLE_SLOT_MASK ((1 << X11_HANDLE_SLOT_BITS) - 1)
+#define X11_HANDLE_GENERATION_MASK 0x7FFFFF
 
 struct keysym_map {
     KeySym sym;
@@ -32,19 +55,37 @@ struct keysym_map {
 };
 
 struct window {
+    PX_Window* owner; // events for this window go to its queue
     Display* display;
     Window window;
     GLXContext gl_ctx;
     bool gl_ctx_valid;
     Atom wm_delete;
+    int width, height; // last configured size, moves report the same one
 };
 
-struct winarray {
+struct splash_state {
+    bool running;
+    pthread_t thread;
+    Display* display;
+    char image[512];
+    int min_ms;
+    struct timespec shown;
+
+    // Shared with the splash thread under g_splash_lock
+    float progress;
+    char stage[SPLASH_STAGE_MAX];
+    bool dirty;
+    bool close;
+    bool abort;
+    bool finished; // the thread has returned and only needs joining
+};
+
+// Handles are the slot index in the low bits and the slot's generation above
+// them, so a handle kept past its window's destroy never reaches a newer one
+struct window_slot {
     struct window* win;
-    struct winarray* next;
-    struct winarray* prev;
-    
-    int handle;
+    int generation;
 };
 
 static const struct keysym_map g_keysym_map[] = {
@@ -161,113 +202,107 @@ static const struct keysym_map g_keysym_map[] = {
     { XK_slash, EKeycode_Slash },
 };
 
-static struct winarray* g_windows = NULL;
+static struct window_slot g_window_slots[MAX_WINDOWS];
 static Display* g_display = NULL;
 static int g_screen = 0;
-static int g_handle = 0;
+// Every window context shares objects (buffers, textures, programs) with this one
+static GLXContext g_share_ctx = NULL;
+// Filled from g_keysym_map at init and on keyboard mapping changes
+static PX_EKeycodes g_keycode_table[X11_KEYCODE_COUNT];
+// XInput2 major opcode, -1 when pointer input comes from core events
+static int g_xi2_opcode = -1;
+// Polled next to the X connection so other threads can cut a wait short
+static int g_wake_fd = -1;
+static atomic_bool g_wake_pending = false;
+static struct splash_state g_splash = {0};
+static pthread_mutex_t g_splash_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_splash_wake = PTHREAD_COND_INITIALIZER;
+
+static void splash_join(bool abort);
+static void splash_reap(void);
+
+static void destroy_window(struct window* win) {
+    if (win->gl_ctx_valid) {
+        if (glXGetCurrentContext() == win->gl_ctx)
+            glXMakeCurrent(win->display, None, NULL);
+        glXDestroyContext(win->display, win->gl_ctx);
+    }
+    XDestroyWindow(win->display, win->window);
+    free(win);
+}
 
 static int append_window(struct window* win) {
-    struct winarray* node = (struct winarray*)malloc(sizeof(struct winarray));
-    if (!node)
-        return -1;
-    
-    node->win = win;
-    node->next = NULL;
-
-    if (g_windows) {
-        struct winarray* nxt = g_windows;
-        for (int i = 0; i < MAX_WINDOWS; i++) {
-            if (nxt->next)
-                nxt = nxt->next;
-            else 
-                break;
-        }
+    for (int i = 0; i < MAX_WINDOWS; i++) {
+        struct window_slot* slot = &g_window_slots[i];
+        if (slot->win)
+            continue;
 
-        nxt->next = node;
-        node->prev = nxt;
-    } else {
-        g_windows = node;
-        node->prev = NULL;
+        slot->win = win;
+        return (slot->generation << X11_HANDLE_SLOT_BITS) | i;
     }
 
-    node->handle = g_handle;
-    g_handle++;
-    return node->handle;
+    return -1;
 }
 
 static struct window* get_window(int handle) {
-    if (!g_windows)
+    if (handle < 0)
+        return NULL;
+
+    int index = handle & X11_HANDLE_SLOT_MASK;
+    if (index >= MAX_WINDOWS)
+        return NULL;
+
+    struct window_slot* slot = &g_window_slots[index];
+    if (slot->generation != (handle >> X11_HANDLE_SLOT_BITS))
         return NULL;
+    return slot->win;
+}
 
-    struct winarray* nxt = g_windows;
+// All windows share g_display, so a poll through any of them reads events for every one
+static struct window* find_window_xid(Window xid) {
     for (int i = 0; i < MAX_WINDOWS; i++) {
-        if (nxt->handle == handle)
-            return nxt->win;
-        if (nxt->next)
-            nxt = nxt->next;
-        else
-            break;
+        struct window* win = g_window_slots[i].win;
+        if (win && win->window == xid)
+            return win;
     }
-
     return NULL;
 }
 
 static void remove_window(int handle) {
-    if (!g_windows)
+    if (!get_window(handle))
         return;
 
-    struct winarray* nxt = g_windows;
-    bool found = false;
-    for (int i = 0; i < MAX_WINDOWS; i++) {
-        if (nxt->handle == handle) {
-            found = true;
-            break;
-        }
-
-        if (nxt->next)
-            nxt = nxt->next;
-        else
-            break;
-    }
-
-    if (found) {
-        if (nxt->prev)
-            nxt->prev->next = nxt->next;
-        else
-            g_windows = nxt->next;
-
-        if (nxt->next)
-            nxt->next->prev = nxt->prev;
-
-        free(nxt);
-    }
+    struct window_slot* slot = &g_window_slots[handle & X11_HANDLE_SLOT_MASK];
+    slot->win = NULL;
+    slot->generation = (slot->generation + 1) & X11_HANDLE_GENERATION_MASK;
 }
 
-static void destroy_all_windows(void) {
-    if (!g_windows)
+// Contexts are created against a live member of the share group
+static void release_share_ctx(struct window* win) {
+    if (!win->gl_ctx_valid || win->gl_ctx != g_share_ctx)
         return;
 
-    struct winarray* nxt = g_windows;
+    g_share_ctx = NULL;
     for (int i = 0; i < MAX_WINDOWS; i++) {
-        if (nxt->win) {
-            if (nxt->win->gl_ctx_valid)
-                glXDestroyContext(nxt->win->display, nxt->win->gl_ctx);
-            XDestroyWindow(nxt->win->display, nxt->win->window);
-            free(nxt->win);
-        }
-        if (nxt->next)
-            nxt = nxt->next;
-        else
+        struct window* other = g_window_slots[i].win;
+        if (other && other != win && other->gl_ctx_valid) {
+            g_share_ctx = other->gl_ctx;
             break;
+        }
     }
+}
 
-    struct winarray* cur = nxt;
+static void destroy_all_windows(void) {
     for (int i = 0; i < MAX_WINDOWS; i++) {
-        if (nxt->prev)
-            nxt = nxt->prev;
-        free(cur);
-        cur = nxt;
+        struct window_slot* slot = &g_window_slots[i];
+        if (!slot->win)
+            continue;
+
+        destroy_window(slot->win);
+        slot->win = NULL;
+        slot->generation = (slot->generation + 1) & X11_HANDLE_GENERATION_MASK;
     }
+    g_share_ctx = NULL;
 }
 
 static PX_EKeycodes x11_map_keysym(KeySym sym) {
@@ -278,6 +313,25 @@ static PX_EKeycodes x11_map_keysym(KeySym sym) {
     return EKeycode_Unknown;
 }
 
+static void x11_build_keycode_table(Display* display) {
+    int min_keycode = 0, max_keycode = 0;
+    XDisplayKeycodes(display, &min_keycode, &max_keycode);
+
+    memset(g_keycode_table, 0, sizeof(g_keycode_table));
+    for (int kc = min_keycode; kc <= max_keycode && kc < X11_KEYCODE_COUNT; kc++)
+        g_keycode_table[kc] = x11_map_keysym(XkbKeycodeToKeysym(display, (KeyCode)kc, 0, 0));
+}
+
+static PX_EKeycodes x11_map_keycode(unsigned int keycode) {
+    return keycode < X11_KEYCODE_COUNT ? g_keycode_table[keycode] : EKeycode_Unknown;
+}
+
+static uint64_t x11_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
 static PX_EKeycodes x11_map_mousesym(unsigned int button) {
     switch (button) {
         case 1: return EKeycode_MouseLButton;
@@ -294,23 +348,100 @@ static PX_EKeycodes x11_map_mousesym(unsigned int button) {
 }
 
 static t_err_codes x11_init(void) {
+    // The splash and the optional render thread use Xlib off the main thread
+    XInitThreads();
     g_display = XOpenDisplay(NULL);
     if (!g_display)
         return ERR_WS_INIT_FAILED;
     g_screen = DefaultScreen(g_display);
     XkbSetDetectableAutoRepeat(g_display, True, NULL);
+    x11_build_keycode_table(g_display);
+
+    g_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_wake_fd < 0)
+        fprintf(stderr, "Warning: No wake fd, waits only end on input or timeout\n");
+
+#ifdef PX_HAVE_XI2
+    // 2.2 is the first version with smooth scrolling and touch, older servers use core events
+    int event = 0, error = 0, major = 2, minor = 2;
+    if (!XQueryExtension(g_display, "XInputExtension", &g_xi2_opcode, &event, &error) ||
+        XIQueryVersion(g_display, &major, &minor) != Success)
+        g_xi2_opcode = -1;
+#endif
+
     return ERR_SUCCESS;
 }
 
 static void x11_shutdown(void) {
-    if (g_windows)
-        destroy_all_windows();
+    splash_join(true);
+
+    destroy_all_windows();
 
     if (g_display) {
         XCloseDisplay(g_display);
         g_display = NULL;
     }
+    g_xi2_opcode = -1;
+
+    if (g_wake_fd >= 0) {
+        close(g_wake_fd);
+        g_wake_fd = -1;
+    }
+    atomic_store(&g_wake_pending, false);
+}
+
+#ifdef PX_HAVE_XI2
+static void x11_select_xi2(Display* display, Window window) {
+    unsigned char bits[XIMaskLen(XI_LASTEVENT)] = {0};
+    XIEventMask mask = {
+        .deviceid = XIAllMasterDevices,
+        .mask_len = sizeof(bits),
+        .mask = bits
+    };
+    XISetMask(bits, XI_Motion);
+    XISetMask(bits, XI_ButtonPress);
+    XISetMask(bits, XI_ButtonRelease);
+    XISelectEvents(display, window, &mask, 1);
+}
+
+// Master pointer events carry sub-pixel window coordinates and the server time
+// Returns the window the event was reported on, NULL when it is dropped
+static struct window* x11_translate_xi2(Display* display, XEvent* ev, PX_WEvent* we) {
+    if (ev->xcookie.extension != g_xi2_opcode || !XGetEventData(display, &ev->xcookie))
+        return NULL;
+
+    const XIDeviceEvent* de = (const XIDeviceEvent*)ev->xcookie.data;
+    struct window* target = find_window_xid(de->event);
+    bool ok = target != NULL;
+    switch (ev->xcookie.evtype) {
+        case XI_Motion:
+            we->type = PX_WE_MOUSE_MOVE;
+            break;
+        case XI_ButtonPress:
+            we->type = PX_WE_MOUSE_DOWN;
+            we->keycode = x11_map_mousesym((unsigned int)de->detail);
+            break;
+        case XI_ButtonRelease:
+            we->type = PX_WE_MOUSE_UP;
+            we->keycode = x11_map_mousesym((unsigned int)de->detail);
+            break;
+        default:
+            ok = false;
+            break;
+    }
+
+    if (ok) {
+        we->fx = (float)de->event_x;
+        we->fy = (float)de->event_y;
+        we->x = (int)floor(de->event_x);
+        we->y = (int)floor(de->event_y);
+        we->time_ms = (uint32_t)de->time;
+    }
+
+    XFreeEventData(display, &ev->xcookie);
+    return ok ? target : NULL;
 }
+#endif
 
 static t_err_codes x11_create(PX_Window* win) {
     if (!win)
@@ -318,11 +449,14 @@ static t_err_codes x11_create(PX_Window* win) {
 
     win->handle = -1;
 
-    struct window* iwin = (struct window*)malloc(sizeof(struct window));
+    struct window* iwin = (struct window*)calloc(1, sizeof(struct window));
     if (!iwin)
         return ERR_ALLOC_FAILED;
 
+    iwin->owner = win;
     iwin->display = g_display;
+    iwin->width = (int)win->width;
+    iwin->height = (int)win->height;
     Window root = RootWindow(g_display, g_screen);
     iwin->window = XCreateSimpleWindow(
         g_display,
@@ -338,15 +472,22 @@ static t_err_codes x11_create(PX_Window* win) {
     iwin->wm_delete = XInternAtom(g_display, "WM_DELETE_WINDOW", False);
     XSetWMProtocols(g_display, iwin->window, &iwin->wm_delete, 1);
 
+    // With XInput2 the pointer comes through XI events only, never both
+    long pointer_mask = ButtonPressMask | ButtonReleaseMask | PointerMotionMask;
+#ifdef PX_HAVE_XI2
+    if (g_xi2_opcode >= 0) {
+        x11_select_xi2(g_display, iwin->window);
+        pointer_mask = 0;
+    }
+#endif
     XSelectInput(
         g_display,
         iwin->window,
         KeyPressMask |
         KeyReleaseMask |
-        ButtonPressMask |
-        ButtonReleaseMask |
-        PointerMotionMask |
+        pointer_mask |
         StructureNotifyMask |
+        FocusChangeMask |
         ExposureMask
     );
 
@@ -354,6 +495,10 @@ static t_err_codes x11_create(PX_Window* win) {
     XFlush(iwin->display);
 
     win->handle = append_window(iwin);
+    if (win->handle < 0) {
+        destroy_window(iwin);
+        return ERR_INTERNAL;
+    }
     return ERR_SUCCESS;
 }
 
@@ -364,13 +509,10 @@ static void x11_destroy(PX_Window* win) {
     struct window* iwin = get_window(win->handle);
     if (!iwin) return;
 
-    if (iwin->gl_ctx_valid)
-        glXDestroyContext(iwin->display, iwin->gl_ctx);
-    XDestroyWindow(iwin->display, iwin->window);
-    free(iwin);
-
+    release_share_ctx(iwin);
     remove_window(win->handle);
-    
+    destroy_window(iwin);
+
     win->handle = -1;
 }
 
@@ -401,6 +543,7 @@ static t_err_codes x11_hide(PX_Window* win) {
 static t_err_codes x11_poll_events(PX_Window* win) {
     if (!win || win->handle < 0)
         return ERR_INTERNAL;
+    splash_reap();
 
     struct window* iwin = get_window(win->handle);
     if (!iwin) return ERR_WS_NO_WINDOW_FOUND;
@@ -410,18 +553,64 @@ static t_err_codes x11_poll_events(PX_Window* win) {
         XNextEvent(iwin->display, &ev);
 
         PX_WEvent we = {0};
-        KeySym sym;
+        we.arrival_ns = x11_now_ns();
+
+        // Keyboard mappings belong to the display, XI2 cookies name their window inside
+        if (ev.type == MappingNotify) {
+            XRefreshKeyboardMapping(&ev.xmapping);
+            if (ev.xmapping.request == MappingKeyboard)
+                x11_build_keycode_table(iwin->display);
+            continue;
+        }
+#ifdef PX_HAVE_XI2
+        if (ev.type == GenericEvent) {
+            struct window* target = x11_translate_xi2(iwin->display, &ev, &we);
+            if (target)
+                px_we_queue_push(&target->owner->queue, &we);
+            continue;
+        }
+#endif
+
+        // Events for windows that are already gone are dropped
+        struct window* target = find_window_xid(ev.xany.window);
+        if (!target)
+            continue;
+
         switch (ev.type) {
             case ClientMessage:
-                if ((Atom)ev.xclient.data.l[0] == iwin->wm_delete)
+                if ((Atom)ev.xclient.data.l[0] == target->wm_delete)
                     we.type = PX_WE_CLOSE;
                 break;
 
             case MapNotify:
-                XSetInputFocus(iwin->display, iwin->window, RevertToParent, CurrentTime);
+                XSetInputFocus(target->display, target->window, RevertToParent, CurrentTime);
+                we.type = PX_WE_SHOWN;
+                break;
+
+            case UnmapNotify:
+                we.type = PX_WE_HIDDEN;
+                break;
+
+            case FocusIn:
+            case FocusOut:
+                // Grabs (menus, window moves) bounce focus without the user leaving the window
+                if (ev.xfocus.mode != NotifyNormal && ev.xfocus.mode != NotifyWhileGrabbed)
+                    continue;
+                we.type = ev.type == FocusIn ? PX_WE_FOCUS_IN : PX_WE_FOCUS_OUT;
+                break;
+
+            case Expose:
+                if (ev.xexpose.count > 0)
+                    continue;
+                we.type = PX_WE_EXPOSE;
                 break;
 
             case ConfigureNotify:
+                if (ev.xconfigure.width == target->width && ev.xconfigure.height == target->height)
+                    continue;
+                target->width = ev.xconfigure.width;
+                target->height = ev.xconfigure.height;
+
                 we.type = PX_WE_RESIZE;
                 we.w = ev.xconfigure.width;
                 we.h = ev.xconfigure.height;
@@ -429,28 +618,14 @@ static t_err_codes x11_poll_events(PX_Window* win) {
 
             case KeyPress:
                 we.type = PX_WE_KEYDOWN;
-
-                sym = XkbKeycodeToKeysym(
-                    ev.xkey.display,
-                    ev.xkey.keycode,
-                    0,
-                    0
-                );
-
-                we.keycode = x11_map_keysym(sym);
+                we.keycode = x11_map_keycode(ev.xkey.keycode);
+                we.time_ms = (uint32_t)ev.xkey.time;
                 break;
 
             case KeyRelease:
                 we.type = PX_WE_KEYUP;
-
-                sym = XkbKeycodeToKeysym(
-                    ev.xkey.display,
-                    ev.xkey.keycode,
-                    0,
-                    0
-                );
-
-                we.keycode = x11_map_keysym(sym);
+                we.keycode = x11_map_keycode(ev.xkey.keycode);
+                we.time_ms = (uint32_t)ev.xkey.time;
                 break;
 
             case ButtonPress:
@@ -458,6 +633,9 @@ static t_err_codes x11_poll_events(PX_Window* win) {
                 we.keycode = x11_map_mousesym(ev.xbutton.button);
                 we.x = ev.xbutton.x;
                 we.y = ev.xbutton.y;
+                we.fx = (float)we.x;
+                we.fy = (float)we.y;
+                we.time_ms = (uint32_t)ev.xbutton.time;
                 break;
 
             case ButtonRelease:
@@ -465,206 +643,408 @@ static t_err_codes x11_poll_events(PX_Window* win) {
                 we.keycode = x11_map_mousesym(ev.xbutton.button);
                 we.x = ev.xbutton.x;
                 we.y = ev.xbutton.y;
+                we.fx = (float)we.x;
+                we.fy = (float)we.y;
+                we.time_ms = (uint32_t)ev.xbutton.time;
                 break;
 
             case MotionNotify:
                 we.type = PX_WE_MOUSE_MOVE;
                 we.x = ev.xmotion.x;
                 we.y = ev.xmotion.y;
+                we.fx = (float)we.x;
+                we.fy = (float)we.y;
+                we.time_ms = (uint32_t)ev.xmotion.time;
                 break;
 
             default:
                 continue;
         }
 
-        px_we_queue_push(&win->queue, &we);
+        px_we_queue_push(&target->owner->queue, &we);
     }
 
     return ERR_SUCCESS;
 }
 
-static t_err_codes x11_engine_splash(void) {
-    return ERR_SUCCESS; // TODO: Fix Splash Screen
-    int logo_w, logo_h;
-    int logo_bit_depth;
-    int logo_color_type;
-
-    unsigned char* logo_data;
-    t_err_codes err = image_get_png("assets/icons/logo.png", &logo_w, &logo_h, &logo_bit_depth, &logo_color_type, &logo_data);
-    if (err != ERR_SUCCESS)
-        return err;
-
-    for (int y = 0; y < logo_h; y++) {
-        uint8_t* p = logo_data + y * logo_w * 4;
-        for (int x = 0; x < logo_w; x++) {
-            uint8_t a = p[3];
-            p[0] = (p[0] * a) / 255;
-            p[1] = (p[1] * a) / 255;
-            p[2] = (p[2] * a) / 255;
-            p += 4;
-        }
-    }
+static bool x11_wait_events(PX_Window* win, int timeout_ms) {
+    if (!win || win->handle < 0)
+        return false;
 
-    for (int y = 0; y < logo_h; y++) {
-        uint8_t* p = logo_data + y * logo_w * 4;
-        for (int x = 0; x < logo_w; x++) {
-            uint8_t r = p[0];
-            uint8_t g = p[1];
-            uint8_t b = p[2];
-            uint8_t a = p[3];
+    struct window* iwin = get_window(win->handle);
+    if (!iwin) return false;
+
+    // XPending flushes our requests and reads whatever already reached the socket
+    if (XPending(iwin->display))
+        return true;
+
+    struct pollfd pfd[2] = {
+        { .fd = ConnectionNumber(iwin->display), .events = POLLIN },
+        { .fd = g_wake_fd, .events = POLLIN }
+    };
+    int ready;
+    do {
+        ready = poll(pfd, g_wake_fd >= 0 ? 2 : 1, timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+
+    // Cleared before the drain: a wake racing it writes again and the next wait sees that
+    if (ready > 0 && g_wake_fd >= 0 && (pfd[1].revents & POLLIN)) {
+        atomic_store_explicit(&g_wake_pending, false, memory_order_release);
+        uint64_t count;
+        ssize_t n = read(g_wake_fd, &count, sizeof(count));
+        (void)n;
+    }
+    return ready > 0;
+}
 
-            r = (r * a) / 255;
-            g = (g * a) / 255;
-            b = (b * a) / 255;
+// One write per wait, however many wakes come in before it drains
+static void x11_wake(void) {
+    if (g_wake_fd < 0 || atomic_exchange_explicit(&g_wake_pending, true, memory_order_acq_rel))
+        return;
 
-            p[0] = b;
-            p[1] = g;
-            p[2] = r;
-            p[3] = a;
+    uint64_t one = 1;
+    ssize_t n = write(g_wake_fd, &one, sizeof(one));
+    (void)n;
+}
 
-            p += 4;
+// ===== Splash =====
+// The splash owns a second display connection and a thread of its own, so
+// it keeps drawing while the main thread compiles shaders and loads assets.
+
+static uint8_t* splash_load_image(const char* path, int* w, int* h) {
+    // A cooked sibling is already premultiplied and needs no decode
+    char cooked[512];
+    const char* dot = strrchr(path, '.');
+    struct px_ptex_source src;
+    if (dot && snprintf(cooked, sizeof(cooked), "%.*s.ptex", (int)(dot - path), path) < (int)sizeof(cooked) &&
+        px_ptex_read(cooked, &src) == ERR_SUCCESS) {
+        uint8_t* pixels = NULL;
+        size_t count = (size_t)src.header.width * src.header.height;
+        const uint8_t* texels = src.file.data + src.mips[0].offset;
+        bool premultiplied = src.header.flags & PX_PTEX_FLAG_PREMULTIPLIED;
+
+        if (src.header.format == PX_PTEX_FORMAT_BGRA8 || src.header.format == PX_PTEX_FORMAT_RGBA8)
+            pixels = (uint8_t*)malloc(count * 4);
+        if (pixels) {
+            static const uint8_t bgra[4] = { 2, 1, 0, 3 };
+            if (src.header.format == PX_PTEX_FORMAT_BGRA8) {
+                if (premultiplied)
+                    memcpy(pixels, texels, count * 4);
+                else
+                    px_pixel_premultiply(pixels, texels, count);
+            } else if (premultiplied) {
+                px_pixel_swizzle(pixels, texels, count, bgra);
+            } else {
+                px_pixel_premultiply_bgra(pixels, texels, count);
+            }
+            *w = (int)src.header.width;
+            *h = (int)src.header.height;
         }
+        px_ptex_source_free(&src);
+        if (pixels)
+            return pixels;
     }
 
-    Window root = RootWindow(g_display, g_screen);
+    int bit_depth, color_type;
+    uint8_t* pixels = NULL;
+    if (image_get_png(path, w, h, &bit_depth, &color_type, &pixels) != ERR_SUCCESS)
+        return NULL;
+
+    // XRender wants premultiplied BGRA
+    px_pixel_premultiply_bgra(pixels, pixels, (size_t)*w * *h);
+    return pixels;
+}
+
+static long splash_elapsed_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - g_splash.shown.tv_sec) * 1000 + (now.tv_nsec - g_splash.shown.tv_nsec) / 1000000;
+}
+
+struct splash_view {
+    Display* dpy;
+    Window win;
+    Colormap colormap;
+    Pixmap back;
+    Picture back_pic;
+    Picture win_pic;
+    GC gc;
+
+    Pixmap logo;
+    Picture logo_pic;
+    int logo_x, logo_y, logo_w, logo_h;
+};
+
+static bool splash_view_create(struct splash_view* v, Display* dpy, const char* image) {
+    memset(v, 0, sizeof(*v));
+    v->dpy = dpy;
+
+    int screen = DefaultScreen(dpy);
+    Window root = RootWindow(dpy, screen);
 
     XVisualInfo vinfo;
-    if (!XMatchVisualInfo(g_display, g_screen, 32, TrueColor, &vinfo)) {
-        free(logo_data);
-        return ERR_WS_INIT_FAILED;
-    }
+    if (!XMatchVisualInfo(dpy, screen, 32, TrueColor, &vinfo))
+        return false;
 
     XSetWindowAttributes attrs = {0};
-    attrs.colormap = XCreateColormap(
-        g_display,
-        root,
-        vinfo.visual,
-        AllocNone
-    );
+    attrs.colormap = XCreateColormap(dpy, root, vinfo.visual, AllocNone);
     attrs.border_pixel = 0;
     attrs.background_pixel = 0;
-
-    Window win = XCreateWindow(
-        g_display, root,
-        0, 0,
-        600, 300,
+    v->colormap = attrs.colormap;
+
+    int screen_w = DisplayWidth(dpy, screen);
+    int screen_h = DisplayHeight(dpy, screen);
+    v->win = XCreateWindow(
+        dpy, root,
+        (screen_w - SPLASH_W) / 2, (screen_h - SPLASH_H) / 2,
+        SPLASH_W, SPLASH_H,
         0, vinfo.depth,
         InputOutput, vinfo.visual,
         CWColormap | CWBorderPixel | CWBackPixel,
         &attrs
     );
 
-    Atom wm_window_type = XInternAtom(g_display, "_NET_WM_WINDOW_TYPE", False);
-    Atom wm_window_type_splash = XInternAtom(g_display, "_NET_WM_WINDOW_TYPE_SPLASH", False);
-    XChangeProperty(g_display, win, wm_window_type, XA_ATOM, 32, PropModeReplace, (unsigned char*)&wm_window_type_splash, 1);
-    Atom wm_state = XInternAtom(g_display, "_NET_WM_STATE", False);
-    Atom wm_state_above = XInternAtom(g_display, "_NET_WM_STATE_ABOVE", False);
-    Atom wm_state_skip_taskbar = XInternAtom(g_display, "_NET_WM_STATE_SKIP_TASKBAR", False);
-    Atom wm_state_skip_pager = XInternAtom(g_display, "_NET_WM_STATE_SKIP_PAGER", False);
+    Atom wm_window_type = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE", False);
+    Atom wm_window_type_splash = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_SPLASH", False);
+    XChangeProperty(dpy, v->win, wm_window_type, XA_ATOM, 32, PropModeReplace, (unsigned char*)&wm_window_type_splash, 1);
 
+    Atom wm_state = XInternAtom(dpy, "_NET_WM_STATE", False);
     Atom states[] = {
-        wm_state_above,
-        wm_state_skip_taskbar,
-        wm_state_skip_pager
+        XInternAtom(dpy, "_NET_WM_STATE_ABOVE", False),
+        XInternAtom(dpy, "_NET_WM_STATE_SKIP_TASKBAR", False),
+        XInternAtom(dpy, "_NET_WM_STATE_SKIP_PAGER", False)
     };
+    XChangeProperty(dpy, v->win, wm_state, XA_ATOM, 32, PropModeReplace, (unsigned char*)states, 3);
+
+    // Everything is composed off screen and copied in one go, no flicker
+    XRenderPictFormat* win_fmt = XRenderFindVisualFormat(dpy, vinfo.visual);
+    v->win_pic = XRenderCreatePicture(dpy, v->win, win_fmt, 0, NULL);
+    v->back = XCreatePixmap(dpy, v->win, SPLASH_W, SPLASH_H, vinfo.depth);
+    v->back_pic = XRenderCreatePicture(dpy, v->back, win_fmt, 0, NULL);
+    v->gc = XCreateGC(dpy, v->back, 0, NULL);
+
+    int img_w, img_h;
+    uint8_t* pixels = splash_load_image(image, &img_w, &img_h);
+    if (pixels) {
+        v->logo = XCreatePixmap(dpy, v->win, img_w, img_h, 32);
+        GC gc = XCreateGC(dpy, v->logo, 0, NULL);
+        XImage* ximage = XCreateImage(dpy, vinfo.visual, 32, ZPixmap, 0, (char*)pixels, img_w, img_h, 32, img_w * 4);
+        XPutImage(dpy, v->logo, gc, ximage, 0, 0, 0, 0, img_w, img_h);
+        ximage->data = NULL;
+        XDestroyImage(ximage);
+        XFreeGC(dpy, gc);
+        free(pixels);
+
+        v->logo_pic = XRenderCreatePicture(dpy, v->logo, XRenderFindStandardFormat(dpy, PictStandardARGB32), 0, NULL);
+
+        // Fit above the progress area, never upscale
+        double max_w = SPLASH_W - 2 * SPLASH_MARGIN;
+        double max_h = SPLASH_H - 3 * SPLASH_MARGIN;
+        double scale = max_w / img_w < max_h / img_h ? max_w / img_w : max_h / img_h;
+        if (scale > 1.0) scale = 1.0;
+        v->logo_w = (int)(img_w * scale);
+        v->logo_h = (int)(img_h * scale);
+        v->logo_x = (SPLASH_W - v->logo_w) / 2;
+        v->logo_y = (SPLASH_H - 2 * SPLASH_MARGIN - v->logo_h) / 2;
+
+        XTransform xform = {{
+            { XDoubleToFixed(1.0 / scale), 0, 0 },
+            { 0, XDoubleToFixed(1.0 / scale), 0 },
+            { 0, 0, XDoubleToFixed(1.0) }
+        }};
+        XRenderSetPictureTransform(dpy, v->logo_pic, &xform);
+        XRenderSetPictureFilter(dpy, v->logo_pic, FilterBilinear, NULL, 0);
+    } else {
+        fprintf(stderr, "Splash: could not load %s\n", image);
+    }
 
-    XChangeProperty(g_display, win, wm_state, XA_ATOM, 32, PropModeReplace, (unsigned char*)states, 3);
+    XSelectInput(dpy, v->win, ExposureMask | StructureNotifyMask);
+    XMapRaised(dpy, v->win);
+    XFlush(dpy);
 
-    XSelectInput(g_display, win, ExposureMask | KeyPressMask | StructureNotifyMask);
-    XMapRaised(g_display, win);
+    return true;
+}
 
-    for (;;) {
-        XEvent e;
-        XNextEvent(g_display, &e);
-        if (e.type == MapNotify && e.xmap.window == win)
-            break;
+static void splash_view_draw(struct splash_view* v, float progress, const char* stage) {
+    static const XRenderColor black = { 0x0000, 0x0000, 0x0000, 0xFFFF };
+    static const XRenderColor track = { 0x2000, 0x2000, 0x2000, 0xFFFF };
+    static const XRenderColor fill = { 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF };
+
+    XRenderFillRectangle(v->dpy, PictOpSrc, v->back_pic, &black, 0, 0, SPLASH_W, SPLASH_H);
+    if (v->logo_pic)
+        XRenderComposite(v->dpy, PictOpOver, v->logo_pic, None, v->back_pic, 0, 0, 0, 0, v->logo_x, v->logo_y, v->logo_w, v->logo_h);
+
+    if (progress < 0.0f) progress = 0.0f;
+    if (progress > 1.0f) progress = 1.0f;
+    int bar_w = SPLASH_W - 2 * SPLASH_MARGIN;
+    int bar_y = SPLASH_H - SPLASH_MARGIN;
+    XRenderFillRectangle(v->dpy, PictOpSrc, v->back_pic, &track, SPLASH_MARGIN, bar_y, bar_w, SPLASH_BAR_H);
+    XRenderFillRectangle(v->dpy, PictOpSrc, v->back_pic, &fill, SPLASH_MARGIN, bar_y, (unsigned int)(bar_w * progress), SPLASH_BAR_H);
+
+    if (stage[0]) {
+        XSetForeground(v->dpy, v->gc, 0xFFFFFFFF);
+        XDrawString(v->dpy, v->back, v->gc, SPLASH_MARGIN, bar_y - 8, stage, (int)strlen(stage));
     }
- 
-    int screen_w = DisplayWidth(g_display, g_screen);
-    int screen_h = DisplayHeight(g_display, g_screen);
 
-    int win_w = logo_w;
-    int win_h = logo_h;
+    XRenderComposite(v->dpy, PictOpSrc, v->back_pic, None, v->win_pic, 0, 0, 0, 0, 0, 0, SPLASH_W, SPLASH_H);
+    XFlush(v->dpy);
+}
 
-    XMoveWindow(g_display, win, (screen_w - win_w) / 2, (screen_h - win_h) / 2);
+static void splash_view_destroy(struct splash_view* v) {
+    if (v->logo_pic) XRenderFreePicture(v->dpy, v->logo_pic);
+    if (v->logo) XFreePixmap(v->dpy, v->logo);
+    if (v->win_pic) XRenderFreePicture(v->dpy, v->win_pic);
+    if (v->back_pic) XRenderFreePicture(v->dpy, v->back_pic);
+    if (v->back) XFreePixmap(v->dpy, v->back);
+    if (v->gc) XFreeGC(v->dpy, v->gc);
+    if (v->win) XDestroyWindow(v->dpy, v->win);
+    if (v->colormap) XFreeColormap(v->dpy, v->colormap);
+    XSync(v->dpy, False);
+}
 
-    Picture win_pic, img_pic;
+static void splash_finish(void) {
+    pthread_mutex_lock(&g_splash_lock);
+    g_splash.finished = true;
+    pthread_mutex_unlock(&g_splash_lock);
+}
 
-    XRenderPictFormat* win_fmt = XRenderFindVisualFormat(g_display, vinfo.visual);
-    win_pic = XRenderCreatePicture(g_display, win, win_fmt, 0, NULL);
+static void* splash_thread(void* arg) {
+    (void)arg;
+    PX_TRACE_THREAD("splash");
+    struct splash_view view;
+    if (!splash_view_create(&view, g_splash.display, g_splash.image)) {
+        fprintf(stderr, "Splash: no 32-bit visual, splash disabled\n");
+        splash_finish();
+        return NULL;
+    }
 
-    Pixmap bg_pix = XCreatePixmap(g_display, win, 600, 300, vinfo.depth);
-    GC bg_gc = XCreateGC(g_display, bg_pix, 0, NULL);
-    XSetForeground(g_display, bg_gc, BlackPixel(g_display, g_screen));
-    XFillRectangle(g_display, bg_pix, bg_gc, 0, 0, 600, 300);
+    float progress = 0.0f;
+    char stage[SPLASH_STAGE_MAX] = {0};
+    bool dirty = true;
 
-    Picture bg_pic = XRenderCreatePicture(g_display, bg_pix, XRenderFindVisualFormat(g_display, vinfo.visual), 0, NULL);
-    XRenderComposite(g_display, PictOpSrc, bg_pic, None, win_pic, 0, 0, 0, 0, 0, 0, 600, 300);
+    for (;;) {
+        while (XPending(view.dpy)) {
+            XEvent e;
+            XNextEvent(view.dpy, &e);
+            if (e.type == Expose && e.xexpose.count == 0)
+                dirty = true;
+        }
 
-    XRenderPictFormat* pix_fmt = XRenderFindStandardFormat(g_display, PictStandardARGB32);
-    Pixmap pix = XCreatePixmap(g_display, win, logo_w, logo_h, 32);
+        pthread_mutex_lock(&g_splash_lock);
+        if (g_splash.dirty) {
+            progress = g_splash.progress;
+            memcpy(stage, g_splash.stage, sizeof(stage));
+            g_splash.dirty = false;
+            dirty = true;
+        }
+        bool done = g_splash.close && (g_splash.abort || splash_elapsed_ms() >= g_splash.min_ms);
+        if (!done && !dirty) {
+            // Woken early by progress or close, the timeout only catches expose events
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += SPLASH_POLL_MS * 1000000L;
+            if (until.tv_nsec >= 1000000000L) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_splash_wake, &g_splash_lock, &until);
+        }
+        pthread_mutex_unlock(&g_splash_lock);
 
-    GC gc = XCreateGC(g_display, pix, 0, NULL);
-    XImage* ximage = XCreateImage(
-        g_display, vinfo.visual,
-        32, ZPixmap, 0,
-        (char*)logo_data, logo_w, logo_h, 32, logo_w * 4
-    );
-    XPutImage(g_display, pix, gc, ximage, 0, 0, 0, 0, logo_w, logo_h);
-    
-    img_pic = XRenderCreatePicture(g_display, pix, pix_fmt, 0, NULL);
- 
-    int logo_scaled_w = logo_w / 2;
-    int logo_scaled_h = logo_h / 2;
-    int dest_x = screen_w - logo_scaled_w - 50; // right-center offset
-    int dest_y = (screen_h - logo_scaled_h) / 2;
-
-    XRenderComposite(
-        g_display, PictOpOver,
-        img_pic, None,
-        win_pic,
-        0, 0,
-        0, 0,
-        dest_x, dest_y,
-        logo_scaled_w, logo_scaled_h
-    );
+        if (done)
+            break;
+        if (dirty) {
+            PX_TRACE_SCOPE("splash_view_draw");
+            splash_view_draw(&view, progress, stage);
+            dirty = false;
+        }
+    }
 
-    XFlush(g_display);
+    splash_view_destroy(&view);
+    splash_finish();
+    return NULL;
+}
 
-    struct timespec start, now;
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    while (1) {
-        while (XPending(g_display)) {
-            XEvent e;
-            XNextEvent(g_display, &e);
-        }
+static t_err_codes x11_show_splash(const PX_SplashDesc* desc) {
+    if (g_splash.running)
+        return ERR_SUCCESS;
 
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        long elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
-        if (elapsed_ms >= 3000)
-            break;
+    // Its own connection, used only by the splash thread; opened here so a
+    // missing display is reported to the caller instead of on the thread
+    g_splash.display = XOpenDisplay(NULL);
+    if (!g_splash.display)
+        return ERR_WS_INIT_FAILED;
 
-        nanosleep(&(struct timespec){0, 1000000}, NULL);
+    snprintf(g_splash.image, sizeof(g_splash.image), "%s", desc->image ? desc->image : "");
+    g_splash.min_ms = desc->min_ms > 0 ? desc->min_ms : 0;
+    g_splash.progress = 0.0f;
+    g_splash.stage[0] = '\0';
+    g_splash.dirty = false;
+    g_splash.close = false;
+    g_splash.abort = false;
+    g_splash.finished = false;
+    clock_gettime(CLOCK_MONOTONIC, &g_splash.shown);
+
+    if (pthread_create(&g_splash.thread, NULL, splash_thread, NULL) != 0) {
+        XCloseDisplay(g_splash.display);
+        g_splash.display = NULL;
+        return ERR_INTERNAL;
     }
+    g_splash.running = true;
+
+    return ERR_SUCCESS;
+}
+
+static void x11_splash_progress(float progress, const char* stage) {
+    if (!g_splash.running)
+        return;
 
-    XDestroyWindow(g_display, win);
-    XSync(g_display, False);
+    pthread_mutex_lock(&g_splash_lock);
+    g_splash.progress = progress;
+    snprintf(g_splash.stage, sizeof(g_splash.stage), "%s", stage ? stage : "");
+    g_splash.dirty = true;
+    pthread_cond_signal(&g_splash_wake);
+    pthread_mutex_unlock(&g_splash_lock);
+}
 
-    if (img_pic) XRenderFreePicture(g_display, img_pic);
-    if (win_pic) XRenderFreePicture(g_display, win_pic);
-    XFreeColormap(g_display, attrs.colormap);
-    XFreePixmap(g_display, pix);
-    XFreeGC(g_display, gc);
-    if (bg_pic) XRenderFreePicture(g_display, bg_pic);
-    XFreePixmap(g_display, bg_pix);
-    XFreeGC(g_display, bg_gc);
+static void x11_close_splash(void) {
+    if (!g_splash.running)
+        return;
 
-    ximage->data = NULL;
-    XDestroyImage(ximage);
+    pthread_mutex_lock(&g_splash_lock);
+    g_splash.close = true;
+    pthread_cond_signal(&g_splash_wake);
+    pthread_mutex_unlock(&g_splash_lock);
+}
 
-    free(logo_data);
+// Waits for the splash thread; abort skips what is left of the minimum time
+static void splash_join(bool abort) {
+    if (!g_splash.running)
+        return;
 
-    return ERR_SUCCESS;
+    pthread_mutex_lock(&g_splash_lock);
+    g_splash.close = true;
+    g_splash.abort = abort;
+    pthread_cond_signal(&g_splash_wake);
+    pthread_mutex_unlock(&g_splash_lock);
+
+    pthread_join(g_splash.thread, NULL);
+    XCloseDisplay(g_splash.display);
+    g_splash.display = NULL;
+    g_splash.running = false;
+}
+
+// Called from the main thread's poll: once the splash thread is out, its
+// thread and Display go right away instead of waiting for shutdown
+static void splash_reap(void) {
+    if (!g_splash.running)
+        return;
+
+    pthread_mutex_lock(&g_splash_lock);
+    bool finished = g_splash.finished;
+    pthread_mutex_unlock(&g_splash_lock);
+    if (finished)
+        splash_join(false);
 }
 
 static t_err_codes x11_window_design(PX_Window* win, PX_WindowDesign* design) {
@@ -699,16 +1079,97 @@ static t_err_codes x11_create_ctx(PX_Window* win) {
         None
     });
 
-    GLXContext gl_ctx = glXCreateContext(iwin->display, visual, 0, True);
+    if (!visual)
+        return ERR_INTERNAL;
+
+    // One object namespace for all windows, tool windows reuse the main
+    // window's fonts, shaders and buffers instead of uploading their own
+    GLXContext gl_ctx = glXCreateContext(iwin->display, visual, g_share_ctx, True);
+    XFree(visual);
+    if (!gl_ctx)
+        return ERR_INTERNAL;
+
+    if (iwin->gl_ctx_valid) {
+        release_share_ctx(iwin);
+        glXDestroyContext(iwin->display, iwin->gl_ctx);
+    }
     iwin->gl_ctx_valid = true;
     iwin->gl_ctx = gl_ctx;
+    if (!g_share_ctx)
+        g_share_ctx = gl_ctx;
     glXMakeCurrent(iwin->display, iwin->window, gl_ctx);
 
-    XFree(visual);
-
     return ERR_SUCCESS;
 }
 
+static t_err_codes x11_make_current(PX_Window* win) {
+    if (!win)
+        return glXMakeCurrent(g_display, None, NULL) ? ERR_SUCCESS : ERR_INTERNAL;
+    if (win->handle < 0)
+        return ERR_INTERNAL;
+    struct window* iwin = get_window(win->handle);
+    if (!iwin || !iwin->gl_ctx_valid) return ERR_WS_NO_WINDOW_FOUND;
+
+    if (glXGetCurrentContext() == iwin->gl_ctx && glXGetCurrentDrawable() == iwin->window)
+        return ERR_SUCCESS;
+    return glXMakeCurrent(iwin->display, iwin->window, iwin->gl_ctx) ? ERR_SUCCESS : ERR_INTERNAL;
+}
+
+static bool x11_has_glx_extension(Display* display, const char* name) {
+    const char* exts = glXQueryExtensionsString(display, DefaultScreen(display));
+    size_t len = strlen(name);
+    for (const char* at = exts; at && (at = strstr(at, name)); at += len) {
+        if ((at == exts || at[-1] == ' ') && (at[len] == ' ' || at[len] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+typedef void (*x11_swap_interval_ext_fn)(Display*, GLXDrawable, int);
+typedef int (*x11_swap_interval_mesa_fn)(unsigned int);
+typedef int (*x11_swap_interval_sgi_fn)(int);
+
+static t_err_codes x11_set_swap_interval(PX_Window* win, PX_WS_SwapInterval interval) {
+    if (!win || win->handle < 0)
+        return ERR_INTERNAL;
+    struct window* iwin = get_window(win->handle);
+    if (!iwin || !iwin->gl_ctx_valid) return ERR_WS_NO_WINDOW_FOUND;
+
+    // Negative intervals need swap_control_tear, everything else only knows on and off
+    int value = (int)interval;
+    if (value < 0 && !x11_has_glx_extension(iwin->display, "GLX_EXT_swap_control_tear"))
+        value = 1;
+
+    if (x11_has_glx_extension(iwin->display, "GLX_EXT_swap_control")) {
+        x11_swap_interval_ext_fn fn = (x11_swap_interval_ext_fn)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalEXT");
+        if (fn) {
+            fn(iwin->display, iwin->window, value);
+            return ERR_SUCCESS;
+        }
+    }
+
+    // MESA and SGI set the interval of the current context's drawable
+    if (x11_make_current(win) != ERR_SUCCESS)
+        return ERR_INTERNAL;
+    if (value < 0)
+        value = 1;
+
+    if (x11_has_glx_extension(iwin->display, "GLX_MESA_swap_control")) {
+        x11_swap_interval_mesa_fn fn = (x11_swap_interval_mesa_fn)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalMESA");
+        if (fn && fn((unsigned int)value) == 0)
+            return ERR_SUCCESS;
+    }
+
+    // SGI cannot turn sync off
+    if (value > 0 && x11_has_glx_extension(iwin->display, "GLX_SGI_swap_control")) {
+        x11_swap_interval_sgi_fn fn = (x11_swap_interval_sgi_fn)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalSGI");
+        if (fn && fn(value) == 0)
+            return ERR_SUCCESS;
+    }
+
+    return ERR_WS_UNSUPPORTED;
+}
+
 static t_err_codes x11_swap_buffers(PX_Window* win) {
     if (!win || win->handle < 0)
         return ERR_INTERNAL;
@@ -750,9 +1211,15 @@ const t_px_ws_backend px_ws_backend_x11 = {
     .show = x11_show,
     .hide = x11_hide,
     .poll_events = x11_poll_events,
-    .show_splash = x11_engine_splash,
+    .wait_events = x11_wait_events,
+    .wake = x11_wake,
+    .show_splash = x11_show_splash,
+    .splash_progress = x11_splash_progress,
+    .close_splash = x11_close_splash,
     .window_design = x11_window_design,
     .create_ctx = x11_create_ctx,
+    .make_current = x11_make_current,
+    .set_swap_interval = x11_set_swap_interval,
     .swap_buffers = x11_swap_buffers,
     .open_file_selector_dialog = x11_open_file_selector_dialog
 };